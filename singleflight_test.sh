@@ -0,0 +1,147 @@
+#!/bin/bash
+
+# 集成测试脚本：同时部署20个使用同一二进制制品的组件，验证Agent只下载一次
+
+echo "开始测试并发部署的下载合并..."
+
+# 检查构建目录
+if [ ! -d "build" ]; then
+    echo "错误：构建目录不存在，请先运行 build.sh"
+    exit 1
+fi
+
+# 检查可执行文件
+if [ ! -f "build/manager" ] || [ ! -f "build/agent" ]; then
+    echo "错误：可执行文件不存在，请先运行 build.sh"
+    exit 1
+fi
+
+DEPLOY_COUNT=20
+ARTIFACT_PORT=18090
+BUSINESS_ID="singleflight-business"
+ARTIFACT_URL="http://127.0.0.1:$ARTIFACT_PORT/sleep-$$"
+
+cd build
+rm -f artifact_server.log
+
+# 启动制品服务器：每个请求记录一行并延迟2秒返回，保证20个部署都在下载进行中到达
+echo "测试1：启动制品服务器..."
+python3 - $ARTIFACT_PORT > artifact_server.log 2>&1 << 'EOF' &
+import http.server, sys, time
+
+with open("/bin/sleep", "rb") as f:
+    BODY = f.read()
+
+class Handler(http.server.BaseHTTPRequestHandler):
+    def do_GET(self):
+        print("FETCH " + self.path, flush=True)
+        time.sleep(2)
+        self.send_response(200)
+        self.send_header("Content-Length", str(len(BODY)))
+        self.end_headers()
+        self.wfile.write(BODY)
+
+    def log_message(self, *args):
+        pass
+
+http.server.ThreadingHTTPServer(("127.0.0.1", int(sys.argv[1])), Handler).serve_forever()
+EOF
+SERVER_PID=$!
+sleep 1
+
+# 测试Manager启动
+echo "测试2：启动Manager..."
+./manager --port 8080 > manager.log 2>&1 &
+MANAGER_PID=$!
+sleep 2
+
+# 检查Manager是否成功启动
+if ! ps -p $MANAGER_PID > /dev/null; then
+    echo "错误：Manager启动失败"
+    cat manager.log
+    kill $SERVER_PID
+    exit 1
+fi
+echo "Manager启动成功，PID: $MANAGER_PID"
+
+# 测试Agent启动（部署接口监听8081端口）
+echo "测试3：启动Agent..."
+./agent --manager-url http://localhost:8080 --interval 2 > agent.log 2>&1 &
+AGENT_PID=$!
+sleep 5
+
+# 检查Agent是否成功启动
+if ! ps -p $AGENT_PID > /dev/null; then
+    echo "错误：Agent启动失败"
+    cat agent.log
+    kill $MANAGER_PID
+    kill $SERVER_PID
+    exit 1
+fi
+echo "Agent启动成功，PID: $AGENT_PID"
+
+# 同时发送20个部署请求，组件ID不同，二进制制品相同
+echo "测试4：同时发送$DEPLOY_COUNT个部署请求..."
+CURL_PIDS=""
+for i in $(seq 1 $DEPLOY_COUNT); do
+    curl -s -X POST -H "Content-Type: application/json" http://localhost:8081/api/deploy -d "{
+        \"component_id\": \"singleflight-$i\",
+        \"business_id\": \"$BUSINESS_ID\",
+        \"component_name\": \"sleep-$i\",
+        \"type\": \"binary\",
+        \"binary_url\": \"$ARTIFACT_URL\",
+        \"command_args\": [\"1000\"]
+    }" > /dev/null &
+    CURL_PIDS="$CURL_PIDS $!"
+done
+wait $CURL_PIDS
+
+# 等待部署完成
+echo "测试5：等待部署完成..."
+sleep 10
+
+# 检查下载次数
+FETCH_COUNT=$(grep -c "FETCH /sleep-$$" artifact_server.log)
+echo "制品下载次数: $FETCH_COUNT"
+
+# 检查已部署的组件数
+DEPLOYED_COUNT=0
+for i in $(seq 1 $DEPLOY_COUNT); do
+    if [ -x "/opt/resource_monitor/binaries/$BUSINESS_ID/singleflight-$i/sleep-$$" ]; then
+        DEPLOYED_COUNT=$((DEPLOYED_COUNT + 1))
+    fi
+done
+echo "已放入组件目录的制品数: $DEPLOYED_COUNT"
+
+# 停止并移除组件
+echo "测试6：停止组件..."
+for i in $(seq 1 $DEPLOY_COUNT); do
+    curl -s -X POST -H "Content-Type: application/json" http://localhost:8081/api/stop -d "{
+        \"component_id\": \"singleflight-$i\",
+        \"business_id\": \"$BUSINESS_ID\",
+        \"permanently\": true
+    }" > /dev/null
+done
+sleep 2
+
+# 清理进程
+echo "测试完成，清理进程..."
+kill $AGENT_PID
+kill $MANAGER_PID
+kill $SERVER_PID
+rm -rf "/opt/resource_monitor/binaries/$BUSINESS_ID"
+
+if [ "$FETCH_COUNT" -ne 1 ]; then
+    echo "错误：$DEPLOY_COUNT个并发部署下载了$FETCH_COUNT次，应为1次"
+    exit 1
+fi
+if [ "$DEPLOYED_COUNT" -ne "$DEPLOY_COUNT" ]; then
+    echo "错误：只有$DEPLOYED_COUNT个组件得到了制品，应为$DEPLOY_COUNT个"
+    exit 1
+fi
+
+echo "测试结果总结："
+echo "- $DEPLOY_COUNT个并发部署只下载了1次制品"
+echo "- 每个组件目录都得到了制品"
+
+echo "下载合并测试完成！"
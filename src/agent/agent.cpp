@@ -1,12 +1,24 @@
 #include "agent.h"
 #include "cpu_collector.h"
 #include "memory_collector.h"
+#include "disk_collector.h"
+#include "network_collector.h"
+#include "pressure_collector.h"
+#include "sample_writer.h"
+#include "timer_wheel.h"
 #include "http_client.h"
+#include "report_spool.h"
+#include "udp_report_sender.h"
+#include "metrics_shm_writer.h"
 #include "component_manager.h"
 #include "utils/logger.h"
 #include <nlohmann/json.hpp>
 #include <iostream>
 #include <unistd.h>
+#include <sys/timerfd.h>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
 #include <sys/utsname.h>
 #include <netdb.h>
 #include <arpa/inet.h>
@@ -21,14 +33,72 @@
 #include <string>
 #include <future>
 #include <thread>
+#include <random>
+#include <algorithm>
+
+// 上报队列容量：默认15秒上报一次时可缓存约16分钟的上报（5秒一次时约5分钟），更早的在Manager长时间阻塞时丢弃
+const size_t kReportQueueCapacity = 64;
+// 暂存区段文件大小
+const size_t kSpoolSegmentBytes = 4 * 1024 * 1024;
+// Manager不可达时的探测间隔：从1秒开始指数退避到60秒
+const int kReplayBackoffMinMs = 1000;
+const int kReplayBackoffMaxMs = 60000;
+// 增量编码的关键帧间隔和结构数上限：默认15秒上报一次时每15分钟一个关键帧（5秒一次时每5分钟），
+// 丢帧后最多影响到下一个关键帧；上报随慢速采集器是否有新样本在几种结构间切换
+const size_t kDeltaKeyframeInterval = 60;
+const size_t kDeltaMaxSchemas = 8;
+// 不发送心跳时Manager只按上报判断存活（10秒没有上报即离线），上报间隔不能超过该值
+const int kReportOnlyMaxIntervalSec = 5;
+// 心跳间隔不超过Manager离线超时的三分之一，偶尔丢失一两个心跳不会被判定为离线
+const int kHeartbeatsPerTimeout = 3;
 
 Agent::Agent(const std::string &manager_url,
              const std::string &hostname,
-             int collection_interval_sec)
+             int collection_interval_sec,
+             int sample_interval_ms,
+             const std::string &spool_dir,
+             int spool_max_mb,
+             int replay_rate,
+             int batch_size,
+             WireFormat report_format,
+             int compress_level,
+             size_t compress_threshold,
+             int heartbeat_interval_ms,
+             bool udp_transport,
+             const std::string &shm_path,
+             int artifact_cache_mb)
     : manager_url_(manager_url),
       hostname_(hostname),
       collection_interval_sec_(collection_interval_sec),
+      sample_interval_ms_(sample_interval_ms),
+      spool_dir_(spool_dir),
+      spool_max_mb_(spool_max_mb),
+      replay_rate_(replay_rate > 0 ? replay_rate : 1),
+      batch_size_(batch_size > 0 ? batch_size : 1),
+      report_format_(report_format),
+      compress_level_(compress_level),
+      compress_threshold_(compress_threshold),
+      heartbeat_interval_ms_(heartbeat_interval_ms > 0 ? heartbeat_interval_ms : 0),
+      udp_transport_(udp_transport),
+      shm_path_(shm_path),
+      artifact_cache_mb_(artifact_cache_mb),
+      tick_count_(0),
+      missed_ticks_(0),
+      tick_lateness_sum_ms_(0.0),
+      tick_lateness_max_ms_(0.0),
+      delta_encoder_(kDeltaKeyframeInterval, kDeltaMaxSchemas),
+      report_queue_(kReportQueueCapacity),
+      reports_sent_(0),
+      reports_failed_(0),
+      spool_enabled_(false),
+      spool_pending_(0),
+      spool_bytes_(0),
+      spool_dropped_(0),
       running_(false),
+      cpu_collector_(nullptr),
+      memory_collector_(nullptr),
+      heartbeats_sent_(0),
+      heartbeats_failed_(0),
       http_server_(nullptr),
       server_running_(false)
 {
@@ -85,11 +155,45 @@ bool Agent::start()
         return false;
     }
 
+    // 打开本机指标共享内存，失败时不影响上报
+    if (!shm_path_.empty())
+    {
+        metrics_shm_.reset(new MetricsShmWriter(shm_path_));
+        if (!metrics_shm_->open())
+        {
+            LOG_ERROR("Failed to open metrics shm {}, local metrics export disabled", shm_path_);
+            metrics_shm_.reset();
+        }
+    }
+
+    // 打开上报暂存区，失败时Manager不可达期间的上报直接丢弃
+    if (!spool_dir_.empty())
+    {
+        size_t max_segments = static_cast<size_t>(spool_max_mb_ > 0 ? spool_max_mb_ : 1) * 1024 * 1024 / kSpoolSegmentBytes;
+        report_spool_.reset(new ReportSpool(spool_dir_, kSpoolSegmentBytes, max_segments));
+        if (!report_spool_->open())
+        {
+            LOG_ERROR("Failed to open report spool {}, reports will be dropped while Manager is unreachable", spool_dir_);
+            report_spool_.reset();
+        }
+    }
+    // 暂存区在工作线程和发送线程启动前打开，之后只由发送线程访问，工作线程只读取复制出的统计
+    publishSpoolStats();
+
+    // 设置运行标志（需在工作线程启动前设置，否则线程可能直接退出）
+    running_ = true;
+
     // 启动工作线程
     worker_thread_ = std::thread(&Agent::workerThread, this);
 
-    // 设置运行标志
-    running_ = true;
+    // 启动上报发送线程
+    sender_thread_ = std::thread(&Agent::senderThread, this);
+
+    // 启动心跳线程
+    if (heartbeat_interval_ms_ > 0)
+    {
+        heartbeat_thread_ = std::thread(&Agent::heartbeatThread, this);
+    }
 
     return true;
 }
@@ -114,6 +218,29 @@ void Agent::stop()
         worker_thread_.join();
     }
 
+    // 工作线程是共享内存唯一的写入方，结束后写入writer_pid为0并解除映射
+    metrics_shm_.reset();
+
+    // 唤醒并等待发送线程结束，队列中未发送的上报写入暂存区（未启用暂存区时丢弃）
+    {
+        std::lock_guard<std::mutex> lock(sender_mutex_);
+    }
+    sender_cv_.notify_one();
+    if (sender_thread_.joinable())
+    {
+        sender_thread_.join();
+    }
+
+    // 唤醒并等待心跳线程结束
+    {
+        std::lock_guard<std::mutex> lock(heartbeat_mutex_);
+    }
+    heartbeat_cv_.notify_one();
+    if (heartbeat_thread_.joinable())
+    {
+        heartbeat_thread_.join();
+    }
+
     // 停止HTTP服务器
     if (server_running_ && http_server_)
     {
@@ -147,8 +274,34 @@ bool Agent::registerToManager()
     register_info["cpu_model"] = getCpuModel();
     register_info["gpu_count"] = getGpuCount();
 
-    // 发送注册请求
-    nlohmann::json response = http_client_->registerAgent(register_info);
+    // 发送注册请求；使用二进制编码时Manager须在响应的report_formats中声明支持该格式，
+    // 否则（如旧版本Manager无法解析请求体）回退为JSON，必要时用JSON重新注册。
+    // 增量编码有状态，只用于上报，注册请求使用JSON
+    WireFormat register_format = report_format_ == kWireDelta ? kWireJson : report_format_;
+    nlohmann::json response = sendRegistration(register_info, register_format);
+    if (report_format_ != kWireJson && !response.value("retryable", false))
+    {
+        bool supported = false;
+        if (response.contains("status") && response["status"] == "success" && response.contains("report_formats"))
+        {
+            for (const auto &format : response["report_formats"])
+            {
+                if (format == wireFormatName(report_format_))
+                {
+                    supported = true;
+                }
+            }
+        }
+        if (!supported)
+        {
+            LOG_INFO("Manager does not accept {} reports, falling back to json", wireFormatName(report_format_));
+            report_format_ = kWireJson;
+            if (register_format != kWireJson && (!response.contains("status") || response["status"] != "success"))
+            {
+                response = sendRegistration(register_info, kWireJson);
+            }
+        }
+    }
 
     // 检查响应
     if (response.contains("status") && response["status"] == "success")
@@ -159,7 +312,46 @@ bool Agent::registerToManager()
             agent_id_ = response["node_id"];
             writeAgentIdToFile(agent_id_file, agent_id_);
         }
-        LOG_INFO("Successfully registered to Manager with Node ID: {}", agent_id_);
+        LOG_INFO("Successfully registered to Manager with Node ID: {}, report format: {}", agent_id_, wireFormatName(report_format_));
+
+        // Manager在响应中给出心跳的离线超时；旧版本Manager没有心跳接口，只按上报判断存活
+        if (heartbeat_interval_ms_ > 0 && !response.contains("heartbeat_timeout_ms"))
+        {
+            LOG_INFO("Manager does not accept heartbeats, liveness follows reports only");
+            heartbeat_interval_ms_ = 0;
+        }
+        if (heartbeat_interval_ms_ > 0)
+        {
+            int max_interval_ms = response["heartbeat_timeout_ms"].get<int>() / kHeartbeatsPerTimeout;
+            if (max_interval_ms > 0 && heartbeat_interval_ms_ > max_interval_ms)
+            {
+                LOG_INFO("Heartbeat interval lowered to {} ms to fit Manager timeout", max_interval_ms);
+                heartbeat_interval_ms_ = max_interval_ms;
+            }
+        }
+        else if (collection_interval_sec_ > kReportOnlyMaxIntervalSec)
+        {
+            LOG_INFO("Report interval lowered to {} s since heartbeats are off", kReportOnlyMaxIntervalSec);
+            collection_interval_sec_ = kReportOnlyMaxIntervalSec;
+        }
+
+        // UDP上报：Manager在响应中给出UDP端口才启用，否则（未开启UDP监听或旧版本）使用HTTP
+        if (udp_transport_ && !udp_sender_)
+        {
+            if (response.contains("udp_port") && report_format_ != kWireDelta)
+            {
+                std::unique_ptr<UdpReportSender> sender(new UdpReportSender(http_client_->host(), response["udp_port"].get<int>()));
+                if (sender->open())
+                {
+                    LOG_INFO("Sending reports over UDP to {}:{}", http_client_->host(), response["udp_port"].get<int>());
+                    udp_sender_ = std::move(sender);
+                }
+            }
+            else
+            {
+                LOG_INFO("Manager does not accept UDP reports, using HTTP");
+            }
+        }
 
         // 将response中的components保存到component_manager中
         if (response.contains("components"))
@@ -179,52 +371,734 @@ bool Agent::registerToManager()
     }
 }
 
-// 采集并上报资源信息
-void Agent::collectAndReportResources()
+nlohmann::json Agent::sendRegistration(const nlohmann::json &register_info, WireFormat format)
 {
-    nlohmann::json report_json;
-    report_json["node_id"] = agent_id_;
-    report_json["timestamp"] = std::time(nullptr);
+    if (format == kWireJson)
+    {
+        return http_client_->registerAgent(register_info);
+    }
+    std::string body;
+    encodeJson(format, register_info, body);
+    return http_client_->registerAgent(body, wireContentType(format));
+}
+
+namespace
+{
+
+// 当前系统时间（纳秒），调度tick与上报时间对齐到系统时间的整数边界
+long long realtimeNs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return static_cast<long long>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+// 做窗口聚合的指标：只有在一个上报周期内明显波动的使用率和PSI。容量、核心数等静态值和负载均值
+// （内核已做平滑）聚合后与上报值相同，不聚合；Manager把聚合值存在对应指标行的列中
+const struct
+{
+    const char *type;
+    const char *metric;
+} kWindowMetrics[] = {
+    {"cpu", "usage_percent"},
+    {"memory", "usage_percent"},
+    {"pressure", "cpu_some_avg10"},
+    {"pressure", "memory_some_avg10"},
+    {"pressure", "io_some_avg10"},
+};
+
+// 把采集样本中的数值字段写入已建立的采样窗口：顶层字段按字段名，嵌套一层对象中的字段按"对象名_字段名"
+// （如pressure的cpu.some_avg10记为cpu_some_avg10），没有窗口的字段和数组（各核心、各设备、各接口）中的字段忽略
+class MetricWindowWriter : public SampleWriter
+{
+public:
+    MetricWindowWriter(std::map<std::string, MetricWindow> &windows, std::string &name)
+        : windows_(windows), name_(name), prefix_length_(0), depth_(0), skip_(0)
+    {
+    }
 
-    nlohmann::json resource_json;
-    // 采集各类资源信息，按类型放入resource字段
-    for (const auto &collector : collectors_)
+    void beginObject(const char *key) override
     {
-        resource_json[collector->getType()] = collector->collect();
+        if (skip_ > 0 || depth_ > 0 || !key)
+        {
+            ++skip_;
+            return;
+        }
+        ++depth_;
+        name_.assign(key);
+        name_ += '_';
+        prefix_length_ = name_.size();
+    }
+
+    void endObject() override
+    {
+        if (skip_ > 0)
+        {
+            --skip_;
+            return;
+        }
+        --depth_;
+    }
+
+    void beginArray(const char *) override { ++skip_; }
+    void endArray() override { --skip_; }
+    void writeDouble(const char *key, double value) override { add(key, value); }
+    void writeInt(const char *key, long long value) override { add(key, static_cast<double>(value)); }
+    void writeUint(const char *key, unsigned long long value) override { add(key, static_cast<double>(value)); }
+    void writeString(const char *, const std::string &) override {}
+    void writeJson(const char *, const nlohmann::json &) override {}
+
+private:
+    void add(const char *key, double value)
+    {
+        if (skip_ > 0)
+        {
+            return;
+        }
+        // name_在采样间复用，字段名不变时不分配内存
+        name_.resize(depth_ > 0 ? prefix_length_ : 0);
+        name_ += key;
+        auto window = windows_.find(name_);
+        if (window != windows_.end())
+        {
+            window->second.add(value);
+        }
+    }
+
+    std::map<std::string, MetricWindow> &windows_;
+    std::string &name_;
+    size_t prefix_length_;
+    int depth_;
+    int skip_;
+};
+
+}
+
+// 调度器tick和时间轮槽位数：50ms一格，一圈3.2s，30s的慢速采集器约绕10圈
+const int kSchedulerTickMs = 50;
+const size_t kSchedulerSlots = 64;
+// 上报定时器在时间轮中的标识，采集器使用其在collectors_中的下标
+const int kReportTimerId = -1;
+
+// 按各采集器声明的周期建立调度状态
+void Agent::initSchedules()
+{
+    schedules_.clear();
+    schedules_.resize(collectors_.size());
+    for (size_t i = 0; i < collectors_.size(); ++i)
+    {
+        CollectorSchedule &schedule = schedules_[i];
+        schedule.type = collectors_[i]->getType();
+        schedule.interval_ms = collectors_[i]->getIntervalMs();
+        // --sample-interval-ms覆盖快速采集器的周期
+        if (sample_interval_ms_ > 0 && collectors_[i]->getCostClass() == ResourceCollector::kCostFast)
+        {
+            schedule.interval_ms = sample_interval_ms_;
+        }
+        schedule.interval_ticks = static_cast<uint64_t>((schedule.interval_ms + kSchedulerTickMs - 1) / kSchedulerTickMs);
+        if (schedule.interval_ticks == 0)
+        {
+            schedule.interval_ticks = 1;
+        }
+        // 窗口容量按一个上报周期的采样次数预留，上报延迟时覆盖最旧的样本
+        schedule.window_capacity = static_cast<size_t>(collection_interval_sec_) * 1000 / static_cast<size_t>(schedule.interval_ms) + 1;
+        for (const auto &metric : kWindowMetrics)
+        {
+            if (schedule.type == metric.type)
+            {
+                schedule.windows.emplace(metric.metric, MetricWindow(schedule.window_capacity));
+            }
+        }
+        LOG_INFO("Collector {} scheduled every {} ms", schedule.type, schedule.interval_ms);
+    }
+}
+
+// 运行一个到期的采集器
+void Agent::runCollector(size_t index, long long due_ns)
+{
+    CollectorSchedule &schedule = schedules_[index];
+    long long begin_ns = realtimeNs();
+    auto begin = std::chrono::steady_clock::now();
+
+    collectors_[index]->sample();
+    MetricWindowWriter writer(schedule.windows, metric_name_buffer_);
+    collectors_[index]->writeSample(writer);
+
+    // 同机服务读取的CPU和内存样本
+    if (metrics_shm_)
+    {
+        if (collectors_[index].get() == cpu_collector_)
+        {
+            metrics_shm_->publishCpu(cpu_collector_->lastSample(), begin_ns);
+        }
+        else if (collectors_[index].get() == memory_collector_)
+        {
+            metrics_shm_->publishMemory(memory_collector_->lastSample(), begin_ns);
+        }
+    }
+
+    auto end = std::chrono::steady_clock::now();
+
+    // 抖动：实际开始时间相对计划时间的延迟
+    double jitter_ms = static_cast<double>(begin_ns - due_ns) / 1e6;
+    schedule.jitter_sum_ms += jitter_ms;
+    if (jitter_ms > schedule.jitter_max_ms)
+    {
+        schedule.jitter_max_ms = jitter_ms;
+    }
+    ++schedule.runs;
+    schedule.last_duration_us = std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
+    schedule.last_sample_time = end;
+    schedule.fresh = true;
+}
+
+// 上报资源信息
+void Agent::reportResources(long long timestamp)
+{
+    // 直接从各采集器的样本序列化为上报格式，缓冲区在上报间复用
+    report_buffer_.clear();
+    switch (report_format_)
+    {
+    case kWireCbor:
+    {
+        CborWriter writer(report_buffer_);
+        writeReport(writer, timestamp);
+        break;
+    }
+    case kWireMsgPack:
+    {
+        MsgPackWriter writer(report_buffer_);
+        writeReport(writer, timestamp);
+        break;
+    }
+    case kWireDelta:
+    {
+        DeltaWriter writer(delta_sample_);
+        writeReport(writer, timestamp);
+        delta_encoder_.encode(delta_sample_, report_buffer_);
+        break;
+    }
+    default:
+    {
+        JsonTextWriter writer(report_buffer_);
+        writeReport(writer, timestamp);
+        break;
+    }
+    }
+
+    // 放入上报队列后立即返回，不等待Manager响应；队列满时丢弃最旧的上报
+    if (report_queue_.push(report_buffer_))
+    {
+        LOG_ERROR("Report queue full, dropped the oldest report ({} dropped in total)", report_queue_.dropped());
+    }
+    {
+        std::lock_guard<std::mutex> lock(sender_mutex_);
+    }
+    sender_cv_.notify_one();
+}
+
+void Agent::writeReport(SampleWriter &writer, long long timestamp)
+{
+    auto now = std::chrono::steady_clock::now();
+
+    writer.beginObject(nullptr);
+    writer.writeString("node_id", agent_id_);
+    writer.writeInt("timestamp", timestamp);
+
+    // 只上报自上次上报以来有新样本的采集器，慢速采集器在其周期到达后才出现
+    writer.beginObject("resource");
+    for (size_t i = 0; i < collectors_.size(); ++i)
+    {
+        if (schedules_[i].fresh)
+        {
+            writer.beginObject(schedules_[i].type.c_str());
+            collectors_[i]->writeSample(writer);
+            writer.endObject();
+        }
+    }
+    writer.endObject();
+
+    // 本上报周期内波动指标（见kWindowMetrics）的窗口聚合值。UDP上报要放进一个数据报，不带聚合值，窗口照常清空
+    bool compact = udp_sender_ != nullptr;
+    if (!compact)
+    {
+        writer.beginObject("aggregates");
+    }
+    for (auto &schedule : schedules_)
+    {
+        if (!schedule.fresh || schedule.windows.empty())
+        {
+            continue;
+        }
+        if (!compact)
+        {
+            writer.beginObject(schedule.type.c_str());
+        }
+        for (auto &field : schedule.windows)
+        {
+            if (field.second.size() > 0)
+            {
+                if (!compact)
+                {
+                    writer.beginObject(field.first.c_str());
+                    field.second.aggregate(writer);
+                    writer.endObject();
+                }
+                field.second.clear();
+            }
+        }
+        if (!compact)
+        {
+            writer.endObject();
+        }
+    }
+    if (!compact)
+    {
+        writer.endObject();
+    }
+
+    // 调度统计：周期、本上报周期内的运行次数和抖动、最近一次耗时、样本年龄
+    writer.beginObject("scheduler");
+    writer.writeInt("tick_ms", kSchedulerTickMs);
+    writer.writeUint("ticks", tick_count_);
+    writer.writeUint("missed_ticks", missed_ticks_);
+    writer.writeDouble("tick_lateness_avg_ms", tick_count_ > 0 ? tick_lateness_sum_ms_ / static_cast<double>(tick_count_) : 0.0);
+    writer.writeDouble("tick_lateness_max_ms", tick_lateness_max_ms_);
+    tick_count_ = 0;
+    missed_ticks_ = 0;
+    tick_lateness_sum_ms_ = 0.0;
+    tick_lateness_max_ms_ = 0.0;
+    for (auto &schedule : schedules_)
+    {
+        writer.beginObject(schedule.type.c_str());
+        writer.writeInt("interval_ms", schedule.interval_ms);
+        writer.writeUint("runs", schedule.runs);
+        writer.writeDouble("jitter_avg_ms", schedule.runs > 0 ? schedule.jitter_sum_ms / static_cast<double>(schedule.runs) : 0.0);
+        writer.writeDouble("jitter_max_ms", schedule.jitter_max_ms);
+        writer.writeInt("last_duration_us", schedule.last_duration_us);
+        writer.writeInt("age_ms", std::chrono::duration_cast<std::chrono::milliseconds>(now - schedule.last_sample_time).count());
+        writer.endObject();
+
+        schedule.runs = 0;
+        schedule.jitter_sum_ms = 0.0;
+        schedule.jitter_max_ms = 0.0;
+        schedule.fresh = false;
+    }
+    writer.endObject();
+
+    // 与Manager之间长连接的累计复用统计
+    HttpClient::ConnectionStats transport = http_client_->getConnectionStats();
+    writer.beginObject("transport");
+    writer.writeUint("requests", transport.requests);
+    writer.writeUint("connections", transport.connections);
+    writer.writeUint("reused", transport.reused);
+    writer.writeUint("retries", transport.retries);
+    writer.writeUint("failures", transport.failures);
+    writer.writeUint("queue_capacity", report_queue_.capacity());
+    writer.writeUint("queue_pending", report_queue_.size());
+    writer.writeUint("queue_dropped", report_queue_.dropped());
+    writer.writeUint("reports_sent", reports_sent_);
+    writer.writeUint("reports_failed", reports_failed_);
+    if (spool_enabled_)
+    {
+        writer.writeUint("spool_pending", spool_pending_);
+        writer.writeUint("spool_bytes", spool_bytes_);
+        writer.writeUint("spool_dropped", spool_dropped_);
+    }
+    if (report_format_ == kWireDelta)
+    {
+        writer.writeUint("delta_keyframes", delta_encoder_.keyframes());
+    }
+    if (udp_sender_)
+    {
+        UdpReportSender::Stats udp = udp_sender_->getStats();
+        writer.writeUint("udp_sent", udp.sent);
+        writer.writeUint("udp_compressed", udp.compressed);
+        writer.writeUint("udp_bytes", udp.bytes);
+        writer.writeUint("udp_too_large", udp.too_large);
+        writer.writeUint("udp_failed", udp.failed);
+    }
+    if (heartbeat_interval_ms_ > 0)
+    {
+        writer.writeUint("heartbeats_sent", heartbeats_sent_);
+        writer.writeUint("heartbeats_failed", heartbeats_failed_);
+    }
+    // 请求体压缩比和压缩/解压耗费的CPU时间
+    HttpCompression::Stats compression = http_client_->getCompressionStats();
+    if (http_client_->compressionEnabled() || compression.compressed > 0 || compression.decompressed > 0)
+    {
+        writer.beginObject("compression");
+        writer.writeUint("compressed", compression.compressed);
+        writer.writeUint("skipped", compression.skipped);
+        writer.writeUint("raw_bytes", compression.raw_bytes);
+        writer.writeUint("encoded_bytes", compression.encoded_bytes);
+        writer.writeDouble("ratio", compression.encoded_bytes > 0 ? static_cast<double>(compression.raw_bytes) / static_cast<double>(compression.encoded_bytes) : 0.0);
+        writer.writeUint("compress_us", compression.compress_us);
+        writer.writeUint("decompressed", compression.decompressed);
+        writer.writeUint("response_wire_bytes", compression.wire_bytes);
+        writer.writeUint("response_bytes", compression.decoded_bytes);
+        writer.writeUint("decompress_us", compression.decompress_us);
+        writer.endObject();
+    }
+    writer.endObject();
+
+    // 本机制品缓存的累计命中情况，部署同一镜像或二进制时免于下载的字节数；未部署过时不写，上报保持精简
+    ArtifactCache::Stats cache = component_manager_->getArtifactCacheStats();
+    if (cache.hits + cache.misses > 0 || cache.files + cache.images > 0)
+    {
+        writer.beginObject("artifact_cache");
+        writer.writeUint("hits", cache.hits);
+        writer.writeUint("misses", cache.misses);
+        writer.writeDouble("hit_rate", cache.hits + cache.misses > 0 ? static_cast<double>(cache.hits) / static_cast<double>(cache.hits + cache.misses) : 0.0);
+        writer.writeUint("bytes_saved", cache.bytes_saved);
+        writer.writeUint("bytes_downloaded", cache.bytes_downloaded);
+        writer.writeUint("files", cache.files);
+        writer.writeUint("images", cache.images);
+        writer.writeUint("bytes", cache.bytes);
+        writer.writeUint("quota_bytes", cache.quota_bytes);
+        writer.writeUint("evictions", cache.evictions);
+        writer.writeUint("corrupted", cache.corrupted);
+        writer.writeUint("coalesced", cache.coalesced);
+        writer.endObject();
     }
-    report_json["resource"] = resource_json;
 
     nlohmann::json components = component_manager_->getComponentStatus();
-    report_json["components"] = components;
+    if (metrics_shm_)
+    {
+        metrics_shm_->publishComponents(components, realtimeNs());
+    }
+    writer.writeJson("components", components);
+    writer.endObject();
+}
+
+Agent::ReportResult Agent::postReports(const std::vector<std::string> &reports, size_t count, bool batch)
+{
+    // 按上报本身的编码确定Content-Type，暂存区中切换格式前的上报仍按原格式发送
+    WireFormat format = detectWireFormat(reports[0]);
+    nlohmann::json response;
+    if (batch)
+    {
+        // 各上报已编码好，直接拼接成数组
+        encodeBatch(format, reports, count, batch_body_);
+        response = http_client_->reportRawBatch(batch_body_, wireContentType(format));
+    }
+    else
+    {
+        response = http_client_->reportRawData(reports[0], wireContentType(format));
+    }
+
+    // Manager的增量解码状态缺失或序号不连续（丢帧、Manager重启）时，下一帧发送关键帧
+    if (response.value("keyframe_required", false))
+    {
+        LOG_INFO("Manager requested a delta keyframe");
+        delta_encoder_.requestKeyframe();
+    }
 
-    // 上报资源数据
-    nlohmann::json response = http_client_->reportData(report_json);
     // 检查响应
     if (response.contains("status") && response["status"] == "success")
     {
-        // LOG_INFO("Successfully reported resource data to Manager: {}", report_json.dump(4));
+        reports_sent_ += count;
+        return kReportSent;
     }
-    else
+
+    reports_failed_ += count;
+    LOG_ERROR("Failed to report resource data to Manager: {}", response.contains("message") ? response["message"].get<std::string>() : "Unknown error");
+    return response.value("retryable", false) ? kReportRetry : kReportRejected;
+}
+
+void Agent::senderThread()
+{
+    std::mt19937 random(std::random_device{}());
+    const int replay_interval_ms = 1000 / replay_rate_;
+    // 每次重放最多取的条数：至少一秒的重放量，批量模式下至少一批
+    const size_t replay_batch = static_cast<size_t>(std::max(batch_size_, replay_rate_));
+    int backoff_ms = 0;                         // 大于0表示Manager不可达，按此间隔探测
+
+    // 攒批的上报和暂存区读出的上报，元素缓冲区循环复用
+    std::vector<std::string> pending(static_cast<size_t>(batch_size_));
+    size_t pending_count = 0;
+    std::vector<std::string> replay;
+
+    // 下一次探测时间加±50%随机抖动，大量Agent在Manager重启后不会同时重连
+    auto next_probe = [&random](int delay_ms)
+    {
+        std::uniform_int_distribution<int> jitter(delay_ms / 2, delay_ms + delay_ms / 2);
+        return std::chrono::steady_clock::now() + std::chrono::milliseconds(jitter(random));
+    };
+    // 启动时暂存区中的上报同样延迟随机时间后开始重放
+    auto next_replay = next_probe(kReplayBackoffMinMs);
+
+    // 攒够的一批发送失败且可重试时写入暂存区
+    auto flush_pending = [&]()
+    {
+        if (postReports(pending, pending_count, batch_size_ > 1) == kReportRetry && report_spool_)
+        {
+            for (size_t i = 0; i < pending_count; ++i)
+            {
+                report_spool_->append(pending[i]);
+            }
+            backoff_ms = kReplayBackoffMinMs;
+            next_replay = next_probe(backoff_ms);
+        }
+        pending_count = 0;
+    };
+
+    while (running_)
+    {
+        {
+            std::unique_lock<std::mutex> lock(sender_mutex_);
+            auto ready = [this]() { return !running_ || !report_queue_.empty(); };
+            if (report_spool_ && !report_spool_->empty())
+            {
+                sender_cv_.wait_until(lock, next_replay, ready);
+            }
+            else
+            {
+                sender_cv_.wait(lock, ready);
+            }
+        }
+
+        // 一次取完积压的全部上报，按生成顺序在同一个长连接上发送，每攒够batch_size_条发送一次，取完后发送剩余的；
+        // 暂存区中还有更早的上报或Manager不可达时追加到暂存区，保证按时间顺序送达
+        while (running_ && report_queue_.tryPop(pending[pending_count]))
+        {
+            // UDP上报不确认、不暂存，发送失败即丢弃；放不进一个数据报的上报走下面的HTTP路径
+            if (udp_sender_ && udp_sender_->send(pending[pending_count]) != UdpReportSender::kUdpTooLarge)
+            {
+                continue;
+            }
+            if (report_spool_ && (backoff_ms > 0 || !report_spool_->empty()))
+            {
+                report_spool_->append(pending[pending_count]);
+                continue;
+            }
+            if (++pending_count == pending.size())
+            {
+                flush_pending();
+            }
+        }
+        // 队列已取空，不足一批的上报也立即发送，不等后续上报凑满一批
+        if (running_ && pending_count > 0)
+        {
+            flush_pending();
+        }
+
+        // 从暂存区最旧的上报开始通过批量接口重放，按replay_rate_限速；
+        // Manager仍不可达时这次重放即为探测，失败后退避
+        if (running_ && report_spool_ && !report_spool_->empty() && std::chrono::steady_clock::now() >= next_replay)
+        {
+            size_t count = report_spool_->peek(replay, replay_batch);
+            // 一批只能是同一种编码，遇到格式不同的上报时留到下一批
+            WireFormat format = detectWireFormat(replay[0]);
+            for (size_t i = 1; i < count; ++i)
+            {
+                if (detectWireFormat(replay[i]) != format)
+                {
+                    count = i;
+                    break;
+                }
+            }
+            if (postReports(replay, count, true) == kReportRetry)
+            {
+                backoff_ms = backoff_ms > 0 ? std::min(backoff_ms * 2, kReplayBackoffMaxMs) : kReplayBackoffMinMs;
+                next_replay = next_probe(backoff_ms);
+            }
+            else
+            {
+                if (backoff_ms > 0)
+                {
+                    LOG_INFO("Manager reachable again, replaying {} spooled reports", report_spool_->pendingCount());
+                    backoff_ms = 0;
+                }
+                report_spool_->pop(count);
+                next_replay = std::chrono::steady_clock::now() + std::chrono::milliseconds(replay_interval_ms * static_cast<int>(count));
+            }
+        }
+        publishSpoolStats();
+    }
+
+    // 退出时攒批中和队列中未发送的上报写入暂存区，下次启动后重放
+    if (report_spool_)
     {
-        LOG_ERROR("Failed to report resource data to Manager: {}", response.contains("message") ? response["message"].get<std::string>() : "Unknown error");
+        for (size_t i = 0; i < pending_count; ++i)
+        {
+            report_spool_->append(pending[i]);
+        }
+        std::string body;
+        while (report_queue_.tryPop(body))
+        {
+            report_spool_->append(body);
+        }
+        publishSpoolStats();
     }
 }
 
-void Agent::workerThread()
+void Agent::publishSpoolStats()
 {
+    if (!report_spool_)
+    {
+        spool_enabled_ = false;
+        return;
+    }
+    spool_pending_ = report_spool_->pendingCount();
+    spool_bytes_ = report_spool_->diskBytes();
+    spool_dropped_ = report_spool_->dropped();
+    spool_enabled_ = true;
+}
+
+void Agent::heartbeatThread()
+{
+    // 心跳使用独立的长连接，不会排在上报和暂存区重放的大请求之后
+    HttpClient client(manager_url_);
+    const std::chrono::milliseconds interval(heartbeat_interval_ms_);
+    auto next = std::chrono::steady_clock::now();
     while (running_)
     {
-        // 采集并上报资源信息
-        collectAndReportResources();
+        nlohmann::json response = client.heartbeat(agent_id_);
+        if (response.contains("status") && response["status"] == "success")
+        {
+            ++heartbeats_sent_;
+        }
+        else
+        {
+            ++heartbeats_failed_;
+        }
 
-        // 等待指定的时间间隔
-        for (int i = 0; i < collection_interval_sec_ && running_; ++i)
+        // 按固定节拍发送，发送耗时不累积；Manager不可达导致错过的节拍不补发
+        next += interval;
+        auto now = std::chrono::steady_clock::now();
+        if (next < now)
         {
-            std::this_thread::sleep_for(std::chrono::seconds(1));
+            next = now + interval;
         }
+        std::unique_lock<std::mutex> lock(heartbeat_mutex_);
+        heartbeat_cv_.wait_until(lock, next, [this]() { return !running_; });
     }
 }
 
+void Agent::workerThread()
+{
+    // 各采集器按自己的周期在时间轮上调度，上报定时器按上报周期触发并打包各采集器的最新样本
+    initSchedules();
+    const long long tick_ns = kSchedulerTickMs * 1000000LL;
+    uint64_t report_ticks = static_cast<uint64_t>(collection_interval_sec_) * 1000 / kSchedulerTickMs;
+    if (report_ticks == 0)
+    {
+        report_ticks = 1;
+    }
+
+    // 绝对时间的周期定时器：内核按系统时间的tick边界触发，采集和上报的耗时不会累积成漂移
+    int timer_fd = timerfd_create(CLOCK_REALTIME, TFD_CLOEXEC);
+    if (timer_fd < 0)
+    {
+        LOG_ERROR("Failed to create collection timer: {}", strerror(errno));
+        return;
+    }
+
+    TimerWheel wheel(kSchedulerSlots);
+    uint64_t base_tick = 0;                                 // 时间轮tick 0对应的绝对tick号（自1970年起）
+    std::vector<uint64_t> due_ticks(collectors_.size(), 1);
+    uint64_t report_due_tick = 1;
+
+    // 下一个对齐到周期整数倍的绝对tick，换算为时间轮tick；不同节点的采集和上报因此落在相同的时间点
+    auto aligned_next = [&base_tick](uint64_t current, uint64_t interval)
+    {
+        return ((base_tick + current) / interval + 1) * interval - base_tick;
+    };
+
+    // 从下一个tick边界开始周期触发；首次启动时所有采集器在第一个tick各运行一次，系统时间被修改后重新对齐
+    auto arm = [&](bool initial) -> bool
+    {
+        base_tick = static_cast<uint64_t>(realtimeNs() / tick_ns);
+        long long first_ns = static_cast<long long>(base_tick + 1) * tick_ns;
+        struct itimerspec spec;
+        spec.it_value.tv_sec = first_ns / 1000000000LL;
+        spec.it_value.tv_nsec = first_ns % 1000000000LL;
+        spec.it_interval.tv_sec = 0;
+        spec.it_interval.tv_nsec = tick_ns;
+        // TFD_TIMER_CANCEL_ON_SET：系统时间被修改时read返回ECANCELED
+        if (timerfd_settime(timer_fd, TFD_TIMER_ABSTIME | TFD_TIMER_CANCEL_ON_SET, &spec, nullptr) != 0)
+        {
+            LOG_ERROR("Failed to arm collection timer: {}", strerror(errno));
+            return false;
+        }
+
+        wheel = TimerWheel(kSchedulerSlots);
+        for (size_t i = 0; i < collectors_.size(); ++i)
+        {
+            due_ticks[i] = initial ? 1 : aligned_next(0, schedules_[i].interval_ticks);
+            wheel.schedule(static_cast<int>(i), due_ticks[i]);
+        }
+        report_due_tick = aligned_next(0, report_ticks);
+        wheel.schedule(kReportTimerId, report_due_tick);
+        return true;
+    };
+
+    std::vector<int> expired;
+    expired.reserve(collectors_.size() + 1);
+    bool armed = arm(true);
+    while (running_ && armed)
+    {
+        uint64_t expirations = 0;
+        ssize_t n = read(timer_fd, &expirations, sizeof(expirations));
+        if (n != static_cast<ssize_t>(sizeof(expirations)))
+        {
+            if (n < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (n < 0 && errno == ECANCELED)
+            {
+                LOG_INFO("System clock changed, realigning collection ticks");
+                armed = arm(false);
+                continue;
+            }
+            LOG_ERROR("Failed to read collection timer: {}", strerror(errno));
+            break;
+        }
+
+        // 每个tick的迟到时间；线程被延迟时一次返回多次到期，时间轮一次推进多个tick，每个定时器只触发一次
+        uint64_t target = wheel.currentTick() + expirations;
+        double lateness_ms = static_cast<double>(realtimeNs() - static_cast<long long>(base_tick + target) * tick_ns) / 1e6;
+        ++tick_count_;
+        missed_ticks_ += expirations - 1;
+        tick_lateness_sum_ms_ += lateness_ms;
+        if (lateness_ms > tick_lateness_max_ms_)
+        {
+            tick_lateness_max_ms_ = lateness_ms;
+        }
+
+        expired.clear();
+        wheel.advanceTo(target, expired);
+
+        long long report_timestamp = -1;
+        for (int id : expired)
+        {
+            if (id == kReportTimerId)
+            {
+                // 上报时间戳取计划时间，为上报周期的整数秒
+                report_timestamp = static_cast<long long>(base_tick + report_due_tick) * tick_ns / 1000000000LL;
+                report_due_tick = aligned_next(target, report_ticks);
+                wheel.schedule(kReportTimerId, report_due_tick - target);
+                continue;
+            }
+
+            size_t index = static_cast<size_t>(id);
+            runCollector(index, static_cast<long long>(base_tick + due_ticks[index]) * tick_ns);
+            due_ticks[index] = aligned_next(target, schedules_[index].interval_ticks);
+            wheel.schedule(id, due_ticks[index] - target);
+        }
+
+        // 同一tick到期的采集器先运行，上报包含它们的最新样本
+        if (report_timestamp >= 0)
+        {
+            reportResources(report_timestamp);
+        }
+    }
+
+    close(timer_fd);
+}
+
 // 启动HTTP服务器
 bool Agent::startHttpServer(int port)
 {
@@ -330,13 +1204,20 @@ nlohmann::json Agent::handleStopRequest(const nlohmann::json &request)
 
 void Agent::init() {
     // 创建HTTP客户端
-    http_client_ = std::make_shared<HttpClient>(manager_url_);
+    http_client_ = std::make_shared<HttpClient>(manager_url_, compress_level_, compress_threshold_);
     // 创建资源采集器
     collectors_.clear();
-    collectors_.push_back(std::make_unique<CpuCollector>());
-    collectors_.push_back(std::make_unique<MemoryCollector>());
+    auto cpu_collector = std::make_unique<CpuCollector>();
+    auto memory_collector = std::make_unique<MemoryCollector>();
+    cpu_collector_ = cpu_collector.get();
+    memory_collector_ = memory_collector.get();
+    collectors_.push_back(std::move(cpu_collector));
+    collectors_.push_back(std::move(memory_collector));
+    collectors_.push_back(std::make_unique<DiskCollector>());
+    collectors_.push_back(std::make_unique<NetworkCollector>());
+    collectors_.push_back(std::make_unique<PressureCollector>());
     // 创建组件管理器
-    component_manager_ = std::make_shared<ComponentManager>(http_client_);
+    component_manager_ = std::make_shared<ComponentManager>(http_client_, artifact_cache_mb_);
 }
 
 // 获取本地agent_id
@@ -6,13 +6,25 @@
 #include <chrono>
 #include <thread>
 #include <atomic>
+#include <mutex>
+#include <condition_variable>
 #include <vector>
 #include <functional>
+#include <map>
+#include <cstdint>
 #include <nlohmann/json.hpp>
+#include "metric_window.h"
+#include "sample_writer.h"
+#include "report_queue.h"
 
 // 前向声明
 class ResourceCollector;
 class HttpClient;
+class ReportSpool;
+class UdpReportSender;
+class MetricsShmWriter;
+class CpuCollector;
+class MemoryCollector;
 class ComponentManager;
 class NodeController;
 
@@ -32,11 +44,35 @@ public:
      * 
      * @param manager_url Manager的URL地址
      * @param hostname 主机名
-     * @param collection_interval_sec 资源采集间隔（秒）
+     * @param collection_interval_sec 资源上报间隔（秒）
+     * @param sample_interval_ms 快速采集器的采集周期（毫秒），0表示使用采集器声明的周期
+     * @param spool_dir Manager不可达时暂存上报的目录，为空表示不暂存
+     * @param spool_max_mb 暂存区大小上限（MB）
+     * @param replay_rate Manager恢复后每秒重放的暂存上报数上限
+     * @param batch_size 每积攒多少条上报批量发送一次，1表示逐条发送
+     * @param report_format 注册和上报的编码格式，Manager不支持时回退为JSON
+     * @param compress_level 发往Manager的请求体的gzip压缩级别（1-9），0表示不压缩
+     * @param compress_threshold 压缩的最小请求体字节数
+     * @param heartbeat_interval_ms 心跳间隔（毫秒），0表示不发送心跳，只靠上报判断存活
+     * @param udp_transport 是否用UDP数据报发送上报（注册、心跳和部署命令仍用HTTP），Manager不支持时使用HTTP；UDP上报不带窗口聚合值
+     * @param shm_path 本机指标共享内存文件路径，为空表示不写入
+     * @param artifact_cache_mb 本机制品缓存中二进制制品的容量上限（MB）
      */
     Agent(const std::string& manager_url, 
           const std::string& hostname = "",
-          int collection_interval_sec = 5);
+          int collection_interval_sec = 15,
+          int sample_interval_ms = 0,
+          const std::string& spool_dir = "report_spool",
+          int spool_max_mb = 64,
+          int replay_rate = 5,
+          int batch_size = 1,
+          WireFormat report_format = kWireJson,
+          int compress_level = 0,
+          size_t compress_threshold = 1024,
+          int heartbeat_interval_ms = 1000,
+          bool udp_transport = false,
+          const std::string& shm_path = "",
+          int artifact_cache_mb = 4096);
     
     /**
      * 析构函数
@@ -64,17 +100,85 @@ private:
      * @return 是否注册成功
      */
     bool registerToManager();
+
+    /**
+     * 按指定格式发送一次注册请求
+     * 
+     * @param register_info 注册信息
+     * @param format 编码格式
+     * @return 服务器响应的JSON对象
+     */
+    nlohmann::json sendRegistration(const nlohmann::json& register_info, WireFormat format);
     
     /**
-     * 采集并上报资源信息
+     * 按各采集器声明的周期建立调度状态
+     */
+    void initSchedules();
+
+    /**
+     * 运行一个到期的采集器，样本数值写入其指标窗口，并记录抖动和耗时
+     * 
+     * @param index 采集器在collectors_中的下标
+     * @param due_ns 计划运行的系统时间（纳秒）
+     */
+    void runCollector(size_t index, long long due_ns);
+
+    /**
+     * 将有新样本的采集器的最新样本、窗口聚合值和调度统计序列化，放入上报队列
+     * 
+     * @param timestamp 上报时间戳（秒），为对齐后的计划上报时间
      */
-    void collectAndReportResources();
+    void reportResources(long long timestamp);
+
+    /**
+     * 将一次上报的全部内容写给writer
+     * 
+     * @param writer 序列化输出，决定编码格式
+     * @param timestamp 上报时间戳（秒）
+     */
+    void writeReport(SampleWriter& writer, long long timestamp);
     
     /**
      * 工作线程函数
      */
     void workerThread();
 
+    /**
+     * 上报发送结果
+     */
+    enum ReportResult {
+        kReportSent,        // Manager已接收
+        kReportRejected,    // Manager拒绝，重试也不会成功，丢弃
+        kReportRetry        // Manager不可达或暂时出错，需要稍后重发
+    };
+
+    /**
+     * 发送若干条上报
+     * 
+     * @param reports 上报内容，各条须为同一编码格式
+     * @param count 发送前count条
+     * @param batch 是否使用批量上报接口，否则count须为1
+     * @return 发送结果
+     */
+    ReportResult postReports(const std::vector<std::string>& reports, size_t count, bool batch);
+
+    /**
+     * 发送线程函数，取出上报队列中积压的全部上报依次发送；
+     * Manager不可达时上报写入暂存区，恢复后按生成顺序限速重放
+     */
+    void senderThread();
+
+    /**
+     * 把暂存区的统计复制到原子变量，供工作线程生成上报时读取，仅发送线程调用
+     */
+    void publishSpoolStats();
+
+    /**
+     * 心跳线程函数，按心跳间隔通过独立的长连接发送心跳，Manager据此判断节点存活，
+     * 上报间隔因此可以比离线检测的超时长
+     */
+    void heartbeatThread();
+
     std::string getHostname();
 
     std::string getLocalIpAddress();
@@ -123,13 +227,72 @@ private:
     int gpu_count_;                                // GPU数量
     
     int collection_interval_sec_;                  // 资源采集间隔（秒）
+    int sample_interval_ms_;                       // 快速采集器的采集周期（毫秒），0表示使用采集器声明的周期
+    std::string spool_dir_;                        // 上报暂存目录
+    int spool_max_mb_;                             // 暂存区大小上限（MB）
+    int replay_rate_;                              // 每秒重放的暂存上报数上限
+    int batch_size_;                               // 每批发送的上报数
+    WireFormat report_format_;                     // 上报的编码格式，注册时按Manager支持的格式确定
+    int compress_level_;                           // 请求体的gzip压缩级别
+    size_t compress_threshold_;                    // 压缩的最小请求体字节数
+    int heartbeat_interval_ms_;                    // 心跳间隔（毫秒），0表示不发送心跳
+    bool udp_transport_;                           // 是否用UDP发送上报
+    std::string shm_path_;                         // 本机指标共享内存文件路径
+    int artifact_cache_mb_;                        // 制品缓存容量上限（MB）
+
+    /**
+     * 一个采集器的调度状态，与collectors_下标一一对应
+     */
+    struct CollectorSchedule {
+        std::string type;                                  // 采集器类型
+        int interval_ms = 0;                               // 采集周期（毫秒）
+        uint64_t interval_ticks = 1;                       // 采集周期（调度tick数）
+        size_t window_capacity = 1;                        // 指标窗口容量
+        std::map<std::string, MetricWindow> windows;       // 做窗口聚合的指标的采样窗口
+        bool fresh = false;                                // 上次上报后是否有新样本
+        unsigned long long runs = 0;                       // 本上报周期内的运行次数
+        double jitter_sum_ms = 0.0;                        // 本上报周期内的抖动累计
+        double jitter_max_ms = 0.0;                        // 本上报周期内的最大抖动
+        long long last_duration_us = 0;                    // 最近一次采集耗时
+        std::chrono::steady_clock::time_point last_sample_time; // 最近一次采集完成时间
+    };
+    std::vector<CollectorSchedule> schedules_;     // 各采集器的调度状态
+    unsigned long long tick_count_;                // 本上报周期内的调度tick数
+    unsigned long long missed_ticks_;              // 本上报周期内错过的tick数（定时器一次返回多次到期）
+    double tick_lateness_sum_ms_;                  // 本上报周期内tick迟到时间累计
+    double tick_lateness_max_ms_;                  // 本上报周期内tick最大迟到时间
+    std::string metric_name_buffer_;               // 复用的指标名缓冲区
+    std::string report_buffer_;                    // 复用的上报编码缓冲区
+    DeltaSample delta_sample_;                     // 复用的增量编码结构和值
+    DeltaEncoder delta_encoder_;                   // 增量编码器，发送线程收到Manager要求时请求关键帧
+    ReportQueue report_queue_;                     // 采集线程与发送线程之间的上报队列
+    std::mutex sender_mutex_;                      // 发送线程等待用的互斥锁
+    std::condition_variable sender_cv_;            // 唤醒发送线程
+    std::atomic<unsigned long long> reports_sent_;   // 累计发送成功的上报数
+    std::atomic<unsigned long long> reports_failed_; // 累计发送失败的上报数
+    std::unique_ptr<ReportSpool> report_spool_;    // Manager不可达时的上报暂存区，启动线程前打开，之后仅发送线程读写
+    std::atomic<bool> spool_enabled_;              // 暂存区是否已打开
+    std::atomic<unsigned long long> spool_pending_;  // 暂存区中未发送的上报数，由发送线程更新
+    std::atomic<unsigned long long> spool_bytes_;    // 暂存区段文件占用的字节数，由发送线程更新
+    std::atomic<unsigned long long> spool_dropped_;  // 暂存区因超过上限丢弃的上报数，由发送线程更新
+    std::string batch_body_;                       // 复用的批量上报请求体缓冲区，仅发送线程使用
+    std::unique_ptr<UdpReportSender> udp_sender_;  // UDP上报发送，注册时Manager提供UDP端口才创建，仅发送线程发送
     std::atomic<bool> running_;                    // 运行标志
     
     std::shared_ptr<HttpClient> http_client_;      // HTTP客户端
     std::vector<std::unique_ptr<ResourceCollector>> collectors_;  // 资源采集器集合
+    CpuCollector* cpu_collector_;                  // collectors_中的CPU采集器
+    MemoryCollector* memory_collector_;            // collectors_中的内存采集器
+    std::unique_ptr<MetricsShmWriter> metrics_shm_;  // 本机指标共享内存，仅工作线程写入
     std::shared_ptr<ComponentManager> component_manager_; // 组件管理器
     
     std::thread worker_thread_;                    // 工作线程
+    std::thread sender_thread_;                    // 上报发送线程
+    std::thread heartbeat_thread_;                 // 心跳线程
+    std::mutex heartbeat_mutex_;                   // 心跳线程等待用的互斥锁
+    std::condition_variable heartbeat_cv_;         // 停止时唤醒心跳线程
+    std::atomic<unsigned long long> heartbeats_sent_;   // 累计发送成功的心跳数
+    std::atomic<unsigned long long> heartbeats_failed_; // 累计发送失败的心跳数
     
     httplib::Server* http_server_;                 // HTTP服务器
     std::atomic<bool> server_running_;             // 服务器运行标志
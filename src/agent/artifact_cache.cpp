@@ -0,0 +1,500 @@
+#include "artifact_cache.h"
+#include "dir_utils.h"
+#include "sftp_client.h"
+#include "utils/logger.h"
+#include "utils/sha256.h"
+#include <algorithm>
+#include <vector>
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+#include <curl/curl.h>
+#include <nlohmann/json.hpp>
+
+namespace {
+
+// 缓存文件和放入组件目录的文件都是可执行的
+const mode_t kObjectMode = 0755;
+
+size_t writeToSink(char* data, size_t size, size_t nmemb, void* userdata) {
+    // 返回值小于数据长度时CURL中止下载
+    const ArtifactCache::Sink& sink = *static_cast<const ArtifactCache::Sink*>(userdata);
+    return sink(data, size * nmemb) ? size * nmemb : 0;
+}
+
+bool isDigest(const std::string& value) {
+    if (value.size() != 64) {
+        return false;
+    }
+    for (char c : value) {
+        if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f'))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 整个文件复制到已打开的fd
+bool copyFile(const std::string& source, int out_fd) {
+    int in_fd = open(source.c_str(), O_RDONLY | O_CLOEXEC);
+    if (in_fd < 0) {
+        return false;
+    }
+    char buffer[65536];
+    ssize_t n;
+    bool ok = true;
+    while (ok && (n = read(in_fd, buffer, sizeof(buffer))) != 0) {
+        if (n < 0) {
+            ok = errno == EINTR;
+            continue;
+        }
+        for (ssize_t written = 0; written < n;) {
+            ssize_t w = write(out_fd, buffer + written, static_cast<size_t>(n - written));
+            if (w < 0 && errno != EINTR) {
+                ok = false;
+                break;
+            }
+            written += w > 0 ? w : 0;
+        }
+    }
+    close(in_fd);
+    return ok;
+}
+
+}
+
+ArtifactCache::ArtifactCache(const std::string& directory, unsigned long long quota_bytes)
+    : directory_(directory), quota_bytes_(quota_bytes), use_seq_(0), temp_seq_(0), total_bytes_(0), stats_() {
+    stats_.quota_bytes = quota_bytes;
+}
+
+bool ArtifactCache::open() {
+    if (!create_directories(directory_ + "/objects") || !create_directories(directory_ + "/tmp")) {
+        LOG_ERROR("Failed to create artifact cache directory {}", directory_);
+        return false;
+    }
+
+    // 上次未完成的下载
+    DIR* dir = opendir((directory_ + "/tmp").c_str());
+    if (dir) {
+        struct dirent* entry;
+        while ((entry = readdir(dir)) != nullptr) {
+            if (entry->d_name[0] != '.') {
+                unlink((directory_ + "/tmp/" + entry->d_name).c_str());
+            }
+        }
+        closedir(dir);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    loadIndex();
+    evict("");
+    saveIndex();
+    LOG_INFO("Artifact cache {}: {} files ({} bytes), {} images", directory_, files_.size(), total_bytes_, images_.size());
+    return true;
+}
+
+bool ArtifactCache::fetchFile(const std::string& url, const std::string& sha256,
+                              const std::string& target_path, std::string& error) {
+    std::string digest;
+    unsigned long long size = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        digest = resolveDigest(url, sha256, false);
+        auto it = files_.find(digest);
+        if (it != files_.end()) {
+            size = it->second.size;
+        } else {
+            digest.clear();
+        }
+    }
+
+    if (!digest.empty()) {
+        // 命中时校验内容，组件目录中的硬链接被改写也会反映到缓存文件上
+        std::string actual;
+        bool valid = Sha256::hashFile(objectPath(digest), actual) && actual == digest;
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = files_.find(digest);
+        if (valid && it != files_.end()) {
+            if (!linkObject(digest, target_path, error)) {
+                return false;
+            }
+            it->second.last_used = ++use_seq_;
+            ++stats_.hits;
+            stats_.bytes_saved += size;
+            saveIndex();
+            LOG_INFO("Artifact cache hit for {} ({}), linked to {}", url, digest, target_path);
+            return true;
+        }
+        if (!valid && it != files_.end()) {
+            LOG_WARN("Artifact {} failed verification, downloading {} again", digest, url);
+            ++stats_.corrupted;
+            removeObject(digest);
+            saveIndex();
+        }
+    }
+
+    // 同一制品同时只下载一次，同时到达的部署等待其完成后直接链接
+    bool shared = false;
+    std::string key = "file:" + (sha256.empty() ? url : sha256);
+    if (!coalesce(key, [&](std::string& load_error) { return storeDownload(url, sha256, load_error); }, shared, error)) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    digest = resolveDigest(url, sha256, true);
+    auto it = files_.find(digest);
+    if (it == files_.end()) {
+        error = "Artifact evicted before it could be linked: " + url;
+        return false;
+    }
+    if (!linkObject(digest, target_path, error)) {
+        return false;
+    }
+    it->second.last_used = ++use_seq_;
+    if (shared) {
+        ++stats_.hits;
+        stats_.bytes_saved += it->second.size;
+        LOG_INFO("Shared in-flight download of {} ({}), linked to {}", url, digest, target_path);
+    }
+    saveIndex();
+    return true;
+}
+
+bool ArtifactCache::coalesce(const std::string& key, const Loader& load, bool& shared, std::string& error) {
+    LoadResult result = loads_.run(key, [&load]() {
+        LoadResult loaded;
+        loaded.ok = load(loaded.error);
+        return loaded;
+    }, shared);
+    if (!result.ok) {
+        error = result.error.empty() ? std::string("download failed") : result.error;
+    }
+    return result.ok;
+}
+
+bool ArtifactCache::findImage(const std::string& url, const std::string& sha256, bool loaded,
+                              const std::function<bool(const std::string&)>& present, std::string& image_id) {
+    std::string digest;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        digest = resolveDigest(url, sha256, loaded);
+        auto it = images_.find(digest);
+        if (it == images_.end()) {
+            return false;
+        }
+        image_id = it->second.image_id;
+    }
+
+    // 镜像可能已被删除，不在时下载重新导入
+    bool found = present(image_id);
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = images_.find(digest);
+    if (!found || it == images_.end() || it->second.image_id != image_id) {
+        if (it != images_.end() && it->second.image_id == image_id) {
+            images_.erase(it);
+            saveIndex();
+        }
+        return false;
+    }
+    it->second.last_used = ++use_seq_;
+    ++stats_.hits;
+    stats_.bytes_saved += it->second.size;
+    saveIndex();
+    return true;
+}
+
+void ArtifactCache::addImage(const std::string& url, const std::string& sha256,
+                             const std::string& image_id, unsigned long long size) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++stats_.misses;
+    stats_.bytes_downloaded += size;
+    images_[sha256] = Entry{size, ++use_seq_, image_id};
+    urls_[url] = sha256;
+    saveIndex();
+}
+
+ArtifactCache::Stats ArtifactCache::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats = stats_;
+    stats.files = files_.size();
+    stats.images = images_.size();
+    stats.bytes = total_bytes_;
+    stats.coalesced = loads_.sharedCount();
+    return stats;
+}
+
+bool ArtifactCache::download(const std::string& url, const Sink& sink, long timeout_sec, std::string& error) {
+    if (url.rfind("sftp://", 0) == 0) {
+        SFTPClient sftp;
+        return sftp.download(url, sink, error);
+    }
+
+    CURL* curl = curl_easy_init();
+    if (!curl) {
+        error = "Failed to create CURL handle";
+        return false;
+    }
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(curl, CURLOPT_FAILONERROR, 1L);
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, timeout_sec);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeToSink);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &sink);
+    CURLcode code = curl_easy_perform(curl);
+    if (code != CURLE_OK) {
+        error = curl_easy_strerror(code);
+    }
+    curl_easy_cleanup(curl);
+    return code == CURLE_OK;
+}
+
+std::string ArtifactCache::resolveDigest(const std::string& url, const std::string& sha256, bool loaded) const {
+    if (!sha256.empty()) {
+        return sha256;
+    }
+    // 同一URL可能重新发布为不同内容，没有期望摘要时不复用以前的下载，只取刚完成的这次
+    if (!loaded) {
+        return "";
+    }
+    auto it = urls_.find(url);
+    return it != urls_.end() ? it->second : "";
+}
+
+bool ArtifactCache::storeDownload(const std::string& url, const std::string& sha256, std::string& error) {
+    std::string temp_path, digest;
+    unsigned long long size = 0;
+    if (!downloadObject(url, temp_path, digest, size, error)) {
+        return false;
+    }
+    if (!sha256.empty() && digest != sha256) {
+        unlink(temp_path.c_str());
+        error = "SHA-256 mismatch: expected " + sha256 + ", got " + digest;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++stats_.misses;
+    stats_.bytes_downloaded += size;
+    // 不同URL的相同内容已在缓存中时保留已有文件
+    if (files_.count(digest) > 0) {
+        unlink(temp_path.c_str());
+    } else {
+        if (rename(temp_path.c_str(), objectPath(digest).c_str()) != 0) {
+            error = "Failed to store artifact: " + std::string(strerror(errno));
+            unlink(temp_path.c_str());
+            return false;
+        }
+        files_[digest] = Entry{size, 0, ""};
+        total_bytes_ += size;
+    }
+    files_[digest].last_used = ++use_seq_;
+    urls_[url] = digest;
+    evict(digest);
+    saveIndex();
+    return true;
+}
+
+bool ArtifactCache::downloadObject(const std::string& url, std::string& temp_path, std::string& digest,
+                                   unsigned long long& size, std::string& error) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        temp_path = directory_ + "/tmp/" + std::to_string(getpid()) + "-" + std::to_string(++temp_seq_);
+    }
+    int fd = ::open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, kObjectMode);
+    if (fd < 0) {
+        error = "Failed to create " + temp_path + ": " + strerror(errno);
+        return false;
+    }
+
+    // 边下载边计算摘要，不再读回文件
+    Sha256 sha;
+    size = 0;
+    bool ok = download(url, [&](const char* data, size_t length) {
+        sha.update(data, length);
+        size += length;
+        for (size_t written = 0; written < length;) {
+            ssize_t n = write(fd, data + written, length - written);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                error = "Failed to write " + temp_path + ": " + strerror(errno);
+                return false;
+            }
+            written += static_cast<size_t>(n);
+        }
+        return true;
+    }, 300, error);
+    if (close(fd) != 0 && ok) {
+        error = "Failed to write " + temp_path + ": " + strerror(errno);
+        ok = false;
+    }
+    if (!ok) {
+        unlink(temp_path.c_str());
+        if (error.empty()) {
+            error = "download failed";
+        }
+        return false;
+    }
+    digest = sha.hexDigest();
+    return true;
+}
+
+bool ArtifactCache::linkObject(const std::string& digest, const std::string& target_path, std::string& error) {
+    size_t last_slash = target_path.find_last_of('/');
+    if (last_slash != std::string::npos && last_slash > 0) {
+        create_directories(target_path.substr(0, last_slash));
+    }
+
+    // 先放到同目录的临时名再改名，替换正在运行的旧文件也不受影响
+    std::string object = objectPath(digest);
+    std::string temp_path = target_path + ".artifact-" + std::to_string(getpid()) + "-" + std::to_string(++temp_seq_);
+    if (link(object.c_str(), temp_path.c_str()) != 0) {
+        int out_fd = ::open(temp_path.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, kObjectMode);
+        if (out_fd < 0) {
+            error = "Failed to create " + temp_path + ": " + strerror(errno);
+            return false;
+        }
+        int in_fd = ::open(object.c_str(), O_RDONLY | O_CLOEXEC);
+        bool ok = in_fd >= 0 && ioctl(out_fd, FICLONE, in_fd) == 0;
+        if (in_fd >= 0) {
+            close(in_fd);
+        }
+        if (!ok) {
+            ok = copyFile(object, out_fd);
+        }
+        if (close(out_fd) != 0 || !ok) {
+            error = "Failed to copy artifact to " + target_path;
+            unlink(temp_path.c_str());
+            return false;
+        }
+    }
+    if (rename(temp_path.c_str(), target_path.c_str()) != 0) {
+        error = "Failed to place artifact at " + target_path + ": " + strerror(errno);
+        unlink(temp_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+void ArtifactCache::removeObject(const std::string& digest) {
+    auto it = files_.find(digest);
+    if (it != files_.end()) {
+        total_bytes_ -= std::min(total_bytes_, it->second.size);
+        files_.erase(it);
+    }
+    unlink(objectPath(digest).c_str());
+    for (auto url = urls_.begin(); url != urls_.end();) {
+        if (url->second == digest && images_.count(digest) == 0) {
+            url = urls_.erase(url);
+        } else {
+            ++url;
+        }
+    }
+}
+
+void ArtifactCache::evict(const std::string& keep) {
+    if (total_bytes_ <= quota_bytes_) {
+        return;
+    }
+    std::vector<std::pair<uint64_t, std::string>> candidates;
+    for (const auto& it : files_) {
+        if (it.first != keep) {
+            candidates.emplace_back(it.second.last_used, it.first);
+        }
+    }
+    std::sort(candidates.begin(), candidates.end());
+    for (const auto& candidate : candidates) {
+        if (total_bytes_ <= quota_bytes_) {
+            break;
+        }
+        // 仍被组件目录链接的文件删除后不释放空间
+        struct stat st;
+        if (stat(objectPath(candidate.second).c_str(), &st) == 0 && st.st_nlink > 1) {
+            continue;
+        }
+        LOG_INFO("Evicting artifact {} from cache", candidate.second);
+        removeObject(candidate.second);
+        ++stats_.evictions;
+    }
+    if (total_bytes_ > quota_bytes_) {
+        LOG_WARN("Artifact cache holds {} bytes in use by components, above the {} byte quota", total_bytes_, quota_bytes_);
+    }
+}
+
+void ArtifactCache::loadIndex() {
+    std::ifstream file(directory_ + "/index.json");
+    if (!file) {
+        return;
+    }
+    nlohmann::json index = nlohmann::json::parse(file, nullptr, false);
+    if (!index.is_object()) {
+        LOG_WARN("Ignoring unreadable artifact cache index in {}", directory_);
+        return;
+    }
+
+    // 文件已不存在的项丢弃，大小以文件为准
+    if (index.contains("files") && index["files"].is_object()) {
+        for (auto it = index["files"].begin(); it != index["files"].end(); ++it) {
+            struct stat st;
+            if (!isDigest(it.key()) || stat(objectPath(it.key()).c_str(), &st) != 0) {
+                continue;
+            }
+            Entry entry{static_cast<unsigned long long>(st.st_size), it.value().value("last_used", 0ULL), ""};
+            files_[it.key()] = entry;
+            total_bytes_ += entry.size;
+            use_seq_ = std::max(use_seq_, entry.last_used);
+        }
+    }
+    if (index.contains("images") && index["images"].is_object()) {
+        for (auto it = index["images"].begin(); it != index["images"].end(); ++it) {
+            Entry entry{it.value().value("size", 0ULL), it.value().value("last_used", 0ULL),
+                        it.value().value("image_id", std::string())};
+            if (!entry.image_id.empty()) {
+                images_[it.key()] = entry;
+                use_seq_ = std::max(use_seq_, entry.last_used);
+            }
+        }
+    }
+}
+
+void ArtifactCache::saveIndex() {
+    nlohmann::json index = {
+        {"files", nlohmann::json::object()},
+        {"images", nlohmann::json::object()}
+    };
+    for (const auto& it : files_) {
+        index["files"][it.first] = {{"size", it.second.size}, {"last_used", it.second.last_used}};
+    }
+    for (const auto& it : images_) {
+        index["images"][it.first] = {{"size", it.second.size}, {"last_used", it.second.last_used},
+                                     {"image_id", it.second.image_id}};
+    }
+
+    std::string path = directory_ + "/index.json";
+    std::string temp_path = path + ".tmp";
+    {
+        std::ofstream file(temp_path, std::ios::trunc);
+        file << index.dump();
+        if (!file) {
+            LOG_ERROR("Failed to write artifact cache index {}", temp_path);
+            return;
+        }
+    }
+    if (rename(temp_path.c_str(), path.c_str()) != 0) {
+        LOG_ERROR("Failed to replace artifact cache index {}: {}", path, strerror(errno));
+    }
+}
+
+std::string ArtifactCache::objectPath(const std::string& digest) const {
+    return directory_ + "/objects/" + digest;
+}
@@ -0,0 +1,219 @@
+#ifndef ARTIFACT_CACHE_H
+#define ARTIFACT_CACHE_H
+
+#include <string>
+#include <map>
+#include <mutex>
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+#include "singleflight.h"
+
+/**
+ * ArtifactCache类 - 本机按内容寻址的制品缓存
+ *
+ * 二进制制品下载后以SHA-256摘要命名保存在缓存目录的objects/下，再以硬链接（跨文件系统时
+ * 用reflink，都不支持时复制）放入各组件目录，同一制品被多个组件使用时只下载和存放一份。
+ * 镜像导入后内容保存在Docker中，缓存只记录tar包摘要对应的镜像ID，再次部署时直接添加名称。
+ * 命中时重新计算文件摘要，与记录不符（如组件目录中的硬链接被原地改写）时丢弃并重新下载。
+ * 二进制制品超过容量上限时按最近最少使用淘汰，仍被组件目录链接的文件删除后不释放空间，不淘汰。
+ * 只按期望的摘要命中：未给出摘要时同一URL可能已重新发布为不同内容，每次都下载，相同内容仍只存放一份。
+ * 索引（摘要到大小和最近使用顺序）保存在index.json中，Agent重启后仍然有效。
+ * 同一制品同时只下载一次，同时部署它的其他调用者等待这次下载并共享结果。
+ * 可在多个部署线程中同时使用
+ */
+class ArtifactCache {
+public:
+    /**
+     * 缓存统计
+     */
+    struct Stats {
+        unsigned long long hits;                // 命中次数
+        unsigned long long misses;              // 未命中而下载的次数
+        unsigned long long bytes_downloaded;    // 未命中时下载的字节数
+        unsigned long long bytes_saved;         // 命中而免于下载的字节数
+        unsigned long long evictions;           // 因超过容量上限淘汰的文件数
+        unsigned long long corrupted;           // 校验不符而丢弃的文件数
+        unsigned long long coalesced;           // 等待并共享了同时进行的下载的次数
+        unsigned long long files;               // 缓存的二进制制品数
+        unsigned long long images;              // 记录的镜像数
+        unsigned long long bytes;               // 缓存的二进制制品占用的字节数
+        unsigned long long quota_bytes;         // 容量上限（字节）
+    };
+
+    /**
+     * 下载数据的接收方：每收到一块调用一次，返回false时中止下载
+     */
+    typedef std::function<bool(const char* data, size_t size)> Sink;
+
+    /**
+     * 下载并存入缓存的过程：成功返回true，失败时写入错误信息
+     */
+    typedef std::function<bool(std::string& error)> Loader;
+
+    /**
+     * 构造函数
+     *
+     * @param directory 缓存目录，应与组件目录在同一文件系统上以便硬链接
+     * @param quota_bytes 二进制制品的容量上限（字节）
+     */
+    ArtifactCache(const std::string& directory, unsigned long long quota_bytes);
+
+    ArtifactCache(const ArtifactCache&) = delete;
+    ArtifactCache& operator=(const ArtifactCache&) = delete;
+
+    /**
+     * 创建目录，清理上次未完成的下载并加载索引
+     *
+     * @return 是否成功
+     */
+    bool open();
+
+    /**
+     * 获取二进制制品并放到target_path，未缓存时下载
+     *
+     * @param url 制品URL（sftp或http）
+     * @param sha256 期望的SHA-256摘要（小写十六进制），为空时总是下载，下载内容不校验
+     * @param target_path 目标路径，已存在时被替换
+     * @param error 输出参数，失败原因
+     * @return 是否成功
+     */
+    bool fetchFile(const std::string& url, const std::string& sha256,
+                   const std::string& target_path, std::string& error);
+
+    /**
+     * 查找已导入的镜像
+     *
+     * @param url 镜像tar包URL
+     * @param sha256 期望的tar包摘要，为空时只在loaded为true时按URL查找
+     * @param loaded 是否在等待的合并导入完成之后查找，此时URL对应的是刚导入的tar包
+     * @param present 检查镜像ID是否仍在Docker中，不在时丢弃记录
+     * @param image_id 输出参数，镜像ID
+     * @return 是否命中
+     */
+    bool findImage(const std::string& url, const std::string& sha256, bool loaded,
+                   const std::function<bool(const std::string&)>& present, std::string& image_id);
+
+    /**
+     * 记录导入的镜像
+     *
+     * @param url 镜像tar包URL
+     * @param sha256 tar包摘要
+     * @param image_id 导入的镜像ID
+     * @param size tar包字节数
+     */
+    void addImage(const std::string& url, const std::string& sha256,
+                  const std::string& image_id, unsigned long long size);
+
+    /**
+     * 同一key同时只执行一次load，执行期间以同一key调用的其他调用者等待并共享其结果，
+     * 之后由各调用者从缓存中取用
+     *
+     * @param key 合并的依据，如URL或摘要
+     * @param load 下载并存入缓存
+     * @param shared 输出参数，结果是否来自其他调用者的执行
+     * @param error 输出参数，失败原因
+     * @return load是否成功
+     */
+    bool coalesce(const std::string& key, const Loader& load, bool& shared, std::string& error);
+
+    /**
+     * 获取缓存统计
+     *
+     * @return 统计
+     */
+    Stats getStats() const;
+
+    /**
+     * 下载URL的内容，支持sftp和http(s)，HTTP错误视为失败
+     *
+     * @param url 制品URL
+     * @param sink 数据接收方
+     * @param timeout_sec 超时（秒），0表示不限
+     * @param error 输出参数，失败原因
+     * @return 是否成功
+     */
+    static bool download(const std::string& url, const Sink& sink, long timeout_sec, std::string& error);
+
+private:
+    /**
+     * 一个缓存项
+     */
+    struct Entry {
+        unsigned long long size;        // 字节数
+        uint64_t last_used;             // 最近使用序号，越大越新
+        std::string image_id;           // 镜像ID，仅镜像项
+    };
+
+    /**
+     * 一次合并执行的结果
+     */
+    struct LoadResult {
+        LoadResult() : ok(false) {
+        }
+
+        bool ok;                        // 是否成功
+        std::string error;              // 失败原因
+    };
+
+    /**
+     * 按期望摘要确定要查找的摘要；没有期望摘要时仅loaded为true（刚完成合并的下载）才按URL查找，调用方需持有mutex_
+     */
+    std::string resolveDigest(const std::string& url, const std::string& sha256, bool loaded) const;
+
+    /**
+     * 下载制品，校验后存入缓存并记录URL对应的摘要，不持有mutex_
+     */
+    bool storeDownload(const std::string& url, const std::string& sha256, std::string& error);
+
+    /**
+     * 下载到临时文件并计算摘要，不持有mutex_
+     */
+    bool downloadObject(const std::string& url, std::string& temp_path, std::string& digest,
+                        unsigned long long& size, std::string& error);
+
+    /**
+     * 把缓存文件放到目标路径：硬链接，失败时reflink，再失败时复制，调用方需持有mutex_
+     */
+    bool linkObject(const std::string& digest, const std::string& target_path, std::string& error);
+
+    /**
+     * 删除缓存文件及指向它的URL，调用方需持有mutex_
+     */
+    void removeObject(const std::string& digest);
+
+    /**
+     * 超过容量上限时按最近最少使用淘汰，keep不淘汰，调用方需持有mutex_
+     */
+    void evict(const std::string& keep);
+
+    /**
+     * 加载索引
+     */
+    void loadIndex();
+
+    /**
+     * 保存索引（写临时文件后改名），调用方需持有mutex_
+     */
+    void saveIndex();
+
+    /**
+     * 获取缓存文件路径
+     */
+    std::string objectPath(const std::string& digest) const;
+
+private:
+    std::string directory_;                         // 缓存目录
+    unsigned long long quota_bytes_;                // 二进制制品的容量上限
+    std::map<std::string, Entry> files_;            // 二进制制品，key为摘要
+    std::map<std::string, Entry> images_;           // 镜像，key为tar包摘要
+    std::map<std::string, std::string> urls_;       // URL最近一次下载得到的摘要，只用于链接刚完成的下载，不保存
+    uint64_t use_seq_;                              // 最近使用序号
+    uint64_t temp_seq_;                             // 临时文件序号
+    unsigned long long total_bytes_;                // 二进制制品占用的字节数
+    Stats stats_;                                   // 统计，files、images、bytes、coalesced在读取时填写
+    Singleflight<LoadResult> loads_;                // 正在进行的下载，同一key的并发请求合并为一次
+    mutable std::mutex mutex_;
+};
+
+#endif // ARTIFACT_CACHE_H
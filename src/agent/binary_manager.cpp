@@ -17,31 +17,118 @@
 #include <cstring>
 #include <vector>
 #include <cerrno>
-#include "sftp_client.h"
+#include <chrono>
+#include <poll.h>
+#include <fcntl.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#include <sys/sysinfo.h>
+#include "proc_utils.h"
+
+#ifndef SYS_pidfd_open
+#define SYS_pidfd_open 434
+#endif
+
+namespace {
+
+// 获取进程的pidfd，内核低于5.3时返回-1
+int openPidfd(pid_t pid) {
+    return static_cast<int>(syscall(SYS_pidfd_open, pid, 0));
+}
+
+// 解析进程ID字符串，非法时返回-1
+pid_t parsePid(const std::string& process_id) {
+    char* end = nullptr;
+    long pid = strtol(process_id.c_str(), &end, 10);
+    if (process_id.empty() || *end != '\0' || pid <= 0) {
+        return -1;
+    }
+    return static_cast<pid_t>(pid);
+}
+
+// 从/proc/<pid>/stat内容中读取状态和CPU累计时间
+bool parseProcStat(const char* data, size_t length, char& state,
+                   unsigned long long& cpu_ticks, unsigned long long& start_ticks) {
+    // 进程名可能包含空格和括号，从最后一个')'之后开始解析
+    const char* end = data + length;
+    const char* p = end;
+    while (p > data && *(p - 1) != ')') {
+        --p;
+    }
+    if (p == data) {
+        return false;
+    }
+
+    // 依次为state(3) ppid pgrp session tty_nr tpgid flags minflt cminflt majflt cmajflt utime(14) stime(15) ... starttime(22)
+    const char* field = nullptr;
+    size_t field_length = 0;
+    p = proc_parse_field(p, end, field, field_length);
+    if (field_length == 0) {
+        return false;
+    }
+    state = field[0];
+
+    unsigned long long value = 0, utime = 0, stime = 0;
+    for (int index = 4; index <= 22 && p < end; ++index) {
+        if (index == 14 || index == 15 || index == 22) {
+            p = proc_parse_number(p, end, value);
+            if (index == 14) {
+                utime = value;
+            } else if (index == 15) {
+                stime = value;
+            } else {
+                start_ticks = value;
+            }
+        } else {
+            // 部分字段可能为负数，按字段跳过
+            p = proc_parse_field(p, end, field, field_length);
+        }
+    }
+    cpu_ticks = utime + stime;
+    return true;
+}
 
-// 用于curl下载的回调函数
-size_t writeCallback(void* ptr, size_t size, size_t nmemb, FILE* stream) {
-    size_t written = fwrite(ptr, size, nmemb, stream);
-    return written;
 }
 
-BinaryManager::BinaryManager() {
+BinaryManager::BinaryManager(std::shared_ptr<ArtifactCache> artifact_cache)
+    : artifact_cache_(artifact_cache), wake_fd_(-1), reaper_running_(false), buffer_(4096),
+      clock_ticks_(sysconf(_SC_CLK_TCK)) {
     // 初始化curl
     curl_global_init(CURL_GLOBAL_DEFAULT);
-    sftp_client_ = std::make_unique<SFTPClient>();
+    wake_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (clock_ticks_ <= 0) {
+        clock_ticks_ = 100;
+    }
 }
 
 BinaryManager::~BinaryManager() {
+    // 停止回收线程
+    reaper_running_ = false;
+    wakeReaper();
+    if (reaper_thread_ && reaper_thread_->joinable()) {
+        reaper_thread_->join();
+    }
+    for (auto& it : processes_) {
+        closeProcess(it.second);
+    }
+    if (wake_fd_ >= 0) {
+        close(wake_fd_);
+    }
     // 清理curl
     curl_global_cleanup();
 }
 
 bool BinaryManager::initialize() {
     LOG_INFO("Initializing BinaryManager...");
+    if (!reaper_running_) {
+        reaper_running_ = true;
+        reaper_thread_ = std::make_unique<std::thread>(&BinaryManager::reaperThread, this);
+    }
     return true;
 }
 
-nlohmann::json BinaryManager::downloadBinary(const std::string& binary_url, const std::string& binary_path) {
+nlohmann::json BinaryManager::downloadBinary(const std::string& binary_url, const std::string& binary_path,
+                                             const std::string& binary_sha256) {
     LOG_INFO("Downloading binary from {} to {}", binary_url, binary_path);
     
     // 创建目录（如果不存在）
@@ -49,48 +136,13 @@ nlohmann::json BinaryManager::downloadBinary(const std::string& binary_url, cons
     std::string parent_dir = (last_slash != std::string::npos) ? binary_path.substr(0, last_slash) : ".";
     create_directories(parent_dir);
     
-    // 判断协议
-    if (binary_url.rfind("sftp://", 0) == 0) {
-        std::string err_msg;
-        bool ok = sftp_client_->downloadFile(binary_url, binary_path, err_msg);
-        if (!ok) {
-            return {
-                {"status", "error"},
-                {"message", "SFTP下载失败: " + err_msg}
-            };
-        }
-    } else {
-        // 原有curl下载逻辑
-        CURL* curl = curl_easy_init();
-        if (!curl) {
-            return {
-                {"status", "error"},
-                {"message", "Failed to initialize curl"}
-            };
-        }
-        FILE* fp = fopen(binary_path.c_str(), "wb");
-        if (!fp) {
-            curl_easy_cleanup(curl);
-            return {
-                {"status", "error"},
-                {"message", "Failed to create file: " + binary_path}
-            };
-        }
-        curl_easy_setopt(curl, CURLOPT_URL, binary_url.c_str());
-        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeCallback);
-        curl_easy_setopt(curl, CURLOPT_WRITEDATA, fp);
-        curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
-        curl_easy_setopt(curl, CURLOPT_TIMEOUT, 300L); // 5分钟超时
-        CURLcode res = curl_easy_perform(curl);
-        fclose(fp);
-        if (res != CURLE_OK) {
-            curl_easy_cleanup(curl);
-            return {
-                {"status", "error"},
-                {"message", "Failed to download file: " + std::string(curl_easy_strerror(res))}
-            };
-        }
-        curl_easy_cleanup(curl);
+    // 经制品缓存获取，相同内容只下载一次
+    std::string err_msg;
+    if (!artifact_cache_->fetchFile(binary_url, binary_sha256, binary_path, err_msg)) {
+        return {
+            {"status", "error"},
+            {"message", "Failed to download file: " + err_msg}
+        };
     }
     
     // 检查文件是否为压缩包，如果是则解压
@@ -159,12 +211,13 @@ nlohmann::json BinaryManager::startProcess(const std::string& binary_path, const
         _exit(127);
     }
     // 父进程
-    // 保存pid为string
+    // 保存pid为string，通过pidfd跟踪进程退出
     std::string pid_str = std::to_string(pid);
     {
         std::lock_guard<std::mutex> lock(process_mutex_);
-        process_map_[pid_str] = binary_path;
+        trackProcess(pid_str, pid, binary_path, true);
     }
+    wakeReaper();
     return {
         {"status", "success"},
         {"process_id", pid_str}
@@ -172,31 +225,45 @@ nlohmann::json BinaryManager::startProcess(const std::string& binary_path, const
 }
 
 nlohmann::json BinaryManager::stopProcess(const std::string& process_id) {
-    int pid = std::stoi(process_id);
-    LOG_INFO("Stopping process: {}", pid);
+    LOG_INFO("Stopping process: {}", process_id);
     if (!isProcessRunning(process_id)) {
         return {
             {"status", "error"},
             {"message", "Process not found: " + process_id}
         };
     }
+    pid_t pid = parsePid(process_id);
+
+    // 先SIGTERM，5秒内未退出再SIGKILL；退出由回收线程或checkExited发现并回收
     kill(pid, SIGTERM);
-    int waited = 0;
-    int max_wait = 5;
-    while (waited < max_wait) {
-        int ret = waitpid(pid, nullptr, WNOHANG);
-        if (ret == pid) break;
-        sleep(1);
-        waited++;
-    }
-    if (waited == max_wait) {
-        kill(pid, SIGKILL);
-        waitpid(pid, nullptr, 0);
+    bool exited = false;
+    for (int round = 0; round < 2 && !exited; ++round) {
+        if (round == 1) {
+            kill(pid, SIGKILL);
+        }
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (std::chrono::steady_clock::now() < deadline) {
+            {
+                std::lock_guard<std::mutex> lock(process_mutex_);
+                auto it = processes_.find(process_id);
+                if (it == processes_.end() || it->second.exited || checkExited(it->second)) {
+                    exited = true;
+                    break;
+                }
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
     }
+
     {
         std::lock_guard<std::mutex> lock(process_mutex_);
-        process_map_.erase(process_id);
+        auto it = processes_.find(process_id);
+        if (it != processes_.end()) {
+            closeProcess(it->second);
+            processes_.erase(it);
+        }
     }
+    wakeReaper();
     return {
         {"status", "success"},
         {"message", "Process stopped successfully"},
@@ -209,9 +276,9 @@ nlohmann::json BinaryManager::getProcessStatus(const std::string& process_id) {
     std::string binary_path;
     {
         std::lock_guard<std::mutex> lock(process_mutex_);
-        auto it = process_map_.find(process_id);
-        if (it != process_map_.end()) {
-            binary_path = it->second;
+        auto it = processes_.find(process_id);
+        if (it != processes_.end()) {
+            binary_path = it->second.binary_path;
         }
     }
     return {
@@ -222,42 +289,91 @@ nlohmann::json BinaryManager::getProcessStatus(const std::string& process_id) {
 }
 
 nlohmann::json BinaryManager::getProcessStats(const std::string& process_id) {
-    int pid = std::stoi(process_id);
     if (!isProcessRunning(process_id)) {
         return {
             {"status", "error"},
             {"message", "Process not found: " + process_id}
         };
     }
-    std::string cmd = "ps -p " + process_id + " -o %cpu,%mem,rss --no-headers";
-    std::string output = executeCommand(cmd);
-    std::istringstream iss(output);
-    float cpu_percent, mem_percent;
-    long rss_kb;
-    iss >> cpu_percent >> mem_percent >> rss_kb;
+
+    std::lock_guard<std::mutex> lock(process_mutex_);
+    auto it = processes_.find(process_id);
+    if (it == processes_.end()) {
+        return {
+            {"status", "error"},
+            {"message", "Process not found: " + process_id}
+        };
+    }
+    ProcessInfo& info = it->second;
+
+    // CPU时间和进程状态来自/proc/<pid>/stat
+    std::string proc_dir = "/proc/" + process_id;
+    char state = '?';
+    unsigned long long cpu_ticks = 0, start_ticks = 0;
+    ssize_t n = read_proc_file(info.stat_fd, proc_dir + "/stat", buffer_);
+    if (n <= 0 || !parseProcStat(buffer_.data(), static_cast<size_t>(n), state, cpu_ticks, start_ticks) || state == 'Z') {
+        return {
+            {"status", "error"},
+            {"message", "Process not found: " + process_id}
+        };
+    }
+
+    // 常驻内存来自/proc/<pid>/status的VmRSS（kB）
+    unsigned long long rss_kb = 0;
+    n = read_proc_file(info.status_fd, proc_dir + "/status", buffer_);
+    if (n > 0) {
+        const char* p = buffer_.data();
+        const char* end = p + n;
+        while (p < end) {
+            const char* line_end = proc_line_end(p, end);
+            if (line_end - p > 6 && memcmp(p, "VmRSS:", 6) == 0) {
+                proc_parse_number(p + 6, line_end, rss_kb);
+                break;
+            }
+            p = line_end + 1;
+        }
+    }
+
+    // 首次采集按进程生命周期平均（与ps一致），之后按两次采集间隔计算
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double cpu_percent = 0.0;
+    if (info.has_last) {
+        double elapsed_sec = static_cast<double>(now.tv_sec - info.last_time.tv_sec) +
+                             static_cast<double>(now.tv_nsec - info.last_time.tv_nsec) / 1e9;
+        if (elapsed_sec > 0.0) {
+            cpu_percent = static_cast<double>(proc_counter_delta(info.last_cpu_ticks, cpu_ticks)) /
+                          static_cast<double>(clock_ticks_) / elapsed_sec * 100.0;
+        }
+    } else {
+        struct timespec boot;
+        clock_gettime(CLOCK_BOOTTIME, &boot);
+        double lifetime_sec = static_cast<double>(boot.tv_sec) + static_cast<double>(boot.tv_nsec) / 1e9 -
+                              static_cast<double>(start_ticks) / static_cast<double>(clock_ticks_);
+        if (lifetime_sec > 0.0) {
+            cpu_percent = static_cast<double>(cpu_ticks) / static_cast<double>(clock_ticks_) / lifetime_sec * 100.0;
+        }
+    }
+    info.last_cpu_ticks = cpu_ticks;
+    info.last_time = now;
+    info.has_last = true;
+
+    double memory_percent = 0.0;
+    struct sysinfo si;
+    if (sysinfo(&si) == 0 && si.totalram > 0) {
+        double total_kb = static_cast<double>(si.totalram) * si.mem_unit / 1024.0;
+        memory_percent = static_cast<double>(rss_kb) / total_kb * 100.0;
+    }
+
     return {
+        {"status", "success"},
         {"process_id", process_id},
         {"cpu_percent", cpu_percent},
-        {"memory_percent", mem_percent},
+        {"memory_percent", memory_percent},
         {"memory_rss_kb", rss_kb}
     };
 }
 
-std::string BinaryManager::executeCommand(const std::string& command) {
-    std::string result;
-    FILE* pipe = popen(command.c_str(), "r");
-    if (!pipe) return "";
-    char buffer[128];
-    if (fgets(buffer, sizeof(buffer), pipe) != nullptr) {
-        result = buffer;
-    }
-    pclose(pipe);
-
-    // 去掉换行符
-    if (!result.empty() && result.back() == '\n') result.pop_back();
-    return result;
-}
-
 bool BinaryManager::extractFile(const std::string& file_path, const std::string& extract_dir) {
     std::string cmd = "tar -xzf " + file_path + " -C " + extract_dir;
     int result = system(cmd.c_str());
@@ -265,20 +381,171 @@ bool BinaryManager::extractFile(const std::string& file_path, const std::string&
 }
 
 bool BinaryManager::isProcessRunning(const std::string& process_id) {
-    int pid = std::stoi(process_id);
-    std::string cmd = "ps -o stat= -p " + process_id + " 2>/dev/null";
-    FILE* pipe = popen(cmd.c_str(), "r");
-    if (!pipe) return false;
-    char buffer[128];
-    std::string status;
-    if (fgets(buffer, sizeof(buffer), pipe) != nullptr) {
-        status = buffer;
-    }
-    pclose(pipe);
-    status.erase(0, status.find_first_not_of(" \t\n\r"));
-    status.erase(status.find_last_not_of(" \t\n\r") + 1);
-    if (status.empty() || status.find('Z') != std::string::npos) {
+    std::lock_guard<std::mutex> lock(process_mutex_);
+    auto it = processes_.find(process_id);
+    if (it != processes_.end()) {
+        ProcessInfo& info = it->second;
+        if (info.exited) {
+            return false;
+        }
+        // 回收线程运行时，持有pidfd的进程退出后由其更新exited，这里只需读取标记
+        if (reaper_running_ && info.pidfd >= 0) {
+            return true;
+        }
+        return !checkExited(info);
+    }
+
+    // 未跟踪的进程（如Agent重启前启动的）：存活则纳入跟踪
+    pid_t pid = parsePid(process_id);
+    if (pid <= 0 || kill(pid, 0) != 0) {
+        return false;
+    }
+    char state = '?';
+    unsigned long long cpu_ticks = 0, start_ticks = 0;
+    int fd = -1;
+    ssize_t n = read_proc_file(fd, "/proc/" + process_id + "/stat", buffer_);
+    if (fd >= 0) {
+        close(fd);
+    }
+    if (n <= 0 || !parseProcStat(buffer_.data(), static_cast<size_t>(n), state, cpu_ticks, start_ticks) || state == 'Z') {
+        return false;
+    }
+    trackProcess(process_id, pid, "", false);
+    wakeReaper();
+    return true;
+}
+
+void BinaryManager::trackProcess(const std::string& process_id, pid_t pid, const std::string& binary_path, bool is_child) {
+    auto it = processes_.find(process_id);
+    if (it != processes_.end()) {
+        closeProcess(it->second);
+    }
+
+    ProcessInfo& info = processes_[process_id];
+    info.pid = pid;
+    info.binary_path = binary_path;
+    info.pidfd = openPidfd(pid);
+    info.is_child = is_child;
+    info.exited = false;
+    info.stat_fd = -1;
+    info.status_fd = -1;
+    info.last_cpu_ticks = 0;
+    info.has_last = false;
+}
+
+bool BinaryManager::checkExited(ProcessInfo& info) {
+    if (info.exited) {
+        return true;
+    }
+    if (info.pidfd >= 0) {
+        // pidfd可读表示进程已退出；回收线程通常已先一步处理
+        struct pollfd pfd = {info.pidfd, POLLIN, 0};
+        if (poll(&pfd, 1, 0) <= 0) {
+            return false;
+        }
+    } else if (info.is_child) {
+        // 内核不支持pidfd时，子进程用waitpid探测
+        int status = 0;
+        if (waitpid(info.pid, &status, WNOHANG) != info.pid) {
+            return false;
+        }
+        info.is_child = false;
+    } else if (kill(info.pid, 0) == 0) {
         return false;
     }
+    markExited(info);
     return true;
 }
+
+void BinaryManager::markExited(ProcessInfo& info) {
+    if (info.is_child) {
+        int status = 0;
+        if (waitpid(info.pid, &status, WNOHANG) == info.pid) {
+            if (WIFEXITED(status)) {
+                LOG_INFO("Process {} exited with code {}", info.pid, WEXITSTATUS(status));
+            } else if (WIFSIGNALED(status)) {
+                LOG_INFO("Process {} killed by signal {}", info.pid, WTERMSIG(status));
+            }
+        }
+    } else {
+        LOG_INFO("Process {} exited", info.pid);
+    }
+    info.exited = true;
+    closeProcess(info);
+}
+
+void BinaryManager::closeProcess(ProcessInfo& info) {
+    int* fds[] = {&info.pidfd, &info.stat_fd, &info.status_fd};
+    for (int* fd : fds) {
+        if (*fd >= 0) {
+            close(*fd);
+        }
+        *fd = -1;
+    }
+}
+
+void BinaryManager::wakeReaper() {
+    if (wake_fd_ >= 0) {
+        uint64_t value = 1;
+        ssize_t ret = write(wake_fd_, &value, sizeof(value));
+        (void)ret;
+    }
+}
+
+void BinaryManager::reaperThread() {
+    std::vector<struct pollfd> pollfds;
+    std::vector<std::string> process_ids;
+
+    while (reaper_running_) {
+        // 每轮重建poll集合：唤醒eventfd + 各未退出进程的pidfd
+        pollfds.clear();
+        process_ids.clear();
+        pollfds.push_back({wake_fd_, POLLIN, 0});
+        bool has_untracked = false;
+        {
+            std::lock_guard<std::mutex> lock(process_mutex_);
+            for (const auto& it : processes_) {
+                if (it.second.exited) {
+                    continue;
+                }
+                if (it.second.pidfd >= 0) {
+                    pollfds.push_back({it.second.pidfd, POLLIN, 0});
+                    process_ids.push_back(it.first);
+                } else {
+                    has_untracked = true;
+                }
+            }
+        }
+
+        // 没有pidfd的进程每秒探测一次，否则只在进程退出或被唤醒时返回
+        int ret = poll(pollfds.data(), pollfds.size(), has_untracked ? 1000 : -1);
+        if (ret < 0 && errno != EINTR) {
+            LOG_ERROR("Reaper poll failed: {}", strerror(errno));
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+            continue;
+        }
+        if (pollfds[0].revents & POLLIN) {
+            uint64_t value = 0;
+            ssize_t n = read(wake_fd_, &value, sizeof(value));
+            (void)n;
+        }
+
+        std::lock_guard<std::mutex> lock(process_mutex_);
+        for (size_t i = 1; i < pollfds.size(); ++i) {
+            if (!(pollfds[i].revents & (POLLIN | POLLHUP | POLLERR))) {
+                continue;
+            }
+            auto it = processes_.find(process_ids[i - 1]);
+            if (it != processes_.end() && !it->second.exited && it->second.pidfd == pollfds[i].fd) {
+                markExited(it->second);
+            }
+        }
+        if (has_untracked) {
+            for (auto& it : processes_) {
+                if (!it.second.exited && it.second.pidfd < 0) {
+                    checkExited(it.second);
+                }
+            }
+        }
+    }
+}
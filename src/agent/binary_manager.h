@@ -5,20 +5,29 @@
 #include <vector>
 #include <map>
 #include <mutex>
+#include <atomic>
+#include <thread>
+#include <memory>
+#include <time.h>
+#include <sys/types.h>
 #include <nlohmann/json.hpp>
-#include "sftp_client.h"
+#include "artifact_cache.h"
 
 /**
  * BinaryManager类 - 二进制运行体管理器
  * 
- * 负责管理二进制运行体的生命周期，包括下载、启动、停止和状态收集
+ * 负责管理二进制运行体的生命周期，包括下载、启动、停止和状态收集。
+ * 二进制文件经本机制品缓存获取，相同内容只下载一次，以硬链接放入各组件目录。
+ * 进程通过pidfd跟踪，退出时由回收线程立即回收；状态和资源直接读取/proc/<pid>
  */
 class BinaryManager {
 public:
     /**
      * 构造函数
+     * 
+     * @param artifact_cache 制品缓存
      */
-    BinaryManager();
+    explicit BinaryManager(std::shared_ptr<ArtifactCache> artifact_cache);
     
     /**
      * 析构函数
@@ -26,20 +35,22 @@ public:
     ~BinaryManager();
     
     /**
-     * 初始化二进制运行体管理器
+     * 初始化二进制运行体管理器，启动进程回收线程
      * 
      * @return 是否成功初始化
      */
     bool initialize();
     
     /**
-     * 下载二进制文件
+     * 下载二进制文件，缓存中已有相同内容时直接链接到保存路径
      * 
      * @param binary_url 二进制文件URL
      * @param binary_path 保存路径
+     * @param binary_sha256 期望的SHA-256摘要，为空时不校验下载内容
      * @return 下载结果
      */
-    nlohmann::json downloadBinary(const std::string& binary_url, const std::string& binary_path);
+    nlohmann::json downloadBinary(const std::string& binary_url, const std::string& binary_path,
+                                  const std::string& binary_sha256 = "");
     
     /**
      * 启动进程
@@ -81,13 +92,63 @@ public:
 
 private:
     /**
-     * 执行命令并返回输出
+     * 一个被跟踪进程的状态
+     */
+    struct ProcessInfo {
+        pid_t pid;                              // 进程ID
+        std::string binary_path;                // 二进制文件路径
+        int pidfd;                              // pidfd_open得到的描述符，内核不支持时为-1
+        bool is_child;                          // 是否由本Agent启动（只有子进程需要回收）
+        bool exited;                            // 是否已退出
+        int stat_fd;                            // 常驻打开的/proc/<pid>/stat
+        int status_fd;                          // 常驻打开的/proc/<pid>/status
+        unsigned long long last_cpu_ticks;      // 上次的CPU累计时间（时钟滴答）
+        struct timespec last_time;              // 上次采集的单调时钟时间
+        bool has_last;                          // 是否已有上次的CPU时间
+    };
+
+    /**
+     * 开始跟踪进程，调用方需持有process_mutex_
      * 
-     * @param command 命令
-     * @return 命令输出
+     * @param process_id 进程ID字符串
+     * @param pid 进程ID
+     * @param binary_path 二进制文件路径
+     * @param is_child 是否为本Agent的子进程
      */
-    std::string executeCommand(const std::string& command);
-    
+    void trackProcess(const std::string& process_id, pid_t pid, const std::string& binary_path, bool is_child);
+
+    /**
+     * 检查未持有pidfd的进程是否已退出，已退出则回收并标记，调用方需持有process_mutex_
+     * 
+     * @param info 进程状态
+     * @return 是否已退出
+     */
+    bool checkExited(ProcessInfo& info);
+
+    /**
+     * 标记进程已退出，子进程立即回收，调用方需持有process_mutex_
+     * 
+     * @param info 进程状态
+     */
+    void markExited(ProcessInfo& info);
+
+    /**
+     * 关闭进程的各描述符
+     * 
+     * @param info 进程状态
+     */
+    static void closeProcess(ProcessInfo& info);
+
+    /**
+     * 进程回收线程函数，poll各pidfd，进程退出后立即回收
+     */
+    void reaperThread();
+
+    /**
+     * 唤醒回收线程以重建poll集合
+     */
+    void wakeReaper();
+
     /**
      * 解压文件
      * 
@@ -98,7 +159,7 @@ private:
     bool extractFile(const std::string& file_path, const std::string& extract_dir);
     
     /**
-     * 检查进程是否存在
+     * 检查进程是否存在，未跟踪的进程（如Agent重启前启动的）会被纳入跟踪
      * 
      * @param process_id 进程ID
      * @return 是否存在
@@ -106,9 +167,15 @@ private:
     bool isProcessRunning(const std::string& process_id);
 
 private:
-    std::map<std::string, std::string> process_map_;  // 进程ID到二进制路径的映射，key为string
+    std::map<std::string, ProcessInfo> processes_;   // 被跟踪的进程，key为进程ID字符串
     std::mutex process_mutex_;
-    std::unique_ptr<SFTPClient> sftp_client_; // SFTP客户端
+    std::shared_ptr<ArtifactCache> artifact_cache_;  // 制品缓存
+
+    int wake_fd_;                                    // 唤醒回收线程的eventfd
+    std::atomic<bool> reaper_running_;               // 回收线程运行标志
+    std::unique_ptr<std::thread> reaper_thread_;     // 回收线程
+    std::vector<char> buffer_;                       // 复用的/proc读取缓冲区
+    long clock_ticks_;                               // 每秒时钟滴答数
 };
 
 #endif // BINARY_MANAGER_H
@@ -6,6 +6,7 @@
 #include <iostream>
 #include <thread>
 #include <chrono>
+#include <algorithm>
 #include <fstream>
 #include <sstream>
 #include <sys/stat.h>
@@ -13,8 +14,27 @@
 #include <errno.h>
 #include "dir_utils.h"
 
-ComponentManager::ComponentManager(std::shared_ptr<HttpClient> http_client)
-    : http_client_(http_client), running_(false), collection_interval_sec_(5)
+namespace
+{
+    // 事件流正常时，每隔该时间仍查询一次所有Docker容器的状态，补上没有标签的容器和遗漏的事件
+    const int kDockerReconcileIntervalSec = 60;
+    // 事件流断开后的重连等待时间上限
+    const int kDockerEventsMaxBackoffSec = 30;
+    // 制品缓存目录，与/opt/resource_monitor/binaries在同一文件系统上以便硬链接
+    const char *const kArtifactCacheDir = "/opt/resource_monitor/artifacts";
+
+    std::string optionalString(const nlohmann::json &info, const char *key)
+    {
+        return info.contains(key) && info[key].is_string() ? info[key].get<std::string>() : "";
+    }
+}
+
+ComponentManager::ComponentManager(std::shared_ptr<HttpClient> http_client, int artifact_cache_mb)
+    : http_client_(http_client),
+      artifact_cache_(std::make_shared<ArtifactCache>(kArtifactCacheDir,
+                                                      static_cast<unsigned long long>(artifact_cache_mb > 0 ? artifact_cache_mb : 1) * 1024 * 1024)),
+      running_(false), collection_interval_sec_(5),
+      events_connected_(false), reconcile_requested_(true)
 {
 }
 
@@ -25,8 +45,14 @@ ComponentManager::~ComponentManager()
 
 bool ComponentManager::initialize()
 {
+    // 打开制品缓存，失败时每次部署仍可下载，只是无法缓存
+    if (!artifact_cache_->open())
+    {
+        LOG_ERROR("Failed to open artifact cache {}", kArtifactCacheDir);
+    }
+
     // 创建Docker管理器
-    docker_manager_ = std::make_unique<DockerManager>();
+    docker_manager_ = std::make_unique<DockerManager>(artifact_cache_);
 
     // 初始化Docker管理器
     if (!docker_manager_->initialize())
@@ -36,7 +62,7 @@ bool ComponentManager::initialize()
     }
 
     // 创建二进制运行体管理器
-    binary_manager_ = std::make_unique<BinaryManager>();
+    binary_manager_ = std::make_unique<BinaryManager>(artifact_cache_);
 
     // 初始化二进制运行体管理器
     if (!binary_manager_->initialize())
@@ -86,6 +112,9 @@ nlohmann::json ComponentManager::deployComponent(const nlohmann::json &component
             component["status"] = "running";
             component["type"] = "docker";
             components_[component_info["component_id"]] = component;
+            ++status_versions_[component_info["component_id"]];
+            // 保存之前容器可能已经退出，对应的事件被忽略，下次收集时查询一次
+            reconcile_requested_ = true;
         }
         return result;
     }
@@ -100,6 +129,7 @@ nlohmann::json ComponentManager::deployComponent(const nlohmann::json &component
             component["status"] = "running";
             component["type"] = "binary";
             components_[component_info["component_id"]] = component;
+            ++status_versions_[component_info["component_id"]];
         }
         return result;
     }
@@ -129,8 +159,8 @@ nlohmann::json ComponentManager::deployDockerComponent(const nlohmann::json &com
     std::string image_url = component_info.contains("image_url") ? component_info["image_url"].get<std::string>() : "";
     std::string image_name = component_info["image_name"];
 
-    // 下载或拉取镜像
-    auto pull_result = docker_manager_->pullImage(image_url, image_name);
+    // 下载或拉取镜像，可选的image_sha256用于校验镜像tar包
+    auto pull_result = docker_manager_->pullImage(image_url, image_name, optionalString(component_info, "image_sha256"));
 
     if (pull_result["status"] != "success") // 如果拉取失败，则返回错误信息
     {
@@ -177,13 +207,17 @@ nlohmann::json ComponentManager::deployDockerComponent(const nlohmann::json &com
     // 打印容器名称
     std::cout << "Container name: " << container_name << std::endl;
 
-    // 创建并启动容器
+    // 创建并启动容器，标签用于从事件流中识别组件
+    nlohmann::json labels = {
+        {kDockerComponentLabel, component_id},
+        {kDockerBusinessLabel, business_id}};
     auto create_result = docker_manager_->createContainer(
         image_name,
         container_name,
         env_vars,
         resource_limits,
-        volumes);
+        volumes,
+        labels);
 
     if (create_result["status"] != "success")
     {
@@ -221,24 +255,19 @@ nlohmann::json ComponentManager::deployBinaryComponent(const nlohmann::json &com
         };
     }
 
-    // 检查文件是否存在
-    std::ifstream file(binary_path);
-    if (!file.good()) {
-        // 文件不存在,需要下载
-        if (!component_info.contains("binary_url") || component_info["binary_url"].get<std::string>().empty()) {
-            return {
-                {"status", "error"},
-                {"message", "Binary file does not exist and no download URL provided"}
-            };
-        }
-
+    // 提供了URL时经制品缓存获取：内容已缓存时只重新链接，目标路径上的旧文件被替换
+    if (component_info.contains("binary_url") && !component_info["binary_url"].get<std::string>().empty()) {
         std::string binary_url = component_info["binary_url"];
-        auto result = binary_manager_->downloadBinary(binary_url, binary_path);
+        auto result = binary_manager_->downloadBinary(binary_url, binary_path, optionalString(component_info, "binary_sha256"));
         if (result["status"] != "success") {
             return result;
         }
+    } else if (!std::ifstream(binary_path).good()) {
+        return {
+            {"status", "error"},
+            {"message", "Binary file does not exist and no download URL provided"}
+        };
     }
-    file.close();
 
     // 创建配置文件（如果有）
     if (component_info.contains("config_files") && component_info["config_files"].is_array())
@@ -394,11 +423,22 @@ nlohmann::json ComponentManager::stopBinaryComponent(const std::string &componen
 // 收集组件状态
 bool ComponentManager::collectComponentStatus()
 {
+    // 事件流未连接、刚重连或到了核对时间时查询所有容器的状态，否则沿用事件更新的状态
+    auto now_steady = std::chrono::steady_clock::now();
+    bool reconcile = !events_connected_ || reconcile_requested_.exchange(false) ||
+                     now_steady - last_reconcile_ >= std::chrono::seconds(kDockerReconcileIntervalSec);
+    if (reconcile)
+    {
+        last_reconcile_ = now_steady;
+    }
+
     // 先获取所有组件的快照,避免长时间加锁
     std::map<std::string, nlohmann::json> components_snapshot;
+    std::map<std::string, unsigned long long> versions_snapshot;
     {
         std::lock_guard<std::mutex> lock(components_mutex_);
         components_snapshot = components_;
+        versions_snapshot = status_versions_;
     }
 
     // 收集每个组件的状态
@@ -419,8 +459,16 @@ bool ComponentManager::collectComponentStatus()
 
             std::string container_id = component["container_id"];
             // 获取容器状态
-            auto status_result = docker_manager_->getContainerStatus(container_id);
-            if (status_result["status"] == "success")
+            nlohmann::json status_result = {{"status", "skipped"}};
+            if (reconcile)
+            {
+                status_result = docker_manager_->getContainerStatus(container_id);
+            }
+            if (status_result["status"] == "skipped")
+            {
+                // 沿用事件流更新的状态
+            }
+            else if (status_result["status"] == "success")
             {
                 std::string container_status = status_result["container_status"];
                 // 更新组件状态
@@ -442,6 +490,17 @@ bool ComponentManager::collectComponentStatus()
                 // 容器可能已经被删除
                 component["status"] = "unknown";
             }
+
+            // 运行中的容器附带资源使用情况，由Manager写入component_metrics
+            component.erase("resource_usage");
+            if (component["status"] == "running")
+            {
+                auto stats_result = docker_manager_->getContainerStats(container_id);
+                if (stats_result["status"] == "success")
+                {
+                    component["resource_usage"] = stats_result["resource_usage"];
+                }
+            }
         }
         else if (component["type"] == "binary")
         {
@@ -456,9 +515,21 @@ bool ComponentManager::collectComponentStatus()
             auto status_result = binary_manager_->getProcessStatus(process_id);
 
             // 更新组件状态
+            component.erase("resource_usage");
             if (status_result["running"])
             {
                 component["status"] = "running";
+
+                // 运行中的进程附带资源使用情况，由Manager写入component_metrics
+                auto stats_result = binary_manager_->getProcessStats(process_id);
+                if (stats_result["status"] == "success")
+                {
+                    component["resource_usage"] = {
+                        {"cpu_percent", stats_result["cpu_percent"]},
+                        {"memory_mb", stats_result["memory_rss_kb"].get<unsigned long long>() / 1024},
+                        {"memory_percent", stats_result["memory_percent"]},
+                        {"gpu_percent", 0.0}};
+                }
             }
             else
             {
@@ -474,11 +545,16 @@ bool ComponentManager::collectComponentStatus()
         updated_components[component_id] = component;
     }
 
-    // 最后一次性更新所有组件状态
+    // 最后一次性更新所有组件状态。收集期间已删除的组件不再加回，
+    // 收集期间收到事件或重新部署的组件保留新的状态，下次收集再更新
     {
         std::lock_guard<std::mutex> lock(components_mutex_);
         for(const auto& it : updated_components) {
-            components_[it.first] = it.second;
+            auto current = components_.find(it.first);
+            if (current == components_.end() || status_versions_[it.first] != versions_snapshot[it.first]) {
+                continue;
+            }
+            current->second = it.second;
         }
     }
 
@@ -493,11 +569,143 @@ void ComponentManager::statusCollectionThread()
         collectComponentStatus();
 
         // 等待指定时间间隔
-        std::this_thread::sleep_for(std::chrono::seconds(collection_interval_sec_));
+        waitFor(collection_interval_sec_);
     }
     LOG_INFO("Status collection thread stopped");
 }
 
+void ComponentManager::dockerEventsThread()
+{
+    long long since = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+    int backoff_sec = 1;
+    while (running_)
+    {
+        bool stopped = docker_manager_->watchEvents(
+            since,
+            [this, &backoff_sec]()
+            {
+                // 连接前后的状态变化可能没有对应的事件，下次收集时查询一次
+                events_connected_ = true;
+                reconcile_requested_ = true;
+                backoff_sec = 1;
+                LOG_INFO("Subscribed to Docker events");
+            },
+            [this, &since](const nlohmann::json &event)
+            {
+                if (event.contains("time") && event["time"].is_number())
+                {
+                    since = event["time"].get<long long>();
+                }
+                handleDockerEvent(event);
+            },
+            [this]()
+            {
+                return running_.load();
+            });
+        events_connected_ = false;
+        if (stopped || !running_)
+        {
+            break;
+        }
+
+        // 重连前等待，期间由状态收集线程轮询
+        waitFor(backoff_sec);
+        backoff_sec = std::min(backoff_sec * 2, kDockerEventsMaxBackoffSec);
+    }
+    LOG_INFO("Docker events thread stopped");
+}
+
+void ComponentManager::handleDockerEvent(const nlohmann::json &event)
+{
+    if (!event.contains("Action") || !event["Action"].is_string() ||
+        !event.contains("Actor") || !event["Actor"].is_object())
+    {
+        return;
+    }
+    const nlohmann::json &actor = event["Actor"];
+    std::string action = event["Action"];
+    std::string container_id = actor.value("ID", "");
+    nlohmann::json attributes = actor.value("Attributes", nlohmann::json::object());
+    if (!attributes.is_object() || !attributes.contains(kDockerComponentLabel) ||
+        !attributes[kDockerComponentLabel].is_string())
+    {
+        return;
+    }
+    std::string component_id = attributes[kDockerComponentLabel].get<std::string>();
+
+    std::lock_guard<std::mutex> lock(components_mutex_);
+    auto it = components_.find(component_id);
+    if (it == components_.end())
+    {
+        return;
+    }
+    nlohmann::json &component = it->second;
+
+    // 同一组件重新部署后旧容器的事件不再生效
+    std::string known_id = component.value("container_id", "");
+    if (known_id.empty() || container_id.compare(0, known_id.size(), known_id) != 0)
+    {
+        return;
+    }
+
+    if (action == "start")
+    {
+        component["status"] = "running";
+        component.erase("exit_code");
+        component.erase("oom_killed");
+    }
+    else if (action == "die")
+    {
+        component["status"] = "stopped";
+        component.erase("resource_usage");
+        if (attributes.contains("exitCode") && attributes["exitCode"].is_string())
+        {
+            try
+            {
+                component["exit_code"] = std::stoi(attributes["exitCode"].get<std::string>());
+            }
+            catch (const std::exception &)
+            {
+            }
+        }
+    }
+    else if (action == "oom")
+    {
+        component["oom_killed"] = true;
+    }
+    else if (action == "pause")
+    {
+        component["status"] = "paused";
+    }
+    else if (action == "unpause")
+    {
+        component["status"] = "running";
+    }
+    else if (action == "destroy")
+    {
+        component["status"] = "unknown";
+        component.erase("resource_usage");
+    }
+    else
+    {
+        return;
+    }
+
+    if (event.contains("time") && event["time"].is_number())
+    {
+        component["timestamp"] = event["time"];
+    }
+    ++status_versions_[component_id];
+    LOG_INFO("Component {} container {}: {}", component_id, known_id.substr(0, 12), action);
+}
+
+void ComponentManager::waitFor(int seconds)
+{
+    std::unique_lock<std::mutex> lock(wait_mutex_);
+    wait_cv_.wait_for(lock, std::chrono::seconds(seconds), [this]()
+                      { return !running_; });
+}
+
 bool ComponentManager::startStatusCollection(int interval_sec)
 {
     if (running_)
@@ -511,6 +719,12 @@ bool ComponentManager::startStatusCollection(int interval_sec)
     // 启动状态收集线程
     collection_thread_ = std::make_unique<std::thread>(&ComponentManager::statusCollectionThread, this);
 
+    // 启动Docker事件流线程
+    if (docker_manager_)
+    {
+        events_thread_ = std::make_unique<std::thread>(&ComponentManager::dockerEventsThread, this);
+    }
+
     return true;
 }
 
@@ -521,13 +735,21 @@ void ComponentManager::stopStatusCollection()
         return;
     }
 
-    running_ = false;
+    {
+        std::lock_guard<std::mutex> lock(wait_mutex_);
+        running_ = false;
+    }
+    wait_cv_.notify_all();
 
-    // 等待线程结束
+    // 等待线程结束，事件流线程最多约1秒后发现停止标志
     if (collection_thread_ && collection_thread_->joinable())
     {
         collection_thread_->join();
     }
+    if (events_thread_ && events_thread_->joinable())
+    {
+        events_thread_->join();
+    }
 }
 
 bool ComponentManager::createConfigFiles(const nlohmann::json &config_files)
@@ -581,7 +803,12 @@ bool ComponentManager::removeComponent(const std::string& component_id)
     auto it = components_.find(component_id);
     if (it != components_.end()) {
         components_.erase(it);
+        status_versions_.erase(component_id);
         return true;
     }
     return false;
-}
\ No newline at end of file
+}
+ArtifactCache::Stats ComponentManager::getArtifactCacheStats() const
+{
+    return artifact_cache_->getStats();
+}
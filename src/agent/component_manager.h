@@ -5,8 +5,12 @@
 #include <memory>
 #include <map>
 #include <mutex>
+#include <atomic>
+#include <condition_variable>
 #include <nlohmann/json.hpp>
 #include <thread>
+#include <chrono>
+#include "artifact_cache.h"
 
 // 前向声明
 class DockerManager;
@@ -24,7 +28,9 @@ enum class ComponentType {
 /**
  * ComponentManager类 - 组件管理器
  * 
- * 负责管理业务组件的生命周期，包括部署、停止和状态收集
+ * 负责管理业务组件的生命周期，包括部署、停止和状态收集。
+ * Docker组件的状态由Docker事件流实时更新，定期轮询只在事件流断开时
+ * 或每分钟做一次核对；资源使用情况仍按收集间隔采集
  */
 class ComponentManager {
 public:
@@ -32,8 +38,9 @@ public:
      * 构造函数
      * 
      * @param http_client HTTP客户端，用于与Manager通信
+     * @param artifact_cache_mb 本机制品缓存中二进制制品的容量上限（MB）
      */
-    explicit ComponentManager(std::shared_ptr<HttpClient> http_client);
+    explicit ComponentManager(std::shared_ptr<HttpClient> http_client, int artifact_cache_mb = 4096);
     
     /**
      * 析构函数
@@ -74,7 +81,7 @@ public:
     nlohmann::json stopComponent(const nlohmann::json& component_info);
     
     /**
-     * 收集组件状态
+     * 收集组件状态。Docker容器的状态只在需要核对时查询，其余时候沿用事件流更新的状态
      * 
      * @return 是否成功收集
      */
@@ -108,6 +115,13 @@ public:
      */
     bool removeComponent(const std::string& component_id);
 
+    /**
+     * 获取制品缓存统计
+     * 
+     * @return 统计
+     */
+    ArtifactCache::Stats getArtifactCacheStats() const;
+
 private:
     /**
      * 部署Docker容器组件
@@ -180,17 +194,44 @@ private:
      */
     void statusCollectionThread();
 
+    /**
+     * Docker事件流线程函数，断开后退避重连
+     */
+    void dockerEventsThread();
+
+    /**
+     * 按Docker事件更新对应组件的状态
+     * 
+     * @param event Docker事件
+     */
+    void handleDockerEvent(const nlohmann::json& event);
+
+    /**
+     * 等待指定时间或停止
+     * 
+     * @param seconds 等待时间（秒）
+     */
+    void waitFor(int seconds);
+
 private:
     std::shared_ptr<HttpClient> http_client_;        // HTTP客户端
+    std::shared_ptr<ArtifactCache> artifact_cache_;  // 镜像和二进制制品的本机缓存
     std::unique_ptr<DockerManager> docker_manager_;  // Docker管理器
     std::unique_ptr<BinaryManager> binary_manager_;  // 二进制运行体管理器
     
     std::map<std::string, nlohmann::json> components_;  // 组件信息，key为组件ID
     std::mutex components_mutex_;                       // 组件信息互斥锁
+    std::map<std::string, unsigned long long> status_versions_; // 各组件状态被Docker事件或部署修改的次数，轮询结果据此判断是否已过时
     
-    bool running_;                                   // 状态收集线程运行标志
+    std::atomic<bool> running_;                      // 状态收集线程运行标志
     std::unique_ptr<std::thread> collection_thread_; // 状态收集线程
+    std::unique_ptr<std::thread> events_thread_;     // Docker事件流线程
+    std::mutex wait_mutex_;                          // 线程等待用的互斥锁
+    std::condition_variable wait_cv_;                // 停止时唤醒等待中的线程
     int collection_interval_sec_;                    // 状态收集间隔（秒）
+    std::atomic<bool> events_connected_;             // Docker事件流是否已连接
+    std::atomic<bool> reconcile_requested_;          // 下次收集时查询所有Docker容器的状态
+    std::chrono::steady_clock::time_point last_reconcile_; // 上次查询所有Docker容器状态的时间
 };
 
 #endif // COMPONENT_MANAGER_H
@@ -1,83 +1,224 @@
 #include "cpu_collector.h"
-#include <fstream>
-#include <sstream>
+#include "proc_utils.h"
 #include <string>
 #include <vector>
-#include <thread>
+#include <cstring>
+#include <cstdlib>
+#include <fcntl.h>
 #include <unistd.h>
 
-CpuCollector::CpuCollector() : last_total_time_(0), last_idle_time_(0) {
+namespace {
+
+// 初始读取缓冲区大小，256核的cpu行约20KB，不够时按倍数扩容
+const size_t kInitialBufferSize = 32 * 1024;
+
+}
+
+CpuCollector::CpuCollector(const std::string& stat_path)
+    : stat_path_(stat_path), stat_fd_(-1), buffer_(kInitialBufferSize),
+      last_total_(), current_total_(), online_core_count_(0), sample_() {
+    stat_fd_ = open(stat_path_.c_str(), O_RDONLY | O_CLOEXEC);
     // 初始化时先采集一次CPU时间，为计算使用率做准备
-    double dummy;
-    getCpuUsagePercent();
+    if (readStat()) {
+        last_total_ = current_total_;
+        last_cores_ = current_cores_;
+    }
 }
 
-nlohmann::json CpuCollector::collect() {
-    nlohmann::json result;
-    
+CpuCollector::~CpuCollector() {
+    if (stat_fd_ >= 0) {
+        close(stat_fd_);
+    }
+}
+
+bool CpuCollector::sample() {
     // 获取CPU使用率
-    double usage_percent = getCpuUsagePercent();
-    
+    CpuUsage total_usage = {-1.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+    bool ok = readStat();
+    if (ok) {
+        total_usage = computeUsage(last_total_, current_total_);
+    }
+
+    sample_.usage_percent = total_usage.usage_percent;
+    sample_.user_percent = total_usage.user_percent;
+    sample_.system_percent = total_usage.system_percent;
+    sample_.iowait_percent = total_usage.iowait_percent;
+    sample_.irq_percent = total_usage.irq_percent;
+    sample_.steal_percent = total_usage.steal_percent;
+    sample_.core_count = online_core_count_;
+
     // 获取系统负载
-    double load_avg[3] = {0.0, 0.0, 0.0};
-    getLoadAverage(load_avg);
-    
-    // 获取CPU核心数
-    int core_count = getCoreCount();
-    
-    // 构建JSON结果
-    result["usage_percent"] = usage_percent;
-    result["load_avg_1m"] = load_avg[0];
-    result["load_avg_5m"] = load_avg[1];
-    result["load_avg_15m"] = load_avg[2];
-    result["core_count"] = core_count;
-    
-    return result;
+    sample_.load_avg[0] = sample_.load_avg[1] = sample_.load_avg[2] = 0.0;
+    getLoadAverage(sample_.load_avg);
+
+    // 每个核心的使用情况，clear()保留容量，核心数不变时不分配内存
+    sample_.cores.clear();
+    if (ok) {
+        for (size_t i = 0; i < current_cores_.size(); ++i) {
+            if (!current_cores_[i].present) {
+                continue;
+            }
+            CpuUsage usage = computeUsage(i < last_cores_.size() ? last_cores_[i] : current_cores_[i], current_cores_[i]);
+            CoreSample core = {static_cast<int>(i), usage.usage_percent, usage.iowait_percent,
+                               usage.irq_percent, usage.steal_percent};
+            sample_.cores.push_back(core);
+        }
+
+        // 更新上次的时间，向量大小不变时不会重新分配
+        last_total_ = current_total_;
+        last_cores_ = current_cores_;
+    }
+
+    return ok;
+}
+
+void CpuCollector::writeSample(SampleWriter& writer) const {
+    writer.writeDouble("usage_percent", sample_.usage_percent);
+    writer.writeDouble("user_percent", sample_.user_percent);
+    writer.writeDouble("system_percent", sample_.system_percent);
+    writer.writeDouble("iowait_percent", sample_.iowait_percent);
+    writer.writeDouble("irq_percent", sample_.irq_percent);
+    writer.writeDouble("steal_percent", sample_.steal_percent);
+    writer.writeDouble("load_avg_1m", sample_.load_avg[0]);
+    writer.writeDouble("load_avg_5m", sample_.load_avg[1]);
+    writer.writeDouble("load_avg_15m", sample_.load_avg[2]);
+    writer.writeInt("core_count", sample_.core_count);
+
+    writer.beginArray("cores");
+    for (const CoreSample& core : sample_.cores) {
+        writer.beginObject(nullptr);
+        writer.writeInt("core", core.core);
+        writer.writeDouble("usage_percent", core.usage_percent);
+        writer.writeDouble("iowait_percent", core.iowait_percent);
+        writer.writeDouble("irq_percent", core.irq_percent);
+        writer.writeDouble("steal_percent", core.steal_percent);
+        writer.endObject();
+    }
+    writer.endArray();
+}
+
+ResourceCollector::CostClass CpuCollector::getCostClass() const {
+    // 只读取/proc/stat开头的cpu行
+    return kCostFast;
 }
 
 std::string CpuCollector::getType() const {
     return "cpu";
 }
 
-double CpuCollector::getCpuUsagePercent() {
-    std::ifstream file("/proc/stat");
-    if (!file.is_open()) {
-        return -1.0;
+bool CpuCollector::readStat() {
+    if (stat_fd_ < 0) {
+        // 上次打开失败时重试
+        stat_fd_ = open(stat_path_.c_str(), O_RDONLY | O_CLOEXEC);
+        if (stat_fd_ < 0) {
+            return false;
+        }
     }
-    
-    std::string line;
-    if (!std::getline(file, line)) {
-        return -1.0;
+
+    while (true) {
+        // 从文件开头重新读取，procfs会重新生成内容
+        ssize_t n = pread(stat_fd_, buffer_.data(), buffer_.size(), 0);
+        if (n <= 0) {
+            return false;
+        }
+
+        bool complete = false;
+        bool found = parseStat(static_cast<size_t>(n), complete);
+
+        // 缓冲区被填满且cpu行还没读完时扩容重读（只在首次或核心数增加时发生）
+        if (!complete && static_cast<size_t>(n) == buffer_.size()) {
+            buffer_.resize(buffer_.size() * 2);
+            continue;
+        }
+        return found;
+    }
+}
+
+bool CpuCollector::parseStat(size_t length, bool& complete) {
+    const char* p = buffer_.data();
+    const char* end = p + length;
+    bool found_total = false;
+
+    for (auto& core : current_cores_) {
+        core.present = false;
     }
-    
-    // 解析CPU时间
-    std::istringstream iss(line);
-    std::string cpu_label;
-    unsigned long long user, nice, system, idle, iowait, irq, softirq, steal, guest, guest_nice;
-    
-    iss >> cpu_label >> user >> nice >> system >> idle >> iowait >> irq >> softirq >> steal >> guest >> guest_nice;
-    
-    // 计算总时间和空闲时间
-    unsigned long long idle_time = idle + iowait;
-    unsigned long long total_time = user + nice + system + idle + iowait + irq + softirq + steal;
-    
+    online_core_count_ = 0;
+    complete = false;
+
+    while (p < end) {
+        // cpu行总是位于文件开头，遇到其他行即可结束，无需读完后面很长的intr行
+        if (end - p >= 3 && memcmp(p, "cpu", 3) != 0) {
+            complete = true;
+            return found_total;
+        }
+
+        const char* line_end = static_cast<const char*>(memchr(p, '\n', end - p));
+        if (!line_end || line_end - p < 4) {
+            // 最后一行不完整，说明缓冲区不够大
+            return found_total;
+        }
+
+        const char* q = p + 3;
+        CpuTimes* target = nullptr;
+        if (*q == ' ') {
+            target = &current_total_;
+            found_total = true;
+        } else {
+            unsigned long long index = 0;
+            q = proc_parse_number(q, line_end, index);
+            if (index >= current_cores_.size()) {
+                current_cores_.resize(index + 1, CpuTimes());
+            }
+            target = &current_cores_[index];
+            ++online_core_count_;
+        }
+
+        // user nice system idle iowait irq softirq steal，后面的guest已计入user/nice
+        q = proc_parse_number(q, line_end, target->user);
+        q = proc_parse_number(q, line_end, target->nice);
+        q = proc_parse_number(q, line_end, target->system);
+        q = proc_parse_number(q, line_end, target->idle);
+        q = proc_parse_number(q, line_end, target->iowait);
+        q = proc_parse_number(q, line_end, target->irq);
+        q = proc_parse_number(q, line_end, target->softirq);
+        proc_parse_number(q, line_end, target->steal);
+        target->present = true;
+
+        p = line_end + 1;
+    }
+
+    // 文件恰好在cpu行后结束
+    complete = true;
+    return found_total;
+}
+
+CpuCollector::CpuUsage CpuCollector::computeUsage(const CpuTimes& prev, const CpuTimes& curr) {
+    CpuUsage usage = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+
     // 计算时间差
-    unsigned long long total_time_delta = total_time - last_total_time_;
-    unsigned long long idle_time_delta = idle_time - last_idle_time_;
-    
-    // 更新上次的时间
-    last_total_time_ = total_time;
-    last_idle_time_ = idle_time;
-    
+    unsigned long long user = proc_counter_delta(prev.user, curr.user) + proc_counter_delta(prev.nice, curr.nice);
+    unsigned long long system = proc_counter_delta(prev.system, curr.system);
+    unsigned long long idle = proc_counter_delta(prev.idle, curr.idle);
+    unsigned long long iowait = proc_counter_delta(prev.iowait, curr.iowait);
+    unsigned long long irq = proc_counter_delta(prev.irq, curr.irq) + proc_counter_delta(prev.softirq, curr.softirq);
+    unsigned long long steal = proc_counter_delta(prev.steal, curr.steal);
+    unsigned long long total = user + system + idle + iowait + irq + steal;
+
     // 如果是第一次采集，返回0
-    if (total_time_delta == 0) {
-        return 0.0;
+    if (total == 0) {
+        return usage;
     }
-    
-    // 计算CPU使用率
-    double usage_percent = 100.0 * (1.0 - static_cast<double>(idle_time_delta) / total_time_delta);
-    
-    return usage_percent;
+
+    // 空闲时间包含iowait，与原有usage_percent口径一致
+    double scale = 100.0 / static_cast<double>(total);
+    usage.usage_percent = 100.0 - static_cast<double>(idle + iowait) * scale;
+    usage.user_percent = static_cast<double>(user) * scale;
+    usage.system_percent = static_cast<double>(system) * scale;
+    usage.iowait_percent = static_cast<double>(iowait) * scale;
+    usage.irq_percent = static_cast<double>(irq) * scale;
+    usage.steal_percent = static_cast<double>(steal) * scale;
+
+    return usage;
 }
 
 bool CpuCollector::getLoadAverage(double load_avg[3]) {
@@ -86,7 +227,3 @@ bool CpuCollector::getLoadAverage(double load_avg[3]) {
     }
     return true;
 }
-
-int CpuCollector::getCoreCount() {
-    return std::thread::hardware_concurrency();
-}
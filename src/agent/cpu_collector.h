@@ -2,31 +2,81 @@
 #define CPU_COLLECTOR_H
 
 #include "resource_collector.h"
+#include <vector>
 
 /**
  * CpuCollector类 - CPU资源采集器
  * 
- * 负责采集CPU相关资源信息
+ * 负责采集CPU相关资源信息，包括整体和每个核心的使用率及iowait/steal/irq占比
  */
 class CpuCollector : public ResourceCollector {
 public:
+    /**
+     * 单个核心的使用情况（百分比）
+     */
+    struct CoreSample {
+        int core;                           // 核心编号
+        double usage_percent;
+        double iowait_percent;
+        double irq_percent;
+        double steal_percent;
+    };
+
+    /**
+     * 一次采集的CPU样本
+     */
+    struct Sample {
+        double usage_percent;               // 整体使用率，读取失败时为-1
+        double user_percent;
+        double system_percent;
+        double iowait_percent;
+        double irq_percent;
+        double steal_percent;
+        double load_avg[3];                 // 1分钟、5分钟、15分钟负载
+        int core_count;                     // 在线核心数
+        std::vector<CoreSample> cores;      // 每个在线核心，容量在采集间复用
+    };
+
     /**
      * 构造函数
+     * 
+     * @param stat_path /proc/stat文件路径
      */
-    CpuCollector();
-    
+    explicit CpuCollector(const std::string& stat_path = "/proc/stat");
+
     /**
      * 析构函数
      */
-    ~CpuCollector() override = default;
-    
+    ~CpuCollector() override;
+
     /**
-     * 采集CPU资源信息
+     * 采集CPU资源信息到样本中
      * 
-     * @return JSON格式的CPU资源信息
+     * @return 是否成功读取/proc/stat
      */
-    nlohmann::json collect() override;
-    
+    bool sample() override;
+
+    /**
+     * 将最近一次采集的样本逐字段写出
+     * 
+     * @param writer 序列化输出
+     */
+    void writeSample(SampleWriter& writer) const override;
+
+    /**
+     * 获取最近一次采集的样本
+     * 
+     * @return CPU样本
+     */
+    const Sample& lastSample() const { return sample_; }
+
+    /**
+     * 获取采集开销等级
+     * 
+     * @return 开销等级
+     */
+    CostClass getCostClass() const override;
+
     /**
      * 获取采集器类型
      * 
@@ -36,12 +86,57 @@ public:
 
 private:
     /**
-     * 获取CPU使用率
+     * /proc/stat中一行cpu的累计时间（单位：jiffies）
+     */
+    struct CpuTimes {
+        unsigned long long user;
+        unsigned long long nice;
+        unsigned long long system;
+        unsigned long long idle;
+        unsigned long long iowait;
+        unsigned long long irq;
+        unsigned long long softirq;
+        unsigned long long steal;
+        bool present;              // 本次采集中该核心是否在线
+    };
+
+    /**
+     * 两次采集之间的CPU时间占比（百分比）
+     */
+    struct CpuUsage {
+        double usage_percent;
+        double user_percent;
+        double system_percent;
+        double iowait_percent;
+        double irq_percent;
+        double steal_percent;
+    };
+
+    /**
+     * 读取/proc/stat并解析所有cpu行到current_total_/current_cores_
+     * 
+     * @return 是否成功读取
+     */
+    bool readStat();
+
+    /**
+     * 解析缓冲区中的cpu行，不分配内存（新核心出现时除外）
+     * 
+     * @param length 缓冲区有效数据长度
+     * @param complete 输出参数，是否已读到cpu行之后的内容
+     * @return 是否解析到整体cpu行
+     */
+    bool parseStat(size_t length, bool& complete);
+
+    /**
+     * 根据两次采集的时间差计算占比
      * 
-     * @return CPU使用率百分比
+     * @param prev 上次采集的时间
+     * @param curr 本次采集的时间
+     * @return 各项时间占比
      */
-    double getCpuUsagePercent();
-    
+    static CpuUsage computeUsage(const CpuTimes& prev, const CpuTimes& curr);
+
     /**
      * 获取系统负载
      * 
@@ -49,17 +144,18 @@ private:
      * @return 是否成功获取
      */
     bool getLoadAverage(double load_avg[3]);
-    
-    /**
-     * 获取CPU核心数
-     * 
-     * @return CPU核心数
-     */
-    int getCoreCount();
 
 private:
-    unsigned long long last_total_time_;   // 上次采集的总CPU时间
-    unsigned long long last_idle_time_;    // 上次采集的空闲CPU时间
+    std::string stat_path_;                 // /proc/stat文件路径
+    int stat_fd_;                           // 常驻打开的/proc/stat文件描述符
+    std::vector<char> buffer_;              // 复用的读取缓冲区
+
+    CpuTimes last_total_;                   // 上次采集的整体CPU时间
+    CpuTimes current_total_;                // 本次采集的整体CPU时间
+    std::vector<CpuTimes> last_cores_;      // 上次采集的每核心CPU时间，下标为核心编号
+    std::vector<CpuTimes> current_cores_;   // 本次采集的每核心CPU时间，下标为核心编号
+    int online_core_count_;                 // 本次采集中在线的核心数
+    Sample sample_;                         // 最近一次采集的样本
 };
 
 #endif // CPU_COLLECTOR_H
@@ -0,0 +1,296 @@
+#include "disk_collector.h"
+#include "proc_utils.h"
+#include <string>
+#include <vector>
+#include <cstring>
+#include <utility>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/statvfs.h>
+
+namespace {
+
+// 初始读取缓冲区大小，不够时由read_proc_file按倍数扩容
+const size_t kInitialBufferSize = 16 * 1024;
+
+// diskstats中的扇区固定为512字节
+const unsigned long long kSectorSize = 512;
+
+// 是否为需要忽略的虚拟块设备
+inline bool isIgnoredDevice(const char* name, size_t length) {
+    return (length >= 4 && memcmp(name, "loop", 4) == 0) ||
+           (length >= 3 && memcmp(name, "ram", 3) == 0);
+}
+
+}
+
+DiskCollector::DiskCollector(const std::string& diskstats_path, const std::string& mounts_path)
+    : diskstats_path_(diskstats_path), mounts_path_(mounts_path),
+      diskstats_fd_(-1), mounts_fd_(-1),
+      diskstats_buffer_(kInitialBufferSize), mounts_buffer_(kInitialBufferSize),
+      current_device_count_(0), last_device_count_(0), mount_count_(0), last_time_(), sample_() {
+    diskstats_fd_ = open(diskstats_path_.c_str(), O_RDONLY | O_CLOEXEC);
+    mounts_fd_ = open(mounts_path_.c_str(), O_RDONLY | O_CLOEXEC);
+
+    // 初始化时先采集一次计数，为计算速率做准备
+    clock_gettime(CLOCK_MONOTONIC, &last_time_);
+    if (readDiskStats()) {
+        std::swap(last_devices_, current_devices_);
+        last_device_count_ = current_device_count_;
+    }
+}
+
+DiskCollector::~DiskCollector() {
+    if (diskstats_fd_ >= 0) {
+        close(diskstats_fd_);
+    }
+    if (mounts_fd_ >= 0) {
+        close(mounts_fd_);
+    }
+}
+
+bool DiskCollector::sample() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double elapsed_sec = static_cast<double>(now.tv_sec - last_time_.tv_sec) +
+                         static_cast<double>(now.tv_nsec - last_time_.tv_nsec) / 1e9;
+
+    // 块设备I/O速率
+    sample_.device_count = 0;
+    bool ok = readDiskStats();
+    if (ok) {
+        for (size_t i = 0; i < current_device_count_; ++i) {
+            const DeviceStats& curr = current_devices_[i];
+            const DeviceStats* prev = findLastDevice(curr.name, i);
+
+            if (sample_.device_count == sample_.devices.size()) {
+                sample_.devices.emplace_back();
+            }
+            DeviceSample& device = sample_.devices[sample_.device_count++];
+            device.device = curr.name;
+            device.read_iops = 0.0;
+            device.write_iops = 0.0;
+            device.read_bytes_per_sec = 0.0;
+            device.write_bytes_per_sec = 0.0;
+            device.await_ms = 0.0;
+            device.util_percent = 0.0;
+            if (prev && elapsed_sec > 0.0) {
+                unsigned long long reads = proc_counter_delta(prev->reads, curr.reads);
+                unsigned long long writes = proc_counter_delta(prev->writes, curr.writes);
+                unsigned long long io_ms = proc_counter_delta(prev->io_ms, curr.io_ms);
+
+                device.read_iops = static_cast<double>(reads) / elapsed_sec;
+                device.write_iops = static_cast<double>(writes) / elapsed_sec;
+                device.read_bytes_per_sec = static_cast<double>(proc_counter_delta(prev->sectors_read, curr.sectors_read) * kSectorSize) / elapsed_sec;
+                device.write_bytes_per_sec = static_cast<double>(proc_counter_delta(prev->sectors_written, curr.sectors_written) * kSectorSize) / elapsed_sec;
+                if (reads + writes > 0) {
+                    device.await_ms = static_cast<double>(proc_counter_delta(prev->read_ms, curr.read_ms) + proc_counter_delta(prev->write_ms, curr.write_ms)) /
+                                      static_cast<double>(reads + writes);
+                }
+                device.util_percent = static_cast<double>(io_ms) / (elapsed_sec * 10.0);
+                if (device.util_percent > 100.0) {
+                    device.util_percent = 100.0;
+                }
+            }
+        }
+
+        // 交换前后两次的计数，字符串容量得以复用
+        std::swap(last_devices_, current_devices_);
+        last_device_count_ = current_device_count_;
+        last_time_ = now;
+    }
+
+    // 挂载点容量
+    sample_.filesystem_count = 0;
+    if (readMounts()) {
+        for (size_t i = 0; i < mount_count_; ++i) {
+            const MountInfo& mount = mounts_[i];
+            struct statvfs vfs;
+            if (statvfs(mount.mount_point.c_str(), &vfs) != 0 || vfs.f_blocks == 0) {
+                continue;
+            }
+
+            unsigned long long total = static_cast<unsigned long long>(vfs.f_blocks) * vfs.f_frsize;
+            unsigned long long free = static_cast<unsigned long long>(vfs.f_bfree) * vfs.f_frsize;
+            unsigned long long available = static_cast<unsigned long long>(vfs.f_bavail) * vfs.f_frsize;
+            unsigned long long used = total - free;
+
+            if (sample_.filesystem_count == sample_.filesystems.size()) {
+                sample_.filesystems.emplace_back();
+            }
+            FilesystemSample& filesystem = sample_.filesystems[sample_.filesystem_count++];
+            filesystem.device = mount.device;
+            filesystem.mount_point = mount.mount_point;
+            filesystem.fs_type = mount.fs_type;
+            filesystem.total = total;
+            filesystem.used = used;
+            filesystem.free = available;
+            // 与df一致，使用率按普通用户可用空间计算
+            filesystem.usage_percent = (used + available) > 0 ?
+                100.0 * static_cast<double>(used) / static_cast<double>(used + available) : 0.0;
+        }
+    }
+
+    return ok;
+}
+
+void DiskCollector::writeSample(SampleWriter& writer) const {
+    writer.beginArray("devices");
+    for (size_t i = 0; i < sample_.device_count; ++i) {
+        const DeviceSample& device = sample_.devices[i];
+        writer.beginObject(nullptr);
+        writer.writeString("device", device.device);
+        writer.writeDouble("read_iops", device.read_iops);
+        writer.writeDouble("write_iops", device.write_iops);
+        writer.writeDouble("read_bytes_per_sec", device.read_bytes_per_sec);
+        writer.writeDouble("write_bytes_per_sec", device.write_bytes_per_sec);
+        writer.writeDouble("await_ms", device.await_ms);
+        writer.writeDouble("util_percent", device.util_percent);
+        writer.endObject();
+    }
+    writer.endArray();
+
+    writer.beginArray("filesystems");
+    for (size_t i = 0; i < sample_.filesystem_count; ++i) {
+        const FilesystemSample& filesystem = sample_.filesystems[i];
+        writer.beginObject(nullptr);
+        writer.writeString("device", filesystem.device);
+        writer.writeString("mount_point", filesystem.mount_point);
+        writer.writeString("fs_type", filesystem.fs_type);
+        writer.writeUint("total", filesystem.total);
+        writer.writeUint("used", filesystem.used);
+        writer.writeUint("free", filesystem.free);
+        writer.writeDouble("usage_percent", filesystem.usage_percent);
+        writer.endObject();
+    }
+    writer.endArray();
+}
+
+ResourceCollector::CostClass DiskCollector::getCostClass() const {
+    // 每个挂载点一次statvfs，慢速存储或网络文件系统上可能阻塞
+    return kCostSlow;
+}
+
+std::string DiskCollector::getType() const {
+    return "disk";
+}
+
+bool DiskCollector::readDiskStats() {
+    ssize_t n = read_proc_file(diskstats_fd_, diskstats_path_, diskstats_buffer_);
+    if (n <= 0) {
+        return false;
+    }
+
+    const char* p = diskstats_buffer_.data();
+    const char* end = p + n;
+    current_device_count_ = 0;
+
+    while (p < end) {
+        const char* line_end = proc_line_end(p, end);
+
+        // major minor name，后面是各项计数
+        unsigned long long major = 0, minor = 0;
+        const char* name = nullptr;
+        size_t name_length = 0;
+        const char* q = proc_parse_number(p, line_end, major);
+        q = proc_parse_number(q, line_end, minor);
+        q = proc_parse_field(q, line_end, name, name_length);
+
+        if (name_length > 0 && !isIgnoredDevice(name, name_length)) {
+            DeviceStats stats;
+            unsigned long long reads_merged = 0, writes_merged = 0, in_flight = 0;
+            q = proc_parse_number(q, line_end, stats.reads);
+            q = proc_parse_number(q, line_end, reads_merged);
+            q = proc_parse_number(q, line_end, stats.sectors_read);
+            q = proc_parse_number(q, line_end, stats.read_ms);
+            q = proc_parse_number(q, line_end, stats.writes);
+            q = proc_parse_number(q, line_end, writes_merged);
+            q = proc_parse_number(q, line_end, stats.sectors_written);
+            q = proc_parse_number(q, line_end, stats.write_ms);
+            q = proc_parse_number(q, line_end, in_flight);
+            proc_parse_number(q, line_end, stats.io_ms);
+
+            // 从未有过I/O的设备（如空光驱）不上报
+            if (stats.reads + stats.writes > 0) {
+                if (current_device_count_ == current_devices_.size()) {
+                    current_devices_.emplace_back();
+                }
+                DeviceStats& target = current_devices_[current_device_count_++];
+                target.name.assign(name, name_length);
+                target.reads = stats.reads;
+                target.sectors_read = stats.sectors_read;
+                target.read_ms = stats.read_ms;
+                target.writes = stats.writes;
+                target.sectors_written = stats.sectors_written;
+                target.write_ms = stats.write_ms;
+                target.io_ms = stats.io_ms;
+            }
+        }
+
+        p = line_end + 1;
+    }
+
+    return true;
+}
+
+bool DiskCollector::readMounts() {
+    ssize_t n = read_proc_file(mounts_fd_, mounts_path_, mounts_buffer_);
+    if (n <= 0) {
+        return false;
+    }
+
+    const char* p = mounts_buffer_.data();
+    const char* end = p + n;
+    mount_count_ = 0;
+
+    while (p < end) {
+        const char* line_end = proc_line_end(p, end);
+
+        // device mount_point fs_type options dump pass
+        const char* device = nullptr;
+        const char* mount_point = nullptr;
+        const char* fs_type = nullptr;
+        size_t device_length = 0, mount_point_length = 0, fs_type_length = 0;
+        const char* q = proc_parse_field(p, line_end, device, device_length);
+        q = proc_parse_field(q, line_end, mount_point, mount_point_length);
+        proc_parse_field(q, line_end, fs_type, fs_type_length);
+
+        // 只统计挂载了块设备的文件系统，同一设备的多个挂载（bind mount）只取第一个
+        if (device_length > 0 && device[0] == '/' && mount_point_length > 0) {
+            bool duplicate = false;
+            for (size_t i = 0; i < mount_count_; ++i) {
+                if (mounts_[i].device.size() == device_length &&
+                    memcmp(mounts_[i].device.data(), device, device_length) == 0) {
+                    duplicate = true;
+                    break;
+                }
+            }
+
+            if (!duplicate) {
+                if (mount_count_ == mounts_.size()) {
+                    mounts_.emplace_back();
+                }
+                MountInfo& target = mounts_[mount_count_++];
+                target.device.assign(device, device_length);
+                target.mount_point.assign(mount_point, mount_point_length);
+                target.fs_type.assign(fs_type, fs_type_length);
+            }
+        }
+
+        p = line_end + 1;
+    }
+
+    return true;
+}
+
+const DiskCollector::DeviceStats* DiskCollector::findLastDevice(const std::string& name, size_t hint) const {
+    if (hint < last_device_count_ && last_devices_[hint].name == name) {
+        return &last_devices_[hint];
+    }
+    for (size_t i = 0; i < last_device_count_; ++i) {
+        if (last_devices_[i].name == name) {
+            return &last_devices_[i];
+        }
+    }
+    return nullptr;
+}
@@ -0,0 +1,167 @@
+#ifndef DISK_COLLECTOR_H
+#define DISK_COLLECTOR_H
+
+#include "resource_collector.h"
+#include <vector>
+#include <time.h>
+#include <sys/types.h>
+
+/**
+ * DiskCollector类 - 磁盘资源采集器
+ * 
+ * 负责采集块设备I/O（/proc/diskstats差值）和各挂载点容量（statvfs）
+ */
+class DiskCollector : public ResourceCollector {
+public:
+    /**
+     * 一个块设备的I/O速率
+     */
+    struct DeviceSample {
+        std::string device;                     // 设备名
+        double read_iops;
+        double write_iops;
+        double read_bytes_per_sec;
+        double write_bytes_per_sec;
+        double await_ms;                        // 平均每次I/O耗时
+        double util_percent;                    // 设备忙碌时间占比
+    };
+
+    /**
+     * 一个挂载点的容量（字节）
+     */
+    struct FilesystemSample {
+        std::string device;
+        std::string mount_point;
+        std::string fs_type;
+        unsigned long long total;
+        unsigned long long used;
+        unsigned long long free;                // 普通用户可用空间
+        double usage_percent;
+    };
+
+    /**
+     * 一次采集的磁盘样本，向量只增不减，元素中的字符串容量在采集间复用
+     */
+    struct Sample {
+        std::vector<DeviceSample> devices;
+        size_t device_count;                    // devices中的有效元素数
+        std::vector<FilesystemSample> filesystems;
+        size_t filesystem_count;                // filesystems中的有效元素数
+    };
+
+    /**
+     * 构造函数
+     * 
+     * @param diskstats_path /proc/diskstats文件路径
+     * @param mounts_path 挂载表文件路径
+     */
+    explicit DiskCollector(const std::string& diskstats_path = "/proc/diskstats",
+                           const std::string& mounts_path = "/proc/self/mounts");
+
+    /**
+     * 析构函数
+     */
+    ~DiskCollector() override;
+
+    /**
+     * 采集磁盘资源信息到样本中
+     * 
+     * @return 是否成功读取/proc/diskstats
+     */
+    bool sample() override;
+
+    /**
+     * 将最近一次采集的样本逐字段写出
+     * 
+     * @param writer 序列化输出
+     */
+    void writeSample(SampleWriter& writer) const override;
+
+    /**
+     * 获取最近一次采集的样本
+     * 
+     * @return 磁盘样本
+     */
+    const Sample& lastSample() const { return sample_; }
+
+    /**
+     * 获取采集开销等级
+     * 
+     * @return 开销等级
+     */
+    CostClass getCostClass() const override;
+
+    /**
+     * 获取采集器类型
+     * 
+     * @return 采集器类型名称
+     */
+    std::string getType() const override;
+
+private:
+    /**
+     * /proc/diskstats中一个块设备的累计计数
+     */
+    struct DeviceStats {
+        std::string name;                       // 设备名，如sda、nvme0n1
+        unsigned long long reads;               // 完成的读次数
+        unsigned long long sectors_read;        // 读扇区数
+        unsigned long long read_ms;             // 读耗时（毫秒）
+        unsigned long long writes;              // 完成的写次数
+        unsigned long long sectors_written;     // 写扇区数
+        unsigned long long write_ms;            // 写耗时（毫秒）
+        unsigned long long io_ms;               // 设备忙碌时间（毫秒）
+    };
+
+    /**
+     * 一个挂载点的信息
+     */
+    struct MountInfo {
+        std::string device;                     // 设备路径，如/dev/sda1
+        std::string mount_point;                // 挂载点
+        std::string fs_type;                    // 文件系统类型
+    };
+
+    /**
+     * 读取并解析/proc/diskstats到current_devices_
+     * 
+     * @return 是否成功读取
+     */
+    bool readDiskStats();
+
+    /**
+     * 读取并解析挂载表到mounts_
+     * 
+     * @return 是否成功读取
+     */
+    bool readMounts();
+
+    /**
+     * 查找上次采集中同名设备
+     * 
+     * @param name 设备名
+     * @param hint 优先比较的下标（diskstats的设备顺序通常不变）
+     * @return 上次的计数，找不到返回nullptr
+     */
+    const DeviceStats* findLastDevice(const std::string& name, size_t hint) const;
+
+private:
+    std::string diskstats_path_;                // /proc/diskstats文件路径
+    std::string mounts_path_;                   // 挂载表文件路径
+    int diskstats_fd_;                          // 常驻打开的diskstats文件描述符
+    int mounts_fd_;                             // 常驻打开的挂载表文件描述符
+    std::vector<char> diskstats_buffer_;        // 复用的diskstats读取缓冲区
+    std::vector<char> mounts_buffer_;           // 复用的挂载表读取缓冲区
+
+    std::vector<DeviceStats> last_devices_;     // 上次采集的设备计数
+    std::vector<DeviceStats> current_devices_;  // 本次采集的设备计数
+    size_t current_device_count_;               // 本次采集的有效设备数
+    size_t last_device_count_;                  // 上次采集的有效设备数
+    std::vector<MountInfo> mounts_;             // 本次采集的挂载点
+    size_t mount_count_;                        // 本次采集的有效挂载点数
+
+    struct timespec last_time_;                 // 上次采集的单调时钟时间
+    Sample sample_;                             // 最近一次采集的样本
+};
+
+#endif // DISK_COLLECTOR_H
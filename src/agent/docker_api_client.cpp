@@ -0,0 +1,250 @@
+#include "docker_api_client.h"
+#include "utils/logger.h"
+#include <curl/curl.h>
+
+namespace {
+
+size_t appendBody(char* data, size_t size, size_t nmemb, void* userdata) {
+    static_cast<std::string*>(userdata)->append(data, size * nmemb);
+    return size * nmemb;
+}
+
+// stream()的回调上下文
+struct StreamContext {
+    CURL* curl;
+    const std::function<void()>* on_connected;
+    const std::function<void(const char*, size_t)>* on_data;
+    const std::function<bool()>* keep_running;
+    std::string* error_body;
+    bool success;                           // 是否为2xx响应
+    bool aborted;                           // 是否因keep_running返回false中止
+};
+
+size_t streamHeader(char* data, size_t size, size_t nitems, void* userdata) {
+    StreamContext* context = static_cast<StreamContext*>(userdata);
+    // 响应头结束时按状态码决定响应体的去向
+    if (size * nitems == 2 && data[0] == '\r' && data[1] == '\n') {
+        long status = 0;
+        curl_easy_getinfo(context->curl, CURLINFO_RESPONSE_CODE, &status);
+        context->success = status >= 200 && status < 300;
+        if (context->success) {
+            (*context->on_connected)();
+        }
+    }
+    return size * nitems;
+}
+
+size_t streamBody(char* data, size_t size, size_t nmemb, void* userdata) {
+    StreamContext* context = static_cast<StreamContext*>(userdata);
+    if (context->success) {
+        (*context->on_data)(data, size * nmemb);
+    } else {
+        context->error_body->append(data, size * nmemb);
+    }
+    return size * nmemb;
+}
+
+int streamProgress(void* userdata, curl_off_t, curl_off_t, curl_off_t, curl_off_t) {
+    StreamContext* context = static_cast<StreamContext*>(userdata);
+    if (!(*context->keep_running)()) {
+        context->aborted = true;
+        return 1;
+    }
+    return 0;
+}
+
+size_t readBody(char* buffer, size_t size, size_t nitems, void* userdata) {
+    const DockerApiClient::BodySource& source = *static_cast<const DockerApiClient::BodySource*>(userdata);
+    return source(buffer, size * nitems);
+}
+
+}
+
+const long DockerApiClient::kDefaultTimeoutSec;
+
+nlohmann::json DockerApiClient::Response::json() const {
+    return nlohmann::json::parse(body, nullptr, false);
+}
+
+std::string DockerApiClient::Response::message() const {
+    if (!error.empty()) {
+        return error;
+    }
+    // Docker的错误响应为{"message": "..."}
+    nlohmann::json parsed = json();
+    if (parsed.is_object() && parsed.contains("message") && parsed["message"].is_string()) {
+        return parsed["message"].get<std::string>();
+    }
+    return body.empty() ? "HTTP " + std::to_string(status) : body;
+}
+
+DockerApiClient::DockerApiClient(const std::string& socket_path, const std::string& api_version)
+    : socket_path_(socket_path),
+      base_url_("http://localhost/" + api_version),
+      requests_(0),
+      connections_(0),
+      failures_(0) {
+}
+
+DockerApiClient::~DockerApiClient() {
+    for (void* curl : idle_) {
+        curl_easy_cleanup(static_cast<CURL*>(curl));
+    }
+}
+
+void* DockerApiClient::acquire() {
+    CURL* curl = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!idle_.empty()) {
+            curl = static_cast<CURL*>(idle_.back());
+            idle_.pop_back();
+        }
+    }
+    if (curl) {
+        // 重置选项，句柄的连接缓存保留
+        curl_easy_reset(curl);
+    } else {
+        curl = curl_easy_init();
+    }
+    if (curl) {
+        curl_easy_setopt(curl, CURLOPT_UNIX_SOCKET_PATH, socket_path_.c_str());
+        curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    }
+    return curl;
+}
+
+DockerApiClient::Response DockerApiClient::request(const std::string& method, const std::string& path,
+                                                   const std::string& body, long timeout_sec) {
+    CURL* curl = static_cast<CURL*>(acquire());
+    if (!curl) {
+        Response response;
+        response.error = "Failed to create CURL handle";
+        return response;
+    }
+
+    struct curl_slist* headers = nullptr;
+    if (method == "POST") {
+        // 无请求体的POST也要带Content-Length: 0
+        curl_easy_setopt(curl, CURLOPT_POST, 1L);
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body.data());
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>(body.size()));
+        if (!body.empty()) {
+            headers = curl_slist_append(headers, "Content-Type: application/json");
+        }
+    } else if (method != "GET") {
+        curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, method.c_str());
+    }
+    return perform(curl, method, path, headers, timeout_sec);
+}
+
+DockerApiClient::Response DockerApiClient::upload(const std::string& path, const std::string& content_type,
+                                                  const BodySource& source, long long size, long timeout_sec) {
+    CURL* curl = static_cast<CURL*>(acquire());
+    if (!curl) {
+        Response response;
+        response.error = "Failed to create CURL handle";
+        return response;
+    }
+
+    struct curl_slist* headers = curl_slist_append(nullptr, ("Content-Type: " + content_type).c_str());
+    curl_easy_setopt(curl, CURLOPT_POST, 1L);
+    curl_easy_setopt(curl, CURLOPT_READFUNCTION, readBody);
+    curl_easy_setopt(curl, CURLOPT_READDATA, &source);
+    if (size >= 0) {
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>(size));
+    } else {
+        headers = curl_slist_append(headers, "Transfer-Encoding: chunked");
+    }
+    return perform(curl, "POST", path, headers, timeout_sec);
+}
+
+DockerApiClient::Response DockerApiClient::perform(void* handle, const std::string& method, const std::string& path,
+                                                   void* header_list, long timeout_sec) {
+    CURL* curl = static_cast<CURL*>(handle);
+    struct curl_slist* headers = static_cast<struct curl_slist*>(header_list);
+    Response response;
+    std::string url = base_url_ + path;
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    if (headers) {
+        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+    }
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, appendBody);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response.body);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, timeout_sec);
+
+    ++requests_;
+    CURLcode code = curl_easy_perform(curl);
+    if (code == CURLE_OK) {
+        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response.status);
+        long connects = 0;
+        curl_easy_getinfo(curl, CURLINFO_NUM_CONNECTS, &connects);
+        connections_ += static_cast<unsigned long long>(connects);
+    } else {
+        ++failures_;
+        response.error = curl_easy_strerror(code);
+        LOG_ERROR("Docker API {} {} failed: {}", method, path, response.error);
+    }
+    curl_slist_free_all(headers);
+
+    // 传输失败的句柄连接状态未知，直接关闭
+    if (code == CURLE_OK) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        idle_.push_back(curl);
+    } else {
+        curl_easy_cleanup(curl);
+    }
+    return response;
+}
+
+DockerApiClient::Response DockerApiClient::stream(const std::string& path,
+                                                  const std::function<void()>& on_connected,
+                                                  const std::function<void(const char* data, size_t size)>& on_data,
+                                                  const std::function<bool()>& keep_running) {
+    Response response;
+    CURL* curl = curl_easy_init();
+    if (!curl) {
+        response.error = "Failed to create CURL handle";
+        return response;
+    }
+
+    StreamContext context = {curl, &on_connected, &on_data, &keep_running, &response.body, false, false};
+    std::string url = base_url_ + path;
+    curl_easy_setopt(curl, CURLOPT_UNIX_SOCKET_PATH, socket_path_.c_str());
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, streamHeader);
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, &context);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, streamBody);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &context);
+    // 没有数据时进度回调也约每秒调用一次，用于检查停止标志
+    curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
+    curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, streamProgress);
+    curl_easy_setopt(curl, CURLOPT_XFERINFODATA, &context);
+
+    ++requests_;
+    ++connections_;
+    CURLcode code = curl_easy_perform(curl);
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response.status);
+    if (code != CURLE_OK && !context.aborted) {
+        ++failures_;
+        response.error = curl_easy_strerror(code);
+    }
+    curl_easy_cleanup(curl);
+    return response;
+}
+
+DockerApiClient::Stats DockerApiClient::getStats() const {
+    Stats stats;
+    stats.requests = requests_;
+    stats.connections = connections_;
+    stats.failures = failures_;
+    return stats;
+}
+
+std::string DockerApiClient::escape(const std::string& value) {
+    char* escaped = curl_easy_escape(nullptr, value.c_str(), static_cast<int>(value.size()));
+    std::string result = escaped ? escaped : "";
+    curl_free(escaped);
+    return result;
+}
@@ -0,0 +1,156 @@
+#ifndef DOCKER_API_CLIENT_H
+#define DOCKER_API_CLIENT_H
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <nlohmann/json.hpp>
+
+/**
+ * DockerApiClient类 - Docker Engine API客户端
+ * 
+ * 通过Docker守护进程的unix套接字发送HTTP请求。每个CURL句柄保持一个长连接，
+ * 请求结束后句柄放回空闲列表，下次请求复用同一连接；多个线程同时请求时各用一个句柄。
+ * 可在多个线程中同时调用
+ */
+class DockerApiClient {
+public:
+    /**
+     * 一次请求的结果
+     */
+    struct Response {
+        long status = 0;                    // HTTP状态码，请求未完成时为0
+        std::string body;                   // 响应体
+        std::string error;                  // 传输错误（连接失败、超时），为空表示收到了响应
+
+        /**
+         * 是否收到2xx响应
+         */
+        bool ok() const { return error.empty() && status >= 200 && status < 300; }
+
+        /**
+         * 解析响应体，不是JSON时返回null
+         */
+        nlohmann::json json() const;
+
+        /**
+         * 错误描述：传输错误、Docker返回的message或响应体
+         */
+        std::string message() const;
+    };
+
+    /**
+     * 连接统计（自创建起累计）
+     */
+    struct Stats {
+        unsigned long long requests;        // 请求数
+        unsigned long long connections;     // 新建的连接数，其余请求复用已有连接
+        unsigned long long failures;        // 传输失败的请求数
+    };
+
+    /**
+     * 请求体来源：向buffer写入最多size字节，返回写入的字节数，0表示结束，CURL_READFUNC_ABORT表示中止请求
+     */
+    typedef std::function<size_t(char* buffer, size_t size)> BodySource;
+
+    /**
+     * 构造函数
+     * 
+     * @param socket_path Docker守护进程的unix套接字
+     * @param api_version API版本前缀
+     */
+    explicit DockerApiClient(const std::string& socket_path = "/var/run/docker.sock",
+                             const std::string& api_version = "v1.40");
+
+    /**
+     * 析构函数，关闭所有连接
+     */
+    ~DockerApiClient();
+
+    DockerApiClient(const DockerApiClient&) = delete;
+    DockerApiClient& operator=(const DockerApiClient&) = delete;
+
+    /**
+     * 发送请求
+     * 
+     * @param method HTTP方法
+     * @param path API路径（不含版本前缀），查询参数须已编码
+     * @param body 请求体，为空时不发送
+     * @param timeout_sec 超时（秒），0表示不限
+     * @return 响应
+     */
+    Response request(const std::string& method, const std::string& path,
+                     const std::string& body = "", long timeout_sec = kDefaultTimeoutSec);
+
+    /**
+     * 发送请求体由source逐块提供的POST请求，请求体不需要完整放在内存中
+     * 
+     * @param path API路径（不含版本前缀）
+     * @param content_type 请求体类型
+     * @param source 请求体来源
+     * @param size 请求体长度，未知时为-1（分块传输）
+     * @param timeout_sec 超时（秒），0表示不限
+     * @return 响应
+     */
+    Response upload(const std::string& path, const std::string& content_type,
+                    const BodySource& source, long long size, long timeout_sec = 0);
+
+    /**
+     * 发送GET请求并逐块接收不定长的响应体（如/events），直到连接断开或keep_running返回false。
+     * 使用单独的连接，不占用空闲句柄
+     * 
+     * @param path API路径（不含版本前缀）
+     * @param on_connected 收到2xx响应头时调用
+     * @param on_data 每收到一块2xx响应体时调用
+     * @param keep_running 约每秒调用一次，返回false时中止
+     * @return 响应；中止时error为空，非2xx响应的响应体在body中
+     */
+    Response stream(const std::string& path,
+                    const std::function<void()>& on_connected,
+                    const std::function<void(const char* data, size_t size)>& on_data,
+                    const std::function<bool()>& keep_running);
+
+    /**
+     * 获取连接统计
+     * 
+     * @return 连接统计
+     */
+    Stats getStats() const;
+
+    /**
+     * 编码查询参数
+     * 
+     * @param value 参数值
+     * @return 编码后的参数值
+     */
+    static std::string escape(const std::string& value);
+
+    // 普通请求的默认超时
+    static const long kDefaultTimeoutSec = 30;
+
+private:
+    /**
+     * 取一个空闲句柄（没有时新建），重置为默认选项
+     */
+    void* acquire();
+
+    /**
+     * 执行请求并把句柄放回空闲列表
+     */
+    Response perform(void* curl, const std::string& method, const std::string& path,
+                     void* headers, long timeout_sec);
+
+private:
+    std::string socket_path_;               // Docker守护进程的unix套接字
+    std::string base_url_;                  // 请求URL前缀（含API版本）
+    std::mutex mutex_;                      // 保护idle_
+    std::vector<void*> idle_;               // 空闲的CURL句柄，各自保持一个连接
+
+    std::atomic<unsigned long long> requests_;      // 请求数
+    std::atomic<unsigned long long> connections_;   // 新建的连接数
+    std::atomic<unsigned long long> failures_;      // 传输失败的请求数
+};
+
+#endif // DOCKER_API_CLIENT_H
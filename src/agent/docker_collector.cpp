@@ -0,0 +1,253 @@
+#include "docker_collector.h"
+#include "proc_utils.h"
+#include "utils/logger.h"
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+
+namespace {
+
+// 初始读取缓冲区大小，不够时由read_proc_file按倍数扩容
+const size_t kInitialBufferSize = 8 * 1024;
+
+// 在目录中查找以prefix开头、以suffix结尾的子目录
+bool findEntry(const std::string& dir, const std::string& prefix, const char* suffix, std::string& path) {
+    DIR* d = opendir(dir.c_str());
+    if (!d) {
+        return false;
+    }
+
+    size_t suffix_length = strlen(suffix);
+    bool found = false;
+    struct dirent* entry;
+    while ((entry = readdir(d)) != nullptr) {
+        size_t length = strlen(entry->d_name);
+        if (length >= prefix.size() + suffix_length &&
+            memcmp(entry->d_name, prefix.data(), prefix.size()) == 0 &&
+            memcmp(entry->d_name + length - suffix_length, suffix, suffix_length) == 0) {
+            path = dir + "/" + entry->d_name;
+            found = true;
+            break;
+        }
+    }
+    closedir(d);
+    return found;
+}
+
+}
+
+DockerCollector::DockerCollector(const std::string& cgroup_root)
+    : cgroup_root_(cgroup_root), buffer_(kInitialBufferSize) {
+}
+
+DockerCollector::~DockerCollector() {
+    for (auto& it : containers_) {
+        closeContainer(it.second);
+    }
+}
+
+bool DockerCollector::isAvailable() const {
+    return access((cgroup_root_ + "/cgroup.controllers").c_str(), F_OK) == 0;
+}
+
+nlohmann::json DockerCollector::collect(const std::string& container_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = containers_.find(container_id);
+    if (it == containers_.end()) {
+        ContainerState state = ContainerState();
+        if (!findCgroupPath(container_id, state.cgroup_path) || !openContainer(state)) {
+            return {
+                {"status", "error"},
+                {"message", "Container cgroup not found: " + container_id}
+            };
+        }
+        it = containers_.emplace(container_id, state).first;
+    }
+    ContainerState& state = it->second;
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    // CPU累计时间
+    unsigned long long usage_usec = 0, throttled_usec = 0;
+    ssize_t n = read_proc_file(state.cpu_stat_fd, state.cgroup_path + "/cpu.stat", buffer_);
+    if (n <= 0 || !parseKeyedValue(buffer_.data(), static_cast<size_t>(n), "usage_usec", usage_usec)) {
+        // 容器已停止，cgroup目录被删除，下次重新查找
+        closeContainer(state);
+        containers_.erase(it);
+        return {
+            {"status", "error"},
+            {"message", "Failed to read cgroup of container: " + container_id}
+        };
+    }
+    parseKeyedValue(buffer_.data(), static_cast<size_t>(n), "throttled_usec", throttled_usec);
+
+    // 内存：与docker stats一致，扣除可回收的inactive_file
+    unsigned long long memory_current = 0, inactive_file = 0, file = 0;
+    n = read_proc_file(state.memory_current_fd, state.cgroup_path + "/memory.current", buffer_);
+    if (n > 0) {
+        proc_parse_number(buffer_.data(), buffer_.data() + n, memory_current);
+    }
+    n = read_proc_file(state.memory_stat_fd, state.cgroup_path + "/memory.stat", buffer_);
+    if (n > 0) {
+        parseKeyedValue(buffer_.data(), static_cast<size_t>(n), "inactive_file", inactive_file);
+        parseKeyedValue(buffer_.data(), static_cast<size_t>(n), "file", file);
+    }
+    unsigned long long memory_used = memory_current > inactive_file ? memory_current - inactive_file : memory_current;
+
+    // 块设备I/O：每行"MAJ:MIN rbytes=.. wbytes=.. rios=.. wios=.. dbytes=.. dios=.."，按设备累加
+    unsigned long long read_bytes = 0, write_bytes = 0;
+    n = read_proc_file(state.io_stat_fd, state.cgroup_path + "/io.stat", buffer_);
+    if (n > 0) {
+        const char* p = buffer_.data();
+        const char* end = p + n;
+        while (p < end) {
+            const char* line_end = proc_line_end(p, end);
+            const char* field = nullptr;
+            size_t field_length = 0;
+            const char* q = proc_parse_field(p, line_end, field, field_length);
+            while (q < line_end) {
+                q = proc_parse_field(q, line_end, field, field_length);
+                unsigned long long value = 0;
+                if (field_length > 7 && memcmp(field, "rbytes=", 7) == 0) {
+                    proc_parse_number(field + 7, field + field_length, value);
+                    read_bytes += value;
+                } else if (field_length > 7 && memcmp(field, "wbytes=", 7) == 0) {
+                    proc_parse_number(field + 7, field + field_length, value);
+                    write_bytes += value;
+                }
+            }
+            p = line_end + 1;
+        }
+    }
+
+    // 容器级PSI（内核开启PSI时存在）
+    PressureCollector::PressureStats pressure[PressureCollector::kResourceCount];
+    bool has_pressure[PressureCollector::kResourceCount];
+    for (size_t i = 0; i < PressureCollector::kResourceCount; ++i) {
+        has_pressure[i] = false;
+        if (state.pressure_fds[i] < 0) {
+            continue;
+        }
+        n = read_proc_file(state.pressure_fds[i], "", buffer_);
+        has_pressure[i] = n > 0 && PressureCollector::parsePressure(buffer_.data(), static_cast<size_t>(n), pressure[i]);
+    }
+
+    // 速率按两次采集之间的单调时钟时间计算，首次采集记为0
+    double cpu_percent = 0.0, throttled_percent = 0.0;
+    double read_bytes_per_sec = 0.0, write_bytes_per_sec = 0.0;
+    if (state.has_last) {
+        double elapsed_sec = static_cast<double>(now.tv_sec - state.last_time.tv_sec) +
+                             static_cast<double>(now.tv_nsec - state.last_time.tv_nsec) / 1e9;
+        if (elapsed_sec > 0.0) {
+            // 与docker stats一致，100%表示占满一个核心
+            cpu_percent = static_cast<double>(proc_counter_delta(state.usage_usec, usage_usec)) / (elapsed_sec * 1e4);
+            throttled_percent = static_cast<double>(proc_counter_delta(state.throttled_usec, throttled_usec)) / (elapsed_sec * 1e4);
+            read_bytes_per_sec = static_cast<double>(proc_counter_delta(state.read_bytes, read_bytes)) / elapsed_sec;
+            write_bytes_per_sec = static_cast<double>(proc_counter_delta(state.write_bytes, write_bytes)) / elapsed_sec;
+        }
+    }
+
+    state.usage_usec = usage_usec;
+    state.throttled_usec = throttled_usec;
+    state.read_bytes = read_bytes;
+    state.write_bytes = write_bytes;
+    state.last_time = now;
+    bool had_last = state.has_last;
+    state.has_last = true;
+
+    nlohmann::json result;
+    result["status"] = "success";
+    nlohmann::json& stats = result["resource_usage"];
+    stats["cpu_percent"] = cpu_percent;
+    stats["cpu_throttled_percent"] = throttled_percent;
+    stats["memory_mb"] = memory_used / (1024 * 1024);
+    stats["memory_bytes"] = memory_used;
+    stats["memory_cache_bytes"] = file;
+    stats["io_read_bytes_per_sec"] = read_bytes_per_sec;
+    stats["io_write_bytes_per_sec"] = write_bytes_per_sec;
+    stats["gpu_percent"] = 0.0;
+
+    nlohmann::json& pressure_json = stats["pressure"];
+    pressure_json = nlohmann::json::object();
+    for (size_t i = 0; i < PressureCollector::kResourceCount; ++i) {
+        if (has_pressure[i]) {
+            PressureCollector::toJson(pressure[i], had_last ? &state.pressure[i] : nullptr,
+                                      pressure_json[PressureCollector::resourceName(i)]);
+            state.pressure[i] = pressure[i];
+        }
+    }
+    return result;
+}
+
+void DockerCollector::removeContainer(const std::string& container_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = containers_.find(container_id);
+    if (it != containers_.end()) {
+        closeContainer(it->second);
+        containers_.erase(it);
+    }
+}
+
+bool DockerCollector::findCgroupPath(const std::string& container_id, std::string& path) const {
+    if (container_id.empty()) {
+        return false;
+    }
+
+    // systemd驱动：system.slice/docker-<id>.scope
+    if (findEntry(cgroup_root_ + "/system.slice", "docker-" + container_id, ".scope", path)) {
+        return true;
+    }
+    // cgroupfs驱动：docker/<id>
+    return findEntry(cgroup_root_ + "/docker", container_id, "", path);
+}
+
+bool DockerCollector::openContainer(ContainerState& state) {
+    state.cpu_stat_fd = open((state.cgroup_path + "/cpu.stat").c_str(), O_RDONLY | O_CLOEXEC);
+    state.memory_current_fd = open((state.cgroup_path + "/memory.current").c_str(), O_RDONLY | O_CLOEXEC);
+    state.memory_stat_fd = open((state.cgroup_path + "/memory.stat").c_str(), O_RDONLY | O_CLOEXEC);
+    state.io_stat_fd = open((state.cgroup_path + "/io.stat").c_str(), O_RDONLY | O_CLOEXEC);
+    for (size_t i = 0; i < PressureCollector::kResourceCount; ++i) {
+        std::string path = state.cgroup_path + "/" + PressureCollector::resourceName(i) + ".pressure";
+        state.pressure_fds[i] = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    }
+    state.has_last = false;
+
+    // cpu.stat是cgroup v2始终存在的文件，打不开说明目录不可用
+    if (state.cpu_stat_fd < 0) {
+        LOG_ERROR("Failed to open cgroup files in {}", state.cgroup_path);
+        closeContainer(state);
+        return false;
+    }
+    return true;
+}
+
+void DockerCollector::closeContainer(ContainerState& state) {
+    int* fds[] = {&state.cpu_stat_fd, &state.memory_current_fd, &state.memory_stat_fd, &state.io_stat_fd,
+                  &state.pressure_fds[0], &state.pressure_fds[1], &state.pressure_fds[2]};
+    for (int* fd : fds) {
+        if (*fd >= 0) {
+            close(*fd);
+        }
+        *fd = -1;
+    }
+}
+
+bool DockerCollector::parseKeyedValue(const char* data, size_t length, const char* key, unsigned long long& value) {
+    const char* p = data;
+    const char* end = data + length;
+    size_t key_length = strlen(key);
+
+    while (p < end) {
+        const char* line_end = proc_line_end(p, end);
+        if (static_cast<size_t>(line_end - p) > key_length &&
+            memcmp(p, key, key_length) == 0 && p[key_length] == ' ') {
+            proc_parse_number(p + key_length, line_end, value);
+            return true;
+        }
+        p = line_end + 1;
+    }
+    return false;
+}
@@ -0,0 +1,116 @@
+#ifndef DOCKER_COLLECTOR_H
+#define DOCKER_COLLECTOR_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <time.h>
+#include <nlohmann/json.hpp>
+#include "pressure_collector.h"
+
+/**
+ * DockerCollector类 - 容器资源采集器
+ * 
+ * 直接读取容器cgroup v2目录下的cpu.stat、memory.current、memory.stat、io.stat和*.pressure，
+ * 替代每次阻塞约1秒的docker stats命令
+ */
+class DockerCollector {
+public:
+    /**
+     * 构造函数
+     * 
+     * @param cgroup_root cgroup v2挂载点
+     */
+    explicit DockerCollector(const std::string& cgroup_root = "/sys/fs/cgroup");
+
+    /**
+     * 析构函数
+     */
+    ~DockerCollector();
+
+    /**
+     * 检查是否为cgroup v2（unified）层级
+     * 
+     * @return 是否可用
+     */
+    bool isAvailable() const;
+
+    /**
+     * 采集容器资源使用情况
+     * 
+     * @param container_id 容器ID（支持短ID）
+     * @return 采集结果，成功时resource_usage中包含cpu_percent、memory_mb等
+     */
+    nlohmann::json collect(const std::string& container_id);
+
+    /**
+     * 移除容器的采集状态并关闭文件描述符
+     * 
+     * @param container_id 容器ID
+     */
+    void removeContainer(const std::string& container_id);
+
+private:
+    /**
+     * 一个容器的cgroup文件描述符和上次的累计计数
+     */
+    struct ContainerState {
+        std::string cgroup_path;                // 容器cgroup目录
+        int cpu_stat_fd;                        // 常驻打开的cpu.stat
+        int memory_current_fd;                  // 常驻打开的memory.current
+        int memory_stat_fd;                     // 常驻打开的memory.stat
+        int io_stat_fd;                         // 常驻打开的io.stat
+        int pressure_fds[PressureCollector::kResourceCount];    // 常驻打开的cpu/memory/io.pressure
+        PressureCollector::PressureStats pressure[PressureCollector::kResourceCount]; // 上次的PSI数据
+        unsigned long long usage_usec;          // 上次的CPU累计使用时间（微秒）
+        unsigned long long throttled_usec;      // 上次的CPU累计被限流时间（微秒）
+        unsigned long long read_bytes;          // 上次的累计读字节数
+        unsigned long long write_bytes;         // 上次的累计写字节数
+        struct timespec last_time;              // 上次采集的单调时钟时间
+        bool has_last;                          // 是否已有上次的计数
+    };
+
+    /**
+     * 查找容器的cgroup目录（兼容systemd和cgroupfs两种驱动）
+     * 
+     * @param container_id 容器ID
+     * @param path 输出的cgroup目录
+     * @return 是否找到
+     */
+    bool findCgroupPath(const std::string& container_id, std::string& path) const;
+
+    /**
+     * 打开容器的各cgroup文件
+     * 
+     * @param state 容器状态，cgroup_path需已设置
+     * @return 是否成功打开
+     */
+    bool openContainer(ContainerState& state);
+
+    /**
+     * 关闭容器的各cgroup文件
+     * 
+     * @param state 容器状态
+     */
+    static void closeContainer(ContainerState& state);
+
+    /**
+     * 在"key value"格式的内容中查找计数
+     * 
+     * @param data 文件内容
+     * @param length 文件长度
+     * @param key 键名
+     * @param value 输出的值
+     * @return 是否找到
+     */
+    static bool parseKeyedValue(const char* data, size_t length, const char* key, unsigned long long& value);
+
+private:
+    std::string cgroup_root_;                           // cgroup v2挂载点
+    std::map<std::string, ContainerState> containers_;  // 容器状态，key为容器ID
+    std::vector<char> buffer_;                          // 复用的读取缓冲区
+    std::mutex mutex_;                                  // 容器状态互斥锁
+};
+
+#endif // DOCKER_COLLECTOR_H
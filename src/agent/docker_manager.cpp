@@ -1,162 +1,309 @@
 #include "docker_manager.h"
 #include "utils/logger.h"
-#include <iostream>
 #include <sstream>
-#include <cstdio>
-#include <memory>
-#include <stdexcept>
-#include <array>
+#include <thread>
 #include <curl/curl.h>
-#include <sys/socket.h>
-#include <sys/un.h>
-#include <unistd.h>
-#include "sftp_client.h"
-
-// 辅助函数：执行系统命令并获取输出
-static std::string exec(const char* cmd) {
-    std::array<char, 128> buffer;
-    std::string result;
-    std::unique_ptr<FILE, decltype(&pclose)> pipe(popen(cmd, "r"), pclose);
-    if (!pipe) {
-        throw std::runtime_error("popen() failed!");
-    }
-    while (fgets(buffer.data(), buffer.size(), pipe.get()) != nullptr) {
-        result += buffer.data();
+#include "stream_pipe.h"
+#include "utils/sha256.h"
+
+namespace {
+
+// 镜像拉取、导入和停止容器可能耗时较长，不设传输超时；停止容器时等待进程退出的秒数
+const int kStopTimeoutSec = 10;
+
+// 镜像下载与导入之间的内存缓冲区大小，下载快于导入时写满后等待
+const size_t kImageStreamBufferSize = 4 * 1024 * 1024;
+
+// 拆分镜像名称为仓库和标签，未指定标签时为latest（不指定标签会拉取仓库的全部标签）
+void splitImageReference(const std::string& image_name, std::string& repo, std::string& tag) {
+    size_t slash = image_name.rfind('/');
+    size_t colon = image_name.rfind(':');
+    if (image_name.find('@') != std::string::npos) {
+        // 按摘要引用时整体作为fromImage
+        repo = image_name;
+        tag.clear();
+    } else if (colon != std::string::npos && (slash == std::string::npos || colon > slash)) {
+        repo = image_name.substr(0, colon);
+        tag = image_name.substr(colon + 1);
+    } else {
+        repo = image_name;
+        tag = "latest";
     }
-    return result;
 }
 
-// 辅助函数：CURL写回调
-static size_t WriteCallback(void* contents, size_t size, size_t nmemb, std::string* s) {
-    size_t newLength = size * nmemb;
-    try {
-        s->append((char*)contents, newLength);
-    } catch(std::bad_alloc &e) {
-        return 0;
+// 逐行解析镜像拉取、导入的进度输出（每行一个JSON对象），出错时返回错误信息，
+// loaded为导入的镜像名称或ID，last_status为最后一条进度
+std::string parseProgress(const std::string& body, std::string* loaded, std::string& last_status) {
+    std::istringstream lines(body);
+    std::string line;
+    while (std::getline(lines, line)) {
+        nlohmann::json message = nlohmann::json::parse(line, nullptr, false);
+        if (!message.is_object()) {
+            continue;
+        }
+        if (message.contains("error")) {
+            return message["error"].is_string() ? message["error"].get<std::string>() : message["error"].dump();
+        }
+        if (message.contains("status") && message["status"].is_string()) {
+            last_status = message["status"].get<std::string>();
+        }
+        if (loaded && message.contains("stream") && message["stream"].is_string()) {
+            // docker load输出"Loaded image: name:tag"或"Loaded image ID: sha256:..."
+            std::string stream = message["stream"].get<std::string>();
+            static const std::string kLoadedId = "Loaded image ID: ";
+            static const std::string kLoaded = "Loaded image: ";
+            size_t pos;
+            if ((pos = stream.find(kLoadedId)) != std::string::npos) {
+                *loaded = stream.substr(pos + kLoadedId.size());
+            } else if ((pos = stream.find(kLoaded)) != std::string::npos) {
+                *loaded = stream.substr(pos + kLoaded.size());
+            }
+            while (!loaded->empty() && (loaded->back() == '\n' || loaded->back() == '\r')) {
+                loaded->pop_back();
+            }
+            last_status = stream;
+        }
     }
-    return newLength;
+    return "";
 }
 
-DockerManager::DockerManager() 
-    : docker_socket_path_("/var/run/docker.sock"), use_api_(true) {
+nlohmann::json errorResult(const std::string& message, const DockerApiClient::Response& response) {
+    return {
+        {"status", "error"},
+        {"message", message + ": " + response.message()}
+    };
+}
+
+}
+
+DockerManager::DockerManager(std::shared_ptr<ArtifactCache> artifact_cache)
+    : artifact_cache_(artifact_cache) {
 }
 
 bool DockerManager::initialize() {
+    // 初始化CURL（须在创建任何句柄之前）
+    curl_global_init(CURL_GLOBAL_ALL);
+
     // 检查Docker守护进程是否可用
     if (!checkDockerAvailable()) {
         LOG_ERROR("Docker daemon is not available");
         return false;
     }
-    
-    // 初始化CURL
-    curl_global_init(CURL_GLOBAL_ALL);
-    
+
     return true;
 }
 
 bool DockerManager::checkDockerAvailable() {
-    try {
-        // 尝试执行docker info命令
-        std::string result = exec("docker info 2>/dev/null");
-        if (result.find("Server Version") != std::string::npos) {
-            return true;
+    DockerApiClient::Response response = api_.request("GET", "/_ping");
+    if (!response.ok()) {
+        LOG_ERROR("Error checking Docker availability: {}", response.message());
+        return false;
+    }
+    return true;
+}
+
+bool DockerManager::imageExists(const std::string& image_name) {
+    return !imageId(image_name).empty();
+}
+
+std::string DockerManager::imageId(const std::string& image) {
+    DockerApiClient::Response response = api_.request("GET", "/images/" + image + "/json");
+    if (!response.ok()) {
+        return "";
+    }
+    nlohmann::json info = nlohmann::json::parse(response.body, nullptr, false);
+    return info.is_object() && info.contains("Id") && info["Id"].is_string() ? info["Id"].get<std::string>() : "";
+}
+
+bool DockerManager::tagImage(const std::string& image, const std::string& image_name) {
+    std::string repo, tag;
+    splitImageReference(image_name, repo, tag);
+    std::string path = "/images/" + image + "/tag?repo=" + DockerApiClient::escape(repo);
+    if (!tag.empty()) {
+        path += "&tag=" + DockerApiClient::escape(tag);
+    }
+    DockerApiClient::Response response = api_.request("POST", path);
+    if (!response.ok()) {
+        LOG_ERROR("Failed to tag image {} as {}: {}", image, image_name, response.message());
+        return false;
+    }
+    return true;
+}
+
+nlohmann::json DockerManager::loadImage(const std::string& image_url, const std::string& image_name,
+                                        const std::string& image_sha256) {
+    // 下载线程把tar包写入内存管道，同时作为/images/load的请求体分块发送，不写临时文件；
+    // 同时计算tar包摘要，与期望不符时以错误结束管道，请求被中止
+    StreamPipe pipe(kImageStreamBufferSize);
+    std::string digest;
+    std::thread downloader([&pipe, &image_url, &image_sha256, &digest]() {
+        Sha256 sha;
+        std::string error;
+        bool ok = ArtifactCache::download(image_url, [&pipe, &sha](const char* data, size_t size) {
+            sha.update(data, size);
+            return pipe.write(data, size);
+        }, 0, error);
+        if (ok) {
+            digest = sha.hexDigest();
+            if (!image_sha256.empty() && digest != image_sha256) {
+                ok = false;
+                error = "SHA-256 mismatch: expected " + image_sha256 + ", got " + digest;
+            }
         }
-        
-        // 如果命令行方式失败，尝试通过API检查
-        nlohmann::json response = dockerApiRequest("GET", "/info");
-        return !response.empty() && response.contains("ServerVersion");
-    } catch (const std::exception& e) {
-        LOG_ERROR("Error checking Docker availability: {}", e.what());
+        pipe.closeWrite(ok ? "" : (error.empty() ? std::string("download failed") : error));
+    });
+
+    DockerApiClient::Response response = api_.upload("/images/load?quiet=1", "application/x-tar",
+        [&pipe](char* buffer, size_t length) -> size_t {
+            size_t read = pipe.read(buffer, length);
+            // 下载失败时中止请求，Docker不会导入不完整的tar包
+            return read == 0 && pipe.failed() ? CURL_READFUNC_ABORT : read;
+        }, -1);
+    // Docker提前返回（如拒绝请求）时让下载线程停止
+    pipe.closeRead();
+    downloader.join();
+
+    if (pipe.failed()) {
+        return {
+            {"status", "error"},
+            {"message", "Failed to download image: " + pipe.error()}
+        };
+    }
+    LOG_INFO("Streamed {} bytes from {} into Docker", pipe.bytes(), image_url);
+    if (!response.ok()) {
+        return errorResult("Failed to load image", response);
+    }
+
+    std::string loaded, output;
+    std::string error = parseProgress(response.body, &loaded, output);
+    if (!error.empty() || loaded.empty()) {
+        return {
+            {"status", "error"},
+            {"message", "Failed to load image: " + (error.empty() ? std::string("no image in archive") : error)}
+        };
+    }
+
+    // 按导入的镜像本身添加名称，而不是取最新的镜像
+    if (loaded != image_name && !tagImage(loaded, image_name)) {
+        return {
+            {"status", "error"},
+            {"message", "Failed to tag loaded image " + loaded + " as " + image_name}
+        };
+    }
+
+    // 记录tar包摘要对应的镜像ID，相同的tar包再次部署时不再下载
+    std::string id = imageId(loaded);
+    if (!id.empty()) {
+        artifact_cache_->addImage(image_url, digest, id, pipe.bytes());
+    }
+    return {
+        {"status", "success"},
+        {"message", "Image loaded successfully"},
+        {"output", output}
+    };
+}
+
+bool DockerManager::tagCachedImage(const std::string& image_url, const std::string& image_name,
+                                   const std::string& image_sha256, bool loaded, nlohmann::json& result) {
+    std::string cached_id;
+    if (!artifact_cache_->findImage(image_url, image_sha256, loaded,
+            [this](const std::string& id) { return imageExists(id); }, cached_id)) {
         return false;
     }
+    if (!image_name.empty() && !tagImage(cached_id, image_name)) {
+        result = {
+            {"status", "error"},
+            {"message", "Failed to tag cached image " + cached_id + " as " + image_name}
+        };
+    } else {
+        result = {
+            {"status", "success"},
+            {"message", "Image already loaded"},
+            {"output", cached_id}
+        };
+    }
+    return true;
 }
 
-nlohmann::json DockerManager::pullImage(const std::string& image_url, const std::string& image_name) {
+nlohmann::json DockerManager::pullImage(const std::string& image_url, const std::string& image_name,
+                                        const std::string& image_sha256) {
     try {
-        std::string cmd;
-        
-        // 如果提供了URL，则从URL加载镜像
+        if (image_url.empty() && image_name.empty()) {
+            return {
+                {"status", "error"},
+                {"message", "No image URL or name provided"}
+            };
+        }
+
+        // 如果提供了URL，同一tar包已导入过时直接添加名称，否则边下载边导入镜像，支持sftp/http
         if (!image_url.empty()) {
-            // 先检查本地是否已有镜像
-            std::string check_cmd = "docker images " + image_name;
-            std::string check_output = exec(check_cmd.c_str());
-            if (check_output.find(image_name) != std::string::npos) {
-                return {
-                    {"status", "success"},
-                    {"message", "Image already exists"},
-                    {"output", check_output}
-                };
+            nlohmann::json result;
+            if (tagCachedImage(image_url, image_name, image_sha256, false, result)) {
+                return result;
             }
 
-            // 下载镜像文件，支持sftp/http
-            int download_result = 1;
-            std::string download_err;
-            if (image_url.rfind("sftp://", 0) == 0) {
-                SFTPClient sftp;
-                if (sftp.downloadFile(image_url, "/tmp/image.tar", download_err)) {
-                    download_result = 0;
+            // 同一tar包同时只下载导入一次，同时部署它的其他线程等待导入完成后直接添加名称
+            bool shared = false;
+            std::string error;
+            std::string key = "image:" + (image_sha256.empty() ? image_url : image_sha256);
+            bool loaded = artifact_cache_->coalesce(key, [&](std::string& load_error) {
+                result = loadImage(image_url, image_name, image_sha256);
+                if (result["status"] != "success") {
+                    load_error = result["message"].get<std::string>();
+                    return false;
                 }
-            } else {
-                std::string download_cmd = "curl -s -L -o /tmp/image.tar " + image_url;
-                download_result = system(download_cmd.c_str());
+                return true;
+            }, shared, error);
+            if (!shared) {
+                return result;
             }
-            if (download_result != 0) {
+            if (!loaded) {
                 return {
                     {"status", "error"},
-                    {"message", "Failed to download image: " + download_err}
+                    {"message", error}
                 };
             }
-            
-            // 加载镜像并设置名称
-            cmd = "docker load -i /tmp/image.tar && docker tag $(docker images -q | head -n 1) " + image_name;
-            std::string load_output = exec(cmd.c_str());
-            
-            // 清理临时文件
-            system("rm -f /tmp/image.tar");
-            
-            return {
-                {"status", "success"},
-                {"message", "Image loaded successfully"},
-                {"output", load_output}
-            };
-        } 
-        // 否则，从Docker Hub拉取镜像
-        else if (!image_name.empty()) {
-
-            // 检查本地有没有镜像
-            std::string check_cmd = "docker images " + image_name;
-            std::string check_output = exec(check_cmd.c_str());
-            if (check_output.find(image_name) != std::string::npos) {
-                return {
-                    {"status", "success"},
-                    {"message", "Image already exists"},
-                    {"output", check_output}
-                };
+            if (tagCachedImage(image_url, image_name, image_sha256, true, result)) {
+                return result;
             }
+            // 导入的镜像未能记录（如随即被删除）时自行导入
+            return loadImage(image_url, image_name, image_sha256);
+        }
 
-            // 拉取镜像
-            cmd = "docker pull " + image_name;
-            std::string pull_output = exec(cmd.c_str());
-            
-            if (pull_output.find("Error") != std::string::npos) {
-                return {
-                    {"status", "error"},
-                    {"message", "Failed to pull image"},
-                    {"output", pull_output}
-                };
-            }
-            
+        // 否则先检查本地是否已有镜像
+        if (imageExists(image_name)) {
             return {
                 {"status", "success"},
-                {"message", "Image pulled successfully"},
-                {"output", pull_output}
+                {"message", "Image already exists"},
+                {"output", image_name}
             };
-        } else {
+        }
+
+        // 从镜像仓库拉取镜像；进度以JSON行流式返回，出错时HTTP状态仍可能为200
+        std::string repo, tag;
+        splitImageReference(image_name, repo, tag);
+        std::string path = "/images/create?fromImage=" + DockerApiClient::escape(repo);
+        if (!tag.empty()) {
+            path += "&tag=" + DockerApiClient::escape(tag);
+        }
+        DockerApiClient::Response response = api_.request("POST", path, "", 0);
+        if (!response.ok()) {
+            return errorResult("Failed to pull image", response);
+        }
+        std::string output;
+        std::string error = parseProgress(response.body, nullptr, output);
+        if (!error.empty()) {
             return {
                 {"status", "error"},
-                {"message", "No image URL or name provided"}
+                {"message", "Failed to pull image"},
+                {"output", error}
             };
         }
+        return {
+            {"status", "success"},
+            {"message", "Image pulled successfully"},
+            {"output", output}
+        };
     } catch (const std::exception& e) {
         return {
             {"status", "error"},
@@ -169,67 +316,68 @@ nlohmann::json DockerManager::createContainer(const std::string& image_name,
                                            const std::string& container_name,
                                            const nlohmann::json& env_vars,
                                            const nlohmann::json& resource_limits,
-                                           const std::vector<std::string>& volumes) {
+                                           const std::vector<std::string>& volumes,
+                                           const nlohmann::json& labels) {
     try {
-        // 构建创建容器的命令
-        std::stringstream cmd;
-        cmd << "docker run -d";
-        
-        // 添加容器名称
-        if (!container_name.empty()) {
-            cmd << " --name " << container_name;
-        }
-        
+        // 构建容器配置，与docker run -d --name -e --cpus --memory -v等价
+        nlohmann::json config;
+        config["Image"] = image_name;
+        config["Labels"] = labels.is_object() ? labels : nlohmann::json::object();
+
         // 添加环境变量
+        nlohmann::json env = nlohmann::json::array();
         if (env_vars.is_object()) {
             for (auto it = env_vars.begin(); it != env_vars.end(); ++it) {
-                cmd << " -e " << it.key() << "=" << it.value().get<std::string>();
+                env.push_back(it.key() + "=" + it.value().get<std::string>());
             }
         }
-        
+        config["Env"] = env;
+
+        nlohmann::json host_config = nlohmann::json::object();
         // 添加资源限制
         if (resource_limits.is_object()) {
             // CPU限制
             if (resource_limits.contains("cpu_cores")) {
                 double cpu_cores = resource_limits["cpu_cores"].get<double>();
-                cmd << " --cpus=" << cpu_cores;
+                host_config["NanoCpus"] = static_cast<long long>(cpu_cores * 1e9);
             }
-            
+
             // 内存限制
             if (resource_limits.contains("memory_mb")) {
                 int memory_mb = resource_limits["memory_mb"].get<int>();
-                cmd << " --memory=" << memory_mb << "m";
+                host_config["Memory"] = static_cast<long long>(memory_mb) * 1024 * 1024;
             }
         }
-        
+
         // 添加卷挂载
-        for (const auto& volume : volumes) {
-            cmd << " -v " << volume;
+        host_config["Binds"] = volumes;
+        config["HostConfig"] = host_config;
+
+        std::string path = "/containers/create";
+        if (!container_name.empty()) {
+            path += "?name=" + DockerApiClient::escape(container_name);
         }
-        
-        // 添加镜像名称
-        cmd << " " << image_name;
-        
-        // 执行命令
-        std::string full_cmd = cmd.str();
-        LOG_INFO("Creating container with command: {}", full_cmd);
-        
-        std::string container_id = exec(full_cmd.c_str());
-        
-        // 检查输出是否包含容器ID（40个字符的哈希值）
-        if (container_id.length() >= 12) {
-            return {
-                {"status", "success"},
-                {"message", "Container created successfully"},
-                {"container_id", container_id.substr(0, 12)}
-            };
-        } else {
-            return {
-                {"status", "error"},
-                {"message", "Failed to create container"},
-                {"output", container_id}
-            };
+        LOG_INFO("Creating container {} from image {}", container_name, image_name);
+
+        DockerApiClient::Response response = api_.request("POST", path, config.dump());
+        nlohmann::json created = response.json();
+        if (!response.ok() || !created.is_object() || !created.contains("Id")) {
+            return errorResult("Failed to create container", response);
+        }
+        std::string container_id = created["Id"].get<std::string>();
+
+        // 启动容器，失败时删除已创建的容器，重新部署时不会因名称冲突失败
+        response = api_.request("POST", "/containers/" + container_id + "/start");
+        if (!response.ok()) {
+            api_.request("DELETE", "/containers/" + container_id + "?force=1");
+            return errorResult("Failed to start container", response);
         }
+
+        return {
+            {"status", "success"},
+            {"message", "Container created successfully"},
+            {"container_id", container_id.substr(0, 12)}
+        };
     } catch (const std::exception& e) {
         LOG_ERROR("Error creating container: {}", e.what());
         return {
@@ -240,277 +388,159 @@ nlohmann::json DockerManager::createContainer(const std::string& image_name,
 }
 
 nlohmann::json DockerManager::stopContainer(const std::string& container_id) {
-    try {
-        LOG_INFO("Stopping container: {}", container_id);
-        // 构建停止容器的命令
-        std::string cmd = "docker stop " + container_id;
-        std::string output = exec(cmd.c_str());
-        
-        // 检查输出是否包含容器ID
-        if (output.find(container_id) != std::string::npos) {
-            return {
-                {"status", "success"},
-                {"message", "Container stopped successfully"}
-            };
-        } else {
-            return {
-                {"status", "error"},
-                {"message", "Failed to stop container"},
-                {"output", output}
-            };
-        }
-    } catch (const std::exception& e) {
-        LOG_ERROR("Error stopping container: {}", e.what());
+    LOG_INFO("Stopping container: {}", container_id);
+    // 守护进程最多等待kStopTimeoutSec秒后强制结束容器，请求超时留出余量
+    DockerApiClient::Response response = api_.request(
+        "POST", "/containers/" + container_id + "/stop?t=" + std::to_string(kStopTimeoutSec), "",
+        kStopTimeoutSec + DockerApiClient::kDefaultTimeoutSec);
+
+    // 304表示容器已经停止
+    if (response.ok() || (response.error.empty() && response.status == 304)) {
         return {
-            {"status", "error"},
-            {"message", std::string("Error stopping container: ") + e.what()}
+            {"status", "success"},
+            {"message", "Container stopped successfully"}
         };
     }
+    LOG_ERROR("Error stopping container: {}", response.message());
+    return errorResult("Failed to stop container", response);
 }
 
 nlohmann::json DockerManager::removeContainer(const std::string& container_id) {
-    try {
-        LOG_INFO("Removing container: {}", container_id);
-        // 构建删除容器的命令
-        std::string cmd = "docker rm -f " + container_id;
-        std::string output = exec(cmd.c_str());
-        
-        // 检查输出是否包含容器ID
-        if (output.find(container_id) != std::string::npos) {
-            return {
-                {"status", "success"},
-                {"message", "Container removed successfully"}
-            };
-        } else {
-            return {
-                {"status", "error"},
-                {"message", "Failed to remove container"},
-                {"output", output}
-            };
-        }
-    } catch (const std::exception& e) {
-        LOG_ERROR("Error removing container: {}", e.what());
+    LOG_INFO("Removing container: {}", container_id);
+    stats_collector_.removeContainer(container_id);
+    DockerApiClient::Response response = api_.request("DELETE", "/containers/" + container_id + "?force=1");
+    if (response.ok()) {
         return {
-            {"status", "error"},
-            {"message", std::string("Error removing container: ") + e.what()}
+            {"status", "success"},
+            {"message", "Container removed successfully"}
         };
     }
+    LOG_ERROR("Error removing container: {}", response.message());
+    return errorResult("Failed to remove container", response);
 }
 
 nlohmann::json DockerManager::getContainerStatus(const std::string& container_id) {
-    try {
-        // 构建获取容器状态的命令
-        std::string cmd = "docker inspect --format='{{.State.Status}}' " + container_id;
-        std::string status = exec(cmd.c_str());
-        
-        // 去除末尾的换行符
-        if (!status.empty() && status[status.length() - 1] == '\n') {
-            status.erase(status.length() - 1);
-        }
-        
-        // 检查是否获取到状态
-        if (status.empty() || status.find("Error") != std::string::npos) {
-            return {
-                {"status", "error"},
-                {"message", "Failed to get container status"},
-                {"output", status}
-            };
-        } else {
-            return {
-                {"status", "success"},
-                {"container_status", status}
-            };
-        }
-    } catch (const std::exception& e) {
-        LOG_ERROR("Error getting container status: {}", e.what());
-        return {
-            {"status", "error"},
-            {"message", std::string("Error getting container status: ") + e.what()}
-        };
+    DockerApiClient::Response response = api_.request("GET", "/containers/" + container_id + "/json");
+    nlohmann::json inspect = response.json();
+    if (!response.ok() || !inspect.is_object() || !inspect.contains("State") ||
+        !inspect["State"].contains("Status") || !inspect["State"]["Status"].is_string()) {
+        return errorResult("Failed to get container status", response);
     }
+    return {
+        {"status", "success"},
+        {"container_status", inspect["State"]["Status"].get<std::string>()}
+    };
 }
 
 nlohmann::json DockerManager::getContainerStats(const std::string& container_id) {
-    try {
-        nlohmann::json stats;
-        
-        // 获取CPU使用率
-        std::string cpu_cmd = "docker stats --no-stream --format '{{.CPUPerc}}' " + container_id;
-        std::string cpu_output = exec(cpu_cmd.c_str());
-        
-        // 去除末尾的换行符和百分号
-        if (!cpu_output.empty()) {
-            if (cpu_output[cpu_output.length() - 1] == '\n') {
-                cpu_output.erase(cpu_output.length() - 1);
-            }
-            if (cpu_output[cpu_output.length() - 1] == '%') {
-                cpu_output.erase(cpu_output.length() - 1);
-            }
-            
-            try {
-                stats["cpu_percent"] = std::stod(cpu_output);
-            } catch (...) {
-                stats["cpu_percent"] = 0.0;
-            }
-        } else {
-            stats["cpu_percent"] = 0.0;
-        }
-        
-        // 获取内存使用量
-        std::string mem_cmd = "docker stats --no-stream --format '{{.MemUsage}}' " + container_id;
-        std::string mem_output = exec(mem_cmd.c_str());
-        
-        // 解析内存使用量，格式如 "100MiB / 2GiB"
-        if (!mem_output.empty()) {
-            size_t pos = mem_output.find(" / ");
-            if (pos != std::string::npos) {
-                std::string mem_used = mem_output.substr(0, pos);
-                
-                // 转换为MB
-                double memory_mb = 0.0;
-                if (mem_used.find("GiB") != std::string::npos) {
-                    memory_mb = std::stod(mem_used.substr(0, mem_used.find("GiB"))) * 1024;
-                } else if (mem_used.find("MiB") != std::string::npos) {
-                    memory_mb = std::stod(mem_used.substr(0, mem_used.find("MiB")));
-                } else if (mem_used.find("KiB") != std::string::npos) {
-                    memory_mb = std::stod(mem_used.substr(0, mem_used.find("KiB"))) / 1024;
-                }
-                
-                stats["memory_mb"] = memory_mb;
-            } else {
-                stats["memory_mb"] = 0;
-            }
-        } else {
-            stats["memory_mb"] = 0;
+    // cgroup v2下直接读取容器cgroup文件，不再调用docker stats
+    if (stats_collector_.isAvailable()) {
+        return stats_collector_.collect(container_id);
+    }
+
+    // cgroup v1主机回退到Engine API的一次性统计，CPU使用率按与上一次统计之间的差值计算
+    DockerApiClient::Response response = api_.request("GET", "/containers/" + container_id + "/stats?stream=false");
+    nlohmann::json raw = response.json();
+    if (!response.ok() || !raw.is_object()) {
+        LOG_ERROR("Error getting container stats: {}", response.message());
+        return errorResult("Failed to get container stats", response);
+    }
+
+    nlohmann::json stats;
+    double cpu_percent = 0.0;
+    const nlohmann::json& cpu = raw.value("cpu_stats", nlohmann::json::object());
+    const nlohmann::json& precpu = raw.value("precpu_stats", nlohmann::json::object());
+    if (cpu.contains("cpu_usage") && precpu.contains("cpu_usage")) {
+        double cpu_delta = cpu["cpu_usage"].value("total_usage", 0.0) - precpu["cpu_usage"].value("total_usage", 0.0);
+        double system_delta = cpu.value("system_cpu_usage", 0.0) - precpu.value("system_cpu_usage", 0.0);
+        double online_cpus = cpu.value("online_cpus", 1.0);
+        if (cpu_delta > 0.0 && system_delta > 0.0) {
+            // 与docker stats一致，100%表示占满一个核心
+            cpu_percent = cpu_delta / system_delta * online_cpus * 100.0;
         }
-        
-        // GPU使用率（简化处理，实际应该使用nvidia-smi等工具）
-        stats["gpu_percent"] = 0.0;
-        
-        return {
-            {"status", "success"},
-            {"resource_usage", stats}
-        };
-    } catch (const std::exception& e) {
-        LOG_ERROR("Error getting container stats: {}", e.what());
-        return {
-            {"status", "error"},
-            {"message", std::string("Error getting container stats: ") + e.what()}
-        };
     }
+    stats["cpu_percent"] = cpu_percent;
+
+    // 与docker stats一致，内存使用量不含页缓存
+    const nlohmann::json& memory = raw.value("memory_stats", nlohmann::json::object());
+    double memory_used = memory.value("usage", 0.0);
+    if (memory.contains("stats")) {
+        memory_used -= memory["stats"].value("cache", 0.0);
+    }
+    stats["memory_mb"] = memory_used > 0.0 ? memory_used / (1024 * 1024) : 0.0;
+
+    // GPU使用率（简化处理，实际应该使用nvidia-smi等工具）
+    stats["gpu_percent"] = 0.0;
+
+    return {
+        {"status", "success"},
+        {"resource_usage", stats}
+    };
 }
 
 nlohmann::json DockerManager::listContainers(bool all) {
-    try {
-        // 构建列出容器的命令
-        std::string cmd = "docker ps --format '{{.ID}}|{{.Names}}|{{.Status}}|{{.Image}}'";
-        if (all) {
-            cmd += " -a";
-        }
-        
-        std::string output = exec(cmd.c_str());
-        std::istringstream iss(output);
-        std::string line;
-        
-        nlohmann::json containers = nlohmann::json::array();
-        
-        while (std::getline(iss, line)) {
-            size_t pos1 = line.find("|");
-            size_t pos2 = line.find("|", pos1 + 1);
-            size_t pos3 = line.find("|", pos2 + 1);
-            
-            if (pos1 != std::string::npos && pos2 != std::string::npos && pos3 != std::string::npos) {
-                std::string id = line.substr(0, pos1);
-                std::string name = line.substr(pos1 + 1, pos2 - pos1 - 1);
-                std::string status = line.substr(pos2 + 1, pos3 - pos2 - 1);
-                std::string image = line.substr(pos3 + 1);
-                
-                nlohmann::json container;
-                container["id"] = id;
-                container["name"] = name;
-                container["status"] = status;
-                container["image"] = image;
-                
-                containers.push_back(container);
+    DockerApiClient::Response response = api_.request("GET", std::string("/containers/json") + (all ? "?all=1" : ""));
+    nlohmann::json list = response.json();
+    if (!response.ok() || !list.is_array()) {
+        LOG_ERROR("Error listing containers: {}", response.message());
+        return errorResult("Failed to list containers", response);
+    }
+
+    // 字段与docker ps相同：短ID、不带前导/的名称、状态描述和镜像
+    nlohmann::json containers = nlohmann::json::array();
+    for (const auto& item : list) {
+        nlohmann::json container;
+        container["id"] = item.value("Id", "").substr(0, 12);
+        std::string name;
+        if (item.contains("Names") && item["Names"].is_array() && !item["Names"].empty()) {
+            name = item["Names"][0].get<std::string>();
+            if (!name.empty() && name[0] == '/') {
+                name.erase(0, 1);
             }
         }
-        
-        return {
-            {"status", "success"},
-            {"containers", containers}
-        };
-    } catch (const std::exception& e) {
-        LOG_ERROR("Error listing containers: {}", e.what());
-        return {
-            {"status", "error"},
-            {"message", std::string("Error listing containers: ") + e.what()}
-        };
+        container["name"] = name;
+        container["status"] = item.value("Status", "");
+        container["image"] = item.value("Image", "");
+        containers.push_back(container);
     }
-}
 
-std::string DockerManager::executeDockerCommand(const std::string& command) {
-    return exec(command.c_str());
+    return {
+        {"status", "success"},
+        {"containers", containers}
+    };
 }
 
-nlohmann::json DockerManager::dockerApiRequest(const std::string& method, 
-                                            const std::string& endpoint, 
-                                            const nlohmann::json& request_body) {
-    CURL* curl = curl_easy_init();
-    std::string response_string;
-    
-    if (curl) {
-        std::string url = "http://localhost/v1.40" + endpoint;
-        
-        // 设置UNIX套接字
-        curl_easy_setopt(curl, CURLOPT_UNIX_SOCKET_PATH, docker_socket_path_.c_str());
-        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-        
-        // 设置HTTP方法
-        if (method == "POST") {
-            curl_easy_setopt(curl, CURLOPT_POST, 1L);
-        } else if (method == "PUT") {
-            curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "PUT");
-        } else if (method == "DELETE") {
-            curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "DELETE");
-        }
-        
-        // 设置请求体
-        std::string request_body_str;
-        if (!request_body.empty()) {
-            request_body_str = request_body.dump();
-            curl_easy_setopt(curl, CURLOPT_POSTFIELDS, request_body_str.c_str());
-            
-            // 设置Content-Type
-            struct curl_slist* headers = NULL;
-            headers = curl_slist_append(headers, "Content-Type: application/json");
-            curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-        }
-        
-        // 设置回调函数
-        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
-        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response_string);
-        
-        // 执行请求
-        CURLcode res = curl_easy_perform(curl);
-        
-        // 检查结果
-        if (res != CURLE_OK) {
-            LOG_ERROR("Docker API request failed: {}", curl_easy_strerror(res));
-            curl_easy_cleanup(curl);
-            return nlohmann::json();
-        }
-        
-        // 清理
-        curl_easy_cleanup(curl);
-        
-        // 解析响应
-        try {
-            return nlohmann::json::parse(response_string);
-        } catch (const std::exception& e) {
-            LOG_ERROR("Error parsing JSON response: {}", e.what());
-            return nlohmann::json();
-        }
+bool DockerManager::watchEvents(long long since,
+                                const std::function<void()>& on_connected,
+                                const std::function<void(const nlohmann::json&)>& on_event,
+                                const std::function<bool()>& keep_running) {
+    nlohmann::json filters = {
+        {"type", {"container"}},
+        {"label", {kDockerComponentLabel}},
+        {"event", {"start", "die", "oom", "pause", "unpause", "destroy"}}
+    };
+    std::string path = "/events?since=" + std::to_string(since) + "&filters=" + DockerApiClient::escape(filters.dump());
+
+    // 事件以换行分隔的JSON对象流式返回，一个事件可能跨多块到达
+    std::string pending;
+    DockerApiClient::Response response = api_.stream(path, on_connected,
+        [&pending, &on_event](const char* data, size_t size) {
+            pending.append(data, size);
+            size_t begin = 0, end;
+            while ((end = pending.find('\n', begin)) != std::string::npos) {
+                nlohmann::json event = nlohmann::json::parse(pending.begin() + begin, pending.begin() + end, nullptr, false);
+                if (event.is_object()) {
+                    on_event(event);
+                }
+                begin = end + 1;
+            }
+            pending.erase(0, begin);
+        },
+        keep_running);
+
+    if (!keep_running()) {
+        return true;
     }
-    
-    return nlohmann::json();
+    LOG_ERROR("Docker event stream ended: {}", response.error.empty() && response.ok() ? std::string("closed by daemon") : response.message());
+    return false;
 }
@@ -3,19 +3,31 @@
 
 #include <string>
 #include <vector>
+#include <functional>
+#include <memory>
 #include <nlohmann/json.hpp>
+#include "docker_collector.h"
+#include "docker_api_client.h"
+#include "artifact_cache.h"
+
+// 本系统创建的容器带有的标签，事件流按该标签只订阅自己的容器
+const char* const kDockerComponentLabel = "resource_monitor.component_id";
+const char* const kDockerBusinessLabel = "resource_monitor.business_id";
 
 /**
  * DockerManager类 - Docker容器管理器
  * 
- * 负责与Docker守护进程交互，管理容器的生命周期
+ * 负责与Docker守护进程交互，管理容器的生命周期。
+ * 所有操作通过Engine API在复用的unix套接字连接上完成，不再调用docker命令行
  */
 class DockerManager {
 public:
     /**
      * 构造函数
+     * 
+     * @param artifact_cache 制品缓存，记录从URL导入的镜像
      */
-    DockerManager();
+    explicit DockerManager(std::shared_ptr<ArtifactCache> artifact_cache);
     
     /**
      * 析构函数
@@ -37,13 +49,15 @@ public:
     bool checkDockerAvailable();
     
     /**
-     * 下载Docker镜像
+     * 下载Docker镜像，同一tar包已导入过时只添加名称；多个部署同时导入同一tar包时只下载一次
      * 
      * @param image_url 镜像URL
      * @param image_name 镜像名称
+     * @param image_sha256 镜像tar包期望的SHA-256摘要，为空时不校验
      * @return 下载结果
      */
-    nlohmann::json pullImage(const std::string& image_url, const std::string& image_name);
+    nlohmann::json pullImage(const std::string& image_url, const std::string& image_name,
+                             const std::string& image_sha256 = "");
     
     /**
      * 创建并启动容器
@@ -53,13 +67,15 @@ public:
      * @param env_vars 环境变量
      * @param resource_limits 资源限制
      * @param volumes 挂载卷
+     * @param labels 容器标签
      * @return 创建结果
      */
     nlohmann::json createContainer(const std::string& image_name,
                                  const std::string& container_name,
                                  const nlohmann::json& env_vars,
                                  const nlohmann::json& resource_limits,
-                                 const std::vector<std::string>& volumes);
+                                 const std::vector<std::string>& volumes,
+                                 const nlohmann::json& labels = nlohmann::json::object());
     
     /**
      * 停止容器
@@ -101,30 +117,75 @@ public:
      */
     nlohmann::json listContainers(bool all = false);
 
+    /**
+     * 订阅带kDockerComponentLabel标签的容器的生命周期事件（start、die、oom、pause、unpause、destroy），
+     * 阻塞直到连接断开或keep_running返回false
+     * 
+     * @param since 从该时间（秒）起的事件，重连时传入最后一个事件的时间，断开期间的事件不会丢失
+     * @param on_connected 订阅成功时调用
+     * @param on_event 每个事件调用一次，参数为Docker事件对象
+     * @param keep_running 约每秒调用一次，返回false时停止订阅
+     * @return 是否因keep_running返回false而停止；连接失败或断开时返回false
+     */
+    bool watchEvents(long long since,
+                     const std::function<void()>& on_connected,
+                     const std::function<void(const nlohmann::json&)>& on_event,
+                     const std::function<bool()>& keep_running);
+
 private:
     /**
-     * 执行Docker命令
+     * 检查本地是否已有镜像
      * 
-     * @param command 命令
-     * @return 命令输出
+     * @param image_name 镜像名称
+     * @return 是否已有
      */
-    std::string executeDockerCommand(const std::string& command);
-    
+    bool imageExists(const std::string& image_name);
+
+    /**
+     * 获取镜像ID
+     * 
+     * @param image 镜像名称或ID
+     * @return 镜像ID（sha256:...），不存在时为空
+     */
+    std::string imageId(const std::string& image);
+
+    /**
+     * 下载镜像tar包并导入Docker，将导入的镜像标记为image_name
+     * 
+     * @param image_url 镜像tar包URL（sftp或http），边下载边导入，不写临时文件
+     * @param image_name 镜像名称
+     * @param image_sha256 tar包期望的SHA-256摘要，为空时不校验
+     * @return 导入结果
+     */
+    nlohmann::json loadImage(const std::string& image_url, const std::string& image_name,
+                             const std::string& image_sha256);
+
+    /**
+     * 同一tar包已导入且镜像仍在时为其添加名称
+     * 
+     * @param image_url 镜像tar包URL
+     * @param image_name 镜像名称
+     * @param image_sha256 tar包期望的SHA-256摘要，为空时只查找刚由合并导入的tar包
+     * @param loaded 是否在等待的合并导入完成之后调用
+     * @param result 输出参数，命中时的结果
+     * @return 是否命中
+     */
+    bool tagCachedImage(const std::string& image_url, const std::string& image_name,
+                        const std::string& image_sha256, bool loaded, nlohmann::json& result);
+
     /**
-     * 通过Docker API执行请求
+     * 为镜像添加名称
      * 
-     * @param method HTTP方法
-     * @param endpoint API端点
-     * @param request_body 请求体
-     * @return 响应
+     * @param image 镜像ID或已有名称
+     * @param image_name 新名称（仓库[:标签]）
+     * @return 是否成功
      */
-    nlohmann::json dockerApiRequest(const std::string& method, 
-                                  const std::string& endpoint, 
-                                  const nlohmann::json& request_body = nlohmann::json());
+    bool tagImage(const std::string& image, const std::string& image_name);
 
 private:
-    std::string docker_socket_path_;  // Docker套接字路径
-    bool use_api_;                    // 是否使用Docker API
+    DockerApiClient api_;             // Engine API客户端，连接在各操作间复用
+    DockerCollector stats_collector_; // 基于cgroup v2的容器资源采集器
+    std::shared_ptr<ArtifactCache> artifact_cache_; // 制品缓存
 };
 
 #endif // DOCKER_MANAGER_H
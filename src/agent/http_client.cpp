@@ -2,13 +2,47 @@
 #include <httplib.h>
 #include <iostream>
 
-HttpClient::HttpClient(const std::string& base_url) : base_url_(base_url) {
-    // 构造函数，初始化基础URL
+HttpClient::HttpClient(const std::string& base_url, int compress_level, size_t compress_threshold)
+    : base_url_(base_url), port_(80), compression_(compress_level, compress_threshold),
+      requests_(0), connections_(0), retries_(0), failures_(0) {
+    // 解析URL，格式为[http://]host[:port][/prefix]，只在构造时解析一次
+    std::string url = base_url_;
+    if (url.compare(0, 7, "http://") == 0) {
+        url = url.substr(7);
+    }
+
+    size_t slash = url.find('/');
+    std::string authority = url.substr(0, slash);
+    if (slash != std::string::npos) {
+        path_prefix_ = url.substr(slash);
+        // 去掉末尾的'/'，端点都以'/'开头
+        while (!path_prefix_.empty() && path_prefix_.back() == '/') {
+            path_prefix_.pop_back();
+        }
+    }
+
+    size_t colon = authority.find(':');
+    host_ = authority.substr(0, colon);
+    if (colon != std::string::npos) {
+        try {
+            port_ = std::stoi(authority.substr(colon + 1));
+        } catch (const std::exception& e) {
+            std::cerr << "Invalid port in manager URL " << base_url_ << ", using 80" << std::endl;
+            port_ = 80;
+        }
+    }
 }
 
+HttpClient::~HttpClient() = default;
+
 nlohmann::json HttpClient::registerAgent(const nlohmann::json& agent_info) {
-    // 发送注册请求
-    return post("/api/register", agent_info);
+    // 发送注册请求，注册响应带有分配给该节点的全部组件，开启压缩时接受gzip响应
+    return postRaw("/api/register", agent_info.dump(), {{"Accept-Encoding", compression_.enabled() ? "gzip" : "identity"}});
+}
+
+nlohmann::json HttpClient::registerAgent(const std::string& body, const std::string& content_type) {
+    // 发送已编码的注册请求
+    return postRaw("/api/register", body, {{"Accept-Encoding", compression_.enabled() ? "gzip" : "identity"}}, content_type);
 }
 
 nlohmann::json HttpClient::reportData(const nlohmann::json& resource_data) {
@@ -16,122 +50,165 @@ nlohmann::json HttpClient::reportData(const nlohmann::json& resource_data) {
     return post("/api/report", resource_data);
 }
 
+nlohmann::json HttpClient::reportRawData(const std::string& body, const std::string& content_type) {
+    // 上报已序列化的资源数据
+    return postRaw("/api/report", body, {}, content_type);
+}
+
+nlohmann::json HttpClient::reportRawBatch(const std::string& body, const std::string& content_type) {
+    // 批量上报已序列化的资源数据
+    return postRaw("/api/report/batch", body, {}, content_type);
+}
+
 nlohmann::json HttpClient::get(const std::string& endpoint, 
                              const std::map<std::string, std::string>& headers) {
-    // 解析URL
-    std::string url = base_url_;
-    std::string host;
-    std::string path = endpoint;
-    int port = 80;
-    
-    // 从base_url中提取host和port
-    if (url.substr(0, 7) == "http://") {
-        url = url.substr(7);
-    }
-    
-    size_t pos = url.find(':');
-    if (pos != std::string::npos) {
-        host = url.substr(0, pos);
-        port = std::stoi(url.substr(pos + 1));
-    } else {
-        pos = url.find('/');
-        if (pos != std::string::npos) {
-            host = url.substr(0, pos);
-            path = url.substr(pos) + path;
-        } else {
-            host = url;
-        }
-    }
-    
-    // 创建HTTP客户端
-    httplib::Client cli(host, port);
-    cli.set_connection_timeout(5);  // 5秒超时
-    cli.set_read_timeout(5);
-    
+    std::string path = path_prefix_ + endpoint;
+
     // 设置请求头
     httplib::Headers header_map;
     for (const auto& header : headers) {
         header_map.emplace(header.first, header.second);
     }
-    
-    // 发送GET请求
-    auto res = cli.Get(path, header_map);
-    
-    // 处理响应
-    if (res && res->status == 200) {
-        try {
-            return nlohmann::json::parse(res->body);
-        } catch (const std::exception& e) {
-            std::cerr << "Error parsing JSON response: " << e.what() << std::endl;
-            return nlohmann::json({{"status", "error"}, {"message", "Invalid JSON response"}});
-        }
-    } else {
-        std::string error_msg = res ? "HTTP error: " + std::to_string(res->status) : "Connection error";
-        return nlohmann::json({{"status", "error"}, {"message", error_msg}});
+    if (header_map.find("Accept-Encoding") == header_map.end()) {
+        header_map.emplace("Accept-Encoding", compression_.enabled() ? "gzip" : "identity");
     }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++requests_;
+
+    // 发送GET请求；复用的连接已被服务端关闭时重建连接重试一次
+    unsigned long long connections = connections_;
+    auto res = acquireClient(false).Get(path, header_map);
+    if (!res && connections_ == connections) {
+        ++retries_;
+        res = acquireClient(true).Get(path, header_map);
+    }
+    if (!res) {
+        ++failures_;
+    }
+
+    // 处理响应
+    return parseResponse(res);
 }
 
 nlohmann::json HttpClient::post(const std::string& endpoint, 
                               const nlohmann::json& data,
                               const std::map<std::string, std::string>& headers) {
-    // 解析URL
-    std::string url = base_url_;
-    std::string host;
-    std::string path = endpoint;
-    int port = 80;
-    
-    // 从base_url中提取host和port
-    if (url.substr(0, 7) == "http://") {
-        url = url.substr(7);
-    }
-    
-    size_t pos = url.find(':');
-    if (pos != std::string::npos) {
-        host = url.substr(0, pos);
-        port = std::stoi(url.substr(pos + 1));
-    } else {
-        pos = url.find('/');
-        if (pos != std::string::npos) {
-            host = url.substr(0, pos);
-            path = url.substr(pos) + path;
-        } else {
-            host = url;
-        }
-    }
-    
-    // 创建HTTP客户端
-    httplib::Client cli(host, port);
-    cli.set_connection_timeout(5);  // 5秒超时
-    cli.set_read_timeout(5);
-    
-    // 设置请求头
+    // 将JSON数据转换为字符串
+    return postRaw(endpoint, data.dump(), headers);
+}
+
+nlohmann::json HttpClient::postRaw(const std::string& endpoint,
+                                 const std::string& body,
+                                 const std::map<std::string, std::string>& headers,
+                                 const std::string& content_type) {
+    std::string path = path_prefix_ + endpoint;
+
+    // 设置请求头；上报的响应只有几十字节，除非调用方指定，不要求压缩响应
     httplib::Headers header_map;
-    header_map.emplace("Content-Type", "application/json");
     for (const auto& header : headers) {
         header_map.emplace(header.first, header.second);
     }
-    
-    // 将JSON数据转换为字符串
-    std::string json_data = data.dump();
-    
-    // 发送POST请求
-    auto res = cli.Post(path, header_map, json_data, "application/json");
-    
+    if (header_map.find("Accept-Encoding") == header_map.end()) {
+        header_map.emplace("Accept-Encoding", "identity");
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++requests_;
+
+    // 不小于阈值的请求体压缩后发送
+    bool compressed = compression_.compress(body, encoded_body_);
+    httplib::Headers compressed_headers;
+    if (compressed) {
+        compressed_headers = header_map;
+        compressed_headers.emplace("Content-Encoding", "gzip");
+    }
+    const std::string& payload = compressed ? encoded_body_ : body;
+    const httplib::Headers& payload_headers = compressed ? compressed_headers : header_map;
+
+    // 发送POST请求；只有复用的连接在请求发出前失败（连接或写入错误）时才重连重试。
+    // 读取响应失败时服务端可能已处理了请求，不重试，避免重复提交
+    unsigned long long connections = connections_;
+    auto res = acquireClient(false).Post(path, payload_headers, payload, content_type.c_str());
+    if (!res && connections_ == connections &&
+        (res.error() == httplib::Error::Connection || res.error() == httplib::Error::Write)) {
+        ++retries_;
+        res = acquireClient(true).Post(path, payload_headers, payload, content_type.c_str());
+    }
+
+    // 未启用zlib的旧版Manager对带Content-Encoding的请求返回415，之后不再压缩，本次按原文重发
+    if (compressed && res && res->status == 415) {
+        std::cerr << "Manager does not accept compressed requests, compression disabled" << std::endl;
+        compression_.disable();
+        res = acquireClient(false).Post(path, header_map, body, content_type.c_str());
+    }
+    if (!res) {
+        ++failures_;
+    }
+
     // 处理响应
+    return parseResponse(res);
+}
+
+nlohmann::json HttpClient::heartbeat(const std::string& node_id) {
+    std::string endpoint = "/api/heartbeat/" + node_id;
+    return post(endpoint, nlohmann::json::object());
+}
+
+nlohmann::json HttpClient::parseResponse(const httplib::Result& res) {
     if (res && res->status == 200) {
+        // httplib的自动解压已关闭，在这里解压以统计解压耗时
+        const std::string* body = &res->body;
+        if (res->get_header_value("Content-Encoding") == "gzip") {
+            if (!compression_.decompress(res->body, decoded_body_)) {
+                std::cerr << "Error decompressing response" << std::endl;
+                return nlohmann::json({{"status", "error"}, {"message", "Invalid compressed response"}});
+            }
+            body = &decoded_body_;
+        }
         try {
-            return nlohmann::json::parse(res->body);
+            return nlohmann::json::parse(*body);
         } catch (const std::exception& e) {
             std::cerr << "Error parsing JSON response: " << e.what() << std::endl;
             return nlohmann::json({{"status", "error"}, {"message", "Invalid JSON response"}});
         }
     } else {
         std::string error_msg = res ? "HTTP error: " + std::to_string(res->status) : "Connection error";
-        return nlohmann::json({{"status", "error"}, {"message", error_msg}});
+        // 连接失败或服务端5xx错误可稍后重试，其余错误重试也不会成功
+        bool retryable = !res || res->status >= 500;
+        return nlohmann::json({{"status", "error"}, {"message", error_msg}, {"retryable", retryable}});
     }
 }
 
-nlohmann::json HttpClient::heartbeat(const std::string& node_id) {
-    std::string endpoint = "/api/heartbeat/" + node_id;
-    return post(endpoint, nlohmann::json::object());
+HttpClient::ConnectionStats HttpClient::getConnectionStats() const {
+    ConnectionStats stats;
+    stats.requests = requests_;
+    stats.connections = connections_;
+    stats.retries = retries_;
+    stats.failures = failures_;
+    // 重试的请求第二次也会新建连接，按请求计只统计一次
+    unsigned long long fresh = stats.connections > stats.requests ? stats.requests : stats.connections;
+    stats.reused = stats.requests - fresh;
+    return stats;
+}
+
+httplib::Client& HttpClient::acquireClient(bool reconnect) {
+    if (client_ && !reconnect) {
+        return *client_;
+    }
+
+    // 创建HTTP客户端，keep-alive保持连接，由httplib在连接断开后自动重连
+    client_.reset(new httplib::Client(host_, port_));
+    client_->set_connection_timeout(5);  // 5秒超时
+    client_->set_read_timeout(5);
+    client_->set_keep_alive(true);
+    // 小请求在长连接上不等待Nagle合并
+    client_->set_tcp_nodelay(true);
+    // 响应体由parseResponse解压，以便统计；请求体由postRaw按阈值压缩
+    client_->set_decompress(false);
+    // 每新建一个socket回调一次，用于统计连接复用
+    client_->set_socket_options([this](httplib::socket_t) {
+        ++connections_;
+    });
+    return *client_;
 }
@@ -3,26 +3,50 @@
 
 #include <string>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <atomic>
 #include <nlohmann/json.hpp>
+#include "utils/http_compression.h"
+
+namespace httplib {
+    class Client;
+    class Result;
+}
 
 /**
  * HttpClient类 - HTTP客户端
  * 
- * 负责Agent与Manager之间的HTTP通信
+ * 负责Agent与Manager之间的HTTP通信。URL在构造时解析一次，所有请求复用同一个
+ * keep-alive连接，连接失效时重建。开启压缩时不小于阈值的请求体以gzip发送，
+ * 注册和GET请求接受gzip响应
  */
 class HttpClient {
 public:
+    /**
+     * 连接复用统计
+     */
+    struct ConnectionStats {
+        unsigned long long requests;            // 请求总数
+        unsigned long long connections;         // 新建TCP连接数
+        unsigned long long reused;              // 复用已有连接的请求数
+        unsigned long long retries;             // 复用的连接失效后重连重试的次数
+        unsigned long long failures;            // 最终失败的请求数
+    };
+
     /**
      * 构造函数
      * 
      * @param base_url 基础URL，如"http://manager:8080"
+     * @param compress_level 请求体的gzip压缩级别（1-9），0表示不压缩
+     * @param compress_threshold 压缩的最小请求体字节数
      */
-    explicit HttpClient(const std::string& base_url);
+    explicit HttpClient(const std::string& base_url, int compress_level = 0, size_t compress_threshold = 1024);
     
     /**
      * 析构函数
      */
-    ~HttpClient() = default;
+    ~HttpClient();
     
     /**
      * 发送注册请求
@@ -31,6 +55,15 @@ public:
      * @return 服务器响应的JSON对象
      */
     nlohmann::json registerAgent(const nlohmann::json& agent_info);
+
+    /**
+     * 发送已编码的注册请求
+     * 
+     * @param body 编码后的Agent信息
+     * @param content_type 编码格式对应的Content-Type
+     * @return 服务器响应的JSON对象
+     */
+    nlohmann::json registerAgent(const std::string& body, const std::string& content_type);
     
     /**
      * 上报资源数据
@@ -39,6 +72,24 @@ public:
      * @return 服务器响应的JSON对象
      */
     nlohmann::json reportData(const nlohmann::json& resource_data);
+
+    /**
+     * 上报已序列化好的资源数据
+     * 
+     * @param body 编码后的上报
+     * @param content_type 编码格式对应的Content-Type
+     * @return 服务器响应的JSON对象
+     */
+    nlohmann::json reportRawData(const std::string& body, const std::string& content_type = "application/json");
+
+    /**
+     * 批量上报已序列化的资源数据
+     * 
+     * @param body 编码后的上报数组
+     * @param content_type 编码格式对应的Content-Type
+     * @return 服务器响应的JSON对象
+     */
+    nlohmann::json reportRawBatch(const std::string& body, const std::string& content_type = "application/json");
     
     /**
      * 发送HTTP GET请求
@@ -62,6 +113,20 @@ public:
                         const nlohmann::json& data,
                         const std::map<std::string, std::string>& headers = {});
 
+    /**
+     * 发送HTTP POST请求，请求体为已序列化好的内容
+     * 
+     * @param endpoint API端点
+     * @param body 请求体
+     * @param headers 请求头
+     * @param content_type 请求体的Content-Type
+     * @return 响应内容的JSON对象
+     */
+    nlohmann::json postRaw(const std::string& endpoint,
+                           const std::string& body,
+                           const std::map<std::string, std::string>& headers = {},
+                           const std::string& content_type = "application/json");
+
     /**
      * 发送心跳请求
      * 
@@ -70,8 +135,73 @@ public:
      */
     nlohmann::json heartbeat(const std::string& node_id);
 
+    /**
+     * 获取连接复用统计
+     * 
+     * @return 连接复用统计
+     */
+    ConnectionStats getConnectionStats() const;
+
+    /**
+     * 获取请求体压缩和响应体解压的统计
+     * 
+     * @return 压缩统计
+     */
+    HttpCompression::Stats getCompressionStats() const {
+        return compression_.getStats();
+    }
+
+    /**
+     * 获取Manager主机
+     * 
+     * @return 基础URL中解析出的主机
+     */
+    const std::string& host() const {
+        return host_;
+    }
+
+    /**
+     * 是否压缩请求体
+     * 
+     * @return Manager不支持Content-Encoding时为false
+     */
+    bool compressionEnabled() const {
+        return compression_.enabled();
+    }
+
 private:
-    std::string base_url_;  // 基础URL
+    /**
+     * 获取长连接客户端，不存在或需要重连时新建
+     * 
+     * @param reconnect 是否丢弃现有连接重新建立
+     * @return 客户端
+     */
+    httplib::Client& acquireClient(bool reconnect);
+
+    /**
+     * 解析服务器响应，gzip编码的响应体先解压
+     * 
+     * @param res 请求结果
+     * @return 响应内容的JSON对象
+     */
+    nlohmann::json parseResponse(const httplib::Result& res);
+
+private:
+    std::string base_url_;                          // 基础URL
+    std::string host_;                              // 解析后的主机
+    int port_;                                      // 解析后的端口
+    std::string path_prefix_;                       // 基础URL中的路径前缀
+
+    std::mutex mutex_;                              // 串行化对长连接的使用
+    std::unique_ptr<httplib::Client> client_;       // 长连接客户端
+    HttpCompression compression_;                   // 请求体压缩
+    std::string encoded_body_;                      // 复用的压缩后请求体缓冲区
+    std::string decoded_body_;                      // 复用的解压后响应体缓冲区
+
+    std::atomic<unsigned long long> requests_;      // 请求总数
+    std::atomic<unsigned long long> connections_;   // 新建TCP连接数
+    std::atomic<unsigned long long> retries_;       // 重连重试次数
+    std::atomic<unsigned long long> failures_;      // 失败的请求数
 };
 
 #endif // HTTP_CLIENT_H
@@ -1,32 +1,52 @@
 #include "memory_collector.h"
-#include <fstream>
-#include <sstream>
+#include "proc_utils.h"
 #include <string>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
 
-MemoryCollector::MemoryCollector() {
-    // 构造函数，无需特殊初始化
+MemoryCollector::MemoryCollector(const std::string& meminfo_path)
+    : meminfo_path_(meminfo_path), meminfo_fd_(-1), buffer_(4096), sample_() {
+    meminfo_fd_ = open(meminfo_path_.c_str(), O_RDONLY | O_CLOEXEC);
 }
 
-nlohmann::json MemoryCollector::collect() {
-    nlohmann::json result;
-    
+MemoryCollector::~MemoryCollector() {
+    if (meminfo_fd_ >= 0) {
+        close(meminfo_fd_);
+    }
+}
+
+bool MemoryCollector::sample() {
     // 获取内存信息
     unsigned long long total = 0, free = 0, available = 0;
-    if (getMemoryInfo(total, free, available)) {
-        // 计算已使用内存
-        unsigned long long used = total - available;
-        
-        // 计算使用率
-        double usage_percent = 100.0 * static_cast<double>(used) / total;
-        
-        // 构建JSON结果
-        result["total"] = total * 1024;  // 转换为字节
-        result["used"] = used * 1024;    // 转换为字节
-        result["free"] = free * 1024;    // 转换为字节
-        result["usage_percent"] = usage_percent;
+    sample_.valid = getMemoryInfo(total, free, available);
+    if (!sample_.valid) {
+        return false;
     }
-    
-    return result;
+
+    // 计算已使用内存
+    unsigned long long used = total - available;
+
+    sample_.total = total * 1024;  // 转换为字节
+    sample_.used = used * 1024;    // 转换为字节
+    sample_.free = free * 1024;    // 转换为字节
+    sample_.usage_percent = 100.0 * static_cast<double>(used) / total;
+    return true;
+}
+
+void MemoryCollector::writeSample(SampleWriter& writer) const {
+    if (!sample_.valid) {
+        return;
+    }
+    writer.writeUint("total", sample_.total);
+    writer.writeUint("used", sample_.used);
+    writer.writeUint("free", sample_.free);
+    writer.writeDouble("usage_percent", sample_.usage_percent);
+}
+
+ResourceCollector::CostClass MemoryCollector::getCostClass() const {
+    // 只读取/proc/meminfo开头几行
+    return kCostFast;
 }
 
 std::string MemoryCollector::getType() const {
@@ -34,27 +54,33 @@ std::string MemoryCollector::getType() const {
 }
 
 bool MemoryCollector::getMemoryInfo(unsigned long long& total, unsigned long long& free, unsigned long long& available) {
-    std::ifstream file("/proc/meminfo");
-    if (!file.is_open()) {
+    ssize_t n = read_proc_file(meminfo_fd_, meminfo_path_, buffer_);
+    if (n <= 0) {
         return false;
     }
-    
-    std::string line;
-    while (std::getline(file, line)) {
-        std::istringstream iss(line);
-        std::string key;
-        unsigned long long value;
-        std::string unit;
-        
-        iss >> key >> value >> unit;
-        
-        if (key == "MemTotal:") {
-            total = value;
-        } else if (key == "MemFree:") {
-            free = value;
-        } else if (key == "MemAvailable:") {
-            available = value;
+
+    // 每行格式: "MemTotal:       16318480 kB"，需要的三项都在文件开头
+    const char* p = buffer_.data();
+    const char* end = p + n;
+    int found = 0;
+    while (p < end && found < 3) {
+        const char* line_end = proc_line_end(p, end);
+        const char* key = nullptr;
+        size_t key_length = 0;
+        const char* q = proc_parse_field(p, line_end, key, key_length);
+
+        if (key_length == 9 && memcmp(key, "MemTotal:", 9) == 0) {
+            proc_parse_number(q, line_end, total);
+            ++found;
+        } else if (key_length == 8 && memcmp(key, "MemFree:", 8) == 0) {
+            proc_parse_number(q, line_end, free);
+            ++found;
+        } else if (key_length == 13 && memcmp(key, "MemAvailable:", 13) == 0) {
+            proc_parse_number(q, line_end, available);
+            ++found;
         }
+
+        p = line_end + 1;
     }
     
     // 如果没有MemAvailable字段（较旧的内核），使用MemFree作为近似值
@@ -2,6 +2,7 @@
 #define MEMORY_COLLECTOR_H
 
 #include "resource_collector.h"
+#include <vector>
 
 /**
  * MemoryCollector类 - 内存资源采集器
@@ -10,23 +11,57 @@
  */
 class MemoryCollector : public ResourceCollector {
 public:
+    /**
+     * 一次采集的内存样本（字节）
+     */
+    struct Sample {
+        bool valid;                             // 是否成功读取，失败时不输出任何字段
+        unsigned long long total;
+        unsigned long long used;
+        unsigned long long free;
+        double usage_percent;
+    };
+
     /**
      * 构造函数
+     * 
+     * @param meminfo_path /proc/meminfo文件路径
      */
-    MemoryCollector();
+    explicit MemoryCollector(const std::string& meminfo_path = "/proc/meminfo");
     
     /**
      * 析构函数
      */
-    ~MemoryCollector() override = default;
+    ~MemoryCollector() override;
     
     /**
-     * 采集内存资源信息
+     * 采集内存资源信息到样本中
+     * 
+     * @return 是否成功读取/proc/meminfo
+     */
+    bool sample() override;
+
+    /**
+     * 将最近一次采集的样本逐字段写出
+     * 
+     * @param writer 序列化输出
+     */
+    void writeSample(SampleWriter& writer) const override;
+
+    /**
+     * 获取最近一次采集的样本
      * 
-     * @return JSON格式的内存资源信息
+     * @return 内存样本
      */
-    nlohmann::json collect() override;
+    const Sample& lastSample() const { return sample_; }
     
+    /**
+     * 获取采集开销等级
+     * 
+     * @return 开销等级
+     */
+    CostClass getCostClass() const override;
+
     /**
      * 获取采集器类型
      * 
@@ -44,6 +79,12 @@ private:
      * @return 是否成功获取
      */
     bool getMemoryInfo(unsigned long long& total, unsigned long long& free, unsigned long long& available);
+
+private:
+    std::string meminfo_path_;                  // /proc/meminfo文件路径
+    int meminfo_fd_;                            // 常驻打开的文件描述符
+    std::vector<char> buffer_;                  // 复用的读取缓冲区
+    Sample sample_;                             // 最近一次采集的样本
 };
 
 #endif // MEMORY_COLLECTOR_H
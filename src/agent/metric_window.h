@@ -0,0 +1,100 @@
+#ifndef METRIC_WINDOW_H
+#define METRIC_WINDOW_H
+
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+#include "sample_writer.h"
+
+/**
+ * MetricWindow类 - 单个指标的固定容量环形缓冲区
+ * 
+ * 在一个上报周期内保存亚秒级采样值，上报时计算min/max/avg/p95/last，
+ * 样本数超过容量时覆盖最旧的值
+ */
+class MetricWindow {
+public:
+    /**
+     * 构造函数
+     * 
+     * @param capacity 最多保存的样本数
+     */
+    explicit MetricWindow(size_t capacity = 64)
+        : values_(capacity > 0 ? capacity : 1), head_(0), count_(0) {
+        scratch_.reserve(values_.size());
+    }
+
+    /**
+     * 添加一个样本
+     * 
+     * @param value 样本值
+     */
+    void add(double value) {
+        values_[head_] = value;
+        head_ = (head_ + 1) % values_.size();
+        if (count_ < values_.size()) {
+            ++count_;
+        }
+    }
+
+    /**
+     * 获取当前样本数
+     * 
+     * @return 样本数
+     */
+    size_t size() const {
+        return count_;
+    }
+
+    /**
+     * 清空样本，开始新的窗口
+     */
+    void clear() {
+        head_ = 0;
+        count_ = 0;
+    }
+
+    /**
+     * 计算窗口聚合值
+     * 
+     * @param writer 序列化输出，写入min、max、avg、p95、last、samples
+     */
+    void aggregate(SampleWriter& writer) {
+        if (count_ == 0) {
+            return;
+        }
+
+        // 环形缓冲区中最早的样本位置
+        size_t start = (head_ + values_.size() - count_) % values_.size();
+        scratch_.clear();
+        double sum = 0.0;
+        double min = values_[start];
+        double max = values_[start];
+        for (size_t i = 0; i < count_; ++i) {
+            double value = values_[(start + i) % values_.size()];
+            scratch_.push_back(value);
+            sum += value;
+            min = std::min(min, value);
+            max = std::max(max, value);
+        }
+
+        // p95取最近秩（nearest-rank）
+        size_t rank = (count_ * 95 + 99) / 100;
+        std::nth_element(scratch_.begin(), scratch_.begin() + (rank - 1), scratch_.end());
+
+        writer.writeDouble("min", min);
+        writer.writeDouble("max", max);
+        writer.writeDouble("avg", sum / static_cast<double>(count_));
+        writer.writeDouble("p95", scratch_[rank - 1]);
+        writer.writeDouble("last", values_[(head_ + values_.size() - 1) % values_.size()]);
+        writer.writeUint("samples", count_);
+    }
+
+private:
+    std::vector<double> values_;        // 环形缓冲区
+    size_t head_;                       // 下一个写入位置
+    size_t count_;                      // 当前样本数
+    std::vector<double> scratch_;       // 计算p95用的临时缓冲区
+};
+
+#endif // METRIC_WINDOW_H
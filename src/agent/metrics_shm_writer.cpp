@@ -0,0 +1,172 @@
+#include "metrics_shm_writer.h"
+#include "utils/logger.h"
+#include <cerrno>
+
+namespace {
+
+// 复制字符串并截断，保证以'\0'结尾
+void copyString(char* out, size_t size, const nlohmann::json& value) {
+    memset(out, 0, size);
+    if (value.is_string()) {
+        const std::string& text = value.get_ref<const std::string&>();
+        memcpy(out, text.data(), text.size() < size - 1 ? text.size() : size - 1);
+    }
+}
+
+double jsonDouble(const nlohmann::json& object, const char* key) {
+    auto it = object.find(key);
+    return it != object.end() && it->is_number() ? it->get<double>() : 0.0;
+}
+
+}
+
+MetricsShmWriter::MetricsShmWriter(const std::string& path)
+    : path_(path),
+      region_(nullptr),
+      components_(kMetricsShmMaxComponents) {
+}
+
+MetricsShmWriter::~MetricsShmWriter() {
+    if (region_) {
+        beginWrite();
+        region_->data.writer_pid = 0;
+        endWrite();
+        munmap(region_, sizeof(MetricsShmRegion));
+    }
+}
+
+bool MetricsShmWriter::open() {
+    int fd = ::open(path_.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        LOG_ERROR("Failed to open metrics shm {}: {}", path_, strerror(errno));
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 ||
+        (static_cast<size_t>(st.st_size) != sizeof(MetricsShmRegion) && ftruncate(fd, sizeof(MetricsShmRegion)) != 0)) {
+        LOG_ERROR("Failed to size metrics shm {}: {}", path_, strerror(errno));
+        ::close(fd);
+        return false;
+    }
+    void* addr = mmap(nullptr, sizeof(MetricsShmRegion), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        LOG_ERROR("Failed to map metrics shm {}: {}", path_, strerror(errno));
+        return false;
+    }
+    region_ = static_cast<MetricsShmRegion*>(addr);
+
+    if (region_->magic == kMetricsShmMagic && region_->version == kMetricsShmVersion &&
+        region_->size == sizeof(MetricsShmRegion)) {
+        // 上次的Agent在写入中途退出时seq停在奇数，补1后继续
+        uint64_t seq = region_->seq.load(std::memory_order_relaxed);
+        if (seq & 1) {
+            region_->seq.store(seq + 1, std::memory_order_release);
+        }
+    } else {
+        // 新文件或布局不同：清空后最后写入magic，读取方在此之前打开会失败
+        __atomic_store_n(&region_->magic, 0, __ATOMIC_RELAXED);
+        region_->version = kMetricsShmVersion;
+        region_->size = sizeof(MetricsShmRegion);
+        region_->seq.store(0, std::memory_order_relaxed);
+        memset(&region_->data, 0, sizeof(region_->data));
+        __atomic_store_n(&region_->magic, kMetricsShmMagic, __ATOMIC_RELEASE);
+    }
+
+    beginWrite();
+    region_->data.writer_pid = static_cast<int32_t>(getpid());
+    endWrite();
+    LOG_INFO("Publishing local metrics to {}", path_);
+    return true;
+}
+
+void MetricsShmWriter::publishCpu(const CpuCollector::Sample& sample, long long time_ns) {
+    size_t cores = sample.cores.size() < kMetricsShmMaxCores ? sample.cores.size() : kMetricsShmMaxCores;
+
+    beginWrite();
+    MetricsShmCpu& cpu = region_->data.cpu;
+    cpu.time_ns = time_ns;
+    cpu.usage_percent = sample.usage_percent;
+    cpu.user_percent = sample.user_percent;
+    cpu.system_percent = sample.system_percent;
+    cpu.iowait_percent = sample.iowait_percent;
+    cpu.irq_percent = sample.irq_percent;
+    cpu.steal_percent = sample.steal_percent;
+    for (int i = 0; i < 3; ++i) {
+        cpu.load_avg[i] = sample.load_avg[i];
+    }
+    cpu.core_count = sample.core_count;
+    for (size_t i = 0; i < cores; ++i) {
+        MetricsShmCore& core = region_->data.cores[i];
+        core.core = sample.cores[i].core;
+        core.usage_percent = sample.cores[i].usage_percent;
+        core.iowait_percent = sample.cores[i].iowait_percent;
+        core.irq_percent = sample.cores[i].irq_percent;
+        core.steal_percent = sample.cores[i].steal_percent;
+    }
+    cpu.cores = static_cast<uint32_t>(cores);
+    endWrite();
+}
+
+void MetricsShmWriter::publishMemory(const MemoryCollector::Sample& sample, long long time_ns) {
+    if (!sample.valid) {
+        return;
+    }
+    beginWrite();
+    MetricsShmMemory& memory = region_->data.memory;
+    memory.time_ns = time_ns;
+    memory.total = sample.total;
+    memory.used = sample.used;
+    memory.free = sample.free;
+    memory.usage_percent = sample.usage_percent;
+    endWrite();
+}
+
+void MetricsShmWriter::publishComponents(const nlohmann::json& components, long long time_ns) {
+    // 先在本地缓冲区中转换，写入期间只做复制，读取方重试的窗口尽量短
+    size_t count = 0;
+    for (const auto& component : components) {
+        if (count == kMetricsShmMaxComponents) {
+            break;
+        }
+        if (!component.is_object()) {
+            continue;
+        }
+        MetricsShmComponent& out = components_[count++];
+        copyString(out.component_id, sizeof(out.component_id), component.value("component_id", nlohmann::json()));
+        copyString(out.business_id, sizeof(out.business_id), component.value("business_id", nlohmann::json()));
+        copyString(out.status, sizeof(out.status), component.value("status", nlohmann::json()));
+        out.timestamp = static_cast<int64_t>(jsonDouble(component, "timestamp"));
+        out.has_usage = 0;
+        out.reserved = 0;
+        out.cpu_percent = 0.0;
+        out.memory_bytes = 0;
+        auto usage = component.find("resource_usage");
+        if (usage != component.end() && usage->is_object()) {
+            out.has_usage = 1;
+            out.cpu_percent = jsonDouble(*usage, "cpu_percent");
+            // Docker组件有memory_bytes，二进制组件只有memory_mb
+            out.memory_bytes = usage->contains("memory_bytes")
+                                   ? static_cast<uint64_t>(jsonDouble(*usage, "memory_bytes"))
+                                   : static_cast<uint64_t>(jsonDouble(*usage, "memory_mb")) * 1024 * 1024;
+        }
+    }
+
+    beginWrite();
+    memcpy(region_->data.components, components_.data(), count * sizeof(MetricsShmComponent));
+    region_->data.component_count = static_cast<uint32_t>(count);
+    region_->data.components_time_ns = time_ns;
+    endWrite();
+}
+
+void MetricsShmWriter::beginWrite() {
+    // seq先变为奇数，之后的数据写入不会被读取方在seq变化之前看到
+    uint64_t seq = region_->seq.load(std::memory_order_relaxed);
+    region_->seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+void MetricsShmWriter::endWrite() {
+    ++region_->data.updates;
+    region_->seq.store(region_->seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
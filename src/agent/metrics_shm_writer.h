@@ -0,0 +1,83 @@
+#ifndef METRICS_SHM_WRITER_H
+#define METRICS_SHM_WRITER_H
+
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "cpu_collector.h"
+#include "memory_collector.h"
+#include "utils/metrics_shm.h"
+
+/**
+ * MetricsShmWriter类 - 本机指标共享内存写入
+ * 
+ * 创建并映射utils/metrics_shm.h定义的文件，每次采集完成后在seqlock保护下写入。
+ * 文件已存在且布局相同时沿用其中的seq，读取方不会把重启前后的两次写入误认为同一次。
+ * 只由采集线程写入
+ */
+class MetricsShmWriter {
+public:
+    /**
+     * 构造函数
+     * 
+     * @param path 映射文件路径
+     */
+    explicit MetricsShmWriter(const std::string& path);
+
+    /**
+     * 析构函数，写入writer_pid为0后解除映射，文件保留给仍在读取的服务
+     */
+    ~MetricsShmWriter();
+
+    MetricsShmWriter(const MetricsShmWriter&) = delete;
+    MetricsShmWriter& operator=(const MetricsShmWriter&) = delete;
+
+    /**
+     * 创建或打开文件并映射
+     * 
+     * @return 是否成功
+     */
+    bool open();
+
+    /**
+     * 写入CPU样本
+     * 
+     * @param sample CPU样本
+     * @param time_ns 采集时间（系统时间，纳秒）
+     */
+    void publishCpu(const CpuCollector::Sample& sample, long long time_ns);
+
+    /**
+     * 写入内存样本，读取失败的样本不写入
+     * 
+     * @param sample 内存样本
+     * @param time_ns 采集时间（系统时间，纳秒）
+     */
+    void publishMemory(const MemoryCollector::Sample& sample, long long time_ns);
+
+    /**
+     * 写入组件状态，超过kMetricsShmMaxComponents的组件不写入
+     * 
+     * @param components 组件状态数组，与上报中的components相同
+     * @param time_ns 写入时间（系统时间，纳秒）
+     */
+    void publishComponents(const nlohmann::json& components, long long time_ns);
+
+private:
+    /**
+     * 开始写入：seq变为奇数
+     */
+    void beginWrite();
+
+    /**
+     * 结束写入：seq变为偶数，累计写入次数
+     */
+    void endWrite();
+
+private:
+    std::string path_;                      // 映射文件路径
+    MetricsShmRegion* region_;              // 映射的区域
+    std::vector<MetricsShmComponent> components_;   // 写入前转换组件状态用的缓冲区
+};
+
+#endif // METRICS_SHM_WRITER_H
@@ -0,0 +1,314 @@
+#include "network_collector.h"
+#include "proc_utils.h"
+#include <string>
+#include <vector>
+#include <cstring>
+#include <utility>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+// 初始读取缓冲区大小，不够时由read_proc_file按倍数扩容
+const size_t kInitialBufferSize = 8 * 1024;
+
+// 网卡计数差值：部分驱动只提供32位计数，上次接近2^32、本次接近0时视为回绕并按2^32补齐；
+// 其他回退（链路闪断、驱动重载、网卡重建导致计数重置）与proc_counter_delta一样视为0
+inline unsigned long long netCounterDelta(unsigned long long prev, unsigned long long curr) {
+    const unsigned long long kWrapWindow = 0x40000000ULL;   // 回绕前后各1/4范围
+    if (curr >= prev) {
+        return curr - prev;
+    }
+    if (prev <= 0xFFFFFFFFULL && prev >= 0x100000000ULL - kWrapWindow && curr < kWrapWindow) {
+        return (0x100000000ULL - prev) + curr;
+    }
+    return 0;
+}
+
+// 每秒速率
+inline double ratePerSec(unsigned long long prev, unsigned long long curr, double elapsed_sec) {
+    return static_cast<double>(netCounterDelta(prev, curr)) / elapsed_sec;
+}
+
+}
+
+NetworkCollector::NetworkCollector(const std::string& proc_net_dir)
+    : dev_path_(proc_net_dir + "/dev"), snmp_path_(proc_net_dir + "/snmp"),
+      netstat_path_(proc_net_dir + "/netstat"),
+      dev_fd_(-1), snmp_fd_(-1), netstat_fd_(-1),
+      dev_buffer_(kInitialBufferSize), snmp_buffer_(kInitialBufferSize), netstat_buffer_(kInitialBufferSize),
+      current_interface_count_(0), last_interface_count_(0),
+      last_tcp_(), current_tcp_(), has_last_tcp_(false), last_time_(), sample_() {
+    dev_fd_ = open(dev_path_.c_str(), O_RDONLY | O_CLOEXEC);
+    snmp_fd_ = open(snmp_path_.c_str(), O_RDONLY | O_CLOEXEC);
+    netstat_fd_ = open(netstat_path_.c_str(), O_RDONLY | O_CLOEXEC);
+
+    // 初始化时先采集一次计数，为计算速率做准备
+    clock_gettime(CLOCK_MONOTONIC, &last_time_);
+    if (readInterfaces()) {
+        std::swap(last_interfaces_, current_interfaces_);
+        last_interface_count_ = current_interface_count_;
+    }
+    if (readTcpStats()) {
+        last_tcp_ = current_tcp_;
+        has_last_tcp_ = true;
+    }
+}
+
+NetworkCollector::~NetworkCollector() {
+    if (dev_fd_ >= 0) {
+        close(dev_fd_);
+    }
+    if (snmp_fd_ >= 0) {
+        close(snmp_fd_);
+    }
+    if (netstat_fd_ >= 0) {
+        close(netstat_fd_);
+    }
+}
+
+bool NetworkCollector::sample() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double elapsed_sec = static_cast<double>(now.tv_sec - last_time_.tv_sec) +
+                         static_cast<double>(now.tv_nsec - last_time_.tv_nsec) / 1e9;
+    last_time_ = now;
+
+    // 各接口收发速率
+    sample_.interface_count = 0;
+    bool ok = readInterfaces();
+    if (ok) {
+        for (size_t i = 0; i < current_interface_count_; ++i) {
+            const InterfaceStats& curr = current_interfaces_[i];
+            const InterfaceStats* prev = findLastInterface(curr.name, i);
+            // 新出现的接口没有上次计数，本次速率记为0
+            if (!prev || elapsed_sec <= 0.0) {
+                prev = &curr;
+            }
+            double elapsed = elapsed_sec > 0.0 ? elapsed_sec : 1.0;
+
+            if (sample_.interface_count == sample_.interfaces.size()) {
+                sample_.interfaces.emplace_back();
+            }
+            InterfaceSample& item = sample_.interfaces[sample_.interface_count++];
+            item.interface = curr.name;
+            item.rx_bytes_per_sec = ratePerSec(prev->rx_bytes, curr.rx_bytes, elapsed);
+            item.tx_bytes_per_sec = ratePerSec(prev->tx_bytes, curr.tx_bytes, elapsed);
+            item.rx_packets_per_sec = ratePerSec(prev->rx_packets, curr.rx_packets, elapsed);
+            item.tx_packets_per_sec = ratePerSec(prev->tx_packets, curr.tx_packets, elapsed);
+            item.rx_errors_per_sec = ratePerSec(prev->rx_errors, curr.rx_errors, elapsed);
+            item.tx_errors_per_sec = ratePerSec(prev->tx_errors, curr.tx_errors, elapsed);
+            item.rx_drops_per_sec = ratePerSec(prev->rx_drops, curr.rx_drops, elapsed);
+            item.tx_drops_per_sec = ratePerSec(prev->tx_drops, curr.tx_drops, elapsed);
+        }
+
+        // 交换前后两次的计数，字符串容量得以复用
+        std::swap(last_interfaces_, current_interfaces_);
+        last_interface_count_ = current_interface_count_;
+    }
+
+    // TCP重传和监听队列溢出
+    sample_.has_tcp = readTcpStats();
+    if (sample_.has_tcp) {
+        const TcpStats& prev = has_last_tcp_ ? last_tcp_ : current_tcp_;
+        double elapsed = elapsed_sec > 0.0 ? elapsed_sec : 1.0;
+        unsigned long long out_segs = proc_counter_delta(prev.out_segs, current_tcp_.out_segs);
+        unsigned long long retrans_segs = proc_counter_delta(prev.retrans_segs, current_tcp_.retrans_segs);
+
+        TcpSample& tcp = sample_.tcp;
+        tcp.out_segs_per_sec = static_cast<double>(out_segs) / elapsed;
+        tcp.retrans_segs_per_sec = static_cast<double>(retrans_segs) / elapsed;
+        tcp.retrans_percent = out_segs > 0 ? 100.0 * static_cast<double>(retrans_segs) / static_cast<double>(out_segs) : 0.0;
+        tcp.listen_overflows_per_sec = static_cast<double>(proc_counter_delta(prev.listen_overflows, current_tcp_.listen_overflows)) / elapsed;
+        tcp.listen_drops_per_sec = static_cast<double>(proc_counter_delta(prev.listen_drops, current_tcp_.listen_drops)) / elapsed;
+
+        last_tcp_ = current_tcp_;
+        has_last_tcp_ = true;
+    }
+
+    return ok;
+}
+
+void NetworkCollector::writeSample(SampleWriter& writer) const {
+    writer.beginArray("interfaces");
+    for (size_t i = 0; i < sample_.interface_count; ++i) {
+        const InterfaceSample& item = sample_.interfaces[i];
+        writer.beginObject(nullptr);
+        writer.writeString("interface", item.interface);
+        writer.writeDouble("rx_bytes_per_sec", item.rx_bytes_per_sec);
+        writer.writeDouble("tx_bytes_per_sec", item.tx_bytes_per_sec);
+        writer.writeDouble("rx_packets_per_sec", item.rx_packets_per_sec);
+        writer.writeDouble("tx_packets_per_sec", item.tx_packets_per_sec);
+        writer.writeDouble("rx_errors_per_sec", item.rx_errors_per_sec);
+        writer.writeDouble("tx_errors_per_sec", item.tx_errors_per_sec);
+        writer.writeDouble("rx_drops_per_sec", item.rx_drops_per_sec);
+        writer.writeDouble("tx_drops_per_sec", item.tx_drops_per_sec);
+        writer.endObject();
+    }
+    writer.endArray();
+
+    if (sample_.has_tcp) {
+        const TcpSample& tcp = sample_.tcp;
+        writer.beginObject("tcp");
+        writer.writeDouble("out_segs_per_sec", tcp.out_segs_per_sec);
+        writer.writeDouble("retrans_segs_per_sec", tcp.retrans_segs_per_sec);
+        writer.writeDouble("retrans_percent", tcp.retrans_percent);
+        writer.writeDouble("listen_overflows_per_sec", tcp.listen_overflows_per_sec);
+        writer.writeDouble("listen_drops_per_sec", tcp.listen_drops_per_sec);
+        writer.endObject();
+    }
+}
+
+ResourceCollector::CostClass NetworkCollector::getCostClass() const {
+    // /proc/net/dev、snmp、netstat三个文件
+    return kCostNormal;
+}
+
+std::string NetworkCollector::getType() const {
+    return "network";
+}
+
+bool NetworkCollector::readInterfaces() {
+    ssize_t n = read_proc_file(dev_fd_, dev_path_, dev_buffer_);
+    if (n <= 0) {
+        return false;
+    }
+
+    const char* p = dev_buffer_.data();
+    const char* end = p + n;
+    current_interface_count_ = 0;
+
+    // 跳过两行表头
+    for (int i = 0; i < 2 && p < end; ++i) {
+        p = proc_line_end(p, end) + 1;
+    }
+
+    while (p < end) {
+        const char* line_end = proc_line_end(p, end);
+
+        // 接口名以冒号结尾，冒号后可能紧跟数字
+        const char* name = proc_skip_spaces(p, line_end);
+        const char* colon = static_cast<const char*>(memchr(name, ':', line_end - name));
+        if (!colon) {
+            p = line_end + 1;
+            continue;
+        }
+        size_t name_length = static_cast<size_t>(colon - name);
+
+        // 回环接口不上报
+        if (name_length == 2 && memcmp(name, "lo", 2) == 0) {
+            p = line_end + 1;
+            continue;
+        }
+
+        if (current_interface_count_ == current_interfaces_.size()) {
+            current_interfaces_.emplace_back();
+        }
+        InterfaceStats& target = current_interfaces_[current_interface_count_++];
+        target.name.assign(name, name_length);
+
+        // 接收: bytes packets errs drop fifo frame compressed multicast
+        // 发送: bytes packets errs drop fifo colls carrier compressed
+        unsigned long long skipped = 0;
+        const char* q = colon + 1;
+        q = proc_parse_number(q, line_end, target.rx_bytes);
+        q = proc_parse_number(q, line_end, target.rx_packets);
+        q = proc_parse_number(q, line_end, target.rx_errors);
+        q = proc_parse_number(q, line_end, target.rx_drops);
+        for (int i = 0; i < 4; ++i) {
+            q = proc_parse_number(q, line_end, skipped);
+        }
+        q = proc_parse_number(q, line_end, target.tx_bytes);
+        q = proc_parse_number(q, line_end, target.tx_packets);
+        q = proc_parse_number(q, line_end, target.tx_errors);
+        proc_parse_number(q, line_end, target.tx_drops);
+
+        p = line_end + 1;
+    }
+
+    return true;
+}
+
+bool NetworkCollector::readTcpStats() {
+    static const char* const kTcpNames[] = {"OutSegs", "RetransSegs"};
+    static const char* const kTcpExtNames[] = {"ListenOverflows", "ListenDrops"};
+
+    unsigned long long tcp_values[2] = {0, 0};
+    unsigned long long tcp_ext_values[2] = {0, 0};
+
+    ssize_t n = read_proc_file(snmp_fd_, snmp_path_, snmp_buffer_);
+    if (n <= 0 || !parseKeyedCounters(snmp_buffer_.data(), static_cast<size_t>(n), "Tcp:", kTcpNames, tcp_values, 2)) {
+        return false;
+    }
+
+    // netstat不存在（如部分容器环境）时监听队列计数记为0
+    n = read_proc_file(netstat_fd_, netstat_path_, netstat_buffer_);
+    if (n > 0) {
+        parseKeyedCounters(netstat_buffer_.data(), static_cast<size_t>(n), "TcpExt:", kTcpExtNames, tcp_ext_values, 2);
+    }
+
+    current_tcp_.out_segs = tcp_values[0];
+    current_tcp_.retrans_segs = tcp_values[1];
+    current_tcp_.listen_overflows = tcp_ext_values[0];
+    current_tcp_.listen_drops = tcp_ext_values[1];
+    return true;
+}
+
+bool NetworkCollector::parseKeyedCounters(const char* data, size_t length, const char* prefix,
+                                          const char* const* names, unsigned long long* values, size_t count) {
+    const char* p = data;
+    const char* end = data + length;
+    size_t prefix_length = strlen(prefix);
+
+    while (p < end) {
+        const char* header_end = proc_line_end(p, end);
+        if (static_cast<size_t>(header_end - p) < prefix_length || memcmp(p, prefix, prefix_length) != 0) {
+            p = header_end + 1;
+            continue;
+        }
+
+        // 表头行的下一行是同前缀的数值行
+        const char* value_line = header_end + 1;
+        if (value_line >= end) {
+            return false;
+        }
+        const char* value_end = proc_line_end(value_line, end);
+
+        const char* h = p + prefix_length;
+        const char* v = value_line + prefix_length;
+        while (h < header_end && v < value_end) {
+            const char* field = nullptr;
+            size_t field_length = 0;
+            h = proc_parse_field(h, header_end, field, field_length);
+            if (field_length == 0) {
+                break;
+            }
+
+            // 数值可能为负（如Tcp: MaxConn为-1），按字段跳过
+            const char* number = nullptr;
+            size_t number_length = 0;
+            v = proc_parse_field(v, value_end, number, number_length);
+
+            for (size_t i = 0; i < count; ++i) {
+                if (strlen(names[i]) == field_length && memcmp(names[i], field, field_length) == 0) {
+                    proc_parse_number(number, number + number_length, values[i]);
+                }
+            }
+        }
+        return true;
+    }
+
+    return false;
+}
+
+const NetworkCollector::InterfaceStats* NetworkCollector::findLastInterface(const std::string& name, size_t hint) const {
+    if (hint < last_interface_count_ && last_interfaces_[hint].name == name) {
+        return &last_interfaces_[hint];
+    }
+    for (size_t i = 0; i < last_interface_count_; ++i) {
+        if (last_interfaces_[i].name == name) {
+            return &last_interfaces_[i];
+        }
+    }
+    return nullptr;
+}
@@ -0,0 +1,186 @@
+#ifndef NETWORK_COLLECTOR_H
+#define NETWORK_COLLECTOR_H
+
+#include "resource_collector.h"
+#include <vector>
+#include <time.h>
+#include <sys/types.h>
+
+/**
+ * NetworkCollector类 - 网络资源采集器
+ * 
+ * 负责采集各网络接口的收发速率（/proc/net/dev差值）以及TCP重传和监听队列溢出计数
+ */
+class NetworkCollector : public ResourceCollector {
+public:
+    /**
+     * 一个接口的每秒收发速率
+     */
+    struct InterfaceSample {
+        std::string interface;                  // 接口名
+        double rx_bytes_per_sec;
+        double tx_bytes_per_sec;
+        double rx_packets_per_sec;
+        double tx_packets_per_sec;
+        double rx_errors_per_sec;
+        double tx_errors_per_sec;
+        double rx_drops_per_sec;
+        double tx_drops_per_sec;
+    };
+
+    /**
+     * TCP重传和监听队列溢出速率
+     */
+    struct TcpSample {
+        double out_segs_per_sec;
+        double retrans_segs_per_sec;
+        double retrans_percent;                 // 重传段占发送段百分比
+        double listen_overflows_per_sec;
+        double listen_drops_per_sec;
+    };
+
+    /**
+     * 一次采集的网络样本，向量只增不减，元素中的字符串容量在采集间复用
+     */
+    struct Sample {
+        std::vector<InterfaceSample> interfaces;
+        size_t interface_count;                 // interfaces中的有效元素数
+        bool has_tcp;                           // 是否成功读取TCP计数
+        TcpSample tcp;
+    };
+
+    /**
+     * 构造函数
+     * 
+     * @param proc_net_dir /proc/net目录路径
+     */
+    explicit NetworkCollector(const std::string& proc_net_dir = "/proc/net");
+
+    /**
+     * 析构函数
+     */
+    ~NetworkCollector() override;
+
+    /**
+     * 采集网络资源信息到样本中
+     * 
+     * @return 是否成功读取/proc/net/dev
+     */
+    bool sample() override;
+
+    /**
+     * 将最近一次采集的样本逐字段写出
+     * 
+     * @param writer 序列化输出
+     */
+    void writeSample(SampleWriter& writer) const override;
+
+    /**
+     * 获取最近一次采集的样本
+     * 
+     * @return 网络样本
+     */
+    const Sample& lastSample() const { return sample_; }
+
+    /**
+     * 获取采集开销等级
+     * 
+     * @return 开销等级
+     */
+    CostClass getCostClass() const override;
+
+    /**
+     * 获取采集器类型
+     * 
+     * @return 采集器类型名称
+     */
+    std::string getType() const override;
+
+private:
+    /**
+     * /proc/net/dev中一个接口的累计计数
+     */
+    struct InterfaceStats {
+        std::string name;                       // 接口名，如eth0
+        unsigned long long rx_bytes;
+        unsigned long long rx_packets;
+        unsigned long long rx_errors;
+        unsigned long long rx_drops;
+        unsigned long long tx_bytes;
+        unsigned long long tx_packets;
+        unsigned long long tx_errors;
+        unsigned long long tx_drops;
+    };
+
+    /**
+     * TCP协议栈累计计数
+     */
+    struct TcpStats {
+        unsigned long long out_segs;            // Tcp: OutSegs
+        unsigned long long retrans_segs;        // Tcp: RetransSegs
+        unsigned long long listen_overflows;    // TcpExt: ListenOverflows
+        unsigned long long listen_drops;        // TcpExt: ListenDrops
+    };
+
+    /**
+     * 读取并解析/proc/net/dev到current_interfaces_
+     * 
+     * @return 是否成功读取
+     */
+    bool readInterfaces();
+
+    /**
+     * 读取并解析/proc/net/snmp和/proc/net/netstat到current_tcp_
+     * 
+     * @return 是否成功读取
+     */
+    bool readTcpStats();
+
+    /**
+     * 在snmp/netstat格式（表头行+数值行成对出现）的缓冲区中查找计数
+     * 
+     * @param data 文件内容
+     * @param length 文件长度
+     * @param prefix 行前缀，如"Tcp:"
+     * @param names 要查找的字段名
+     * @param values 输出的字段值，与names一一对应
+     * @param count 字段个数
+     * @return 是否找到对应的行
+     */
+    static bool parseKeyedCounters(const char* data, size_t length, const char* prefix,
+                                   const char* const* names, unsigned long long* values, size_t count);
+
+    /**
+     * 查找上次采集中同名接口
+     * 
+     * @param name 接口名
+     * @param hint 优先比较的下标（接口顺序通常不变）
+     * @return 上次的计数，找不到返回nullptr
+     */
+    const InterfaceStats* findLastInterface(const std::string& name, size_t hint) const;
+
+private:
+    std::string dev_path_;                          // /proc/net/dev路径
+    std::string snmp_path_;                         // /proc/net/snmp路径
+    std::string netstat_path_;                      // /proc/net/netstat路径
+    int dev_fd_;                                    // 常驻打开的文件描述符
+    int snmp_fd_;
+    int netstat_fd_;
+    std::vector<char> dev_buffer_;                  // 复用的读取缓冲区
+    std::vector<char> snmp_buffer_;
+    std::vector<char> netstat_buffer_;
+
+    std::vector<InterfaceStats> last_interfaces_;    // 上次采集的接口计数
+    std::vector<InterfaceStats> current_interfaces_; // 本次采集的接口计数
+    size_t current_interface_count_;                // 本次采集的接口数
+    size_t last_interface_count_;                   // 上次采集的接口数
+
+    TcpStats last_tcp_;                             // 上次采集的TCP计数
+    TcpStats current_tcp_;                          // 本次采集的TCP计数
+    bool has_last_tcp_;                             // 是否已有上次的TCP计数
+
+    struct timespec last_time_;                     // 上次采集的单调时钟时间
+    Sample sample_;                                 // 最近一次采集的样本
+};
+
+#endif // NETWORK_COLLECTOR_H
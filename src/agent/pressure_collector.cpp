@@ -0,0 +1,151 @@
+#include "pressure_collector.h"
+#include "proc_utils.h"
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+const char* const kResourceNames[PressureCollector::kResourceCount] = {"cpu", "memory", "io"};
+
+}
+
+PressureCollector::PressureCollector(const std::string& pressure_dir)
+    : buffer_(1024), sample_() {
+    for (size_t i = 0; i < kResourceCount; ++i) {
+        paths_[i] = pressure_dir + "/" + kResourceNames[i];
+        fds_[i] = open(paths_[i].c_str(), O_RDONLY | O_CLOEXEC);
+        has_last_[i] = false;
+
+        // 初始化时先采集一次累计停顿时间，为计算差值做准备
+        ssize_t n = read_proc_file(fds_[i], paths_[i], buffer_);
+        if (n > 0 && parsePressure(buffer_.data(), static_cast<size_t>(n), last_[i])) {
+            has_last_[i] = true;
+        }
+    }
+}
+
+PressureCollector::~PressureCollector() {
+    for (size_t i = 0; i < kResourceCount; ++i) {
+        if (fds_[i] >= 0) {
+            close(fds_[i]);
+        }
+    }
+}
+
+bool PressureCollector::sample() {
+    bool found = false;
+
+    for (size_t i = 0; i < kResourceCount; ++i) {
+        PressureStats stats;
+        ResourceSample& resource = sample_.resources[i];
+        ssize_t n = read_proc_file(fds_[i], paths_[i], buffer_);
+        resource.present = n > 0 && parsePressure(buffer_.data(), static_cast<size_t>(n), stats);
+        if (!resource.present) {
+            continue;
+        }
+
+        makeSample(stats, has_last_[i] ? &last_[i] : nullptr, resource);
+        last_[i] = stats;
+        has_last_[i] = true;
+        found = true;
+    }
+
+    return found;
+}
+
+void PressureCollector::writeSample(SampleWriter& writer) const {
+    for (size_t i = 0; i < kResourceCount; ++i) {
+        if (sample_.resources[i].present) {
+            writer.beginObject(kResourceNames[i]);
+            writeResource(sample_.resources[i], writer);
+            writer.endObject();
+        }
+    }
+}
+
+ResourceCollector::CostClass PressureCollector::getCostClass() const {
+    // 三个很小的PSI文件
+    return kCostFast;
+}
+
+std::string PressureCollector::getType() const {
+    return "pressure";
+}
+
+const char* PressureCollector::resourceName(size_t index) {
+    return index < kResourceCount ? kResourceNames[index] : "";
+}
+
+bool PressureCollector::parsePressure(const char* data, size_t length, PressureStats& stats) {
+    const char* p = data;
+    const char* end = data + length;
+    bool has_some = false;
+    stats = PressureStats();
+
+    // 每行格式: some|full avg10=0.00 avg60=0.00 avg300=0.00 total=0
+    while (p < end) {
+        const char* line_end = proc_line_end(p, end);
+        const char* kind = nullptr;
+        size_t kind_length = 0;
+        const char* q = proc_parse_field(p, line_end, kind, kind_length);
+
+        double* avg10 = nullptr;
+        double* avg60 = nullptr;
+        unsigned long long* total = nullptr;
+        if (kind_length == 4 && memcmp(kind, "some", 4) == 0) {
+            avg10 = &stats.some_avg10;
+            avg60 = &stats.some_avg60;
+            total = &stats.some_total;
+            has_some = true;
+        } else if (kind_length == 4 && memcmp(kind, "full", 4) == 0) {
+            avg10 = &stats.full_avg10;
+            avg60 = &stats.full_avg60;
+            total = &stats.full_total;
+        }
+
+        while (total && q < line_end) {
+            const char* field = nullptr;
+            size_t field_length = 0;
+            q = proc_parse_field(q, line_end, field, field_length);
+            const char* field_end = field + field_length;
+            if (field_length > 6 && memcmp(field, "avg10=", 6) == 0) {
+                proc_parse_decimal(field + 6, field_end, *avg10);
+            } else if (field_length > 6 && memcmp(field, "avg60=", 6) == 0) {
+                proc_parse_decimal(field + 6, field_end, *avg60);
+            } else if (field_length > 6 && memcmp(field, "total=", 6) == 0) {
+                proc_parse_number(field + 6, field_end, *total);
+            }
+        }
+
+        p = line_end + 1;
+    }
+
+    return has_some;
+}
+
+void PressureCollector::toJson(const PressureStats& curr, const PressureStats* prev, nlohmann::json& out) {
+    ResourceSample sample;
+    makeSample(curr, prev, sample);
+    JsonDomWriter writer(out);
+    writeResource(sample, writer);
+}
+
+void PressureCollector::makeSample(const PressureStats& curr, const PressureStats* prev, ResourceSample& out) {
+    out.present = true;
+    out.some_avg10 = curr.some_avg10;
+    out.some_avg60 = curr.some_avg60;
+    out.some_stall_us = prev ? proc_counter_delta(prev->some_total, curr.some_total) : 0ULL;
+    out.full_avg10 = curr.full_avg10;
+    out.full_avg60 = curr.full_avg60;
+    out.full_stall_us = prev ? proc_counter_delta(prev->full_total, curr.full_total) : 0ULL;
+}
+
+void PressureCollector::writeResource(const ResourceSample& sample, SampleWriter& writer) {
+    writer.writeDouble("some_avg10", sample.some_avg10);
+    writer.writeDouble("some_avg60", sample.some_avg60);
+    writer.writeUint("some_stall_us", sample.some_stall_us);
+    writer.writeDouble("full_avg10", sample.full_avg10);
+    writer.writeDouble("full_avg60", sample.full_avg60);
+    writer.writeUint("full_stall_us", sample.full_stall_us);
+}
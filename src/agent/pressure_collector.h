@@ -0,0 +1,150 @@
+#ifndef PRESSURE_COLLECTOR_H
+#define PRESSURE_COLLECTOR_H
+
+#include "resource_collector.h"
+#include <vector>
+
+/**
+ * PressureCollector类 - 资源压力采集器
+ * 
+ * 负责采集/proc/pressure/{cpu,memory,io}中的PSI（Pressure Stall Information），
+ * 反映任务因等待CPU、内存或I/O而停顿的时间比例，弥补使用率看不出的资源争抢
+ */
+class PressureCollector : public ResourceCollector {
+public:
+    /**
+     * 一个资源的PSI数据
+     */
+    struct PressureStats {
+        double some_avg10;                      // 至少一个任务停顿的时间占比（10秒平均）
+        double some_avg60;                      // 至少一个任务停顿的时间占比（60秒平均）
+        unsigned long long some_total;          // 至少一个任务停顿的累计时间（微秒）
+        double full_avg10;                      // 全部任务停顿的时间占比（10秒平均）
+        double full_avg60;                      // 全部任务停顿的时间占比（60秒平均）
+        unsigned long long full_total;          // 全部任务停顿的累计时间（微秒）
+    };
+
+    /**
+     * 一个资源一次采集的PSI样本，停顿时间为与上次采集的差值
+     */
+    struct ResourceSample {
+        bool present;                           // 本次是否成功读取
+        double some_avg10;
+        double some_avg60;
+        unsigned long long some_stall_us;
+        double full_avg10;
+        double full_avg60;
+        unsigned long long full_stall_us;
+    };
+
+    // PSI资源种类数，依次为cpu、memory、io
+    static const size_t kResourceCount = 3;
+
+    /**
+     * 一次采集的资源压力样本
+     */
+    struct Sample {
+        ResourceSample resources[kResourceCount];
+    };
+
+    /**
+     * 构造函数
+     * 
+     * @param pressure_dir PSI文件所在目录
+     */
+    explicit PressureCollector(const std::string& pressure_dir = "/proc/pressure");
+
+    /**
+     * 析构函数
+     */
+    ~PressureCollector() override;
+
+    /**
+     * 采集资源压力信息到样本中
+     * 
+     * @return 是否读取到任一资源的PSI，内核不支持PSI时为false
+     */
+    bool sample() override;
+
+    /**
+     * 将最近一次采集的样本逐字段写出，内核不支持PSI时不输出任何字段
+     * 
+     * @param writer 序列化输出
+     */
+    void writeSample(SampleWriter& writer) const override;
+
+    /**
+     * 获取最近一次采集的样本
+     * 
+     * @return 资源压力样本
+     */
+    const Sample& lastSample() const { return sample_; }
+
+    /**
+     * 获取采集开销等级
+     * 
+     * @return 开销等级
+     */
+    CostClass getCostClass() const override;
+
+    /**
+     * 获取采集器类型
+     * 
+     * @return 采集器类型名称
+     */
+    std::string getType() const override;
+
+    /**
+     * 获取资源名称
+     * 
+     * @param index 资源下标
+     * @return 资源名称（cpu、memory、io）
+     */
+    static const char* resourceName(size_t index);
+
+    /**
+     * 解析PSI文件内容（some/full两行）
+     * 
+     * @param data 文件内容
+     * @param length 文件长度
+     * @param stats 输出的PSI数据
+     * @return 是否解析到some行
+     */
+    static bool parsePressure(const char* data, size_t length, PressureStats& stats);
+
+    /**
+     * 将PSI数据转换为JSON，停顿时间为与上次采集的差值
+     * 
+     * @param curr 本次的PSI数据
+     * @param prev 上次的PSI数据，为nullptr时停顿时间记为0
+     * @param out 输出的JSON对象
+     */
+    static void toJson(const PressureStats& curr, const PressureStats* prev, nlohmann::json& out);
+
+    /**
+     * 由两次PSI数据生成样本
+     * 
+     * @param curr 本次的PSI数据
+     * @param prev 上次的PSI数据，为nullptr时停顿时间记为0
+     * @param out 输出的样本
+     */
+    static void makeSample(const PressureStats& curr, const PressureStats* prev, ResourceSample& out);
+
+    /**
+     * 将一个资源的样本逐字段写出
+     * 
+     * @param sample 资源样本
+     * @param writer 序列化输出
+     */
+    static void writeResource(const ResourceSample& sample, SampleWriter& writer);
+
+private:
+    std::string paths_[kResourceCount];             // 各资源PSI文件路径
+    int fds_[kResourceCount];                       // 常驻打开的文件描述符
+    PressureStats last_[kResourceCount];            // 上次采集的PSI数据
+    bool has_last_[kResourceCount];                 // 是否已有上次的PSI数据
+    std::vector<char> buffer_;                      // 复用的读取缓冲区
+    Sample sample_;                                 // 最近一次采集的样本
+};
+
+#endif // PRESSURE_COLLECTOR_H
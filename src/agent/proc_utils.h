@@ -0,0 +1,101 @@
+#ifndef PROC_UTILS_H
+#define PROC_UTILS_H
+
+#include <string>
+#include <vector>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+
+// /proc文件读取与解析的公共函数，供各采集器复用缓冲区、避免逐行分配
+
+// 从文件开头读取整个文件到复用缓冲区，fd无效时重新打开，缓冲区不够时按倍数扩容
+inline ssize_t read_proc_file(int& fd, const std::string& path, std::vector<char>& buffer) {
+    if (fd < 0) {
+        fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return -1;
+        }
+    }
+    if (buffer.empty()) {
+        buffer.resize(4096);
+    }
+
+    // seq_file（如/proc/diskstats、/proc/self/mounts、/proc/net/dev）一次最多返回约一页，
+    // 读不满缓冲区不代表到了文件末尾，须一直读到返回0
+    size_t total = 0;
+    while (true) {
+        if (total == buffer.size()) {
+            buffer.resize(buffer.size() * 2);
+        }
+        ssize_t n = pread(fd, buffer.data() + total, buffer.size() - total, static_cast<off_t>(total));
+        if (n < 0) {
+            return -1;
+        }
+        if (n == 0) {
+            return static_cast<ssize_t>(total);
+        }
+        total += static_cast<size_t>(n);
+    }
+}
+
+// 跳过空格和制表符
+inline const char* proc_skip_spaces(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t')) {
+        ++p;
+    }
+    return p;
+}
+
+// 读取一个空白分隔的字段，返回字段结束位置
+inline const char* proc_parse_field(const char* p, const char* end, const char*& field, size_t& length) {
+    p = proc_skip_spaces(p, end);
+    field = p;
+    while (p < end && *p != ' ' && *p != '\t' && *p != '\n') {
+        ++p;
+    }
+    length = static_cast<size_t>(p - field);
+    return p;
+}
+
+// 读取一个无符号整数，返回数字结束位置
+inline const char* proc_parse_number(const char* p, const char* end, unsigned long long& value) {
+    p = proc_skip_spaces(p, end);
+    unsigned long long v = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        v = v * 10 + static_cast<unsigned long long>(*p - '0');
+        ++p;
+    }
+    value = v;
+    return p;
+}
+
+// 读取一个非负小数（如PSI中的"1.74"），返回数字结束位置
+inline const char* proc_parse_decimal(const char* p, const char* end, double& value) {
+    unsigned long long integer = 0;
+    p = proc_parse_number(p, end, integer);
+    double v = static_cast<double>(integer);
+    if (p < end && *p == '.') {
+        double scale = 0.1;
+        for (++p; p < end && *p >= '0' && *p <= '9'; ++p) {
+            v += static_cast<double>(*p - '0') * scale;
+            scale *= 0.1;
+        }
+    }
+    value = v;
+    return p;
+}
+
+// 返回下一行的结束位置（换行符或缓冲区末尾）
+inline const char* proc_line_end(const char* p, const char* end) {
+    const char* line_end = static_cast<const char*>(memchr(p, '\n', end - p));
+    return line_end ? line_end : end;
+}
+
+// 两次计数的差值，计数回退（设备重置或32位计数回绕）时视为0
+inline unsigned long long proc_counter_delta(unsigned long long prev, unsigned long long curr) {
+    return curr >= prev ? curr - prev : 0;
+}
+
+#endif // PROC_UTILS_H
@@ -0,0 +1,171 @@
+#ifndef REPORT_QUEUE_H
+#define REPORT_QUEUE_H
+
+#include <string>
+#include <memory>
+#include <atomic>
+#include <cstddef>
+
+/**
+ * ReportQueue类 - 有界无锁上报队列
+ * 
+ * 采集线程（唯一的入队方）把序列化好的上报放入队列，发送线程取出发送，两者互不阻塞。
+ * 基于序号的环形队列（每个槽位带序号，入队出队各用一个原子位置），
+ * 入队和出队都只做CAS，不加锁。队列满时丢弃最旧的上报并计数，
+ * 保证Manager阻塞时采集节奏不受影响。
+ * 槽位中的字符串与调用方交换而不是拷贝，缓冲区在上报间循环复用
+ */
+class ReportQueue {
+public:
+    /**
+     * 构造函数
+     * 
+     * @param capacity 容量，向上取整为2的幂
+     */
+    explicit ReportQueue(size_t capacity) : dropped_(0) {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        mask_ = size - 1;
+        cells_.reset(new Cell[size]);
+        for (size_t i = 0; i < size; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        enqueue_pos_.store(0, std::memory_order_relaxed);
+        dequeue_pos_.store(0, std::memory_order_relaxed);
+    }
+
+    ReportQueue(const ReportQueue&) = delete;
+    ReportQueue& operator=(const ReportQueue&) = delete;
+
+    /**
+     * 放入一条上报，队列满时丢弃最旧的一条
+     * 
+     * @param report 上报内容，与槽位交换，返回时为一个可复用的旧缓冲区
+     * @return 是否丢弃了旧的上报
+     */
+    bool push(std::string& report) {
+        bool dropped = false;
+        while (!tryPush(report)) {
+            // 以消费者身份取走最旧的一条；与发送线程竞争失败说明已有空位，重试入队即可
+            if (tryPop(drop_buffer_)) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                dropped = true;
+            }
+        }
+        return dropped;
+    }
+
+    /**
+     * 取出最旧的一条上报
+     * 
+     * @param report 输出参数，与槽位交换
+     * @return 队列为空时返回false
+     */
+    bool tryPop(std::string& report) {
+        size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells_[pos & mask_];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            long long diff = static_cast<long long>(sequence) - static_cast<long long>(pos + 1);
+            if (diff == 0) {
+                if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    report.swap(cell.value);
+                    cell.sequence.store(pos + mask_ + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * 队列是否为空（近似值，仅用于唤醒判断）
+     * 
+     * @return 是否为空
+     */
+    bool empty() const {
+        return size() == 0;
+    }
+
+    /**
+     * 获取队列中的上报数（近似值）
+     * 
+     * @return 上报数
+     */
+    size_t size() const {
+        size_t dequeue = dequeue_pos_.load(std::memory_order_relaxed);
+        size_t enqueue = enqueue_pos_.load(std::memory_order_relaxed);
+        return enqueue > dequeue ? enqueue - dequeue : 0;
+    }
+
+    /**
+     * 获取容量
+     * 
+     * @return 容量
+     */
+    size_t capacity() const {
+        return mask_ + 1;
+    }
+
+    /**
+     * 获取累计丢弃的上报数
+     * 
+     * @return 丢弃数
+     */
+    unsigned long long dropped() const {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
+private:
+    /**
+     * 尝试放入一条上报
+     * 
+     * @param report 上报内容，成功时与槽位交换
+     * @return 队列满时返回false
+     */
+    bool tryPush(std::string& report) {
+        size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells_[pos & mask_];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            long long diff = static_cast<long long>(sequence) - static_cast<long long>(pos);
+            if (diff == 0) {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    report.swap(cell.value);
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+private:
+    /**
+     * 一个槽位：序号等于入队位置时可写，等于入队位置+1时可读
+     */
+    struct Cell {
+        std::atomic<size_t> sequence;           // 槽位序号
+        std::string value;                      // 上报内容
+    };
+
+    std::unique_ptr<Cell[]> cells_;             // 槽位
+    size_t mask_;                               // 容量-1
+    char pad0_[64];                             // 隔开入队和出队位置，避免伪共享
+    std::atomic<size_t> enqueue_pos_;           // 下一个入队位置
+    char pad1_[64];
+    std::atomic<size_t> dequeue_pos_;           // 下一个出队位置
+    char pad2_[64];
+    std::atomic<unsigned long long> dropped_;   // 累计丢弃的上报数
+    std::string drop_buffer_;                   // 接收被丢弃的上报，仅入队方使用
+};
+
+#endif // REPORT_QUEUE_H
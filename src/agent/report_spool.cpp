@@ -0,0 +1,338 @@
+#include "report_spool.h"
+#include "dir_utils.h"
+#include "utils/logger.h"
+#include <algorithm>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/mman.h>
+
+namespace {
+
+const uint32_t kSegmentMagic = 0x4C505352;     // "RSPL"
+const uint32_t kSegmentVersion = 1;
+const uint32_t kRecordMagic = 0x43455252;      // "RREC"
+
+// 段头，位于每个段文件开头
+struct SegmentHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t seq;
+    uint64_t read_offset;                       // 已发送到的位置，重放确认后更新
+    uint8_t reserved[40];
+};
+
+// 记录头，后接length字节的上报内容，整条记录按8字节对齐
+struct RecordHeader {
+    uint32_t magic;                             // 最后写入，为kRecordMagic时记录完整
+    uint32_t length;
+    uint64_t seq;                               // 全局连续的记录序号
+    uint32_t crc;                               // 上报内容的CRC32
+    uint32_t reserved;
+};
+
+const size_t kSegmentHeaderSize = sizeof(SegmentHeader);
+const size_t kRecordHeaderSize = sizeof(RecordHeader);
+
+size_t recordSize(size_t length) {
+    return (kRecordHeaderSize + length + 7) & ~static_cast<size_t>(7);
+}
+
+uint32_t crc32(const char* data, size_t length) {
+    static uint32_t table[256];
+    static bool initialized = false;
+    if (!initialized) {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            table[i] = c;
+        }
+        initialized = true;
+    }
+
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < length; ++i) {
+        crc = table[(crc ^ static_cast<unsigned char>(data[i])) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+SegmentHeader* segmentHeader(char* base) {
+    return reinterpret_cast<SegmentHeader*>(base);
+}
+
+RecordHeader* recordHeader(char* base, size_t offset) {
+    return reinterpret_cast<RecordHeader*>(base + offset);
+}
+
+}
+
+ReportSpool::ReportSpool(const std::string& directory, size_t segment_bytes, size_t max_segments)
+    : directory_(directory),
+      segment_bytes_(std::max(segment_bytes, static_cast<size_t>(64 * 1024))),
+      max_segments_(std::max(max_segments, static_cast<size_t>(2))),
+      next_segment_seq_(1),
+      next_record_seq_(1),
+      pending_count_(0),
+      disk_bytes_(0),
+      dropped_(0) {
+}
+
+ReportSpool::~ReportSpool() {
+    for (auto& segment : segments_) {
+        closeSegment(segment, false);
+    }
+}
+
+bool ReportSpool::open() {
+    if (!create_directories(directory_)) {
+        LOG_ERROR("Failed to create spool directory {}: {}", directory_, strerror(errno));
+        return false;
+    }
+
+    // 按文件名中的序号恢复已有的段
+    std::vector<uint64_t> seqs;
+    DIR* dir = opendir(directory_.c_str());
+    if (!dir) {
+        LOG_ERROR("Failed to open spool directory {}: {}", directory_, strerror(errno));
+        return false;
+    }
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        unsigned long long seq = 0;
+        char suffix[8] = {0};
+        if (sscanf(entry->d_name, "segment-%16llx.%7s", &seq, suffix) == 2 && strcmp(suffix, "spool") == 0) {
+            seqs.push_back(seq);
+        }
+    }
+    closedir(dir);
+    std::sort(seqs.begin(), seqs.end());
+
+    for (uint64_t seq : seqs) {
+        Segment segment;
+        if (!mapSegment(seq, false, segment) || !recoverSegment(segment)) {
+            LOG_ERROR("Discarding invalid spool segment {}", segmentPath(seq));
+            if (segment.base) {
+                closeSegment(segment, true);
+            } else {
+                unlink(segmentPath(seq).c_str());
+            }
+            continue;
+        }
+        next_segment_seq_ = seq + 1;
+        if (segment.records == 0) {
+            closeSegment(segment, true);
+            continue;
+        }
+        pending_count_ += segment.records;
+        disk_bytes_ += segment_bytes_;
+        segments_.push_back(segment);
+    }
+
+    if (pending_count_ > 0) {
+        LOG_INFO("Recovered {} unsent reports from spool {}", pending_count_.load(), directory_);
+    }
+    return true;
+}
+
+bool ReportSpool::append(const std::string& report) {
+    size_t size = recordSize(report.size());
+    if (kSegmentHeaderSize + size > segment_bytes_) {
+        LOG_ERROR("Report of {} bytes exceeds spool segment size, discarded", report.size());
+        return false;
+    }
+
+    // 当前段放不下时开新段，段数到达上限时先删除最旧的段
+    if (segments_.empty() || segments_.back().write_offset + size > segment_bytes_) {
+        if (segments_.size() >= max_segments_) {
+            Segment& oldest = segments_.front();
+            dropped_ += oldest.records;
+            pending_count_ -= oldest.records;
+            disk_bytes_ -= segment_bytes_;
+            LOG_ERROR("Report spool full, dropped {} oldest reports", oldest.records);
+            closeSegment(oldest, true);
+            segments_.pop_front();
+        }
+
+        Segment segment;
+        if (!mapSegment(next_segment_seq_, true, segment)) {
+            return false;
+        }
+        ++next_segment_seq_;
+        disk_bytes_ += segment_bytes_;
+        segments_.push_back(segment);
+    }
+
+    // 先写内容和记录头的其余字段，最后写magic，崩溃时写了一半的记录不会被当作完整记录
+    Segment& segment = segments_.back();
+    RecordHeader* header = recordHeader(segment.base, segment.write_offset);
+    memcpy(segment.base + segment.write_offset + kRecordHeaderSize, report.data(), report.size());
+    header->length = static_cast<uint32_t>(report.size());
+    header->seq = next_record_seq_++;
+    header->crc = crc32(report.data(), report.size());
+    header->reserved = 0;
+    __atomic_store_n(&header->magic, kRecordMagic, __ATOMIC_RELEASE);
+
+    segment.write_offset += size;
+    ++segment.records;
+    ++pending_count_;
+    return true;
+}
+
+size_t ReportSpool::peek(std::vector<std::string>& reports, size_t max_count) {
+    if (reports.size() < max_count) {
+        reports.resize(max_count);
+    }
+
+    // 从最旧的段开始顺序读取，跨段时接着读下一段
+    size_t count = 0;
+    for (const auto& segment : segments_) {
+        size_t offset = segment.read_offset;
+        for (unsigned long long i = 0; i < segment.records && count < max_count; ++i) {
+            const RecordHeader* header = recordHeader(segment.base, offset);
+            reports[count++].assign(segment.base + offset + kRecordHeaderSize, header->length);
+            offset += recordSize(header->length);
+        }
+        if (count == max_count) {
+            break;
+        }
+    }
+    return count;
+}
+
+void ReportSpool::pop(size_t count) {
+    while (count > 0 && !segments_.empty()) {
+        // 更新段头的已发送位置，崩溃后从这里继续重放（至多重复发送最后一批）
+        Segment& segment = segments_.front();
+        const RecordHeader* header = recordHeader(segment.base, segment.read_offset);
+        segment.read_offset += recordSize(header->length);
+        segmentHeader(segment.base)->read_offset = segment.read_offset;
+        --segment.records;
+        --pending_count_;
+        --count;
+
+        // 段内记录全部发送后删除该段
+        if (segment.records == 0) {
+            disk_bytes_ -= segment_bytes_;
+            closeSegment(segment, true);
+            segments_.pop_front();
+        }
+    }
+}
+
+bool ReportSpool::mapSegment(uint64_t seq, bool create, Segment& segment) {
+    segment.seq = seq;
+    segment.path = segmentPath(seq);
+    segment.base = nullptr;
+    segment.read_offset = kSegmentHeaderSize;
+    segment.write_offset = kSegmentHeaderSize;
+    segment.records = 0;
+
+    int flags = O_RDWR | O_CLOEXEC | (create ? O_CREAT | O_TRUNC : 0);
+    segment.fd = ::open(segment.path.c_str(), flags, 0644);
+    if (segment.fd < 0) {
+        LOG_ERROR("Failed to open spool segment {}: {}", segment.path, strerror(errno));
+        return false;
+    }
+
+    // 新段预先扩展到固定大小，未写入的部分读出为0，扫描时即为无效记录
+    if (create && ftruncate(segment.fd, static_cast<off_t>(segment_bytes_)) != 0) {
+        LOG_ERROR("Failed to size spool segment {}: {}", segment.path, strerror(errno));
+        ::close(segment.fd);
+        unlink(segment.path.c_str());
+        return false;
+    }
+    if (!create) {
+        off_t size = lseek(segment.fd, 0, SEEK_END);
+        if (size != static_cast<off_t>(segment_bytes_)) {
+            ::close(segment.fd);
+            segment.fd = -1;
+            return false;
+        }
+    }
+
+    void* base = mmap(nullptr, segment_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED, segment.fd, 0);
+    if (base == MAP_FAILED) {
+        LOG_ERROR("Failed to map spool segment {}: {}", segment.path, strerror(errno));
+        ::close(segment.fd);
+        segment.fd = -1;
+        if (create) {
+            unlink(segment.path.c_str());
+        }
+        return false;
+    }
+    segment.base = static_cast<char*>(base);
+
+    if (create) {
+        SegmentHeader* header = segmentHeader(segment.base);
+        memset(header, 0, kSegmentHeaderSize);
+        header->version = kSegmentVersion;
+        header->seq = seq;
+        header->read_offset = kSegmentHeaderSize;
+        __atomic_store_n(&header->magic, kSegmentMagic, __ATOMIC_RELEASE);
+    }
+    return true;
+}
+
+bool ReportSpool::recoverSegment(Segment& segment) {
+    const SegmentHeader* header = segmentHeader(segment.base);
+    if (header->magic != kSegmentMagic || header->version != kSegmentVersion || header->seq != segment.seq ||
+        header->read_offset < kSegmentHeaderSize || header->read_offset > segment_bytes_) {
+        return false;
+    }
+
+    // 从已发送位置开始，magic、长度、序号连续性和CRC都通过的记录才算完整
+    size_t offset = header->read_offset;
+    uint64_t expected_seq = 0;
+    while (offset + kRecordHeaderSize <= segment_bytes_) {
+        const RecordHeader* record = recordHeader(segment.base, offset);
+        if (record->magic != kRecordMagic || offset + recordSize(record->length) > segment_bytes_) {
+            break;
+        }
+        if (expected_seq != 0 && record->seq != expected_seq) {
+            break;
+        }
+        if (crc32(segment.base + offset + kRecordHeaderSize, record->length) != record->crc) {
+            break;
+        }
+        expected_seq = record->seq + 1;
+        offset += recordSize(record->length);
+        ++segment.records;
+    }
+
+    segment.read_offset = header->read_offset;
+    segment.write_offset = offset;
+    if (expected_seq > next_record_seq_) {
+        next_record_seq_ = expected_seq;
+    }
+    return true;
+}
+
+void ReportSpool::closeSegment(Segment& segment, bool remove) {
+    if (segment.base) {
+        if (!remove) {
+            msync(segment.base, segment_bytes_, MS_SYNC);
+        }
+        munmap(segment.base, segment_bytes_);
+        segment.base = nullptr;
+    }
+    if (segment.fd >= 0) {
+        ::close(segment.fd);
+        segment.fd = -1;
+    }
+    if (remove) {
+        unlink(segment.path.c_str());
+    }
+}
+
+std::string ReportSpool::segmentPath(uint64_t seq) const {
+    char name[48];
+    snprintf(name, sizeof(name), "segment-%016llx.spool", static_cast<unsigned long long>(seq));
+    return directory_ + "/" + name;
+}
@@ -0,0 +1,167 @@
+#ifndef REPORT_SPOOL_H
+#define REPORT_SPOOL_H
+
+#include <string>
+#include <deque>
+#include <vector>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * ReportSpool类 - 磁盘上报暂存区
+ * 
+ * Manager不可达时未发送的上报按顺序追加到暂存区，恢复后从最旧的一条开始重放。
+ * 暂存区由目录下若干固定大小的段文件组成，每段mmap映射后顺序追加记录，
+ * 段数达到上限时删除最旧的段（丢弃其中未发送的上报并计数），总大小因此有上限。
+ * 每条记录带序号和CRC，记录头的magic最后写入；进程崩溃后重新打开时从每段的
+ * 已发送位置扫描到第一条不完整的记录为止，已写完的记录不会丢失，写了一半的记录被忽略。
+ * 只由发送线程使用，统计接口可在其他线程调用
+ */
+class ReportSpool {
+public:
+    /**
+     * 构造函数
+     * 
+     * @param directory 段文件所在目录
+     * @param segment_bytes 每个段文件的大小（字节）
+     * @param max_segments 段文件数上限
+     */
+    ReportSpool(const std::string& directory, size_t segment_bytes, size_t max_segments);
+
+    /**
+     * 析构函数，同步并关闭所有段
+     */
+    ~ReportSpool();
+
+    ReportSpool(const ReportSpool&) = delete;
+    ReportSpool& operator=(const ReportSpool&) = delete;
+
+    /**
+     * 创建目录并恢复已有的段文件
+     * 
+     * @return 是否成功
+     */
+    bool open();
+
+    /**
+     * 追加一条上报
+     * 
+     * @param report 上报内容
+     * @return 是否成功，超过单段容量或写文件失败时返回false
+     */
+    bool append(const std::string& report);
+
+    /**
+     * 按顺序读取最旧的若干条未发送上报
+     * 
+     * @param reports 输出参数，前若干个元素被覆盖，元素的缓冲区在调用间复用
+     * @param max_count 最多读取的条数
+     * @return 读取的条数，暂存区为空时为0
+     */
+    size_t peek(std::vector<std::string>& reports, size_t max_count);
+
+    /**
+     * 将最旧的若干条上报标记为已发送
+     * 
+     * @param count 条数
+     */
+    void pop(size_t count);
+
+    /**
+     * 暂存区是否为空
+     * 
+     * @return 是否为空
+     */
+    bool empty() const {
+        return pending_count_ == 0;
+    }
+
+    /**
+     * 获取未发送的上报数
+     * 
+     * @return 上报数
+     */
+    unsigned long long pendingCount() const {
+        return pending_count_;
+    }
+
+    /**
+     * 获取段文件占用的字节数
+     * 
+     * @return 字节数
+     */
+    unsigned long long diskBytes() const {
+        return disk_bytes_;
+    }
+
+    /**
+     * 获取因超过大小上限而丢弃的上报数
+     * 
+     * @return 丢弃数
+     */
+    unsigned long long dropped() const {
+        return dropped_;
+    }
+
+private:
+    /**
+     * 一个已映射的段文件
+     */
+    struct Segment {
+        uint64_t seq;                   // 段序号，同时决定文件名和重放顺序
+        std::string path;               // 文件路径
+        int fd;                         // 文件描述符
+        char* base;                     // 映射地址
+        size_t read_offset;             // 下一条未发送记录的位置
+        size_t write_offset;            // 下一条记录的追加位置
+        unsigned long long records;     // 未发送的记录数
+    };
+
+    /**
+     * 创建或打开段文件并映射
+     * 
+     * @param seq 段序号
+     * @param create 是否新建（新建时初始化段头）
+     * @param segment 输出参数
+     * @return 是否成功
+     */
+    bool mapSegment(uint64_t seq, bool create, Segment& segment);
+
+    /**
+     * 从段头记录的已发送位置扫描完整的记录，确定追加位置和未发送记录数
+     * 
+     * @param segment 段
+     * @return 段头有效时返回true
+     */
+    bool recoverSegment(Segment& segment);
+
+    /**
+     * 解除映射并关闭段文件
+     * 
+     * @param segment 段
+     * @param remove 是否同时删除文件
+     */
+    void closeSegment(Segment& segment, bool remove);
+
+    /**
+     * 获取段文件路径
+     * 
+     * @param seq 段序号
+     * @return 文件路径
+     */
+    std::string segmentPath(uint64_t seq) const;
+
+private:
+    std::string directory_;                         // 段文件所在目录
+    size_t segment_bytes_;                          // 每个段文件的大小
+    size_t max_segments_;                           // 段文件数上限
+    std::deque<Segment> segments_;                  // 按序号排列的段，最旧的在前
+    uint64_t next_segment_seq_;                     // 下一个新段的序号
+    uint64_t next_record_seq_;                      // 下一条记录的序号
+    std::atomic<unsigned long long> pending_count_; // 未发送的上报数
+    std::atomic<unsigned long long> disk_bytes_;    // 段文件占用的字节数
+    std::atomic<unsigned long long> dropped_;       // 丢弃的上报数
+};
+
+#endif // REPORT_SPOOL_H
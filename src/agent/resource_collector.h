@@ -3,26 +3,82 @@
 
 #include <string>
 #include <nlohmann/json.hpp>
+#include "sample_writer.h"
 
 /**
  * ResourceCollector抽象基类 - 资源采集器
  * 
- * 定义资源采集的通用接口
+ * 定义资源采集的通用接口。采集器把每次采集结果写入内部预分配的类型化样本，
+ * 上报时再通过SampleWriter一次性序列化，collect()保留为JSON适配接口
  */
 class ResourceCollector {
 public:
+    /**
+     * 采集开销等级，决定默认采集周期
+     */
+    enum CostClass {
+        kCostFast,          // 读取一两个/proc文件，每250ms采集
+        kCostNormal,        // 每1s采集
+        kCostSlow           // 涉及较多系统调用（如逐个挂载点statvfs），每30s采集
+    };
+
     /**
      * 析构函数
      */
     virtual ~ResourceCollector() = default;
-    
+
+    /**
+     * 采集一次资源信息，结果保存在采集器的样本中
+     * 
+     * @return 是否采集成功
+     */
+    virtual bool sample() = 0;
+
+    /**
+     * 将最近一次采集的样本逐字段写出
+     * 
+     * @param writer 序列化输出
+     */
+    virtual void writeSample(SampleWriter& writer) const = 0;
+
     /**
      * 采集资源信息
      * 
      * @return JSON格式的资源信息
      */
-    virtual nlohmann::json collect() = 0;
-    
+    nlohmann::json collect() {
+        sample();
+        nlohmann::json result = nlohmann::json::object();
+        JsonDomWriter writer(result);
+        writeSample(writer);
+        return result;
+    }
+
+    /**
+     * 获取采集开销等级
+     * 
+     * @return 开销等级
+     */
+    virtual CostClass getCostClass() const {
+        return kCostNormal;
+    }
+
+    /**
+     * 获取采集周期
+     * 
+     * @return 采集周期（毫秒），默认由开销等级决定
+     */
+    virtual int getIntervalMs() const {
+        switch (getCostClass()) {
+            case kCostFast:
+                return 250;
+            case kCostSlow:
+                return 30000;
+            default:
+                return 1000;
+        }
+    }
+
     /**
      * 获取采集器类型
      * 
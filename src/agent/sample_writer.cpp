@@ -0,0 +1,631 @@
+#include "sample_writer.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+JsonTextWriter::JsonTextWriter(std::string& out) : out_(out) {
+    has_item_.reserve(8);
+}
+
+void JsonTextWriter::beginObject(const char* key) {
+    writeKey(key);
+    out_ += '{';
+    has_item_.push_back(false);
+}
+
+void JsonTextWriter::endObject() {
+    out_ += '}';
+    has_item_.pop_back();
+}
+
+void JsonTextWriter::beginArray(const char* key) {
+    writeKey(key);
+    out_ += '[';
+    has_item_.push_back(false);
+}
+
+void JsonTextWriter::endArray() {
+    out_ += ']';
+    has_item_.pop_back();
+}
+
+void JsonTextWriter::writeDouble(const char* key, double value) {
+    writeKey(key);
+    // 与nlohmann::json一致，非有限值输出null
+    if (!std::isfinite(value)) {
+        out_ += "null";
+        return;
+    }
+
+    // 使用nlohmann::json内部的最短往返格式化（Grisu2），输出与dump()完全一致
+    char buffer[64];
+    char* end = nlohmann::detail::to_chars(buffer, buffer + sizeof(buffer), value);
+    out_.append(buffer, static_cast<size_t>(end - buffer));
+}
+
+void JsonTextWriter::writeInt(const char* key, long long value) {
+    writeKey(key);
+    char buffer[24];
+    int length = snprintf(buffer, sizeof(buffer), "%lld", value);
+    out_.append(buffer, static_cast<size_t>(length));
+}
+
+void JsonTextWriter::writeUint(const char* key, unsigned long long value) {
+    writeKey(key);
+    char buffer[24];
+    int length = snprintf(buffer, sizeof(buffer), "%llu", value);
+    out_.append(buffer, static_cast<size_t>(length));
+}
+
+void JsonTextWriter::writeString(const char* key, const std::string& value) {
+    writeKey(key);
+    writeEscaped(value.data(), value.size());
+}
+
+void JsonTextWriter::writeJson(const char* key, const nlohmann::json& value) {
+    writeKey(key);
+    out_ += value.dump();
+}
+
+void JsonTextWriter::writeKey(const char* key) {
+    if (!has_item_.empty()) {
+        if (has_item_.back()) {
+            out_ += ',';
+        }
+        has_item_.back() = true;
+    }
+    if (key) {
+        writeEscaped(key, strlen(key));
+        out_ += ':';
+    }
+}
+
+void JsonTextWriter::writeEscaped(const char* value, size_t length) {
+    static const char kHex[] = "0123456789abcdef";
+
+    out_ += '"';
+    for (size_t i = 0; i < length; ++i) {
+        unsigned char c = static_cast<unsigned char>(value[i]);
+        switch (c) {
+            case '"': out_ += "\\\""; break;
+            case '\\': out_ += "\\\\"; break;
+            case '\n': out_ += "\\n"; break;
+            case '\r': out_ += "\\r"; break;
+            case '\t': out_ += "\\t"; break;
+            default:
+                if (c < 0x20) {
+                    out_ += "\\u00";
+                    out_ += kHex[c >> 4];
+                    out_ += kHex[c & 0x0F];
+                } else {
+                    out_ += static_cast<char>(c);
+                }
+                break;
+        }
+    }
+    out_ += '"';
+}
+
+JsonDomWriter::JsonDomWriter(nlohmann::json& root) {
+    if (!root.is_object()) {
+        root = nlohmann::json::object();
+    }
+    stack_.push_back(&root);
+}
+
+void JsonDomWriter::beginObject(const char* key) {
+    nlohmann::json& object = add(key);
+    object = nlohmann::json::object();
+    stack_.push_back(&object);
+}
+
+void JsonDomWriter::endObject() {
+    stack_.pop_back();
+}
+
+void JsonDomWriter::beginArray(const char* key) {
+    nlohmann::json& array = add(key);
+    array = nlohmann::json::array();
+    stack_.push_back(&array);
+}
+
+void JsonDomWriter::endArray() {
+    stack_.pop_back();
+}
+
+void JsonDomWriter::writeDouble(const char* key, double value) {
+    add(key) = value;
+}
+
+void JsonDomWriter::writeInt(const char* key, long long value) {
+    add(key) = value;
+}
+
+void JsonDomWriter::writeUint(const char* key, unsigned long long value) {
+    add(key) = value;
+}
+
+void JsonDomWriter::writeString(const char* key, const std::string& value) {
+    add(key) = value;
+}
+
+void JsonDomWriter::writeJson(const char* key, const nlohmann::json& value) {
+    add(key) = value;
+}
+
+nlohmann::json& JsonDomWriter::add(const char* key) {
+    nlohmann::json& current = *stack_.back();
+    if (current.is_array()) {
+        current.push_back(nullptr);
+        return current.back();
+    }
+    return current[key];
+}
+
+CborWriter::CborWriter(std::string& out) : out_(out) {
+}
+
+void CborWriter::beginObject(const char* key) {
+    writeKey(key);
+    out_ += '\xBF';
+}
+
+void CborWriter::endObject() {
+    out_ += '\xFF';
+}
+
+void CborWriter::beginArray(const char* key) {
+    writeKey(key);
+    out_ += '\x9F';
+}
+
+void CborWriter::endArray() {
+    out_ += '\xFF';
+}
+
+void CborWriter::writeDouble(const char* key, double value) {
+    writeKey(key);
+    // 与JSON输出一致，非有限值写null
+    if (!std::isfinite(value)) {
+        out_ += '\xF6';
+        return;
+    }
+
+    // 采集值多为百分比和速率，能无损转换为float32时只占5字节
+    float narrow = static_cast<float>(value);
+    if (static_cast<double>(narrow) == value) {
+        uint32_t bits;
+        memcpy(&bits, &narrow, sizeof(bits));
+        out_ += '\xFA';
+        for (int shift = 24; shift >= 0; shift -= 8) {
+            out_ += static_cast<char>((bits >> shift) & 0xFF);
+        }
+        return;
+    }
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    out_ += '\xFB';
+    for (int shift = 56; shift >= 0; shift -= 8) {
+        out_ += static_cast<char>((bits >> shift) & 0xFF);
+    }
+}
+
+void CborWriter::writeInt(const char* key, long long value) {
+    writeKey(key);
+    if (value >= 0) {
+        writeHead(0, static_cast<unsigned long long>(value));
+    } else {
+        writeHead(1, static_cast<unsigned long long>(-(value + 1)));
+    }
+}
+
+void CborWriter::writeUint(const char* key, unsigned long long value) {
+    writeKey(key);
+    writeHead(0, value);
+}
+
+void CborWriter::writeString(const char* key, const std::string& value) {
+    writeKey(key);
+    writeHead(3, value.size());
+    out_ += value;
+}
+
+void CborWriter::writeJson(const char* key, const nlohmann::json& value) {
+    writeKey(key);
+    nlohmann::json::to_cbor(value, nlohmann::detail::output_adapter<char>(out_));
+}
+
+void CborWriter::writeKey(const char* key) {
+    if (key) {
+        size_t length = strlen(key);
+        writeHead(3, length);
+        out_.append(key, length);
+    }
+}
+
+void CborWriter::writeHead(unsigned char major, unsigned long long value) {
+    char type = static_cast<char>(major << 5);
+    if (value < 24) {
+        out_ += static_cast<char>(type | static_cast<char>(value));
+        return;
+    }
+
+    int bytes;
+    if (value <= 0xFF) {
+        out_ += static_cast<char>(type | 24);
+        bytes = 1;
+    } else if (value <= 0xFFFF) {
+        out_ += static_cast<char>(type | 25);
+        bytes = 2;
+    } else if (value <= 0xFFFFFFFFULL) {
+        out_ += static_cast<char>(type | 26);
+        bytes = 4;
+    } else {
+        out_ += static_cast<char>(type | 27);
+        bytes = 8;
+    }
+    for (int shift = (bytes - 1) * 8; shift >= 0; shift -= 8) {
+        out_ += static_cast<char>((value >> shift) & 0xFF);
+    }
+}
+
+MsgPackWriter::MsgPackWriter(std::string& out) : out_(out) {
+    stack_.reserve(8);
+}
+
+void MsgPackWriter::beginObject(const char* key) {
+    writeKey(key);
+    beginContainer('\xDF');
+}
+
+void MsgPackWriter::endObject() {
+    endContainer();
+}
+
+void MsgPackWriter::beginArray(const char* key) {
+    writeKey(key);
+    beginContainer('\xDD');
+}
+
+void MsgPackWriter::endArray() {
+    endContainer();
+}
+
+void MsgPackWriter::writeDouble(const char* key, double value) {
+    writeKey(key);
+    if (!std::isfinite(value)) {
+        out_ += '\xC0';
+        return;
+    }
+
+    float narrow = static_cast<float>(value);
+    if (static_cast<double>(narrow) == value) {
+        uint32_t bits;
+        memcpy(&bits, &narrow, sizeof(bits));
+        out_ += '\xCA';
+        writeBigEndian(bits, 4);
+        return;
+    }
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    out_ += '\xCB';
+    writeBigEndian(bits, 8);
+}
+
+void MsgPackWriter::writeInt(const char* key, long long value) {
+    if (value >= 0) {
+        writeUint(key, static_cast<unsigned long long>(value));
+        return;
+    }
+
+    writeKey(key);
+    if (value >= -32) {
+        out_ += static_cast<char>(value);
+    } else if (value >= -128) {
+        out_ += '\xD0';
+        writeBigEndian(static_cast<unsigned long long>(value), 1);
+    } else if (value >= -32768) {
+        out_ += '\xD1';
+        writeBigEndian(static_cast<unsigned long long>(value), 2);
+    } else if (value >= -2147483648LL) {
+        out_ += '\xD2';
+        writeBigEndian(static_cast<unsigned long long>(value), 4);
+    } else {
+        out_ += '\xD3';
+        writeBigEndian(static_cast<unsigned long long>(value), 8);
+    }
+}
+
+void MsgPackWriter::writeUint(const char* key, unsigned long long value) {
+    writeKey(key);
+    if (value < 128) {
+        out_ += static_cast<char>(value);
+    } else if (value <= 0xFF) {
+        out_ += '\xCC';
+        writeBigEndian(value, 1);
+    } else if (value <= 0xFFFF) {
+        out_ += '\xCD';
+        writeBigEndian(value, 2);
+    } else if (value <= 0xFFFFFFFFULL) {
+        out_ += '\xCE';
+        writeBigEndian(value, 4);
+    } else {
+        out_ += '\xCF';
+        writeBigEndian(value, 8);
+    }
+}
+
+void MsgPackWriter::writeString(const char* key, const std::string& value) {
+    writeKey(key);
+    writeStr(value.data(), value.size());
+}
+
+void MsgPackWriter::writeJson(const char* key, const nlohmann::json& value) {
+    writeKey(key);
+    nlohmann::json::to_msgpack(value, nlohmann::detail::output_adapter<char>(out_));
+}
+
+void MsgPackWriter::writeKey(const char* key) {
+    if (!stack_.empty()) {
+        ++stack_.back().count;
+    }
+    if (key) {
+        writeStr(key, strlen(key));
+    }
+}
+
+void MsgPackWriter::writeStr(const char* value, size_t length) {
+    if (length < 32) {
+        out_ += static_cast<char>(0xA0 | length);
+    } else if (length <= 0xFF) {
+        out_ += '\xD9';
+        writeBigEndian(length, 1);
+    } else if (length <= 0xFFFF) {
+        out_ += '\xDA';
+        writeBigEndian(length, 2);
+    } else {
+        out_ += '\xDB';
+        writeBigEndian(length, 4);
+    }
+    out_.append(value, length);
+}
+
+void MsgPackWriter::beginContainer(char marker) {
+    Container container;
+    container.header_offset = out_.size();
+    container.count = 0;
+    stack_.push_back(container);
+    out_ += marker;
+    out_.append(4, '\0');
+}
+
+void MsgPackWriter::endContainer() {
+    const Container& container = stack_.back();
+    for (int i = 0; i < 4; ++i) {
+        out_[container.header_offset + 1 + i] = static_cast<char>((container.count >> ((3 - i) * 8)) & 0xFF);
+    }
+    stack_.pop_back();
+}
+
+void MsgPackWriter::writeBigEndian(unsigned long long value, int bytes) {
+    for (int shift = (bytes - 1) * 8; shift >= 0; shift -= 8) {
+        out_ += static_cast<char>((value >> shift) & 0xFF);
+    }
+}
+
+DeltaWriter::DeltaWriter(DeltaSample& sample) : sample_(sample) {
+    sample_.schema.clear();
+    sample_.count = 0;
+}
+
+void DeltaWriter::beginObject(const char* key) {
+    writeToken(kDeltaBeginObject, key);
+}
+
+void DeltaWriter::endObject() {
+    sample_.schema += static_cast<char>(kDeltaEndObject);
+}
+
+void DeltaWriter::beginArray(const char* key) {
+    writeToken(kDeltaBeginArray, key);
+}
+
+void DeltaWriter::endArray() {
+    sample_.schema += static_cast<char>(kDeltaEndArray);
+}
+
+void DeltaWriter::writeDouble(const char* key, double value) {
+    if (!std::isfinite(value)) {
+        writeToken(kDeltaNull, key);
+        return;
+    }
+    writeToken(kDeltaDouble, key);
+    memcpy(&addValue(kDeltaDouble).bits, &value, sizeof(value));
+}
+
+void DeltaWriter::writeInt(const char* key, long long value) {
+    writeToken(kDeltaInt, key);
+    addValue(kDeltaInt).bits = static_cast<uint64_t>(value);
+}
+
+void DeltaWriter::writeUint(const char* key, unsigned long long value) {
+    writeToken(kDeltaUint, key);
+    addValue(kDeltaUint).bits = value;
+}
+
+void DeltaWriter::writeString(const char* key, const std::string& value) {
+    writeToken(kDeltaString, key);
+    addValue(kDeltaString).text = value;
+}
+
+void DeltaWriter::writeJson(const char* key, const nlohmann::json& value) {
+    switch (value.type()) {
+        case nlohmann::json::value_t::object:
+            beginObject(key);
+            for (auto it = value.begin(); it != value.end(); ++it) {
+                writeJson(it.key().c_str(), it.value());
+            }
+            endObject();
+            break;
+        case nlohmann::json::value_t::array:
+            beginArray(key);
+            for (const auto& element : value) {
+                writeJson(nullptr, element);
+            }
+            endArray();
+            break;
+        case nlohmann::json::value_t::string:
+            writeString(key, value.get_ref<const std::string&>());
+            break;
+        case nlohmann::json::value_t::boolean:
+            writeToken(kDeltaBool, key);
+            addValue(kDeltaBool).bits = value.get<bool>() ? 1 : 0;
+            break;
+        case nlohmann::json::value_t::number_integer:
+            writeInt(key, value.get<long long>());
+            break;
+        case nlohmann::json::value_t::number_unsigned:
+            writeUint(key, value.get<unsigned long long>());
+            break;
+        case nlohmann::json::value_t::number_float:
+            writeDouble(key, value.get<double>());
+            break;
+        default:
+            writeToken(kDeltaNull, key);
+            break;
+    }
+}
+
+void DeltaWriter::writeToken(DeltaToken token, const char* key) {
+    sample_.schema += static_cast<char>(token);
+    if (key) {
+        size_t length = strlen(key);
+        appendDeltaVarint(sample_.schema, length + 1);
+        sample_.schema.append(key, length);
+    } else {
+        sample_.schema += '\0';
+    }
+}
+
+DeltaValue& DeltaWriter::addValue(DeltaToken type) {
+    if (sample_.count == sample_.values.size()) {
+        sample_.values.emplace_back();
+    }
+    DeltaValue& value = sample_.values[sample_.count++];
+    value.type = static_cast<unsigned char>(type);
+    return value;
+}
+
+const char* wireFormatName(WireFormat format) {
+    switch (format) {
+        case kWireCbor:
+            return "cbor";
+        case kWireMsgPack:
+            return "msgpack";
+        case kWireDelta:
+            return "delta";
+        default:
+            return "json";
+    }
+}
+
+const char* wireContentType(WireFormat format) {
+    switch (format) {
+        case kWireCbor:
+            return "application/cbor";
+        case kWireMsgPack:
+            return "application/msgpack";
+        case kWireDelta:
+            return "application/x-metric-delta";
+        default:
+            return "application/json";
+    }
+}
+
+bool parseWireFormat(const std::string& name, WireFormat& format) {
+    if (name == "json") {
+        format = kWireJson;
+    } else if (name == "cbor") {
+        format = kWireCbor;
+    } else if (name == "msgpack") {
+        format = kWireMsgPack;
+    } else if (name == "delta") {
+        format = kWireDelta;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+WireFormat detectWireFormat(const std::string& encoded) {
+    // 顶层为对象：CBOR的map首字节为0xA0-0xBF，MessagePack的map为0x80-0x8F、0xDE、0xDF，
+    // 增量帧以kDeltaFrameMagic开头，其余按JSON文本处理
+    if (!encoded.empty()) {
+        unsigned char first = static_cast<unsigned char>(encoded[0]);
+        if (first == kDeltaFrameMagic) {
+            return kWireDelta;
+        }
+        if (first == 0xBF || (first & 0xE0) == 0xA0) {
+            return kWireCbor;
+        }
+        if (first == 0xDF || first == 0xDE || (first & 0xF0) == 0x80) {
+            return kWireMsgPack;
+        }
+    }
+    return kWireJson;
+}
+
+void encodeJson(WireFormat format, const nlohmann::json& value, std::string& out) {
+    out.clear();
+    switch (format) {
+        case kWireCbor:
+            nlohmann::json::to_cbor(value, nlohmann::detail::output_adapter<char>(out));
+            break;
+        case kWireMsgPack:
+            nlohmann::json::to_msgpack(value, nlohmann::detail::output_adapter<char>(out));
+            break;
+        default:
+            out = value.dump();
+            break;
+    }
+}
+
+void encodeBatch(WireFormat format, const std::vector<std::string>& items, size_t count, std::string& out) {
+    out.clear();
+    switch (format) {
+        case kWireCbor:
+            // 不定长数组，元素原样拼接
+            out += '\x9F';
+            for (size_t i = 0; i < count; ++i) {
+                out += items[i];
+            }
+            out += '\xFF';
+            break;
+        case kWireMsgPack:
+            // array32头后原样拼接元素
+            out += '\xDD';
+            for (int shift = 24; shift >= 0; shift -= 8) {
+                out += static_cast<char>((count >> shift) & 0xFF);
+            }
+            for (size_t i = 0; i < count; ++i) {
+                out += items[i];
+            }
+            break;
+        case kWireDelta:
+            // 帧自带长度，直接拼接
+            for (size_t i = 0; i < count; ++i) {
+                out += items[i];
+            }
+            break;
+        default:
+            out += '[';
+            for (size_t i = 0; i < count; ++i) {
+                if (i > 0) {
+                    out += ',';
+                }
+                out += items[i];
+            }
+            out += ']';
+            break;
+    }
+}
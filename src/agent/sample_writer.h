@@ -0,0 +1,397 @@
+#ifndef SAMPLE_WRITER_H
+#define SAMPLE_WRITER_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+#include "utils/metric_delta.h"
+
+/**
+ * SampleWriter抽象基类 - 采集样本的序列化接口
+ * 
+ * 采集器把类型化的样本逐字段写给SampleWriter，由具体实现决定输出格式，
+ * 字段列表只在采集器中定义一次。key为nullptr表示数组元素
+ */
+class SampleWriter {
+public:
+    /**
+     * 析构函数
+     */
+    virtual ~SampleWriter() = default;
+
+    /**
+     * 开始一个对象
+     * 
+     * @param key 字段名，数组元素为nullptr
+     */
+    virtual void beginObject(const char* key) = 0;
+
+    /**
+     * 结束当前对象
+     */
+    virtual void endObject() = 0;
+
+    /**
+     * 开始一个数组
+     * 
+     * @param key 字段名，数组元素为nullptr
+     */
+    virtual void beginArray(const char* key) = 0;
+
+    /**
+     * 结束当前数组
+     */
+    virtual void endArray() = 0;
+
+    /**
+     * 写入浮点数字段
+     * 
+     * @param key 字段名
+     * @param value 字段值
+     */
+    virtual void writeDouble(const char* key, double value) = 0;
+
+    /**
+     * 写入有符号整数字段
+     * 
+     * @param key 字段名
+     * @param value 字段值
+     */
+    virtual void writeInt(const char* key, long long value) = 0;
+
+    /**
+     * 写入无符号整数字段（字节数、计数等）
+     * 
+     * @param key 字段名
+     * @param value 字段值
+     */
+    virtual void writeUint(const char* key, unsigned long long value) = 0;
+
+    /**
+     * 写入字符串字段
+     * 
+     * @param key 字段名
+     * @param value 字段值
+     */
+    virtual void writeString(const char* key, const std::string& value) = 0;
+
+    /**
+     * 写入已有的JSON值（如组件状态），按输出格式编码
+     * 
+     * @param key 字段名
+     * @param value JSON值
+     */
+    virtual void writeJson(const char* key, const nlohmann::json& value) = 0;
+};
+
+/**
+ * JsonTextWriter类 - 直接输出JSON文本
+ * 
+ * 追加写入调用方复用的字符串，不构建中间的JSON对象，用于上报时一次性序列化
+ */
+class JsonTextWriter : public SampleWriter {
+public:
+    /**
+     * 构造函数
+     * 
+     * @param out 输出字符串，内容追加在末尾
+     */
+    explicit JsonTextWriter(std::string& out);
+
+    void beginObject(const char* key) override;
+    void endObject() override;
+    void beginArray(const char* key) override;
+    void endArray() override;
+    void writeDouble(const char* key, double value) override;
+    void writeInt(const char* key, long long value) override;
+    void writeUint(const char* key, unsigned long long value) override;
+    void writeString(const char* key, const std::string& value) override;
+    void writeJson(const char* key, const nlohmann::json& value) override;
+
+private:
+    /**
+     * 写入逗号分隔符和字段名
+     * 
+     * @param key 字段名，数组元素为nullptr
+     */
+    void writeKey(const char* key);
+
+    /**
+     * 写入带引号和转义的字符串
+     * 
+     * @param value 字符串
+     * @param length 字符串长度
+     */
+    void writeEscaped(const char* value, size_t length);
+
+private:
+    std::string& out_;                  // 输出字符串
+    std::vector<bool> has_item_;        // 每层对象/数组是否已写入元素，用于插入逗号
+};
+
+/**
+ * JsonDomWriter类 - 构建nlohmann::json对象
+ * 
+ * 兼容原有collect()接口和manager侧按JSON处理的调用方
+ */
+class JsonDomWriter : public SampleWriter {
+public:
+    /**
+     * 构造函数
+     * 
+     * @param root 输出的JSON对象，字段写入其中
+     */
+    explicit JsonDomWriter(nlohmann::json& root);
+
+    void beginObject(const char* key) override;
+    void endObject() override;
+    void beginArray(const char* key) override;
+    void endArray() override;
+    void writeDouble(const char* key, double value) override;
+    void writeInt(const char* key, long long value) override;
+    void writeUint(const char* key, unsigned long long value) override;
+    void writeString(const char* key, const std::string& value) override;
+    void writeJson(const char* key, const nlohmann::json& value) override;
+
+private:
+    /**
+     * 在当前对象/数组中添加一个元素
+     * 
+     * @param key 字段名，数组元素为nullptr
+     * @return 新元素的引用
+     */
+    nlohmann::json& add(const char* key);
+
+private:
+    std::vector<nlohmann::json*> stack_;    // 当前所在的对象/数组
+};
+
+/**
+ * CborWriter类 - 直接输出CBOR（RFC 8949）
+ * 
+ * 对象和数组使用不定长编码（结束时写0xFF），无需回填元素个数；
+ * 整数按最短编码，浮点数能无损表示为float32时写4字节，否则写8字节
+ */
+class CborWriter : public SampleWriter {
+public:
+    /**
+     * 构造函数
+     * 
+     * @param out 输出缓冲区，内容追加在末尾
+     */
+    explicit CborWriter(std::string& out);
+
+    void beginObject(const char* key) override;
+    void endObject() override;
+    void beginArray(const char* key) override;
+    void endArray() override;
+    void writeDouble(const char* key, double value) override;
+    void writeInt(const char* key, long long value) override;
+    void writeUint(const char* key, unsigned long long value) override;
+    void writeString(const char* key, const std::string& value) override;
+    void writeJson(const char* key, const nlohmann::json& value) override;
+
+private:
+    /**
+     * 写入字段名，数组元素不写
+     * 
+     * @param key 字段名，数组元素为nullptr
+     */
+    void writeKey(const char* key);
+
+    /**
+     * 写入主类型和长度/数值，按最短编码
+     * 
+     * @param major 主类型（0-7）
+     * @param value 长度或数值
+     */
+    void writeHead(unsigned char major, unsigned long long value);
+
+private:
+    std::string& out_;                  // 输出缓冲区
+};
+
+/**
+ * MsgPackWriter类 - 直接输出MessagePack
+ * 
+ * MessagePack没有不定长容器，对象和数组先写4字节长度的map32/array32头，
+ * 结束时回填实际元素个数；标量编码规则与CborWriter相同
+ */
+class MsgPackWriter : public SampleWriter {
+public:
+    /**
+     * 构造函数
+     * 
+     * @param out 输出缓冲区，内容追加在末尾
+     */
+    explicit MsgPackWriter(std::string& out);
+
+    void beginObject(const char* key) override;
+    void endObject() override;
+    void beginArray(const char* key) override;
+    void endArray() override;
+    void writeDouble(const char* key, double value) override;
+    void writeInt(const char* key, long long value) override;
+    void writeUint(const char* key, unsigned long long value) override;
+    void writeString(const char* key, const std::string& value) override;
+    void writeJson(const char* key, const nlohmann::json& value) override;
+
+private:
+    /**
+     * 为当前对象/数组计数并写入字段名
+     * 
+     * @param key 字段名，数组元素为nullptr
+     */
+    void writeKey(const char* key);
+
+    /**
+     * 写入字符串（fixstr/str8/str16/str32）
+     * 
+     * @param value 字符串
+     * @param length 字符串长度
+     */
+    void writeStr(const char* value, size_t length);
+
+    /**
+     * 开始对象或数组，写入占位的头
+     * 
+     * @param marker 0xdf（map32）或0xdd（array32）
+     */
+    void beginContainer(char marker);
+
+    /**
+     * 结束对象或数组，回填元素个数
+     */
+    void endContainer();
+
+    /**
+     * 按大端序写入无符号整数
+     * 
+     * @param value 数值
+     * @param bytes 字节数
+     */
+    void writeBigEndian(unsigned long long value, int bytes);
+
+private:
+    /**
+     * 一层未结束的对象/数组
+     */
+    struct Container {
+        size_t header_offset;           // 头在输出中的位置
+        uint32_t count;                 // 已写入的元素（键值对）个数
+    };
+
+    std::string& out_;                  // 输出缓冲区
+    std::vector<Container> stack_;      // 未结束的对象/数组
+};
+
+/**
+ * DeltaWriter类 - 拆分出结构和值，供DeltaEncoder增量编码
+ * 
+ * 字段名和类型追加到结构中，数值和字符串按顺序放入值列表；
+ * 非有限的浮点数与JSON输出一致记为null，只出现在结构中
+ */
+class DeltaWriter : public SampleWriter {
+public:
+    /**
+     * 构造函数
+     * 
+     * @param sample 输出的结构和值，构造时清空，值的缓冲区复用
+     */
+    explicit DeltaWriter(DeltaSample& sample);
+
+    void beginObject(const char* key) override;
+    void endObject() override;
+    void beginArray(const char* key) override;
+    void endArray() override;
+    void writeDouble(const char* key, double value) override;
+    void writeInt(const char* key, long long value) override;
+    void writeUint(const char* key, unsigned long long value) override;
+    void writeString(const char* key, const std::string& value) override;
+    void writeJson(const char* key, const nlohmann::json& value) override;
+
+private:
+    /**
+     * 在结构中追加一个记号和字段名
+     * 
+     * @param token 记号
+     * @param key 字段名，数组元素为nullptr
+     */
+    void writeToken(DeltaToken token, const char* key);
+
+    /**
+     * 在值列表末尾取一个值
+     * 
+     * @param type 值的类型
+     * @return 值的引用
+     */
+    DeltaValue& addValue(DeltaToken type);
+
+private:
+    DeltaSample& sample_;               // 输出的结构和值
+};
+
+/**
+ * 上报的编码格式
+ */
+enum WireFormat {
+    kWireJson,          // JSON文本，application/json
+    kWireCbor,          // CBOR，application/cbor
+    kWireMsgPack,       // MessagePack，application/msgpack
+    kWireDelta          // 增量编码（见utils/metric_delta.h），application/x-metric-delta，只用于上报
+};
+
+/**
+ * 获取编码格式的名称
+ * 
+ * @param format 编码格式
+ * @return 名称（json、cbor、msgpack、delta）
+ */
+const char* wireFormatName(WireFormat format);
+
+/**
+ * 获取编码格式对应的Content-Type
+ * 
+ * @param format 编码格式
+ * @return Content-Type
+ */
+const char* wireContentType(WireFormat format);
+
+/**
+ * 按名称解析编码格式
+ * 
+ * @param name 名称（json、cbor、msgpack、delta）
+ * @param format 输出参数
+ * @return 名称无效时返回false
+ */
+bool parseWireFormat(const std::string& name, WireFormat& format);
+
+/**
+ * 根据首字节判断已编码上报的格式，用于暂存区中可能混有不同格式的上报
+ * 
+ * @param encoded 已编码的上报（顶层为对象）
+ * @return 编码格式
+ */
+WireFormat detectWireFormat(const std::string& encoded);
+
+/**
+ * 按指定格式编码JSON值
+ * 
+ * @param format 编码格式，增量编码有状态，按JSON输出
+ * @param value JSON值
+ * @param out 输出缓冲区，内容被覆盖
+ */
+void encodeJson(WireFormat format, const nlohmann::json& value, std::string& out);
+
+/**
+ * 把若干条已编码的上报拼接成指定格式的数组，不重新编码
+ * 
+ * @param format 编码格式，各上报须为同一格式
+ * @param items 已编码的上报
+ * @param count 条数
+ * @param out 输出缓冲区，内容被覆盖
+ */
+void encodeBatch(WireFormat format, const std::vector<std::string>& items, size_t count, std::string& out);
+
+#endif // SAMPLE_WRITER_H
@@ -23,6 +23,33 @@ bool SFTPClient::parseUrl(const std::string& url, std::string& user, std::string
 }
 
 bool SFTPClient::downloadFile(const std::string& url, const std::string& local_path, std::string& err_msg) {
+    std::ofstream ofs;
+    bool opened = false;
+    bool ok = download(url, [&](const char* data, size_t size) {
+        // 远程文件打开成功后才创建本地文件
+        if (!opened) {
+            opened = true;
+            ofs.open(local_path, std::ios::binary);
+            if (!ofs) {
+                err_msg = "无法创建本地文件: " + local_path;
+                return false;
+            }
+        }
+        ofs.write(data, size);
+        return static_cast<bool>(ofs);
+    }, err_msg);
+    if (ok && !opened) {
+        // 远程文件为空
+        ofs.open(local_path, std::ios::binary);
+        ok = static_cast<bool>(ofs);
+        if (!ok) {
+            err_msg = "无法创建本地文件: " + local_path;
+        }
+    }
+    return ok;
+}
+
+bool SFTPClient::download(const std::string& url, const std::function<bool(const char*, size_t)>& sink, std::string& err_msg) {
     std::string user, pass, host, remote_path;
     int port = 22;
     if (!parseUrl(url, user, pass, host, port, remote_path)) {
@@ -70,30 +97,28 @@ bool SFTPClient::downloadFile(const std::string& url, const std::string& local_p
         ssh_free(session);
         return false;
     }
-    std::ofstream ofs(local_path, std::ios::binary);
-    if (!ofs) {
-        err_msg = "无法创建本地文件: " + local_path;
-        sftp_close(file);
-        sftp_free(sftp);
-        ssh_disconnect(session);
-        ssh_free(session);
-        return false;
-    }
-    char buffer[4096];
+    char buffer[32768];
     int nbytes;
     while ((nbytes = sftp_read(file, buffer, sizeof(buffer))) > 0) {
-        ofs.write(buffer, nbytes);
+        if (!sink(buffer, static_cast<size_t>(nbytes))) {
+            if (err_msg.empty()) {
+                err_msg = "下载已中止";
+            }
+            sftp_close(file);
+            sftp_free(sftp);
+            ssh_disconnect(session);
+            ssh_free(session);
+            return false;
+        }
     }
     if (nbytes < 0) {
         err_msg = "SFTP读取失败: " + std::to_string(sftp_get_error(sftp));
-        ofs.close();
         sftp_close(file);
         sftp_free(sftp);
         ssh_disconnect(session);
         ssh_free(session);
         return false;
     }
-    ofs.close();
     sftp_close(file);
     sftp_free(sftp);
     ssh_disconnect(session);
@@ -0,0 +1,113 @@
+#ifndef SINGLEFLIGHT_H
+#define SINGLEFLIGHT_H
+
+#include <string>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <functional>
+#include <condition_variable>
+#include <cstddef>
+
+/**
+ * Singleflight类 - 合并同一key的并发调用
+ *
+ * 同一key同时只执行一次函数：第一个调用者执行，执行期间到达的调用者等待并得到同一结果。
+ * 执行结束后key即被释放，之后的调用重新执行，结果不缓存。
+ * 用于合并同时部署同一制品时的下载。Result须可默认构造和拷贝
+ */
+template <typename Result>
+class Singleflight {
+public:
+    Singleflight() : shared_(0) {
+    }
+
+    Singleflight(const Singleflight&) = delete;
+    Singleflight& operator=(const Singleflight&) = delete;
+
+    /**
+     * 执行fn，同一key已在执行时等待其结果
+     *
+     * @param key 合并的依据
+     * @param fn 要执行的函数，抛出异常时等待者得到默认构造的结果，异常继续抛给执行者
+     * @param shared 输出参数，结果是否来自其他调用者的执行
+     * @return 结果
+     */
+    Result run(const std::string& key, const std::function<Result()>& fn, bool& shared) {
+        std::shared_ptr<Call> call;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            auto it = calls_.find(key);
+            if (it != calls_.end()) {
+                call = it->second;
+                ++shared_;
+                call->done_cv.wait(lock, [&call]() { return call->done; });
+                shared = true;
+                return call->result;
+            }
+            call = std::make_shared<Call>();
+            calls_[key] = call;
+        }
+
+        shared = false;
+        Result result;
+        try {
+            result = fn();
+        } catch (...) {
+            finish(key, call, Result());
+            throw;
+        }
+        finish(key, call, result);
+        return result;
+    }
+
+    /**
+     * 获取正在执行的key数
+     *
+     * @return key数
+     */
+    size_t inFlight() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return calls_.size();
+    }
+
+    /**
+     * 获取等待并共享了其他调用者结果的调用数
+     *
+     * @return 调用数
+     */
+    unsigned long long sharedCount() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return shared_;
+    }
+
+private:
+    /**
+     * 一次正在执行的调用
+     */
+    struct Call {
+        Call() : done(false) {
+        }
+
+        bool done;                              // 是否已执行完
+        Result result;                          // 执行结果
+        std::condition_variable done_cv;        // 执行完时唤醒等待者
+    };
+
+    void finish(const std::string& key, const std::shared_ptr<Call>& call, const Result& result) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            call->result = result;
+            call->done = true;
+            calls_.erase(key);
+        }
+        call->done_cv.notify_all();
+    }
+
+private:
+    std::map<std::string, std::shared_ptr<Call>> calls_;    // 正在执行的调用，key为合并依据
+    unsigned long long shared_;                              // 共享了结果的调用数
+    mutable std::mutex mutex_;
+};
+
+#endif // SINGLEFLIGHT_H
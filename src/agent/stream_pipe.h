@@ -0,0 +1,143 @@
+#ifndef STREAM_PIPE_H
+#define STREAM_PIPE_H
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <mutex>
+#include <condition_variable>
+#include <cstddef>
+#include <cstring>
+
+/**
+ * StreamPipe类 - 有界内存管道
+ * 
+ * 一个线程写入（如下载），另一个线程读取（如作为请求体发送），两者同时进行，数据不落盘。
+ * 环形缓冲区满时写入方等待，空时读取方等待；任一方关闭后另一方不再阻塞。
+ * 每个传输使用自己的管道，并发传输互不影响
+ */
+class StreamPipe {
+public:
+    /**
+     * 构造函数
+     * 
+     * @param capacity 缓冲区大小（字节）
+     */
+    explicit StreamPipe(size_t capacity)
+        : buffer_(capacity > 0 ? capacity : 1), head_(0), size_(0),
+          write_closed_(false), read_closed_(false), bytes_(0) {
+    }
+
+    StreamPipe(const StreamPipe&) = delete;
+    StreamPipe& operator=(const StreamPipe&) = delete;
+
+    /**
+     * 写入数据，缓冲区满时等待读取方取走
+     * 
+     * @param data 数据
+     * @param size 长度
+     * @return 读取方已关闭时返回false，写入方应停止
+     */
+    bool write(const char* data, size_t size) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (size > 0) {
+            writable_.wait(lock, [this]() { return read_closed_ || size_ < buffer_.size(); });
+            if (read_closed_) {
+                return false;
+            }
+            // 一次最多写到缓冲区末尾，剩余部分下一轮从开头写
+            size_t tail = (head_ + size_) % buffer_.size();
+            size_t length = std::min(size, std::min(buffer_.size() - size_, buffer_.size() - tail));
+            memcpy(&buffer_[tail], data, length);
+            size_ += length;
+            bytes_ += length;
+            data += length;
+            size -= length;
+            readable_.notify_one();
+        }
+        return true;
+    }
+
+    /**
+     * 读取数据，缓冲区空时等待写入方写入
+     * 
+     * @param data 输出缓冲区
+     * @param size 最多读取的长度
+     * @return 读取的长度，写入方已关闭且数据已读完时返回0
+     */
+    size_t read(char* data, size_t size) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        readable_.wait(lock, [this]() { return write_closed_ || size_ > 0; });
+        size_t length = std::min(size, std::min(size_, buffer_.size() - head_));
+        memcpy(data, &buffer_[head_], length);
+        head_ = (head_ + length) % buffer_.size();
+        size_ -= length;
+        writable_.notify_one();
+        return length;
+    }
+
+    /**
+     * 写入方结束
+     * 
+     * @param error 错误信息，为空表示数据完整
+     */
+    void closeWrite(const std::string& error = "") {
+        std::lock_guard<std::mutex> lock(mutex_);
+        write_closed_ = true;
+        error_ = error;
+        readable_.notify_all();
+    }
+
+    /**
+     * 读取方结束，之后的写入立即返回false
+     */
+    void closeRead() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        read_closed_ = true;
+        writable_.notify_all();
+    }
+
+    /**
+     * 写入方是否以错误结束
+     * 
+     * @return 是否失败
+     */
+    bool failed() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return write_closed_ && !error_.empty();
+    }
+
+    /**
+     * 获取写入方的错误信息
+     * 
+     * @return 错误信息
+     */
+    std::string error() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return error_;
+    }
+
+    /**
+     * 获取累计写入的字节数
+     * 
+     * @return 字节数
+     */
+    unsigned long long bytes() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return bytes_;
+    }
+
+private:
+    std::vector<char> buffer_;              // 环形缓冲区
+    size_t head_;                           // 第一个未读字节的位置
+    size_t size_;                           // 未读字节数
+    bool write_closed_;                     // 写入方是否已结束
+    bool read_closed_;                      // 读取方是否已结束
+    std::string error_;                     // 写入方的错误信息
+    unsigned long long bytes_;              // 累计写入的字节数
+    mutable std::mutex mutex_;
+    std::condition_variable readable_;      // 有数据可读或写入方结束
+    std::condition_variable writable_;      // 有空间可写或读取方结束
+};
+
+#endif // STREAM_PIPE_H
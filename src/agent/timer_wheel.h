@@ -0,0 +1,87 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * TimerWheel类 - 单层哈希时间轮
+ * 
+ * 以固定tick推进，定时器按到期tick散列到槽位，超过一圈的定时器记录剩余圈数。
+ * 添加和到期都是O(1)，不负责计时，由调用方按tick调用advanceTo()
+ */
+class TimerWheel {
+public:
+    /**
+     * 构造函数
+     * 
+     * @param slot_count 槽位数
+     */
+    explicit TimerWheel(size_t slot_count = 64)
+        : slots_(slot_count > 0 ? slot_count : 1), current_tick_(0) {
+    }
+
+    /**
+     * 添加定时器
+     * 
+     * @param id 定时器标识，到期时原样返回
+     * @param delay_ticks 从当前tick起的延迟，至少为1
+     */
+    void schedule(int id, uint64_t delay_ticks) {
+        if (delay_ticks == 0) {
+            delay_ticks = 1;
+        }
+        // 第一次经过目标槽位时已走过(delay-1)%n+1个tick，之后每圈n个tick
+        Entry entry = {id, (delay_ticks - 1) / slots_.size()};
+        slots_[(current_tick_ + delay_ticks) % slots_.size()].push_back(entry);
+    }
+
+    /**
+     * 推进到指定tick，收集期间到期的定时器
+     * 
+     * 落后多个tick时一次推进完，每个定时器最多到期一次，重新调度由调用方负责
+     * 
+     * @param tick 目标tick
+     * @param expired 输出参数，追加到期的定时器标识
+     */
+    void advanceTo(uint64_t tick, std::vector<int>& expired) {
+        while (current_tick_ < tick) {
+            ++current_tick_;
+            std::vector<Entry>& slot = slots_[current_tick_ % slots_.size()];
+            for (size_t i = 0; i < slot.size();) {
+                if (slot[i].rounds == 0) {
+                    expired.push_back(slot[i].id);
+                    slot[i] = slot.back();
+                    slot.pop_back();
+                } else {
+                    --slot[i].rounds;
+                    ++i;
+                }
+            }
+        }
+    }
+
+    /**
+     * 获取当前tick
+     * 
+     * @return 当前tick
+     */
+    uint64_t currentTick() const {
+        return current_tick_;
+    }
+
+private:
+    /**
+     * 槽位中的一个定时器
+     */
+    struct Entry {
+        int id;                                 // 定时器标识
+        uint64_t rounds;                        // 到期前还需经过本槽位的圈数
+    };
+
+    std::vector<std::vector<Entry>> slots_;     // 各槽位的定时器
+    uint64_t current_tick_;                     // 已推进到的tick
+};
+
+#endif // TIMER_WHEEL_H
@@ -0,0 +1,132 @@
+#include "udp_report_sender.h"
+#include "sample_writer.h"
+#include "utils/udp_report.h"
+#include "utils/http_compression.h"
+#include "utils/logger.h"
+#include <cstring>
+#include <random>
+#include <netdb.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+namespace {
+
+// 超过数据报上限的上报的压缩级别，上报为几KB，压缩耗时在百微秒量级
+const int kUdpGzipLevel = 6;
+
+}
+
+UdpReportSender::UdpReportSender(const std::string& host, int port)
+    : host_(host),
+      port_(port),
+      fd_(-1),
+      session_(0),
+      seq_(0),
+      sent_(0),
+      compressed_count_(0),
+      bytes_(0),
+      too_large_(0),
+      failed_(0) {
+    std::random_device device;
+    session_ = (static_cast<uint64_t>(device()) << 32) | device();
+}
+
+UdpReportSender::~UdpReportSender() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+bool UdpReportSender::open() {
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    struct addrinfo* result = nullptr;
+    std::string port = std::to_string(port_);
+    int ret = getaddrinfo(host_.c_str(), port.c_str(), &hints, &result);
+    if (ret != 0) {
+        LOG_ERROR("Failed to resolve {} for UDP reports: {}", host_, gai_strerror(ret));
+        return false;
+    }
+
+    // 连接UDP套接字：send不必每次带地址，Manager端口不可达的ICMP错误也能在下次send时返回
+    for (struct addrinfo* addr = result; addr; addr = addr->ai_next) {
+        int fd = socket(addr->ai_family, addr->ai_socktype | SOCK_CLOEXEC, addr->ai_protocol);
+        if (fd < 0) {
+            continue;
+        }
+        if (connect(fd, addr->ai_addr, addr->ai_addrlen) == 0) {
+            fd_ = fd;
+            break;
+        }
+        ::close(fd);
+    }
+    freeaddrinfo(result);
+
+    if (fd_ < 0) {
+        LOG_ERROR("Failed to create UDP report socket to {}:{}: {}", host_, port_, strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+UdpReportSender::Result UdpReportSender::send(const std::string& report) {
+    UdpReportHeader header;
+    switch (detectWireFormat(report)) {
+    case kWireJson:
+        header.format = kUdpFormatJson;
+        break;
+    case kWireCbor:
+        header.format = kUdpFormatCbor;
+        break;
+    case kWireMsgPack:
+        header.format = kUdpFormatMsgPack;
+        break;
+    default:
+        // 增量帧丢失后要靠HTTP响应通知发送关键帧，不能用UDP发送
+        ++too_large_;
+        return kUdpTooLarge;
+    }
+
+    // 放不下时压缩，仍放不下则交给HTTP
+    const std::string* payload = &report;
+    if (kUdpReportHeaderSize + report.size() > kUdpReportMaxDatagram) {
+        if (!gzipCompress(report.data(), report.size(), kUdpGzipLevel, compressed_) ||
+            kUdpReportHeaderSize + compressed_.size() > kUdpReportMaxDatagram) {
+            ++too_large_;
+            return kUdpTooLarge;
+        }
+        header.flags |= kUdpFlagGzip;
+        payload = &compressed_;
+    }
+
+    // 发送失败的数据报同样占用序号，Manager按丢失统计
+    header.session = session_;
+    header.seq = seq_++;
+    datagram_.clear();
+    appendUdpReportHeader(datagram_, header);
+    datagram_.append(*payload);
+
+    ssize_t written = ::send(fd_, datagram_.data(), datagram_.size(), MSG_DONTWAIT | MSG_NOSIGNAL);
+    if (written != static_cast<ssize_t>(datagram_.size())) {
+        ++failed_;
+        return kUdpFailed;
+    }
+    ++sent_;
+    bytes_ += datagram_.size();
+    if (header.flags & kUdpFlagGzip) {
+        ++compressed_count_;
+    }
+    return kUdpSent;
+}
+
+UdpReportSender::Stats UdpReportSender::getStats() const {
+    Stats stats;
+    stats.sent = sent_;
+    stats.compressed = compressed_count_;
+    stats.bytes = bytes_;
+    stats.too_large = too_large_;
+    stats.failed = failed_;
+    return stats;
+}
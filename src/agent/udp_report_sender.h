@@ -0,0 +1,91 @@
+#ifndef UDP_REPORT_SENDER_H
+#define UDP_REPORT_SENDER_H
+
+#include <string>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * UdpReportSender类 - UDP上报发送
+ * 
+ * 每条上报作为一个数据报发给Manager的UDP端口，不等待确认，发送失败不重试也不暂存。
+ * 超过数据报上限的上报先gzip压缩，仍放不下时返回kUdpTooLarge，由调用方改走HTTP。
+ * 格式见utils/udp_report.h。只由发送线程调用send，统计接口可在其他线程调用
+ */
+class UdpReportSender {
+public:
+    /**
+     * 发送结果
+     */
+    enum Result {
+        kUdpSent,           // 已交给内核发送
+        kUdpTooLarge,       // 压缩后仍超过数据报上限，或编码不能用UDP发送，需改走HTTP
+        kUdpFailed          // 发送失败，上报丢弃
+    };
+
+    /**
+     * 发送统计
+     */
+    struct Stats {
+        unsigned long long sent;            // 发送的数据报数
+        unsigned long long compressed;      // 其中压缩后发送的数据报数
+        unsigned long long bytes;           // 发送的数据报字节数
+        unsigned long long too_large;       // 放不下、改走HTTP的上报数
+        unsigned long long failed;          // 发送失败丢弃的上报数
+    };
+
+    /**
+     * 构造函数
+     * 
+     * @param host Manager主机
+     * @param port Manager的UDP上报端口
+     */
+    UdpReportSender(const std::string& host, int port);
+
+    /**
+     * 析构函数，关闭套接字
+     */
+    ~UdpReportSender();
+
+    UdpReportSender(const UdpReportSender&) = delete;
+    UdpReportSender& operator=(const UdpReportSender&) = delete;
+
+    /**
+     * 解析Manager地址并创建已连接的UDP套接字
+     * 
+     * @return 是否成功
+     */
+    bool open();
+
+    /**
+     * 发送一条上报
+     * 
+     * @param report 编码后的上报（JSON、CBOR或MessagePack）
+     * @return 发送结果
+     */
+    Result send(const std::string& report);
+
+    /**
+     * 获取发送统计
+     * 
+     * @return 发送统计
+     */
+    Stats getStats() const;
+
+private:
+    std::string host_;                              // Manager主机
+    int port_;                                      // Manager的UDP上报端口
+    int fd_;                                        // 已连接的UDP套接字
+    uint64_t session_;                              // 会话标识，每次启动随机生成
+    uint64_t seq_;                                  // 下一个数据报的序号
+    std::string datagram_;                          // 复用的数据报缓冲区
+    std::string compressed_;                        // 复用的压缩缓冲区
+
+    std::atomic<unsigned long long> sent_;          // 发送的数据报数
+    std::atomic<unsigned long long> compressed_count_; // 压缩后发送的数据报数
+    std::atomic<unsigned long long> bytes_;         // 发送的数据报字节数
+    std::atomic<unsigned long long> too_large_;     // 改走HTTP的上报数
+    std::atomic<unsigned long long> failed_;        // 发送失败的上报数
+};
+
+#endif // UDP_REPORT_SENDER_H
@@ -11,7 +11,19 @@ int main(int argc, char* argv[]) {
     // 默认参数
     std::string manager_url = "http://localhost:8080";
     std::string hostname = "";
-    int collection_interval_sec = 5;
+    int collection_interval_sec = 15;
+    int sample_interval_ms = 0;
+    std::string spool_dir = "report_spool";
+    int spool_max_mb = 64;
+    int replay_rate = 5;
+    int batch_size = 1;
+    WireFormat report_format = kWireJson;
+    int compress_level = 0;
+    int compress_threshold = 1024;
+    int heartbeat_interval_ms = 1000;
+    bool udp_transport = false;
+    std::string shm_path = "";
+    int artifact_cache_mb = 4096;
     
     // 解析命令行参数
     for (int i = 1; i < argc; i++) {
@@ -22,19 +34,71 @@ int main(int argc, char* argv[]) {
             hostname = argv[++i];
         } else if (arg == "--interval" && i + 1 < argc) {
             collection_interval_sec = std::atoi(argv[++i]);
+        } else if (arg == "--sample-interval-ms" && i + 1 < argc) {
+            sample_interval_ms = std::atoi(argv[++i]);
+        } else if (arg == "--spool-dir" && i + 1 < argc) {
+            spool_dir = argv[++i];
+        } else if (arg == "--spool-max-mb" && i + 1 < argc) {
+            spool_max_mb = std::atoi(argv[++i]);
+        } else if (arg == "--replay-rate" && i + 1 < argc) {
+            replay_rate = std::atoi(argv[++i]);
+        } else if (arg == "--batch-size" && i + 1 < argc) {
+            batch_size = std::atoi(argv[++i]);
+        } else if (arg == "--report-format" && i + 1 < argc) {
+            if (!parseWireFormat(argv[++i], report_format)) {
+                LOG_ERROR("Unknown report format: {}", argv[i]);
+                return 1;
+            }
+        } else if (arg == "--compress-level" && i + 1 < argc) {
+            compress_level = std::atoi(argv[++i]);
+        } else if (arg == "--compress-threshold" && i + 1 < argc) {
+            compress_threshold = std::atoi(argv[++i]);
+        } else if (arg == "--heartbeat-interval-ms" && i + 1 < argc) {
+            heartbeat_interval_ms = std::atoi(argv[++i]);
+        } else if (arg == "--transport" && i + 1 < argc) {
+            std::string transport = argv[++i];
+            if (transport != "http" && transport != "udp") {
+                LOG_ERROR("Unknown transport: {}", transport);
+                return 1;
+            }
+            udp_transport = transport == "udp";
+        } else if (arg == "--shm-path" && i + 1 < argc) {
+            shm_path = argv[++i];
+        } else if (arg == "--artifact-cache-mb" && i + 1 < argc) {
+            artifact_cache_mb = std::atoi(argv[++i]);
         } else if (arg == "--help") {
             LOG_INFO("Usage: agent [options]");
             LOG_INFO("Options:");
             LOG_INFO("  --manager-url <url>    Manager URL (default: http://localhost:8080)");
             LOG_INFO("  --hostname <name>      Override hostname");
-            LOG_INFO("  --interval <seconds>   Collection interval in seconds (default: 5)");
+            LOG_INFO("  --interval <seconds>   Report interval in seconds, at most 5 without heartbeats (default: 15)");
+            LOG_INFO("  --sample-interval-ms <ms>  Period of fast collectors (cpu, memory, pressure) in ms (default: 250; normal 1000, slow 30000)");
+            LOG_INFO("  --spool-dir <dir>      Directory spooling reports while Manager is unreachable, empty to disable (default: report_spool)");
+            LOG_INFO("  --spool-max-mb <mb>    Maximum spool size in MB, oldest reports dropped beyond it (default: 64)");
+            LOG_INFO("  --replay-rate <n>      Maximum spooled reports replayed per second (default: 5)");
+            LOG_INFO("  --batch-size <n>       Send queued reports to /api/report/batch up to n at a time (default: 1, one request per report)");
+            LOG_INFO("  --report-format <fmt>  Encoding of registration and reports: json, cbor, msgpack or delta (changed fields only, keyframe every 60 reports), json if Manager lacks support (default: json)");
+            LOG_INFO("  --compress-level <n>   gzip level 1-9 for request bodies sent to Manager, 0 to disable (default: 0)");
+            LOG_INFO("  --compress-threshold <bytes>  Minimum request body size to compress (default: 1024)");
+            LOG_INFO("  --heartbeat-interval-ms <ms>  Heartbeat interval for liveness, 0 to rely on reports only (default: 1000)");
+            LOG_INFO("  --transport <t>        Report transport: http, or udp (one unacknowledged datagram per report, HTTP for registration, heartbeats, commands and reports that do not fit) (default: http)");
+            LOG_INFO("  --shm-path <path>      Publish latest cpu, memory and component samples to this shared memory file for local readers, e.g. /dev/shm/resource_monitor_metrics (default: disabled)");
+            LOG_INFO("  --artifact-cache-mb <mb>  Quota of the local binary artifact cache, least recently used unlinked artifacts evicted beyond it (default: 4096)");
             LOG_INFO("  --help                 Show this help message");
             return 0;
         }
     }
     
+    // 增量帧丢失后须通过HTTP响应要求关键帧，不能用UDP发送
+    if (udp_transport && report_format == kWireDelta) {
+        LOG_ERROR("--report-format delta requires --transport http");
+        return 1;
+    }
+
     // 创建Agent实例
-    Agent agent(manager_url, hostname, collection_interval_sec);
+    Agent agent(manager_url, hostname, collection_interval_sec, sample_interval_ms, spool_dir, spool_max_mb, replay_rate, batch_size, report_format,
+                compress_level, compress_threshold > 0 ? static_cast<size_t>(compress_threshold) : 0,
+                heartbeat_interval_ms, udp_transport, shm_path, artifact_cache_mb);
     
     // 启动Agent
     if (!agent.start()) {
@@ -18,8 +18,9 @@ std::string generate_uuid()
     return std::string(uuid_str);
 }
 
-BusinessManager::BusinessManager(std::shared_ptr<DatabaseManager> db_manager, std::shared_ptr<Scheduler> scheduler)
-    : db_manager_(db_manager), scheduler_(scheduler)
+BusinessManager::BusinessManager(std::shared_ptr<DatabaseManager> db_manager, std::shared_ptr<Scheduler> scheduler,
+                                 int compress_level, size_t compress_threshold)
+    : db_manager_(db_manager), scheduler_(scheduler), compression_(compress_level, compress_threshold)
 {
 }
 
@@ -328,47 +329,13 @@ nlohmann::json BusinessManager::deployComponent(const std::string &business_id,
     }
     std::string node_url = "http://" + node_info["ip_address"].get<std::string>() + ":8081";
     std::string host = node_info["ip_address"].get<std::string>();
-    int port = 8081;
     std::string path = "/api/deploy";
 
     // 构造部署请求
     nlohmann::json deploy_request = component_info;
     deploy_request["business_id"] = business_id;
 
-    nlohmann::json response;
-    try
-    {
-        httplib::Client cli(host, port);
-        cli.set_connection_timeout(5);
-        cli.set_read_timeout(5);
-
-        httplib::Headers header_map = {{"Content-Type", "application/json"}};
-        std::string json_data = deploy_request.dump();
-
-        auto res = cli.Post(path, header_map, json_data, "application/json");
-        if (res && res->status == 200)
-        {
-            try
-            {
-                response = nlohmann::json::parse(res->body);
-            }
-            catch (const std::exception &e)
-            {
-                response = {{"status", "error"}, {"message", "Invalid JSON response"}};
-            }
-        }
-        else
-        {
-            std::string error_msg = res ? "HTTP error: " + std::to_string(res->status) : "Connection error";
-            response = {{"status", "error"}, {"message", error_msg}};
-        }
-    }
-    catch (const std::exception &e)
-    {
-        response = {{"status", "error"}, {"message", std::string("Exception: ") + e.what()}};
-    }
-
-    return response;
+    return postToAgent(host, path, deploy_request);
 }
 
 nlohmann::json BusinessManager::stopComponent(const std::string &business_id, const std::string &component_id, bool permanently)
@@ -389,7 +356,6 @@ nlohmann::json BusinessManager::stopComponent(const std::string &business_id, co
         return {{"status", "error"}, {"message", "Node not found or missing IP"}};
     }
     std::string host = node_info["ip_address"].get<std::string>();
-    int port = 8081;
     std::string path = "/api/stop";
 
     // 构造停止请求
@@ -410,22 +376,67 @@ nlohmann::json BusinessManager::stopComponent(const std::string &business_id, co
         stop_request["permanently"] = true;
     }
 
+    return postToAgent(host, path, stop_request);
+}
+
+HttpCompression::Stats BusinessManager::getCompressionStats() const
+{
+    return compression_.getStats();
+}
+
+nlohmann::json BusinessManager::postToAgent(const std::string &host, const std::string &path, const nlohmann::json &request)
+{
+    int port = 8081;
     nlohmann::json response;
     try
     {
         httplib::Client cli(host, port);
         cli.set_connection_timeout(5);
         cli.set_read_timeout(5);
+        // 响应体在下面解压，以便统计解压耗时
+        cli.set_decompress(false);
+
+        httplib::Headers header_map = {{"Accept-Encoding", compression_.enabled() ? "gzip" : "identity"}};
+        std::string json_data = request.dump();
+
+        // 部署请求带有组件的完整配置和内联的配置文件，不小于阈值时压缩发送
+        std::string encoded;
+        bool compressed = compression_.compress(json_data, encoded);
+        httplib::Headers compressed_headers = header_map;
+        compressed_headers.emplace("Content-Encoding", "gzip");
+        auto res = compressed ? cli.Post(path, compressed_headers, encoded, "application/json")
+                              : cli.Post(path, header_map, json_data, "application/json");
+        if (compressed)
+        {
+            HttpCompression::Stats stats = compression_.getStats();
+            LOG_INFO("Sent {} to {}: {} bytes gzip-compressed to {} (total {} requests, ratio {:.2f}, compress {} us, decompress {} us)",
+                     path, host, json_data.size(), encoded.size(), stats.compressed,
+                     stats.encoded_bytes > 0 ? static_cast<double>(stats.raw_bytes) / static_cast<double>(stats.encoded_bytes) : 0.0,
+                     stats.compress_us, stats.decompress_us);
+
+            // 未启用zlib的旧版Agent返回415，按原文重发
+            if (res && res->status == 415)
+            {
+                LOG_INFO("Agent {} does not accept compressed requests, resending uncompressed", host);
+                res = cli.Post(path, header_map, json_data, "application/json");
+            }
+        }
 
-        httplib::Headers header_map = {{"Content-Type", "application/json"}};
-        std::string json_data = stop_request.dump();
-
-        auto res = cli.Post(path, header_map, json_data, "application/json");
         if (res && res->status == 200)
         {
+            const std::string *body = &res->body;
+            std::string decoded;
+            if (res->get_header_value("Content-Encoding") == "gzip")
+            {
+                if (!compression_.decompress(res->body, decoded))
+                {
+                    return {{"status", "error"}, {"message", "Invalid compressed response"}};
+                }
+                body = &decoded;
+            }
             try
             {
-                response = nlohmann::json::parse(res->body);
+                response = nlohmann::json::parse(*body);
             }
             catch (const std::exception &e)
             {
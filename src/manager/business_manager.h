@@ -6,6 +6,7 @@
 #include <map>
 #include <mutex>
 #include <nlohmann/json.hpp>
+#include "utils/http_compression.h"
 
 // 前向声明
 class DatabaseManager;
@@ -23,8 +24,11 @@ public:
      * 
      * @param db_manager 数据库管理器
      * @param scheduler 调度器
+     * @param compress_level 发往Agent的部署/停止请求体的gzip压缩级别（1-9），0表示不压缩
+     * @param compress_threshold 压缩的最小请求体字节数
      */
-    BusinessManager(std::shared_ptr<DatabaseManager> db_manager, std::shared_ptr<Scheduler> scheduler);
+    BusinessManager(std::shared_ptr<DatabaseManager> db_manager, std::shared_ptr<Scheduler> scheduler,
+                    int compress_level = 0, size_t compress_threshold = 1024);
     
     /**
      * 析构函数
@@ -121,6 +125,13 @@ public:
      */
     nlohmann::json stopComponent(const std::string& business_id, const std::string& component_id, bool permanently = false);
 
+    /**
+     * 获取发往Agent的请求体压缩和响应解压的累计统计
+     * 
+     * @return 压缩统计
+     */
+    HttpCompression::Stats getCompressionStats() const;
+
 private:
     /**
      * 验证业务信息
@@ -150,9 +161,20 @@ private:
                                  const nlohmann::json& component_info, 
                                  const std::string& node_id);
 
+    /**
+     * 向Agent发送请求：请求体按阈值gzip压缩，Agent不支持时按原文重发，gzip响应在这里解压
+     * 
+     * @param host Agent地址
+     * @param path API路径
+     * @param request 请求内容
+     * @return Agent的响应
+     */
+    nlohmann::json postToAgent(const std::string& host, const std::string& path, const nlohmann::json& request);
+
 private:
     std::shared_ptr<DatabaseManager> db_manager_;  // 数据库管理器
     std::shared_ptr<Scheduler> scheduler_;         // 调度器
+    HttpCompression compression_;                  // 发往Agent的请求体压缩
 };
 
 #endif // BUSINESS_MANAGER_H
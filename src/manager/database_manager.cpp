@@ -35,6 +35,7 @@ DatabaseManager::~DatabaseManager()
 
 bool DatabaseManager::initialize()
 {
+    std::lock_guard<std::recursive_mutex> lock(db_mutex_);
     try
     {
         // 创建或打开数据库
@@ -87,4 +88,24 @@ bool DatabaseManager::initialize()
         std::cerr << "Database initialization error: " << e.what() << std::endl;
         return false;
     }
-}
\ No newline at end of file
+}
+StatementCache::StatementCache(SQLite::Database &db) : db_(db)
+{
+}
+
+StatementCache::~StatementCache() = default;
+
+SQLite::Statement &StatementCache::get(const std::string &sql)
+{
+    auto it = statements_.find(sql);
+    if (it == statements_.end())
+    {
+        it = statements_.emplace(sql, std::unique_ptr<SQLite::Statement>(new SQLite::Statement(db_, sql))).first;
+    }
+    else
+    {
+        // 上次执行失败时语句可能未重置
+        it->second->reset();
+    }
+    return *it->second;
+}
@@ -6,6 +6,7 @@
 #include <nlohmann/json.hpp>
 #include <thread>
 #include <unordered_map>
+#include <map>
 #include <vector>
 #include <optional>
 #include <mutex>
@@ -14,8 +15,35 @@
 // 前向声明
 namespace SQLite {
     class Database;
+    class Statement;
 }
 
+/**
+ * StatementCache类 - 预编译语句缓存
+ * 
+ * 同一批写入中按SQL文本复用预编译语句，每条语句只编译一次，取出时重置
+ */
+class StatementCache {
+public:
+    explicit StatementCache(SQLite::Database& db);
+    ~StatementCache();
+
+    /**
+     * 获取预编译语句，第一次使用时编译
+     * 
+     * @param sql SQL文本
+     * @return 已重置、可重新绑定参数的语句
+     */
+    SQLite::Statement& get(const std::string& sql);
+
+private:
+    SQLite::Database& db_;
+    std::map<std::string, std::unique_ptr<SQLite::Statement>> statements_;
+};
+
+// 发送心跳的节点超过该时间（毫秒）没有心跳也没有上报时判定为离线
+const long long kNodeHeartbeatTimeoutMs = 5000;
+
 /**
  * DatabaseManager类 - 数据库管理器
  * 
@@ -37,17 +65,29 @@ public:
     bool saveNode(const nlohmann::json& node_info);
     bool updateNodeLastSeen(const std::string& node_id);
     bool updateNodeStatus(const std::string& node_id, const std::string& status);
+    // 节点心跳，只更新内存中的时间戳，不写数据库；离线检测和恢复在线由节点监控线程完成
+    void recordHeartbeat(const std::string& node_id);
 
     // 节点监控与资源采集
     void startNodeStatusMonitor();
-    bool saveResourceUsage(const nlohmann::json& resource_usage);
+    // 保存一次上报。返回false表示数据库错误（已回滚，可重发）；saved为false表示上报字段不全或节点未注册而被跳过
+    bool saveResourceUsage(const nlohmann::json& resource_usage, bool& saved);
+    bool saveResourceUsageBatch(const nlohmann::json& reports, int& saved_count);
     bool saveCpuMetrics(const std::string& node_id, long long timestamp, const nlohmann::json& cpu_data);
     bool saveMemoryMetrics(const std::string& node_id, long long timestamp, const nlohmann::json& memory_data);
+    bool saveDiskMetrics(const std::string& node_id, long long timestamp, const nlohmann::json& disk_data);
+    bool saveNetworkMetrics(const std::string& node_id, long long timestamp, const nlohmann::json& network_data);
+    bool savePressureMetrics(const std::string& node_id, long long timestamp, const nlohmann::json& pressure_data);
 
     nlohmann::json getNodes();
     nlohmann::json getNode(const std::string& node_id);
     nlohmann::json getCpuMetrics(const std::string& node_id, int limit = 100);
     nlohmann::json getMemoryMetrics(const std::string& node_id, int limit = 100);
+    nlohmann::json getDiskMetrics(const std::string& node_id, int limit = 100);
+    nlohmann::json getDiskIoMetrics(const std::string& node_id, int limit = 100);
+    nlohmann::json getNetworkMetrics(const std::string& node_id, int limit = 100);
+    nlohmann::json getTcpMetrics(const std::string& node_id, int limit = 100);
+    nlohmann::json getPressureMetrics(const std::string& node_id, int limit = 100);
     nlohmann::json getNodeResourceHistory(const std::string& node_id, int limit = 100);
 
     // 业务管理相关
@@ -87,11 +127,34 @@ public:
 
     nlohmann::json getOnlineNodes();
 
+private:
+    // 资源上报写入，使用调用方的语句缓存，不开启事务，由调用方决定事务范围。
+    // 字段缺失或类型不符时跳过该项并返回false；数据库错误以异常抛出，由持有事务的调用方回滚整个事务
+    bool writeResourceUsage(StatementCache& statements, const nlohmann::json& resource_usage);
+    bool updateNodeLastSeen(StatementCache& statements, const std::string& node_id);
+    // aggregates为该采集器的窗口聚合值（{指标名: {min, max, avg, p95, samples}}），写入同一行的聚合值列
+    bool saveCpuMetrics(StatementCache& statements, const std::string& node_id, long long timestamp, const nlohmann::json& cpu_data, const nlohmann::json& aggregates);
+    bool saveMemoryMetrics(StatementCache& statements, const std::string& node_id, long long timestamp, const nlohmann::json& memory_data, const nlohmann::json& aggregates);
+    bool saveDiskMetrics(StatementCache& statements, const std::string& node_id, long long timestamp, const nlohmann::json& disk_data);
+    bool saveNetworkMetrics(StatementCache& statements, const std::string& node_id, long long timestamp, const nlohmann::json& network_data);
+    bool savePressureMetrics(StatementCache& statements, const std::string& node_id, long long timestamp, const nlohmann::json& pressure_data, const nlohmann::json& aggregates);
+    // 表中没有metric的窗口聚合值列（<metric>_min等）时添加，用于升级旧数据库
+    void addAggregateColumns(const std::string& table, const std::string& metric);
+    bool updateComponentStatus(StatementCache& statements, const nlohmann::json& component_info);
+    bool updateComponentStatus(StatementCache& statements, const std::string& component_id, const std::string& type, const std::string& status, const std::string& container_id, const std::string& process_id);
+    bool saveComponentMetrics(StatementCache& statements, const std::string& component_id, long long timestamp, const nlohmann::json& metrics);
+    // 节点有心跳时在节点信息中加入最近一次心跳的时间（秒）
+    void addLastHeartbeat(nlohmann::json& node, const std::string& node_id);
+
 private:
     std::string db_path_;                     // 数据库文件路径
     std::unique_ptr<SQLite::Database> db_;    // 数据库连接
+    std::recursive_mutex db_mutex_;           // 串行化对db_的所有访问。事务是连接级的状态，各线程共用一个连接时
+                                              // 不互斥会在其他线程的事务中再次BEGIN，或把无关的写入一起提交、回滚
 
     bool node_monitor_running_;               // 节点监控线程运行标志
+    std::mutex heartbeat_mutex_;              // 保护heartbeats_
+    std::unordered_map<std::string, long long> heartbeats_; // 各节点最近一次心跳的时间（毫秒）
     std::unique_ptr<std::thread> node_monitor_thread_; // 节点监控线程
 
     // Slot Status Monitor
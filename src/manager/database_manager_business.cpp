@@ -73,6 +73,7 @@ bool DatabaseManager::initializeBusinessTables() {
 
 // 保存业务信息
 bool DatabaseManager::saveBusiness(const nlohmann::json& business_info) {
+    std::lock_guard<std::recursive_mutex> lock(db_mutex_);
     try {
         // 检查必要字段
         if (!business_info.contains("business_id") || !business_info.contains("business_name") || 
@@ -118,6 +119,7 @@ bool DatabaseManager::saveBusiness(const nlohmann::json& business_info) {
 
 // 更新业务状态
 bool DatabaseManager::updateBusinessStatus(const std::string& business_id, const std::string& status) {
+    std::lock_guard<std::recursive_mutex> lock(db_mutex_);
     try {
         // 获取当前时间戳
         auto now = std::chrono::system_clock::now();
@@ -139,6 +141,7 @@ bool DatabaseManager::updateBusinessStatus(const std::string& business_id, const
 
 // 保存业务组件信息
 bool DatabaseManager::saveBusinessComponent(const nlohmann::json& component_info) {
+    std::lock_guard<std::recursive_mutex> lock(db_mutex_);
     try {
         
         // 检查必要字段
@@ -236,6 +239,7 @@ bool DatabaseManager::saveBusinessComponent(const nlohmann::json& component_info
 
 // 更新业务组件状态
 bool DatabaseManager::updateComponentStatus(const std::string& component_id, const std::string& status) {
+    std::lock_guard<std::recursive_mutex> lock(db_mutex_);
     try {
         SQLite::Statement update(*db_, "UPDATE business_components SET status = ? WHERE component_id = ?");
         update.bind(1, status);
@@ -254,45 +258,72 @@ bool DatabaseManager::updateComponentStatus(const std::string& component_id,
                                           const std::string& status, 
                                           const std::string& container_id, 
                                           const std::string& process_id) {
+    std::lock_guard<std::recursive_mutex> lock(db_mutex_);
     try {
-        // 获取当前时间戳
-        auto now = std::chrono::system_clock::now();
-        auto timestamp = std::chrono::system_clock::to_time_t(now);
-            
-        if (type == "docker") {
-            // 更新container_id
-            SQLite::Statement update(*db_, 
-                "UPDATE business_components SET status = ?, container_id = ?, updated_at = ? WHERE component_id = ?");
-            update.bind(1, status);
-            update.bind(2, container_id);
-            update.bind(3, static_cast<int64_t>(timestamp));
-            update.bind(4, component_id);
-            update.exec();
-        } else if (type == "binary") {
-            // 更新process_id
-            SQLite::Statement update(*db_, 
-                "UPDATE business_components SET status = ?, process_id = ?, updated_at = ? WHERE component_id = ?");
-            update.bind(1, status);
-            update.bind(2, process_id);
-            update.bind(3, static_cast<int64_t>(timestamp));
-            update.bind(4, component_id);
-            update.exec();
-        } else {
-            std::cerr << "Unknown component type: " << type << std::endl;
-            return false;
-        }
-        
-        return true;
+        StatementCache statements(*db_);
+        return updateComponentStatus(statements, component_id, type, status, container_id, process_id);
     } catch (const std::exception& e) {
         std::cerr << "Update component status error: " << e.what() << std::endl;
         return false;
     }
 }
 
+bool DatabaseManager::updateComponentStatus(StatementCache& statements,
+                                          const std::string& component_id, 
+                                          const std::string& type,
+                                          const std::string& status, 
+                                          const std::string& container_id, 
+                                          const std::string& process_id) {
+    // 获取当前时间戳
+    auto now = std::chrono::system_clock::now();
+    auto timestamp = std::chrono::system_clock::to_time_t(now);
+    int changed = 0;
+        
+    if (type == "docker") {
+        // 更新container_id
+        SQLite::Statement& update = statements.get(
+            "UPDATE business_components SET status = ?, container_id = ?, updated_at = ? WHERE component_id = ?");
+        update.bind(1, status);
+        update.bind(2, container_id);
+        update.bind(3, static_cast<int64_t>(timestamp));
+        update.bind(4, component_id);
+        changed = update.exec();
+    } else if (type == "binary") {
+        // 更新process_id
+        SQLite::Statement& update = statements.get(
+            "UPDATE business_components SET status = ?, process_id = ?, updated_at = ? WHERE component_id = ?");
+        update.bind(1, status);
+        update.bind(2, process_id);
+        update.bind(3, static_cast<int64_t>(timestamp));
+        update.bind(4, component_id);
+        changed = update.exec();
+    } else {
+        std::cerr << "Unknown component type: " << type << std::endl;
+        return false;
+    }
+    
+    // 没有更新到行说明组件不存在（已被删除）
+    return changed > 0;
+}
+
 // 保存组件资源使用指标
 bool DatabaseManager::saveComponentMetrics(const std::string& component_id, 
                                          long long timestamp, 
                                          const nlohmann::json& metrics) {
+    std::lock_guard<std::recursive_mutex> lock(db_mutex_);
+    try {
+        StatementCache statements(*db_);
+        return saveComponentMetrics(statements, component_id, timestamp, metrics);
+    } catch (const std::exception& e) {
+        std::cerr << "Save component metrics error: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+bool DatabaseManager::saveComponentMetrics(StatementCache& statements,
+                                         const std::string& component_id, 
+                                         long long timestamp, 
+                                         const nlohmann::json& metrics) {
     try {
         // 检查必要字段
         if (!metrics.contains("cpu_percent") || !metrics.contains("memory_mb")) {
@@ -300,7 +331,7 @@ bool DatabaseManager::saveComponentMetrics(const std::string& component_id,
         }
         
         // 插入组件指标
-        SQLite::Statement insert(*db_, 
+        SQLite::Statement& insert = statements.get(
             "INSERT INTO component_metrics (component_id, timestamp, cpu_percent, memory_mb, gpu_percent) "
             "VALUES (?, ?, ?, ?, ?)");
         insert.bind(1, component_id);
@@ -311,7 +342,7 @@ bool DatabaseManager::saveComponentMetrics(const std::string& component_id,
         insert.exec();
         
         return true;
-    } catch (const std::exception& e) {
+    } catch (const nlohmann::json::exception& e) {
         std::cerr << "Save component metrics error: " << e.what() << std::endl;
         return false;
     }
@@ -319,6 +350,7 @@ bool DatabaseManager::saveComponentMetrics(const std::string& component_id,
 
 // 获取所有业务
 nlohmann::json DatabaseManager::getBusinesses() {
+    std::lock_guard<std::recursive_mutex> lock(db_mutex_);
     try {
         nlohmann::json result = nlohmann::json::array();
         
@@ -350,6 +382,7 @@ nlohmann::json DatabaseManager::getBusinesses() {
 
 // 获取业务详情
 nlohmann::json DatabaseManager::getBusinessDetails(const std::string& business_id) {
+    std::lock_guard<std::recursive_mutex> lock(db_mutex_);
     try {
         // 查询业务信息
         SQLite::Statement query(*db_, 
@@ -384,6 +417,7 @@ nlohmann::json DatabaseManager::getBusinessDetails(const std::string& business_i
 
 // 获取业务组件
 nlohmann::json DatabaseManager::getBusinessComponents(const std::string& business_id) {
+    std::lock_guard<std::recursive_mutex> lock(db_mutex_);
     try {
         nlohmann::json result = nlohmann::json::array();
         
@@ -435,6 +469,7 @@ nlohmann::json DatabaseManager::getBusinessComponents(const std::string& busines
 
 // 获取组件指标
 nlohmann::json DatabaseManager::getComponentMetrics(const std::string& component_id, int limit) {
+    std::lock_guard<std::recursive_mutex> lock(db_mutex_);
     try {
         nlohmann::json result = nlohmann::json::array();
         
@@ -464,6 +499,7 @@ nlohmann::json DatabaseManager::getComponentMetrics(const std::string& component
 
 // 删除业务
 bool DatabaseManager::deleteBusiness(const std::string& business_id) {
+    std::lock_guard<std::recursive_mutex> lock(db_mutex_);
     try {
         // 开始事务
         SQLite::Transaction transaction(*db_);
@@ -499,6 +535,7 @@ bool DatabaseManager::deleteBusiness(const std::string& business_id) {
 
 // 获取节点资源信息
 nlohmann::json DatabaseManager::getNodeResourceInfo(const std::string& node_id) {
+    std::lock_guard<std::recursive_mutex> lock(db_mutex_);
     try {
         nlohmann::json result;
         
@@ -529,6 +566,24 @@ nlohmann::json DatabaseManager::getNodeResourceInfo(const std::string& node_id)
                 result["memory_usage_percent"] = query.getColumn(3).getDouble();
             }
         }
+
+        // 获取最新的资源压力（PSI），如cpu_pressure_some_avg10、memory_pressure_full_avg10
+        {
+            SQLite::Statement query(*db_,
+                "SELECT resource, some_avg10, some_avg60, full_avg10, full_avg60 "
+                "FROM pressure_metrics WHERE node_id = ? AND timestamp = "
+                "(SELECT MAX(timestamp) FROM pressure_metrics WHERE node_id = ?)");
+            query.bind(1, node_id);
+            query.bind(2, node_id);
+
+            while (query.executeStep()) {
+                std::string prefix = query.getColumn(0).getString() + "_pressure_";
+                result[prefix + "some_avg10"] = query.getColumn(1).getDouble();
+                result[prefix + "some_avg60"] = query.getColumn(2).getDouble();
+                result[prefix + "full_avg10"] = query.getColumn(3).getDouble();
+                result[prefix + "full_avg60"] = query.getColumn(4).getDouble();
+            }
+        }
                
         return result;
     } catch (const std::exception& e) {
@@ -539,6 +594,7 @@ nlohmann::json DatabaseManager::getNodeResourceInfo(const std::string& node_id)
 
 // 通过component_id获取组件信息
 nlohmann::json DatabaseManager::getComponentById(const std::string& component_id) {
+    std::lock_guard<std::recursive_mutex> lock(db_mutex_);
     try {
         SQLite::Statement query(*db_,
             "SELECT component_id, business_id, component_name, type, image_url, image_name, binary_path, binary_url, process_id, resource_requirements, environment_variables, config_files, affinity, node_id, container_id, status, started_at, updated_at FROM business_components WHERE component_id = ?");
@@ -577,12 +633,23 @@ nlohmann::json DatabaseManager::getComponentById(const std::string& component_id
 }
 
 bool DatabaseManager::updateComponentStatus(const nlohmann::json &component_status) {
+    std::lock_guard<std::recursive_mutex> lock(db_mutex_);
+    try {
+        StatementCache statements(*db_);
+        return updateComponentStatus(statements, component_status);
+    } catch (const std::exception &e) {
+        std::cerr << "updateComponentStatus(json) error: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+bool DatabaseManager::updateComponentStatus(StatementCache &statements, const nlohmann::json &component_status) {
     try {
         // 支持批量和单个
         if (component_status.is_array()) {
             bool all_success = true;
             for (const auto &item : component_status) {
-                if (!updateComponentStatus(item)) {
+                if (!updateComponentStatus(statements, item)) {
                     all_success = false;
                 }
             }
@@ -599,14 +666,15 @@ bool DatabaseManager::updateComponentStatus(const nlohmann::json &component_stat
         std::string container_id = component_status.contains("container_id") ? component_status["container_id"].get<std::string>() : "";
         std::string process_id = component_status.contains("process_id") ? component_status["process_id"].get<std::string>() : "";
         // 调用原有的updateComponentStatus
-        return updateComponentStatus(component_id, type, status, container_id, process_id);
-    } catch (const std::exception &e) {
+        return updateComponentStatus(statements, component_id, type, status, container_id, process_id);
+    } catch (const nlohmann::json::exception &e) {
         std::cerr << "updateComponentStatus(json) error: " << e.what() << std::endl;
         return false;
     }
 }
 
 int DatabaseManager::countAbnormalComponents(const std::string& business_id) {
+    std::lock_guard<std::recursive_mutex> lock(db_mutex_);
     try {
         int count = 0;
         SQLite::Statement query(*db_,
@@ -623,6 +691,7 @@ int DatabaseManager::countAbnormalComponents(const std::string& business_id) {
 }
 
 nlohmann::json DatabaseManager::getComponentsByNodeId(const std::string& node_id) {
+    std::lock_guard<std::recursive_mutex> lock(db_mutex_);
     try {
         nlohmann::json result = nlohmann::json::array();
         SQLite::Statement query(*db_,
@@ -7,6 +7,49 @@
 #include <vector>
 #include <algorithm>
 
+namespace
+{
+
+// 指标窗口聚合值的列名后缀，列名为"<指标>_<后缀>"；窗口的last即该行的指标值本身，不另存
+const char *const kAggregateSuffixes[] = {"min", "max", "avg", "p95", "samples"};
+const int kAggregateColumnCount = 5;
+
+// 把一个指标的窗口聚合值绑定到从index开始的5列，上报没有该指标的聚合值时为NULL
+void bindAggregate(SQLite::Statement &insert, int index, const nlohmann::json &aggregates, const std::string &metric)
+{
+    auto it = aggregates.find(metric);
+    if (it == aggregates.end() || !it->is_object())
+    {
+        for (int i = 0; i < kAggregateColumnCount; ++i)
+        {
+            insert.bind(index + i);
+        }
+        return;
+    }
+    insert.bind(index, it->value("min", 0.0));
+    insert.bind(index + 1, it->value("max", 0.0));
+    insert.bind(index + 2, it->value("avg", 0.0));
+    insert.bind(index + 3, it->value("p95", 0.0));
+    insert.bind(index + 4, it->value("samples", 0));
+}
+
+// 读取从index开始的5列窗口聚合值，存在时写入metric的"<指标>_aggregate"
+void readAggregate(SQLite::Statement &query, int index, const std::string &metric, nlohmann::json &result)
+{
+    if (query.getColumn(index).isNull())
+    {
+        return;
+    }
+    result[metric + "_aggregate"] = {
+        {"min", query.getColumn(index).getDouble()},
+        {"max", query.getColumn(index + 1).getDouble()},
+        {"avg", query.getColumn(index + 2).getDouble()},
+        {"p95", query.getColumn(index + 3).getDouble()},
+        {"samples", query.getColumn(index + 4).getInt()}};
+}
+
+}
+
 bool DatabaseManager::initializeMetricTables()
 {
     try
@@ -22,6 +65,11 @@ bool DatabaseManager::initializeMetricTables()
                 load_avg_5m REAL NOT NULL,
                 load_avg_15m REAL NOT NULL,
                 core_count INTEGER NOT NULL,
+                usage_percent_min REAL,
+                usage_percent_max REAL,
+                usage_percent_avg REAL,
+                usage_percent_p95 REAL,
+                usage_percent_samples INTEGER,
                 FOREIGN KEY (node_id) REFERENCES node(node_id)
             )
         )");
@@ -36,15 +84,120 @@ bool DatabaseManager::initializeMetricTables()
                 used BIGINT NOT NULL,
                 free BIGINT NOT NULL,
                 usage_percent REAL NOT NULL,
+                usage_percent_min REAL,
+                usage_percent_max REAL,
+                usage_percent_avg REAL,
+                usage_percent_p95 REAL,
+                usage_percent_samples INTEGER,
                 FOREIGN KEY (node_id) REFERENCES node(node_id)
             )
         )");
 
+        // 创建disk_metrics表（挂载点容量）
+        db_->exec(R"(
+            CREATE TABLE IF NOT EXISTS disk_metrics (
+                id INTEGER PRIMARY KEY AUTOINCREMENT,
+                node_id TEXT NOT NULL,
+                timestamp TIMESTAMP NOT NULL,
+                device TEXT NOT NULL,
+                mount_point TEXT NOT NULL,
+                fs_type TEXT,
+                total BIGINT NOT NULL,
+                used BIGINT NOT NULL,
+                free BIGINT NOT NULL,
+                usage_percent REAL NOT NULL,
+                FOREIGN KEY (node_id) REFERENCES node(node_id)
+            )
+        )");
+
+        // 创建disk_io_metrics表（块设备I/O）
+        db_->exec(R"(
+            CREATE TABLE IF NOT EXISTS disk_io_metrics (
+                id INTEGER PRIMARY KEY AUTOINCREMENT,
+                node_id TEXT NOT NULL,
+                timestamp TIMESTAMP NOT NULL,
+                device TEXT NOT NULL,
+                read_iops REAL NOT NULL,
+                write_iops REAL NOT NULL,
+                read_bytes_per_sec REAL NOT NULL,
+                write_bytes_per_sec REAL NOT NULL,
+                await_ms REAL NOT NULL,
+                util_percent REAL NOT NULL,
+                FOREIGN KEY (node_id) REFERENCES node(node_id)
+            )
+        )");
+
+        // 创建network_metrics表（网络接口收发速率）
+        db_->exec(R"(
+            CREATE TABLE IF NOT EXISTS network_metrics (
+                id INTEGER PRIMARY KEY AUTOINCREMENT,
+                node_id TEXT NOT NULL,
+                timestamp TIMESTAMP NOT NULL,
+                interface TEXT NOT NULL,
+                rx_bytes_per_sec REAL NOT NULL,
+                tx_bytes_per_sec REAL NOT NULL,
+                rx_packets_per_sec REAL NOT NULL,
+                tx_packets_per_sec REAL NOT NULL,
+                rx_errors_per_sec REAL NOT NULL,
+                tx_errors_per_sec REAL NOT NULL,
+                rx_drops_per_sec REAL NOT NULL,
+                tx_drops_per_sec REAL NOT NULL,
+                FOREIGN KEY (node_id) REFERENCES node(node_id)
+            )
+        )");
+
+        // 创建tcp_metrics表（TCP重传和监听队列溢出）
+        db_->exec(R"(
+            CREATE TABLE IF NOT EXISTS tcp_metrics (
+                id INTEGER PRIMARY KEY AUTOINCREMENT,
+                node_id TEXT NOT NULL,
+                timestamp TIMESTAMP NOT NULL,
+                out_segs_per_sec REAL NOT NULL,
+                retrans_segs_per_sec REAL NOT NULL,
+                retrans_percent REAL NOT NULL,
+                listen_overflows_per_sec REAL NOT NULL,
+                listen_drops_per_sec REAL NOT NULL,
+                FOREIGN KEY (node_id) REFERENCES node(node_id)
+            )
+        )");
+
+        // 创建pressure_metrics表（PSI资源压力，每种资源一行）
+        db_->exec(R"(
+            CREATE TABLE IF NOT EXISTS pressure_metrics (
+                id INTEGER PRIMARY KEY AUTOINCREMENT,
+                node_id TEXT NOT NULL,
+                timestamp TIMESTAMP NOT NULL,
+                resource TEXT NOT NULL,
+                some_avg10 REAL NOT NULL,
+                some_avg60 REAL NOT NULL,
+                some_stall_us BIGINT NOT NULL,
+                full_avg10 REAL NOT NULL,
+                full_avg60 REAL NOT NULL,
+                full_stall_us BIGINT NOT NULL,
+                some_avg10_min REAL,
+                some_avg10_max REAL,
+                some_avg10_avg REAL,
+                some_avg10_p95 REAL,
+                some_avg10_samples INTEGER,
+                FOREIGN KEY (node_id) REFERENCES node(node_id)
+            )
+        )");
+
+        // Agent亚秒级采样的窗口聚合值存在各指标行的列中（未开启采样时为NULL），旧数据库的表补上这些列
+        addAggregateColumns("cpu_metrics", "usage_percent");
+        addAggregateColumns("memory_metrics", "usage_percent");
+        addAggregateColumns("pressure_metrics", "some_avg10");
+
         // 创建索引以提高查询性能
         db_->exec("CREATE INDEX IF NOT EXISTS idx_cpu_metrics_node_id ON cpu_metrics(node_id)");
         db_->exec("CREATE INDEX IF NOT EXISTS idx_cpu_metrics_timestamp ON cpu_metrics(timestamp)");
         db_->exec("CREATE INDEX IF NOT EXISTS idx_memory_metrics_node_id ON memory_metrics(node_id)");
         db_->exec("CREATE INDEX IF NOT EXISTS idx_memory_metrics_timestamp ON memory_metrics(timestamp)");
+        db_->exec("CREATE INDEX IF NOT EXISTS idx_disk_metrics_node_id_timestamp ON disk_metrics(node_id, timestamp)");
+        db_->exec("CREATE INDEX IF NOT EXISTS idx_disk_io_metrics_node_id_timestamp ON disk_io_metrics(node_id, timestamp)");
+        db_->exec("CREATE INDEX IF NOT EXISTS idx_network_metrics_node_id_timestamp ON network_metrics(node_id, timestamp)");
+        db_->exec("CREATE INDEX IF NOT EXISTS idx_tcp_metrics_node_id_timestamp ON tcp_metrics(node_id, timestamp)");
+        db_->exec("CREATE INDEX IF NOT EXISTS idx_pressure_metrics_node_id_timestamp ON pressure_metrics(node_id, timestamp)");
 
         return true;
     }
@@ -55,9 +208,45 @@ bool DatabaseManager::initializeMetricTables()
     }
 }
 
+void DatabaseManager::addAggregateColumns(const std::string &table, const std::string &metric)
+{
+    SQLite::Statement columns(*db_, "PRAGMA table_info(" + table + ")");
+    while (columns.executeStep())
+    {
+        if (columns.getColumn(1).getString() == metric + "_min")
+        {
+            return;
+        }
+    }
+    for (const char *suffix : kAggregateSuffixes)
+    {
+        std::string type = std::string(suffix) == "samples" ? "INTEGER" : "REAL";
+        db_->exec("ALTER TABLE " + table + " ADD COLUMN " + metric + "_" + suffix + " " + type);
+    }
+}
+
 bool DatabaseManager::saveCpuMetrics(const std::string &node_id,
                                      long long timestamp,
                                      const nlohmann::json &cpu_data)
+{
+    std::lock_guard<std::recursive_mutex> lock(db_mutex_);
+    try
+    {
+        StatementCache statements(*db_);
+        return saveCpuMetrics(statements, node_id, timestamp, cpu_data, nlohmann::json());
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Save CPU metrics error: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+bool DatabaseManager::saveCpuMetrics(StatementCache &statements,
+                                     const std::string &node_id,
+                                     long long timestamp,
+                                     const nlohmann::json &cpu_data,
+                                     const nlohmann::json &aggregates)
 {
     try
     {
@@ -70,9 +259,10 @@ bool DatabaseManager::saveCpuMetrics(const std::string &node_id,
         }
 
         // 插入CPU指标
-        SQLite::Statement insert(*db_,
-                                 "INSERT INTO cpu_metrics (node_id, timestamp, usage_percent, load_avg_1m, load_avg_5m, load_avg_15m, core_count) "
-                                 "VALUES (?, ?, ?, ?, ?, ?, ?)");
+        SQLite::Statement &insert = statements.get(
+            "INSERT INTO cpu_metrics (node_id, timestamp, usage_percent, load_avg_1m, load_avg_5m, load_avg_15m, core_count, "
+            "usage_percent_min, usage_percent_max, usage_percent_avg, usage_percent_p95, usage_percent_samples) "
+            "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
         insert.bind(1, node_id);
         insert.bind(2, static_cast<int64_t>(timestamp));
         insert.bind(3, cpu_data["usage_percent"].get<double>());
@@ -80,11 +270,12 @@ bool DatabaseManager::saveCpuMetrics(const std::string &node_id,
         insert.bind(5, cpu_data["load_avg_5m"].get<double>());
         insert.bind(6, cpu_data["load_avg_15m"].get<double>());
         insert.bind(7, cpu_data["core_count"].get<int>());
+        bindAggregate(insert, 8, aggregates, "usage_percent");
         insert.exec();
 
         return true;
     }
-    catch (const std::exception &e)
+    catch (const nlohmann::json::exception &e)
     {
         std::cerr << "Save CPU metrics error: " << e.what() << std::endl;
         return false;
@@ -94,6 +285,25 @@ bool DatabaseManager::saveCpuMetrics(const std::string &node_id,
 bool DatabaseManager::saveMemoryMetrics(const std::string &node_id,
                                         long long timestamp,
                                         const nlohmann::json &memory_data)
+{
+    std::lock_guard<std::recursive_mutex> lock(db_mutex_);
+    try
+    {
+        StatementCache statements(*db_);
+        return saveMemoryMetrics(statements, node_id, timestamp, memory_data, nlohmann::json());
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Save memory metrics error: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+bool DatabaseManager::saveMemoryMetrics(StatementCache &statements,
+                                        const std::string &node_id,
+                                        long long timestamp,
+                                        const nlohmann::json &memory_data,
+                                        const nlohmann::json &aggregates)
 {
     try
     {
@@ -105,35 +315,285 @@ bool DatabaseManager::saveMemoryMetrics(const std::string &node_id,
         }
 
         // 插入内存指标
-        SQLite::Statement insert(*db_,
-                                 "INSERT INTO memory_metrics (node_id, timestamp, total, used, free, usage_percent) "
-                                 "VALUES (?, ?, ?, ?, ?, ?)");
+        SQLite::Statement &insert = statements.get(
+            "INSERT INTO memory_metrics (node_id, timestamp, total, used, free, usage_percent, "
+            "usage_percent_min, usage_percent_max, usage_percent_avg, usage_percent_p95, usage_percent_samples) "
+            "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
         insert.bind(1, node_id);
         insert.bind(2, static_cast<int64_t>(timestamp));
         insert.bind(3, static_cast<int64_t>(memory_data["total"].get<unsigned long long>()));
         insert.bind(4, static_cast<int64_t>(memory_data["used"].get<unsigned long long>()));
         insert.bind(5, static_cast<int64_t>(memory_data["free"].get<unsigned long long>()));
         insert.bind(6, memory_data["usage_percent"].get<double>());
+        bindAggregate(insert, 7, aggregates, "usage_percent");
         insert.exec();
 
         return true;
     }
-    catch (const std::exception &e)
+    catch (const nlohmann::json::exception &e)
     {
         std::cerr << "Save memory metrics error: " << e.what() << std::endl;
         return false;
     }
 }
 
+bool DatabaseManager::saveDiskMetrics(const std::string &node_id,
+                                      long long timestamp,
+                                      const nlohmann::json &disk_data)
+{
+    std::lock_guard<std::recursive_mutex> lock(db_mutex_);
+    try
+    {
+        // 多行数据放在同一个事务中写入
+        SQLite::Transaction transaction(*db_);
+        StatementCache statements(*db_);
+        bool result = saveDiskMetrics(statements, node_id, timestamp, disk_data);
+        transaction.commit();
+        return result;
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Save disk metrics error: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+bool DatabaseManager::saveDiskMetrics(StatementCache &statements,
+                                      const std::string &node_id,
+                                      long long timestamp,
+                                      const nlohmann::json &disk_data)
+{
+    try
+    {
+        if (disk_data.contains("filesystems") && disk_data["filesystems"].is_array())
+        {
+            SQLite::Statement &insert = statements.get(
+                "INSERT INTO disk_metrics (node_id, timestamp, device, mount_point, fs_type, total, used, free, usage_percent) "
+                "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?)");
+            for (const auto &filesystem : disk_data["filesystems"])
+            {
+                // 检查必要字段
+                if (!filesystem.contains("device") || !filesystem.contains("mount_point") ||
+                    !filesystem.contains("total") || !filesystem.contains("used") ||
+                    !filesystem.contains("free") || !filesystem.contains("usage_percent"))
+                {
+                    continue;
+                }
+
+                insert.bind(1, node_id);
+                insert.bind(2, static_cast<int64_t>(timestamp));
+                insert.bind(3, filesystem["device"].get<std::string>());
+                insert.bind(4, filesystem["mount_point"].get<std::string>());
+                insert.bind(5, filesystem.contains("fs_type") ? filesystem["fs_type"].get<std::string>() : "");
+                insert.bind(6, static_cast<int64_t>(filesystem["total"].get<unsigned long long>()));
+                insert.bind(7, static_cast<int64_t>(filesystem["used"].get<unsigned long long>()));
+                insert.bind(8, static_cast<int64_t>(filesystem["free"].get<unsigned long long>()));
+                insert.bind(9, filesystem["usage_percent"].get<double>());
+                insert.exec();
+                insert.reset();
+            }
+        }
+
+        if (disk_data.contains("devices") && disk_data["devices"].is_array())
+        {
+            SQLite::Statement &insert = statements.get(
+                "INSERT INTO disk_io_metrics (node_id, timestamp, device, read_iops, write_iops, read_bytes_per_sec, write_bytes_per_sec, await_ms, util_percent) "
+                "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?)");
+            for (const auto &device : disk_data["devices"])
+            {
+                // 检查必要字段
+                if (!device.contains("device") || !device.contains("read_iops") ||
+                    !device.contains("write_iops") || !device.contains("read_bytes_per_sec") ||
+                    !device.contains("write_bytes_per_sec") || !device.contains("await_ms") ||
+                    !device.contains("util_percent"))
+                {
+                    continue;
+                }
+
+                insert.bind(1, node_id);
+                insert.bind(2, static_cast<int64_t>(timestamp));
+                insert.bind(3, device["device"].get<std::string>());
+                insert.bind(4, device["read_iops"].get<double>());
+                insert.bind(5, device["write_iops"].get<double>());
+                insert.bind(6, device["read_bytes_per_sec"].get<double>());
+                insert.bind(7, device["write_bytes_per_sec"].get<double>());
+                insert.bind(8, device["await_ms"].get<double>());
+                insert.bind(9, device["util_percent"].get<double>());
+                insert.exec();
+                insert.reset();
+            }
+        }
+
+        return true;
+    }
+    catch (const nlohmann::json::exception &e)
+    {
+        std::cerr << "Save disk metrics error: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+bool DatabaseManager::saveNetworkMetrics(const std::string &node_id,
+                                         long long timestamp,
+                                         const nlohmann::json &network_data)
+{
+    std::lock_guard<std::recursive_mutex> lock(db_mutex_);
+    try
+    {
+        // 多行数据放在同一个事务中写入
+        SQLite::Transaction transaction(*db_);
+        StatementCache statements(*db_);
+        bool result = saveNetworkMetrics(statements, node_id, timestamp, network_data);
+        transaction.commit();
+        return result;
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Save network metrics error: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+bool DatabaseManager::saveNetworkMetrics(StatementCache &statements,
+                                         const std::string &node_id,
+                                         long long timestamp,
+                                         const nlohmann::json &network_data)
+{
+    try
+    {
+        if (network_data.contains("interfaces") && network_data["interfaces"].is_array())
+        {
+            SQLite::Statement &insert = statements.get(
+                "INSERT INTO network_metrics (node_id, timestamp, interface, rx_bytes_per_sec, tx_bytes_per_sec, "
+                "rx_packets_per_sec, tx_packets_per_sec, rx_errors_per_sec, tx_errors_per_sec, rx_drops_per_sec, tx_drops_per_sec) "
+                "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
+            for (const auto &interface : network_data["interfaces"])
+            {
+                // 检查必要字段
+                if (!interface.contains("interface") || !interface.contains("rx_bytes_per_sec") ||
+                    !interface.contains("tx_bytes_per_sec"))
+                {
+                    continue;
+                }
+
+                insert.bind(1, node_id);
+                insert.bind(2, static_cast<int64_t>(timestamp));
+                insert.bind(3, interface["interface"].get<std::string>());
+                insert.bind(4, interface["rx_bytes_per_sec"].get<double>());
+                insert.bind(5, interface["tx_bytes_per_sec"].get<double>());
+                insert.bind(6, interface.value("rx_packets_per_sec", 0.0));
+                insert.bind(7, interface.value("tx_packets_per_sec", 0.0));
+                insert.bind(8, interface.value("rx_errors_per_sec", 0.0));
+                insert.bind(9, interface.value("tx_errors_per_sec", 0.0));
+                insert.bind(10, interface.value("rx_drops_per_sec", 0.0));
+                insert.bind(11, interface.value("tx_drops_per_sec", 0.0));
+                insert.exec();
+                insert.reset();
+            }
+        }
+
+        if (network_data.contains("tcp") && network_data["tcp"].is_object())
+        {
+            const auto &tcp = network_data["tcp"];
+            SQLite::Statement &insert = statements.get(
+                "INSERT INTO tcp_metrics (node_id, timestamp, out_segs_per_sec, retrans_segs_per_sec, retrans_percent, "
+                "listen_overflows_per_sec, listen_drops_per_sec) "
+                "VALUES (?, ?, ?, ?, ?, ?, ?)");
+            insert.bind(1, node_id);
+            insert.bind(2, static_cast<int64_t>(timestamp));
+            insert.bind(3, tcp.value("out_segs_per_sec", 0.0));
+            insert.bind(4, tcp.value("retrans_segs_per_sec", 0.0));
+            insert.bind(5, tcp.value("retrans_percent", 0.0));
+            insert.bind(6, tcp.value("listen_overflows_per_sec", 0.0));
+            insert.bind(7, tcp.value("listen_drops_per_sec", 0.0));
+            insert.exec();
+        }
+
+        return true;
+    }
+    catch (const nlohmann::json::exception &e)
+    {
+        std::cerr << "Save network metrics error: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+bool DatabaseManager::savePressureMetrics(const std::string &node_id,
+                                          long long timestamp,
+                                          const nlohmann::json &pressure_data)
+{
+    std::lock_guard<std::recursive_mutex> lock(db_mutex_);
+    try
+    {
+        // 多行数据放在同一个事务中写入
+        SQLite::Transaction transaction(*db_);
+        StatementCache statements(*db_);
+        bool result = savePressureMetrics(statements, node_id, timestamp, pressure_data, nlohmann::json());
+        transaction.commit();
+        return result;
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Save pressure metrics error: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+bool DatabaseManager::savePressureMetrics(StatementCache &statements,
+                                          const std::string &node_id,
+                                          long long timestamp,
+                                          const nlohmann::json &pressure_data,
+                                          const nlohmann::json &aggregates)
+{
+    try
+    {
+        if (!pressure_data.is_object() || pressure_data.empty())
+        {
+            return true;
+        }
+
+        SQLite::Statement &insert = statements.get(
+            "INSERT INTO pressure_metrics (node_id, timestamp, resource, some_avg10, some_avg60, some_stall_us, "
+            "full_avg10, full_avg60, full_stall_us, some_avg10_min, some_avg10_max, some_avg10_avg, some_avg10_p95, "
+            "some_avg10_samples) "
+            "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
+        for (const auto &item : pressure_data.items())
+        {
+            const auto &pressure = item.value();
+            insert.bind(1, node_id);
+            insert.bind(2, static_cast<int64_t>(timestamp));
+            insert.bind(3, item.key());
+            insert.bind(4, pressure.value("some_avg10", 0.0));
+            insert.bind(5, pressure.value("some_avg60", 0.0));
+            insert.bind(6, static_cast<int64_t>(pressure.value("some_stall_us", 0ULL)));
+            insert.bind(7, pressure.value("full_avg10", 0.0));
+            insert.bind(8, pressure.value("full_avg60", 0.0));
+            insert.bind(9, static_cast<int64_t>(pressure.value("full_stall_us", 0ULL)));
+            // Agent按"资源名_字段名"聚合各资源的PSI，如cpu_some_avg10
+            bindAggregate(insert, 10, aggregates, item.key() + "_some_avg10");
+            insert.exec();
+            insert.reset();
+        }
+        return true;
+    }
+    catch (const nlohmann::json::exception &e)
+    {
+        std::cerr << "Save pressure metrics error: " << e.what() << std::endl;
+        return false;
+    }
+}
+
 nlohmann::json DatabaseManager::getCpuMetrics(const std::string &node_id, int limit)
 {
+    std::lock_guard<std::recursive_mutex> lock(db_mutex_);
     try
     {
         nlohmann::json result = nlohmann::json::array();
 
         // 查询CPU指标
         SQLite::Statement query(*db_,
-                                "SELECT timestamp, usage_percent, load_avg_1m, load_avg_5m, load_avg_15m, core_count "
+                                "SELECT timestamp, usage_percent, load_avg_1m, load_avg_5m, load_avg_15m, core_count, "
+                                "usage_percent_min, usage_percent_max, usage_percent_avg, usage_percent_p95, usage_percent_samples "
                                 "FROM cpu_metrics WHERE node_id = ? ORDER BY timestamp DESC LIMIT ?");
         query.bind(1, node_id);
         query.bind(2, limit);
@@ -147,6 +607,7 @@ nlohmann::json DatabaseManager::getCpuMetrics(const std::string &node_id, int li
             metric["load_avg_5m"] = query.getColumn(3).getDouble();
             metric["load_avg_15m"] = query.getColumn(4).getDouble();
             metric["core_count"] = query.getColumn(5).getInt();
+            readAggregate(query, 6, "usage_percent", metric);
 
             result.push_back(metric);
         }
@@ -162,13 +623,15 @@ nlohmann::json DatabaseManager::getCpuMetrics(const std::string &node_id, int li
 
 nlohmann::json DatabaseManager::getMemoryMetrics(const std::string &node_id, int limit)
 {
+    std::lock_guard<std::recursive_mutex> lock(db_mutex_);
     try
     {
         nlohmann::json result = nlohmann::json::array();
 
         // 查询内存指标
         SQLite::Statement query(*db_,
-                                "SELECT timestamp, total, used, free, usage_percent "
+                                "SELECT timestamp, total, used, free, usage_percent, "
+                                "usage_percent_min, usage_percent_max, usage_percent_avg, usage_percent_p95, usage_percent_samples "
                                 "FROM memory_metrics WHERE node_id = ? ORDER BY timestamp DESC LIMIT ?");
         query.bind(1, node_id);
         query.bind(2, limit);
@@ -181,6 +644,7 @@ nlohmann::json DatabaseManager::getMemoryMetrics(const std::string &node_id, int
             metric["used"] = query.getColumn(2).getInt64();
             metric["free"] = query.getColumn(3).getInt64();
             metric["usage_percent"] = query.getColumn(4).getDouble();
+            readAggregate(query, 5, "usage_percent", metric);
 
             result.push_back(metric);
         }
@@ -194,38 +658,342 @@ nlohmann::json DatabaseManager::getMemoryMetrics(const std::string &node_id, int
     }
 }
 
+nlohmann::json DatabaseManager::getDiskMetrics(const std::string &node_id, int limit)
+{
+    std::lock_guard<std::recursive_mutex> lock(db_mutex_);
+    try
+    {
+        nlohmann::json result = nlohmann::json::array();
+
+        // 查询最近limit次上报的挂载点容量
+        SQLite::Statement query(*db_,
+                                "SELECT timestamp, device, mount_point, fs_type, total, used, free, usage_percent "
+                                "FROM disk_metrics WHERE node_id = ? AND timestamp IN "
+                                "(SELECT DISTINCT timestamp FROM disk_metrics WHERE node_id = ? ORDER BY timestamp DESC LIMIT ?) "
+                                "ORDER BY timestamp DESC, mount_point");
+        query.bind(1, node_id);
+        query.bind(2, node_id);
+        query.bind(3, limit);
+
+        while (query.executeStep())
+        {
+            nlohmann::json metric;
+            metric["timestamp"] = query.getColumn(0).getInt64();
+            metric["device"] = query.getColumn(1).getString();
+            metric["mount_point"] = query.getColumn(2).getString();
+            metric["fs_type"] = query.getColumn(3).getString();
+            metric["total"] = query.getColumn(4).getInt64();
+            metric["used"] = query.getColumn(5).getInt64();
+            metric["free"] = query.getColumn(6).getInt64();
+            metric["usage_percent"] = query.getColumn(7).getDouble();
+
+            result.push_back(metric);
+        }
+
+        return result;
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Get disk metrics error: " << e.what() << std::endl;
+        return nlohmann::json::array();
+    }
+}
+
+nlohmann::json DatabaseManager::getDiskIoMetrics(const std::string &node_id, int limit)
+{
+    std::lock_guard<std::recursive_mutex> lock(db_mutex_);
+    try
+    {
+        nlohmann::json result = nlohmann::json::array();
+
+        // 查询最近limit次上报的块设备I/O
+        SQLite::Statement query(*db_,
+                                "SELECT timestamp, device, read_iops, write_iops, read_bytes_per_sec, write_bytes_per_sec, await_ms, util_percent "
+                                "FROM disk_io_metrics WHERE node_id = ? AND timestamp IN "
+                                "(SELECT DISTINCT timestamp FROM disk_io_metrics WHERE node_id = ? ORDER BY timestamp DESC LIMIT ?) "
+                                "ORDER BY timestamp DESC, device");
+        query.bind(1, node_id);
+        query.bind(2, node_id);
+        query.bind(3, limit);
+
+        while (query.executeStep())
+        {
+            nlohmann::json metric;
+            metric["timestamp"] = query.getColumn(0).getInt64();
+            metric["device"] = query.getColumn(1).getString();
+            metric["read_iops"] = query.getColumn(2).getDouble();
+            metric["write_iops"] = query.getColumn(3).getDouble();
+            metric["read_bytes_per_sec"] = query.getColumn(4).getDouble();
+            metric["write_bytes_per_sec"] = query.getColumn(5).getDouble();
+            metric["await_ms"] = query.getColumn(6).getDouble();
+            metric["util_percent"] = query.getColumn(7).getDouble();
+
+            result.push_back(metric);
+        }
+
+        return result;
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Get disk io metrics error: " << e.what() << std::endl;
+        return nlohmann::json::array();
+    }
+}
+
+nlohmann::json DatabaseManager::getNetworkMetrics(const std::string &node_id, int limit)
+{
+    std::lock_guard<std::recursive_mutex> lock(db_mutex_);
+    try
+    {
+        nlohmann::json result = nlohmann::json::array();
+
+        // 查询最近limit次上报的接口收发速率
+        SQLite::Statement query(*db_,
+                                "SELECT timestamp, interface, rx_bytes_per_sec, tx_bytes_per_sec, rx_packets_per_sec, tx_packets_per_sec, "
+                                "rx_errors_per_sec, tx_errors_per_sec, rx_drops_per_sec, tx_drops_per_sec "
+                                "FROM network_metrics WHERE node_id = ? AND timestamp IN "
+                                "(SELECT DISTINCT timestamp FROM network_metrics WHERE node_id = ? ORDER BY timestamp DESC LIMIT ?) "
+                                "ORDER BY timestamp DESC, interface");
+        query.bind(1, node_id);
+        query.bind(2, node_id);
+        query.bind(3, limit);
+
+        while (query.executeStep())
+        {
+            nlohmann::json metric;
+            metric["timestamp"] = query.getColumn(0).getInt64();
+            metric["interface"] = query.getColumn(1).getString();
+            metric["rx_bytes_per_sec"] = query.getColumn(2).getDouble();
+            metric["tx_bytes_per_sec"] = query.getColumn(3).getDouble();
+            metric["rx_packets_per_sec"] = query.getColumn(4).getDouble();
+            metric["tx_packets_per_sec"] = query.getColumn(5).getDouble();
+            metric["rx_errors_per_sec"] = query.getColumn(6).getDouble();
+            metric["tx_errors_per_sec"] = query.getColumn(7).getDouble();
+            metric["rx_drops_per_sec"] = query.getColumn(8).getDouble();
+            metric["tx_drops_per_sec"] = query.getColumn(9).getDouble();
+
+            result.push_back(metric);
+        }
+
+        return result;
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Get network metrics error: " << e.what() << std::endl;
+        return nlohmann::json::array();
+    }
+}
+
+nlohmann::json DatabaseManager::getTcpMetrics(const std::string &node_id, int limit)
+{
+    std::lock_guard<std::recursive_mutex> lock(db_mutex_);
+    try
+    {
+        nlohmann::json result = nlohmann::json::array();
+
+        // 查询TCP指标
+        SQLite::Statement query(*db_,
+                                "SELECT timestamp, out_segs_per_sec, retrans_segs_per_sec, retrans_percent, listen_overflows_per_sec, listen_drops_per_sec "
+                                "FROM tcp_metrics WHERE node_id = ? ORDER BY timestamp DESC LIMIT ?");
+        query.bind(1, node_id);
+        query.bind(2, limit);
+
+        while (query.executeStep())
+        {
+            nlohmann::json metric;
+            metric["timestamp"] = query.getColumn(0).getInt64();
+            metric["out_segs_per_sec"] = query.getColumn(1).getDouble();
+            metric["retrans_segs_per_sec"] = query.getColumn(2).getDouble();
+            metric["retrans_percent"] = query.getColumn(3).getDouble();
+            metric["listen_overflows_per_sec"] = query.getColumn(4).getDouble();
+            metric["listen_drops_per_sec"] = query.getColumn(5).getDouble();
+
+            result.push_back(metric);
+        }
+
+        return result;
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Get TCP metrics error: " << e.what() << std::endl;
+        return nlohmann::json::array();
+    }
+}
+
+nlohmann::json DatabaseManager::getPressureMetrics(const std::string &node_id, int limit)
+{
+    std::lock_guard<std::recursive_mutex> lock(db_mutex_);
+    try
+    {
+        nlohmann::json result = nlohmann::json::array();
+
+        // 查询最近limit次上报的资源压力
+        SQLite::Statement query(*db_,
+                                "SELECT timestamp, resource, some_avg10, some_avg60, some_stall_us, full_avg10, full_avg60, full_stall_us, "
+                                "some_avg10_min, some_avg10_max, some_avg10_avg, some_avg10_p95, some_avg10_samples "
+                                "FROM pressure_metrics WHERE node_id = ? AND timestamp IN "
+                                "(SELECT DISTINCT timestamp FROM pressure_metrics WHERE node_id = ? ORDER BY timestamp DESC LIMIT ?) "
+                                "ORDER BY timestamp DESC, resource");
+        query.bind(1, node_id);
+        query.bind(2, node_id);
+        query.bind(3, limit);
+
+        while (query.executeStep())
+        {
+            nlohmann::json metric;
+            metric["timestamp"] = query.getColumn(0).getInt64();
+            metric["resource"] = query.getColumn(1).getString();
+            metric["some_avg10"] = query.getColumn(2).getDouble();
+            metric["some_avg60"] = query.getColumn(3).getDouble();
+            metric["some_stall_us"] = query.getColumn(4).getInt64();
+            metric["full_avg10"] = query.getColumn(5).getDouble();
+            metric["full_avg60"] = query.getColumn(6).getDouble();
+            metric["full_stall_us"] = query.getColumn(7).getInt64();
+            readAggregate(query, 8, "some_avg10", metric);
+
+            result.push_back(metric);
+        }
+
+        return result;
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Get pressure metrics error: " << e.what() << std::endl;
+        return nlohmann::json::array();
+    }
+}
+
 nlohmann::json DatabaseManager::getNodeResourceHistory(const std::string& node_id, int limit)
 {
     // cpu metrics
     auto cpu_metrics = getCpuMetrics(node_id, limit);
     // memory metrics
     auto memory_metrics = getMemoryMetrics(node_id, limit);
+    // disk metrics
+    auto disk_metrics = getDiskMetrics(node_id, limit);
+    auto disk_io_metrics = getDiskIoMetrics(node_id, limit);
+    // network metrics
+    auto network_metrics = getNetworkMetrics(node_id, limit);
+    auto tcp_metrics = getTcpMetrics(node_id, limit);
+    // pressure metrics
+    auto pressure_metrics = getPressureMetrics(node_id, limit);
 
     nlohmann::json result;
     result["cpu_metrics"] = cpu_metrics;
     result["memory_metrics"] = memory_metrics;
+    result["disk_metrics"] = disk_metrics;
+    result["disk_io_metrics"] = disk_io_metrics;
+    result["network_metrics"] = network_metrics;
+    result["tcp_metrics"] = tcp_metrics;
+    result["pressure_metrics"] = pressure_metrics;
 
     return result;
 }
 
-bool DatabaseManager::saveResourceUsage(const nlohmann::json &resource_usage)
+bool DatabaseManager::saveResourceUsage(const nlohmann::json &resource_usage, bool &saved)
+{
+    std::lock_guard<std::recursive_mutex> lock(db_mutex_);
+    saved = false;
+    try
+    {
+        // 一次上报的节点状态、各类指标和组件状态放在同一个事务中写入
+        SQLite::Transaction transaction(*db_);
+        StatementCache statements(*db_);
+        bool result = writeResourceUsage(statements, resource_usage);
+        transaction.commit();
+        saved = result;
+        return true;
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Save resource usage error: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+bool DatabaseManager::saveResourceUsageBatch(const nlohmann::json &reports, int &saved_count)
+{
+    std::lock_guard<std::recursive_mutex> lock(db_mutex_);
+    saved_count = 0;
+    if (!reports.is_array())
+    {
+        return false;
+    }
+
+    try
+    {
+        // 整批上报只开一个事务，每种语句只编译一次；单条上报字段不全时跳过，不影响其他上报
+        SQLite::Transaction transaction(*db_);
+        StatementCache statements(*db_);
+        for (const auto &report : reports)
+        {
+            if (writeResourceUsage(statements, report))
+            {
+                ++saved_count;
+            }
+        }
+        transaction.commit();
+        return true;
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Save resource usage batch error: " << e.what() << std::endl;
+        saved_count = 0;
+        return false;
+    }
+}
+
+bool DatabaseManager::writeResourceUsage(StatementCache &statements, const nlohmann::json &resource_usage)
 {
     // 检查必要字段
-    if (!resource_usage.contains("node_id") || !resource_usage.contains("timestamp") || !resource_usage.contains("resource")) {
+    if (!resource_usage.is_object() || !resource_usage.contains("node_id") || !resource_usage.contains("timestamp") || !resource_usage.contains("resource")) {
+        return false;
+    }
+    if (!resource_usage["node_id"].is_string() || !resource_usage["timestamp"].is_number_integer() || !resource_usage["resource"].is_object()) {
         return false;
     }
     std::string node_id = resource_usage["node_id"];
     long long timestamp = resource_usage["timestamp"];
     const auto& resource = resource_usage["resource"];
-    // 更新Board最后一次上报时间
-    updateNodeLastSeen(node_id);
+    // 更新Board最后一次上报时间；节点未注册时（如Manager数据库被重建）指标表的外键会拒绝写入，跳过该上报
+    if (!updateNodeLastSeen(statements, node_id)) {
+        return false;
+    }
+    // Agent开启亚秒级采样时附带的窗口聚合值，与对应采集器的指标写在同一行
+    static const nlohmann::json kNoAggregates;
+    auto reported = resource_usage.find("aggregates");
+    auto aggregatesOf = [&](const char* type) -> const nlohmann::json& {
+        if (reported == resource_usage.end()) {
+            return kNoAggregates;
+        }
+        auto it = reported->find(type);
+        return it != reported->end() ? *it : kNoAggregates;
+    };
     // 保存各类资源数据
     if (resource.contains("cpu")) {
-        saveCpuMetrics(node_id, timestamp, resource["cpu"]);
+        saveCpuMetrics(statements, node_id, timestamp, resource["cpu"], aggregatesOf("cpu"));
     }
     if (resource.contains("memory")) {
-        saveMemoryMetrics(node_id, timestamp, resource["memory"]);
+        saveMemoryMetrics(statements, node_id, timestamp, resource["memory"], aggregatesOf("memory"));
+    }
+    if (resource.contains("disk")) {
+        saveDiskMetrics(statements, node_id, timestamp, resource["disk"]);
+    }
+    if (resource.contains("network")) {
+        saveNetworkMetrics(statements, node_id, timestamp, resource["network"]);
+    }
+    if (resource.contains("pressure")) {
+        savePressureMetrics(statements, node_id, timestamp, resource["pressure"], aggregatesOf("pressure"));
+    }
+    // 保存组件状态和组件资源使用情况
+    if (resource_usage.contains("components")) {
+        for (const auto& component : resource_usage["components"]) {
+            // 组件不存在（已被删除）时不保存其指标，component_metrics的外键会拒绝写入
+            if (updateComponentStatus(statements, component) && component.contains("resource_usage")) {
+                saveComponentMetrics(statements, component["component_id"], timestamp, component["resource_usage"]);
+            }
+        }
     }
     
     return true;
-}
\ No newline at end of file
+}
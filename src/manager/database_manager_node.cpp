@@ -4,6 +4,10 @@
 #include <iostream>
 #include <chrono>
 #include <thread>
+#include <algorithm>
+
+// 不发送心跳的节点超过该时间（秒）没有上报时判定为离线
+const long long kNodeReportTimeoutSec = 10;
 
 // 初始化Node相关的数据库表
 bool DatabaseManager::initializeNodeTables()
@@ -36,6 +40,7 @@ bool DatabaseManager::initializeNodeTables()
 
 bool DatabaseManager::saveNode(const nlohmann::json &node_info)
 {
+    std::lock_guard<std::recursive_mutex> lock(db_mutex_);
     try
     {
         // 检查必要字段
@@ -97,19 +102,11 @@ bool DatabaseManager::saveNode(const nlohmann::json &node_info)
 
 bool DatabaseManager::updateNodeLastSeen(const std::string &node_id)
 {
+    std::lock_guard<std::recursive_mutex> lock(db_mutex_);
     try
     {
-        // 获取当前时间戳
-        auto now = std::chrono::system_clock::now();
-        auto timestamp = std::chrono::system_clock::to_time_t(now);
-        
-        // 更新Node最后活动时间和状态为在线
-        SQLite::Statement update(*db_, "UPDATE node SET updated_at = ?, status = 'online' WHERE node_id = ?");
-        update.bind(1, static_cast<int64_t>(timestamp));
-        update.bind(2, node_id);
-        update.exec();
-        
-        return true;
+        StatementCache statements(*db_);
+        return updateNodeLastSeen(statements, node_id);
     }
     catch (const std::exception &e)
     {
@@ -118,8 +115,24 @@ bool DatabaseManager::updateNodeLastSeen(const std::string &node_id)
     }
 }
 
+bool DatabaseManager::updateNodeLastSeen(StatementCache &statements, const std::string &node_id)
+{
+    // 获取当前时间戳
+    auto now = std::chrono::system_clock::now();
+    auto timestamp = std::chrono::system_clock::to_time_t(now);
+    
+    // 更新Node最后活动时间和状态为在线
+    SQLite::Statement &update = statements.get("UPDATE node SET updated_at = ?, status = 'online' WHERE node_id = ?");
+    update.bind(1, static_cast<int64_t>(timestamp));
+    update.bind(2, node_id);
+    
+    // 没有更新到行说明节点未注册
+    return update.exec() > 0;
+}
+
 bool DatabaseManager::updateNodeStatus(const std::string &node_id, const std::string &status)
 {
+    std::lock_guard<std::recursive_mutex> lock(db_mutex_);
     try
     {
         // 更新Node状态
@@ -137,6 +150,24 @@ bool DatabaseManager::updateNodeStatus(const std::string &node_id, const std::st
     }
 }
 
+void DatabaseManager::recordHeartbeat(const std::string &node_id)
+{
+    long long now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    std::lock_guard<std::mutex> lock(heartbeat_mutex_);
+    heartbeats_[node_id] = now_ms;
+}
+
+void DatabaseManager::addLastHeartbeat(nlohmann::json &node, const std::string &node_id)
+{
+    std::lock_guard<std::mutex> lock(heartbeat_mutex_);
+    auto heartbeat = heartbeats_.find(node_id);
+    if (heartbeat != heartbeats_.end())
+    {
+        node["last_heartbeat"] = heartbeat->second / 1000;
+    }
+}
+
 void DatabaseManager::startNodeStatusMonitor()
 {
     // 如果监控线程已经在运行，则不再启动
@@ -150,22 +181,58 @@ void DatabaseManager::startNodeStatusMonitor()
     // 创建并启动监控线程
     node_monitor_thread_ = std::make_unique<std::thread>([this]()
                                                          {
+        std::unordered_map<std::string, long long> heartbeats;
         while (node_monitor_running_) {
             try {
                 // 获取当前时间戳
                 auto now = std::chrono::system_clock::now();
                 auto current_timestamp = std::chrono::system_clock::to_time_t(now);
+                long long now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
+
+                // 取心跳时间戳的快照；超过上报超时仍没有心跳的节点（如改为不发心跳的Agent）不再按心跳判断
+                {
+                    std::lock_guard<std::mutex> lock(heartbeat_mutex_);
+                    for (auto it = heartbeats_.begin(); it != heartbeats_.end();) {
+                        if (now_ms - it->second > kNodeReportTimeoutSec * 1000) {
+                            it = heartbeats_.erase(it);
+                        } else {
+                            ++it;
+                        }
+                    }
+                    heartbeats = heartbeats_;
+                }
                 
-                // 查询所有节点
-                SQLite::Statement query(*db_, "SELECT node_id, ip_address, updated_at FROM node where status = 'online'");
+                // 查询所有节点；检查期间持有db_mutex_，不与上报的事务交错
+                std::unique_lock<std::recursive_mutex> db_lock(db_mutex_);
+                SQLite::Statement query(*db_, "SELECT node_id, ip_address, updated_at, status FROM node");
                 
                 while (query.executeStep()) {
                     std::string node_id = query.getColumn(0).getString();
                     std::string ip_address = query.getColumn(1).getString();
                     int64_t updated_at = query.getColumn(2).getInt64();
+                    bool online = query.getColumn(3).getString() == "online";
+
+                    // 发送心跳的节点按最近一次心跳或上报判断，超时较短；其余节点只按上报判断
+                    auto heartbeat = heartbeats.find(node_id);
+                    bool alive;
+                    if (heartbeat != heartbeats.end()) {
+                        long long last_seen_ms = std::max(heartbeat->second, static_cast<long long>(updated_at) * 1000);
+                        alive = now_ms - last_seen_ms <= kNodeHeartbeatTimeoutMs;
+                    } else {
+                        alive = current_timestamp - updated_at <= kNodeReportTimeoutSec;
+                    }
+
+                    // 离线节点恢复心跳时重新标记为在线（上报时由updateNodeLastSeen标记）
+                    if (!online) {
+                        if (alive && heartbeat != heartbeats.end()) {
+                            LOG_INFO("Node {} is back online", ip_address);
+                            updateNodeStatus(node_id, "online");
+                        }
+                        continue;
+                    }
                     
-                    // 如果超过5秒没有上报，则标记为离线
-                    if (current_timestamp - updated_at > 10) {
+                    // 超时没有心跳或上报，则标记为离线
+                    if (!alive) {
                         LOG_INFO("Node {} is offline", ip_address);
                         updateNodeStatus(node_id, "offline");
 
@@ -181,6 +248,7 @@ void DatabaseManager::startNodeStatusMonitor()
                         }
                     }
                 }
+                db_lock.unlock();
                 
                 // 每秒检查一次
                 std::this_thread::sleep_for(std::chrono::seconds(1));
@@ -194,6 +262,7 @@ void DatabaseManager::startNodeStatusMonitor()
 
 nlohmann::json DatabaseManager::getNodes()
 {
+    std::lock_guard<std::recursive_mutex> lock(db_mutex_);
     try
     {
         nlohmann::json result = nlohmann::json::array();
@@ -215,6 +284,7 @@ nlohmann::json DatabaseManager::getNodes()
             node["created_at"] = query.getColumn(6).getInt64();
             node["updated_at"] = query.getColumn(7).getInt64();
             node["status"] = query.getColumn(8).getString();
+            addLastHeartbeat(node, node_id);
 
             result.push_back(node);
         }
@@ -230,6 +300,7 @@ nlohmann::json DatabaseManager::getNodes()
 
 nlohmann::json DatabaseManager::getNode(const std::string &node_id)
 {
+    std::lock_guard<std::recursive_mutex> lock(db_mutex_);
     try
     {
         SQLite::Statement query(*db_, "SELECT node_id, hostname, ip_address, os_info, gpu_count, cpu_model, created_at, updated_at, status FROM node WHERE node_id = ?");
@@ -249,6 +320,7 @@ nlohmann::json DatabaseManager::getNode(const std::string &node_id)
             node["created_at"] = query.getColumn(6).getInt64();
             node["updated_at"] = query.getColumn(7).getInt64();
             node["status"] = query.getColumn(8).getString();
+            addLastHeartbeat(node, node_id);
 
             return node;
         }
@@ -265,6 +337,7 @@ nlohmann::json DatabaseManager::getNode(const std::string &node_id)
 
 nlohmann::json DatabaseManager::getOnlineNodes()
 {
+    std::lock_guard<std::recursive_mutex> lock(db_mutex_);
     try
     {
         nlohmann::json result = nlohmann::json::array();
@@ -67,6 +67,7 @@ bool DatabaseManager::createBusinessTemplateTable() {
 
 // 保存组件模板
 nlohmann::json DatabaseManager::saveComponentTemplate(const nlohmann::json& template_info) {
+    std::lock_guard<std::recursive_mutex> lock(db_mutex_);
     try {
         std::string template_id = template_info.contains("component_template_id") ? template_info["component_template_id"].get<std::string>() : generate_template_uuid("ct");
         std::string timestamp = get_current_timestamp();
@@ -103,6 +104,7 @@ nlohmann::json DatabaseManager::saveComponentTemplate(const nlohmann::json& temp
 
 // 获取组件模板列表
 nlohmann::json DatabaseManager::getComponentTemplates() {
+    std::lock_guard<std::recursive_mutex> lock(db_mutex_);
     try {
         SQLite::Statement query(*db_, "SELECT component_template_id, template_name, description, type, config, created_at, updated_at FROM component_templates ORDER BY created_at DESC");
         nlohmann::json templates = nlohmann::json::array();
@@ -125,6 +127,7 @@ nlohmann::json DatabaseManager::getComponentTemplates() {
 
 // 获取组件模板详情
 nlohmann::json DatabaseManager::getComponentTemplate(const std::string& template_id) {
+    std::lock_guard<std::recursive_mutex> lock(db_mutex_);
     try {
         SQLite::Statement query(*db_, "SELECT component_template_id, template_name, description, type, config, created_at, updated_at FROM component_templates WHERE component_template_id = ?");
         query.bind(1, template_id);
@@ -147,6 +150,7 @@ nlohmann::json DatabaseManager::getComponentTemplate(const std::string& template
 
 // 删除组件模板
 nlohmann::json DatabaseManager::deleteComponentTemplate(const std::string& template_id) {
+    std::lock_guard<std::recursive_mutex> lock(db_mutex_);
     try {
         // 检查是否有业务模板引用了该组件模板
         SQLite::Statement check(*db_, "SELECT business_template_id FROM business_templates WHERE components LIKE ?");
@@ -170,6 +174,7 @@ nlohmann::json DatabaseManager::deleteComponentTemplate(const std::string& templ
 
 // 保存业务模板
 nlohmann::json DatabaseManager::saveBusinessTemplate(const nlohmann::json& template_info) {
+    std::lock_guard<std::recursive_mutex> lock(db_mutex_);
     try {
         std::string template_id = template_info.contains("business_template_id") ? template_info["business_template_id"].get<std::string>() : generate_template_uuid("bt");
         std::string timestamp = get_current_timestamp();
@@ -218,6 +223,7 @@ nlohmann::json DatabaseManager::saveBusinessTemplate(const nlohmann::json& templ
 
 // 获取业务模板列表
 nlohmann::json DatabaseManager::getBusinessTemplates() {
+    std::lock_guard<std::recursive_mutex> lock(db_mutex_);
     try {
         SQLite::Statement query(*db_, "SELECT business_template_id, template_name, description, components, created_at, updated_at FROM business_templates ORDER BY created_at DESC");
         nlohmann::json templates = nlohmann::json::array();
@@ -252,6 +258,7 @@ nlohmann::json DatabaseManager::getBusinessTemplates() {
 
 // 获取业务模板详情
 nlohmann::json DatabaseManager::getBusinessTemplate(const std::string& template_id) {
+    std::lock_guard<std::recursive_mutex> lock(db_mutex_);
     try {
         SQLite::Statement query(*db_, "SELECT business_template_id, template_name, description, components, created_at, updated_at FROM business_templates WHERE business_template_id = ?");
         query.bind(1, template_id);
@@ -286,6 +293,7 @@ nlohmann::json DatabaseManager::getBusinessTemplate(const std::string& template_
 
 // 删除业务模板
 nlohmann::json DatabaseManager::deleteBusinessTemplate(const std::string& template_id) {
+    std::lock_guard<std::recursive_mutex> lock(db_mutex_);
     try {
         SQLite::Statement del(*db_, "DELETE FROM business_templates WHERE business_template_id = ?");
         del.bind(1, template_id);
@@ -3,6 +3,7 @@
 #include "business_manager.h"
 #include "utils/logger.h"
 #include <iostream>
+#include <cstdlib>
 
 HTTPServer::HTTPServer(std::shared_ptr<DatabaseManager> db_manager,
                        std::shared_ptr<BusinessManager> business_manager,
@@ -38,12 +39,25 @@ bool HTTPServer::start()
 
     // 启动服务器
     running_ = true;
+    // httplib在调用处理函数前已解压gzip请求体，处理完后按Content-Length统计解压前后的字节数
+    server_.set_logger([this](const httplib::Request &req, const httplib::Response &)
+                       {
+        if (req.get_header_value("Content-Encoding") == "gzip")
+        {
+            request_compression_.recordDecompressed(std::strtoull(req.get_header_value("Content-Length").c_str(), nullptr, 10),
+                                                    req.body.size());
+        } });
     server_.set_default_headers({{"Access-Control-Allow-Origin", "*"}, {"Access-Control-Allow-Methods", "GET, POST, PUT, DELETE, OPTIONS"}, {"Access-Control-Allow-Headers", "Content-Type"}});
     server_.listen("0.0.0.0", port_);
 
     return true;
 }
 
+void HTTPServer::setUdpReportServer(std::shared_ptr<UdpReportServer> udp_server)
+{
+    udp_server_ = udp_server;
+}
+
 void HTTPServer::stop()
 {
     if (running_)
@@ -54,6 +68,25 @@ void HTTPServer::stop()
     }
 }
 
+// 请求解析辅助方法
+nlohmann::json HTTPServer::parseRequestBody(const httplib::Request& req) {
+    // Agent可用二进制编码发送注册和上报，其余请求和未声明类型的请求按JSON解析
+    std::string content_type = req.get_header_value("Content-Type");
+    content_type = content_type.substr(0, content_type.find(';'));
+    if (content_type == "application/cbor") {
+        return nlohmann::json::from_cbor(req.body);
+    }
+    if (content_type == "application/msgpack" || content_type == "application/x-msgpack") {
+        return nlohmann::json::from_msgpack(req.body);
+    }
+    return nlohmann::json::parse(req.body);
+}
+
+bool HTTPServer::isDeltaRequest(const httplib::Request& req) {
+    std::string content_type = req.get_header_value("Content-Type");
+    return content_type.substr(0, content_type.find(';')) == "application/x-metric-delta";
+}
+
 // 响应辅助方法
 void HTTPServer::sendSuccessResponse(httplib::Response& res, const std::string& message) {
     res.set_content(nlohmann::json({{"status", "success"}, {"message", message}}).dump(), "application/json");
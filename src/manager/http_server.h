@@ -5,12 +5,16 @@
 #include <memory>
 #include <functional>
 #include <map>
+#include <mutex>
 #include <httplib.h>
 #include <nlohmann/json.hpp>
+#include "utils/metric_delta.h"
+#include "utils/http_compression.h"
 
 // 前向声明
 class DatabaseManager;
 class BusinessManager;
+class UdpReportServer;
 
 /**
  * HTTPServer类 - HTTP服务器
@@ -29,6 +33,9 @@ public:
     bool start();
     void stop();
 
+    // 设置UDP上报接收，注册响应中告知Agent其端口，须在start之前调用
+    void setUdpReportServer(std::shared_ptr<UdpReportServer> udp_server);
+
     // 路由初始化
     void initRoutes();
     void initBusinessRoutes();
@@ -62,11 +69,19 @@ public:
     // 板卡管理相关
     void handleNodeRegistration(const httplib::Request& req, httplib::Response& res);
     void handleResourceReport(const httplib::Request& req, httplib::Response& res);
+    void handleResourceReportBatch(const httplib::Request& req, httplib::Response& res);
+    void handleDeltaReport(const httplib::Request& req, httplib::Response& res, bool batch);
     void handleGetNodes(const httplib::Request& req, httplib::Response& res);
     void handleGetNodeDetails(const httplib::Request& req, httplib::Response& res);
     void handleGetNodeResourceHistory(const httplib::Request& req, httplib::Response& res);
     void handleGetNodeResources(const httplib::Request& req, httplib::Response& res);
     void handleNodeHeartbeat(const httplib::Request& req, httplib::Response& res);
+    void handleGetUdpStats(const httplib::Request& req, httplib::Response& res);
+    void handleGetCompressionStats(const httplib::Request& req, httplib::Response& res);
+
+    // 请求解析辅助方法：按Content-Type解析JSON、CBOR或MessagePack编码的请求体
+    nlohmann::json parseRequestBody(const httplib::Request& req);
+    bool isDeltaRequest(const httplib::Request& req);
 
     // 响应辅助方法
     void sendSuccessResponse(httplib::Response& res, const std::string& message);
@@ -81,6 +96,10 @@ protected:
     httplib::Server server_;  // HTTP服务器
     std::shared_ptr<BusinessManager> business_manager_;  // 业务管理器
     std::shared_ptr<DatabaseManager> db_manager_;    // 数据库管理器
+    DeltaDecoder delta_decoder_;  // 增量编码上报的解码器，按流保存还原状态
+    std::mutex delta_mutex_;  // 保护delta_decoder_
+    std::shared_ptr<UdpReportServer> udp_server_;  // UDP上报接收，未开启时为空
+    HttpCompression request_compression_;  // 统计Agent发来的gzip请求体，由httplib解压，只记录个数和字节数
 
 private:
     int port_;  // 监听端口
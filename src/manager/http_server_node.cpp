@@ -1,6 +1,7 @@
 #include "http_server.h"
 #include "database_manager.h"
 #include "business_manager.h"
+#include "udp_report_server.h"
 #include "utils/logger.h"
 #include <iostream>
 #include <sstream>
@@ -17,12 +18,32 @@ void HTTPServer::initNodeRoutes()
     server_.Post("/api/report", [this](const httplib::Request &req, httplib::Response &res)
                  { handleResourceReport(req, res); });
 
+    // 批量资源上报
+    server_.Post("/api/report/batch", [this](const httplib::Request &req, httplib::Response &res)
+                 { handleResourceReportBatch(req, res); });
+
+    // 节点心跳
+    server_.Post("/api/heartbeat/:node_id", [this](const httplib::Request &req, httplib::Response &res)
+                 { handleNodeHeartbeat(req, res); });
+
+    // UDP上报的接收和按节点的丢失统计
+    server_.Get("/api/udp/stats", [this](const httplib::Request &req, httplib::Response &res)
+                { handleGetUdpStats(req, res); });
+
+    // 发往Agent和Agent发来的请求体的压缩统计
+    server_.Get("/api/compression/stats", [this](const httplib::Request &req, httplib::Response &res)
+                { handleGetCompressionStats(req, res); });
+
     // 获取节点列表
     server_.Get("/api/nodes", [this](const httplib::Request &req, httplib::Response &res)
                 { handleGetNodes(req, res); });
 
     server_.Get("/api/nodes/:node_id", [this](const httplib::Request &req, httplib::Response &res)
                 { handleGetNodeDetails(req, res); });
+
+    // 获取节点资源历史
+    server_.Get("/api/nodes/:node_id/resources", [this](const httplib::Request &req, httplib::Response &res)
+                { handleGetNodeResourceHistory(req, res); });
 }
 
 // 处理节点注册
@@ -30,7 +51,7 @@ void HTTPServer::handleNodeRegistration(const httplib::Request &req, httplib::Re
 {
     try
     {
-        auto json = nlohmann::json::parse(req.body);
+        auto json = parseRequestBody(req);
         std::string node_id;
         if (!json.contains("node_id") || json["node_id"].get<std::string>().empty()) {
             // 生成新的board_id
@@ -53,8 +74,14 @@ void HTTPServer::handleNodeRegistration(const httplib::Request &req, httplib::Re
             nlohmann::json resp = {
                 {"status", "success"},
                 {"node_id", node_id},
-                {"components", components}
+                {"components", components},
+                {"report_formats", {"json", "cbor", "msgpack", "delta"}},
+                {"heartbeat_timeout_ms", kNodeHeartbeatTimeoutMs}
             };
+            if (udp_server_)
+            {
+                resp["udp_port"] = udp_server_->port();
+            }
             res.set_content(resp.dump(), "application/json");
         }
         else
@@ -68,27 +95,121 @@ void HTTPServer::handleNodeRegistration(const httplib::Request &req, httplib::Re
     }
 }
 
+// 处理节点心跳：只更新内存中的时间戳，不访问数据库，响应为固定内容
+void HTTPServer::handleNodeHeartbeat(const httplib::Request &req, httplib::Response &res)
+{
+    static const std::string response = R"({"status":"success","message":"Heartbeat updated"})";
+    db_manager_->recordHeartbeat(req.path_params.at("node_id"));
+    res.set_content(response, "application/json");
+}
+
+// 处理获取UDP上报统计
+void HTTPServer::handleGetUdpStats(const httplib::Request &req, httplib::Response &res)
+{
+    if (!udp_server_)
+    {
+        sendErrorResponse(res, "UDP reports are not enabled");
+        return;
+    }
+    sendSuccessResponse(res, "udp", udp_server_->getStats());
+}
+
+// 处理获取压缩统计：sent为发往Agent的部署、停止请求（Manager压缩请求体、解压响应），
+// received为Agent发来的gzip请求（httplib已解压，没有解压耗时）
+void HTTPServer::handleGetCompressionStats(const httplib::Request &req, httplib::Response &res)
+{
+    HttpCompression::Stats sent = business_manager_->getCompressionStats();
+    HttpCompression::Stats received = request_compression_.getStats();
+    nlohmann::json stats = {
+        {"sent", {{"compressed", sent.compressed},
+                  {"skipped", sent.skipped},
+                  {"raw_bytes", sent.raw_bytes},
+                  {"encoded_bytes", sent.encoded_bytes},
+                  {"ratio", sent.encoded_bytes > 0 ? static_cast<double>(sent.raw_bytes) / static_cast<double>(sent.encoded_bytes) : 0.0},
+                  {"compress_us", sent.compress_us},
+                  {"decompressed", sent.decompressed},
+                  {"response_wire_bytes", sent.wire_bytes},
+                  {"response_bytes", sent.decoded_bytes},
+                  {"decompress_us", sent.decompress_us}}},
+        {"received", {{"decompressed", received.decompressed},
+                      {"wire_bytes", received.wire_bytes},
+                      {"decoded_bytes", received.decoded_bytes},
+                      {"ratio", received.wire_bytes > 0 ? static_cast<double>(received.decoded_bytes) / static_cast<double>(received.wire_bytes) : 0.0}}}};
+    sendSuccessResponse(res, "compression", stats);
+}
+
 // 处理资源上报
 void HTTPServer::handleResourceReport(const httplib::Request &req, httplib::Response &res)
 {
     try
     {
-        auto json = nlohmann::json::parse(req.body);
+        // 增量编码的上报需要按流还原
+        if (isDeltaRequest(req))
+        {
+            handleDeltaReport(req, res, false);
+            return;
+        }
+
+        auto json = parseRequestBody(req);
 
-        if (db_manager_->saveResourceUsage(json))
+        // 资源指标、组件状态和组件资源使用情况在同一个事务中保存
+        bool saved = false;
+        if (!db_manager_->saveResourceUsage(json, saved))
+        {
+            // 事务回滚，返回5xx让Agent暂存后重发
+            res.status = 503;
+            sendErrorResponse(res, "Failed to save resource usage");
+        }
+        else if (saved)
         {
             sendSuccessResponse(res, "Resource usage saved successfully");
         }
         else
         {
-            sendErrorResponse(res, "Failed to save resource usage");
+            // 字段不全或节点未注册，重发也无法保存
+            sendErrorResponse(res, "Invalid resource usage report");
         }
+    }
+    catch (const std::exception &e)
+    {
+        sendExceptionResponse(res, e);
+    }
+}
 
-        // 保存组件状态
-        if (json.contains("components")) {
-            for (const auto& component : json["components"]) {
-                db_manager_->updateComponentStatus(component);
-            }
+// 处理批量资源上报
+void HTTPServer::handleResourceReportBatch(const httplib::Request &req, httplib::Response &res)
+{
+    try
+    {
+        if (isDeltaRequest(req))
+        {
+            handleDeltaReport(req, res, true);
+            return;
+        }
+
+        auto json = parseRequestBody(req);
+        if (!json.is_array())
+        {
+            sendErrorResponse(res, "Request body must be an array of reports");
+            return;
+        }
+
+        int saved_count = 0;
+        if (db_manager_->saveResourceUsageBatch(json, saved_count))
+        {
+            nlohmann::json resp = {
+                {"status", "success"},
+                {"message", "Resource usage batch saved successfully"},
+                {"saved", saved_count},
+                {"skipped", static_cast<int>(json.size()) - saved_count}
+            };
+            res.set_content(resp.dump(), "application/json");
+        }
+        else
+        {
+            // 事务整体回滚，返回5xx让Agent稍后重发整批
+            res.status = 503;
+            sendErrorResponse(res, "Failed to save resource usage batch");
         }
     }
     catch (const std::exception &e)
@@ -97,6 +218,96 @@ void HTTPServer::handleResourceReport(const httplib::Request &req, httplib::Resp
     }
 }
 
+// 处理增量编码的上报：请求体为一帧（批量时为多帧拼接），按流还原出完整上报后与普通上报同样保存。
+// 流状态缺失或序号不连续的帧被跳过，响应带keyframe_required通知Agent下一帧发送关键帧
+void HTTPServer::handleDeltaReport(const httplib::Request &req, httplib::Response &res, bool batch)
+{
+    // 解码和保存期间加锁，还原出的上报在保存前不会被同一流的下一帧改动
+    std::lock_guard<std::mutex> lock(delta_mutex_);
+
+    nlohmann::json reports = nlohmann::json::array();
+    std::vector<uint64_t> streams;
+    const nlohmann::json *report = nullptr;
+    bool keyframe_required = false;
+    int frames = 0;
+    size_t offset = 0;
+    while (offset < req.body.size())
+    {
+        size_t consumed = 0;
+        uint64_t stream_id = 0;
+        DeltaDecoder::Result result = delta_decoder_.decode(req.body.data() + offset, req.body.size() - offset,
+                                                            consumed, stream_id, report);
+        if (result == DeltaDecoder::kDecodeInvalid)
+        {
+            // 前面已解码的帧不再保存，相关的流都需要重新同步
+            for (uint64_t stream : streams)
+            {
+                delta_decoder_.invalidate(stream);
+            }
+            nlohmann::json resp = {{"status", "error"}, {"message", "Invalid delta frame"}, {"keyframe_required", true}};
+            res.set_content(resp.dump(), "application/json");
+            return;
+        }
+        offset += consumed;
+        ++frames;
+        if (result == DeltaDecoder::kDecodeKeyframeRequired)
+        {
+            keyframe_required = true;
+            report = nullptr;
+            continue;
+        }
+        streams.push_back(stream_id);
+        if (!batch)
+        {
+            break;
+        }
+        // 同一流的后续帧会原地更新还原的上报，批量保存前先复制
+        reports.push_back(*report);
+    }
+
+    nlohmann::json resp;
+    int saved_count = 0;
+    bool report_saved = false;
+    bool saved = batch ? (reports.empty() || db_manager_->saveResourceUsageBatch(reports, saved_count))
+                       : (report && db_manager_->saveResourceUsage(*report, report_saved));
+    if (saved && !batch && !report_saved)
+    {
+        // 字段不全或节点未注册，流状态已推进，与其他未保存的帧一样要求关键帧
+        delta_decoder_.invalidate(streams.back());
+        keyframe_required = true;
+        resp = {{"status", "error"}, {"message", "Invalid resource usage report"}};
+    }
+    else if (saved)
+    {
+        resp = {{"status", "success"}, {"message", "Resource usage saved successfully"}};
+        if (batch)
+        {
+            resp["saved"] = saved_count;
+            resp["skipped"] = frames - saved_count;
+        }
+    }
+    else if (!batch && !report)
+    {
+        resp = {{"status", "error"}, {"message", "Delta stream out of sync, keyframe required"}};
+    }
+    else
+    {
+        // 未保存的帧已推进流状态，改为要求关键帧；与普通上报一样返回5xx，Agent按可重试处理
+        for (uint64_t stream : streams)
+        {
+            delta_decoder_.invalidate(stream);
+        }
+        keyframe_required = true;
+        res.status = 503;
+        resp = {{"status", "error"}, {"message", "Failed to save resource usage"}};
+    }
+    if (keyframe_required)
+    {
+        resp["keyframe_required"] = true;
+    }
+    res.set_content(resp.dump(), "application/json");
+}
+
 // 处理获取节点列表
 void HTTPServer::handleGetNodes(const httplib::Request &req, httplib::Response &res)
 {
@@ -130,6 +341,17 @@ void HTTPServer::handleGetNodeDetails(const httplib::Request &req, httplib::Resp
             if (!memory_metrics.empty()) {
                 node["latest_memory"] = memory_metrics[0];
             }
+            // 最新一次上报的各挂载点容量和块设备I/O
+            node["latest_disk"] = db_manager_->getDiskMetrics(node_id, 1);
+            node["latest_disk_io"] = db_manager_->getDiskIoMetrics(node_id, 1);
+            // 最新一次上报的各接口收发速率和TCP指标
+            node["latest_network"] = db_manager_->getNetworkMetrics(node_id, 1);
+            auto tcp_metrics = db_manager_->getTcpMetrics(node_id, 1);
+            if (!tcp_metrics.empty()) {
+                node["latest_tcp"] = tcp_metrics[0];
+            }
+            // 最新一次上报的资源压力（PSI）
+            node["latest_pressure"] = db_manager_->getPressureMetrics(node_id, 1);
             sendSuccessResponse(res, "node", node);
         }
         else
@@ -141,4 +363,30 @@ void HTTPServer::handleGetNodeDetails(const httplib::Request &req, httplib::Resp
     {
         sendExceptionResponse(res, e);
     }
-}
\ No newline at end of file
+}
+
+// 处理获取节点资源历史
+void HTTPServer::handleGetNodeResourceHistory(const httplib::Request &req, httplib::Response &res)
+{
+    try
+    {
+        std::string node_id = req.path_params.at("node_id");
+        int limit = 100;
+        if (req.has_param("limit"))
+        {
+            limit = std::stoi(req.get_param_value("limit"));
+            if (limit <= 0)
+            {
+                sendErrorResponse(res, "Invalid limit");
+                return;
+            }
+        }
+
+        auto history = db_manager_->getNodeResourceHistory(node_id, limit);
+        sendSuccessResponse(res, "history", history);
+    }
+    catch (const std::exception &e)
+    {
+        sendExceptionResponse(res, e);
+    }
+}
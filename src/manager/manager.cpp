@@ -2,13 +2,15 @@
 #include "http_server.h"
 #include "database_manager.h"
 #include "business_manager.h"
+#include "udp_report_server.h"
 #include "utils/logger.h"
 #include <iostream>
 #include <thread>
 #include <chrono>
 
-Manager::Manager(int port, const std::string& db_path)
-    : db_path_(db_path), port_(port), running_(false) {
+Manager::Manager(int port, const std::string& db_path, int compress_level, size_t compress_threshold, int udp_port)
+    : db_path_(db_path), port_(port), compress_level_(compress_level), compress_threshold_(compress_threshold),
+      udp_port_(udp_port), running_(false) {
 }
 
 Manager::~Manager() {
@@ -35,7 +37,7 @@ bool Manager::initialize() {
     }
     
     // 创建业务管理器
-    business_manager_ = std::make_shared<BusinessManager>(db_manager_, scheduler_);
+    business_manager_ = std::make_shared<BusinessManager>(db_manager_, scheduler_, compress_level_, compress_threshold_);
     if (!business_manager_->initialize()) {
         LOG_ERROR("Failed to initialize business manager");
         return false;
@@ -43,7 +45,11 @@ bool Manager::initialize() {
     
     // 创建HTTP服务器
     http_server_ = std::make_unique<HTTPServer>(db_manager_, business_manager_, port_);
-    
+
+    // 创建UDP上报接收
+    if (udp_port_ > 0) {
+        udp_server_ = std::make_shared<UdpReportServer>(db_manager_, udp_port_);
+    }
     
     LOG_INFO("Manager initialized successfully");
     return true;
@@ -56,7 +62,16 @@ bool Manager::start() {
     }
     
     LOG_INFO("Starting Manager...");
-    
+
+    // 先启动UDP上报接收，成功后才在注册响应中告知Agent，失败时Agent使用HTTP上报
+    if (udp_server_) {
+        if (udp_server_->start()) {
+            http_server_->setUdpReportServer(udp_server_);
+        } else {
+            LOG_ERROR("Failed to start UDP report listener, agents will report over HTTP");
+            udp_server_.reset();
+        }
+    }
     
     // 在单独的线程中启动HTTP服务器以避免阻塞
     std::thread server_thread([this]() {
@@ -85,6 +100,11 @@ void Manager::stop() {
     
     // 停止HTTP服务器
     http_server_->stop();
+
+    // 停止UDP上报接收
+    if (udp_server_) {
+        udp_server_->stop();
+    }
     
     running_ = false;
     LOG_INFO("Manager stopped successfully");
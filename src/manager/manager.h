@@ -9,6 +9,7 @@
 class HTTPServer;
 class DatabaseManager;
 class BusinessManager;
+class UdpReportServer;
 
 /**
  * Manager类 - 管理器
@@ -22,8 +23,12 @@ public:
      * 
      * @param port HTTP服务器端口
      * @param db_path 数据库文件路径
+     * @param compress_level 发往Agent的请求体的gzip压缩级别（1-9），0表示不压缩
+     * @param compress_threshold 压缩的最小请求体字节数
+     * @param udp_port UDP上报监听端口，0表示不接收UDP上报
      */
-    Manager(int port = 8080, const std::string& db_path = "resource_monitor.db");
+    Manager(int port = 8080, const std::string& db_path = "resource_monitor.db",
+            int compress_level = 0, size_t compress_threshold = 1024, int udp_port = 0);
     
     /**
      * 析构函数
@@ -57,12 +62,16 @@ public:
 private:
     int port_;                                          // HTTP服务器端口
     std::string db_path_;                               // 数据库文件路径
+    int compress_level_;                                // 发往Agent的请求体的压缩级别
+    size_t compress_threshold_;                         // 压缩的最小请求体字节数
+    int udp_port_;                                      // UDP上报监听端口
     bool running_;                                      // 运行标志
     
     std::unique_ptr<HTTPServer> http_server_;           // HTTP服务器
     std::shared_ptr<DatabaseManager> db_manager_;       // 数据库管理器
     std::shared_ptr<BusinessManager> business_manager_; // 业务管理器
     std::shared_ptr<Scheduler> scheduler_; // 调度器
+    std::shared_ptr<UdpReportServer> udp_server_;       // UDP上报接收
 };
 
 #endif // MANAGER_H
@@ -5,6 +5,7 @@
 #include <algorithm>
 #include <cmath>
 #include <climits>
+#include <limits>
 
 Scheduler::Scheduler(std::shared_ptr<DatabaseManager> db_manager)
     : db_manager_(db_manager) {}
@@ -99,7 +100,7 @@ bool Scheduler::checkNodeAffinity(const std::string &node_id, const nlohmann::js
 std::string Scheduler::selectBestNodeForComponent(const nlohmann::json &component, const nlohmann::json &available_nodes, std::unordered_map<std::string, int> &node_assign_count)
 {
     std::string best_node_id;
-    float best_score = -1.0f;
+    float best_score = std::numeric_limits<float>::lowest();
 
     // 有亲和性，按亲和性优先分配
     nlohmann::json affinity;
@@ -113,13 +114,7 @@ std::string Scheduler::selectBestNodeForComponent(const nlohmann::json &componen
             if (!checkNodeAffinity(node_id, affinity))
                 continue;
 
-            nlohmann::json resource_usage = db_manager_->getNodeResourceInfo(node_id);
-            float cpu_score = 0.0f, memory_score = 0.0f;
-            if (resource_usage.contains("cpu_usage_percent"))
-                cpu_score = 100.0f - resource_usage["cpu_usage_percent"].get<float>();
-            if (resource_usage.contains("memory_usage_percent"))
-                memory_score = 100.0f - resource_usage["memory_usage_percent"].get<float>();
-            float score = 0.5f * cpu_score + 0.5f * memory_score;
+            float score = calculateNodeScore(db_manager_->getNodeResourceInfo(node_id));
             if (score > best_score)
             {
                 best_score = score;
@@ -161,13 +156,7 @@ std::string Scheduler::selectBestNodeForComponent(const nlohmann::json &componen
 
     for (const auto &node_id : candidate_nodes)
     {
-        nlohmann::json resource_usage = db_manager_->getNodeResourceInfo(node_id);
-        float cpu_score = 0.0f, memory_score = 0.0f;
-        if (resource_usage.contains("cpu_usage_percent"))
-            cpu_score = 100.0f - resource_usage["cpu_usage_percent"].get<float>();
-        if (resource_usage.contains("memory_usage_percent"))
-            memory_score = 100.0f - resource_usage["memory_usage_percent"].get<float>();
-        float score = 0.5f * cpu_score + 0.5f * memory_score;
+        float score = calculateNodeScore(db_manager_->getNodeResourceInfo(node_id));
         if (score > best_score)
         {
             best_score = score;
@@ -176,4 +165,24 @@ std::string Scheduler::selectBestNodeForComponent(const nlohmann::json &componen
     }
 
     return best_node_id;
-}
\ No newline at end of file
+}
+
+float Scheduler::calculateNodeScore(const nlohmann::json &resource_usage)
+{
+    float cpu_score = 0.0f, memory_score = 0.0f;
+    if (resource_usage.contains("cpu_usage_percent"))
+        cpu_score = 100.0f - resource_usage["cpu_usage_percent"].get<float>();
+    if (resource_usage.contains("memory_usage_percent"))
+        memory_score = 100.0f - resource_usage["memory_usage_percent"].get<float>();
+    float score = 0.5f * cpu_score + 0.5f * memory_score;
+
+    // 使用率看不出资源争抢，按PSI最近10秒的停顿时间占比扣分，避开正在停顿的节点
+    static const char *const pressure_keys[] = {
+        "cpu_pressure_some_avg10", "memory_pressure_some_avg10", "io_pressure_some_avg10"};
+    for (const char *key : pressure_keys)
+    {
+        if (resource_usage.contains(key))
+            score -= resource_usage[key].get<float>();
+    }
+    return score;
+}
@@ -65,6 +65,14 @@ private:
      */
     std::string selectBestNodeForComponent(const nlohmann::json& component, const nlohmann::json& available_nodes, std::unordered_map<std::string, int>& node_assign_count);
 
+    /**
+     * 计算节点得分，空闲的CPU和内存越多得分越高，资源压力（PSI）越大得分越低
+     * 
+     * @param resource_usage 节点资源信息（getNodeResourceInfo的结果）
+     * @return 节点得分
+     */
+    float calculateNodeScore(const nlohmann::json& resource_usage);
+
 private:
     std::shared_ptr<DatabaseManager> db_manager_;  // 数据库管理器
 };
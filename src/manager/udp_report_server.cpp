@@ -0,0 +1,241 @@
+#include "udp_report_server.h"
+#include "database_manager.h"
+#include "utils/udp_report.h"
+#include "utils/http_compression.h"
+#include "utils/logger.h"
+#include <chrono>
+#include <cstring>
+#include <poll.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+namespace
+{
+
+// 接收缓冲区：保存一批上报的事务执行期间到达的数据报在内核中排队
+const int kUdpReceiveBufferBytes = 4 * 1024 * 1024;
+// 一个事务最多保存的上报数
+const size_t kUdpMaxBatch = 256;
+// 接收线程检查停止标志的间隔
+const int kUdpPollTimeoutMs = 200;
+// 压缩的上报解压后的上限
+const size_t kUdpMaxReportBytes = 1024 * 1024;
+
+}
+
+UdpReportServer::UdpReportServer(std::shared_ptr<DatabaseManager> db_manager, int port)
+    : db_manager_(db_manager), port_(port), fd_(-1), running_(false),
+      datagrams_(0), invalid_(0), saved_(0), failed_(0)
+{
+}
+
+UdpReportServer::~UdpReportServer()
+{
+    stop();
+}
+
+bool UdpReportServer::start()
+{
+    // 监听IPv6通配地址并接受IPv4（映射地址），与HTTP服务器同样对所有地址开放
+    fd_ = socket(AF_INET6, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (fd_ < 0)
+    {
+        LOG_ERROR("Failed to create UDP report socket: {}", strerror(errno));
+        return false;
+    }
+    int off = 0;
+    setsockopt(fd_, IPPROTO_IPV6, IPV6_V6ONLY, &off, sizeof(off));
+    int buffer = kUdpReceiveBufferBytes;
+    setsockopt(fd_, SOL_SOCKET, SO_RCVBUF, &buffer, sizeof(buffer));
+
+    struct sockaddr_in6 addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin6_family = AF_INET6;
+    addr.sin6_addr = in6addr_any;
+    addr.sin6_port = htons(static_cast<uint16_t>(port_));
+    if (bind(fd_, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) != 0)
+    {
+        LOG_ERROR("Failed to bind UDP report port {}: {}", port_, strerror(errno));
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+
+    running_ = true;
+    receive_thread_ = std::thread(&UdpReportServer::receiveLoop, this);
+    LOG_INFO("Listening for UDP reports on port {}", port_);
+    return true;
+}
+
+void UdpReportServer::stop()
+{
+    running_ = false;
+    if (receive_thread_.joinable())
+    {
+        receive_thread_.join();
+    }
+    if (fd_ >= 0)
+    {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+void UdpReportServer::receiveLoop()
+{
+    char buffer[kUdpReportMaxDatagram + 1];
+    nlohmann::json reports = nlohmann::json::array();
+    struct pollfd pfd;
+    pfd.fd = fd_;
+    pfd.events = POLLIN;
+
+    while (running_)
+    {
+        if (poll(&pfd, 1, kUdpPollTimeoutMs) <= 0)
+        {
+            continue;
+        }
+
+        // 取完积压的数据报（最多一批）后一起保存；上报稀疏时每个事务只有一条
+        while (reports.size() < kUdpMaxBatch)
+        {
+            ssize_t size = recv(fd_, buffer, sizeof(buffer), MSG_DONTWAIT);
+            if (size < 0)
+            {
+                break;
+            }
+            ++datagrams_;
+            handleDatagram(buffer, static_cast<size_t>(size), reports);
+        }
+        if (reports.empty())
+        {
+            continue;
+        }
+
+        int saved_count = 0;
+        if (db_manager_->saveResourceUsageBatch(reports, saved_count))
+        {
+            saved_ += static_cast<unsigned long long>(saved_count);
+            failed_ += reports.size() - static_cast<unsigned long long>(saved_count);
+        }
+        else
+        {
+            // UDP上报不重发，保存失败即丢弃
+            LOG_ERROR("Failed to save {} UDP reports", reports.size());
+            failed_ += reports.size();
+        }
+        reports = nlohmann::json::array();
+    }
+}
+
+void UdpReportServer::handleDatagram(const char *data, size_t size, nlohmann::json &reports)
+{
+    // 超过上限的数据报被recv截断，按格式错误丢弃
+    UdpReportHeader header;
+    if (size > kUdpReportMaxDatagram || !parseUdpReportHeader(data, size, header))
+    {
+        ++invalid_;
+        return;
+    }
+
+    const char *payload = data + kUdpReportHeaderSize;
+    size_t payload_size = size - kUdpReportHeaderSize;
+    std::string decompressed;
+    if (header.flags & kUdpFlagGzip)
+    {
+        if (!gzipDecompress(payload, payload_size, kUdpMaxReportBytes, decompressed))
+        {
+            ++invalid_;
+            return;
+        }
+        payload = decompressed.data();
+        payload_size = decompressed.size();
+    }
+
+    nlohmann::json report;
+    try
+    {
+        const uint8_t *bytes = reinterpret_cast<const uint8_t *>(payload);
+        if (header.format == kUdpFormatCbor)
+        {
+            report = nlohmann::json::from_cbor(bytes, bytes + payload_size);
+        }
+        else if (header.format == kUdpFormatMsgPack)
+        {
+            report = nlohmann::json::from_msgpack(bytes, bytes + payload_size);
+        }
+        else
+        {
+            report = nlohmann::json::parse(payload, payload + payload_size);
+        }
+    }
+    catch (const std::exception &e)
+    {
+        ++invalid_;
+        return;
+    }
+    if (!report.is_object() || !report.contains("node_id") || !report["node_id"].is_string())
+    {
+        ++invalid_;
+        return;
+    }
+
+    // 按节点统计：新会话（Agent重启）从收到的序号重新开始，序号跳过的记为丢失，晚到的从丢失中扣除
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        PeerStats &peer = peers_[report["node_id"].get<std::string>()];
+        if (peer.sessions == 0 || header.session != peer.session)
+        {
+            peer.session = header.session;
+            peer.next_seq = header.seq + 1;
+            ++peer.sessions;
+        }
+        else if (header.seq >= peer.next_seq)
+        {
+            peer.lost += header.seq - peer.next_seq;
+            peer.next_seq = header.seq + 1;
+        }
+        else
+        {
+            ++peer.late;
+            if (peer.lost > 0)
+            {
+                --peer.lost;
+            }
+        }
+        ++peer.received;
+        peer.last_seen = std::chrono::duration_cast<std::chrono::seconds>(
+                             std::chrono::system_clock::now().time_since_epoch())
+                             .count();
+    }
+
+    reports.push_back(std::move(report));
+}
+
+nlohmann::json UdpReportServer::getStats()
+{
+    nlohmann::json nodes = nlohmann::json::array();
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        for (const auto &entry : peers_)
+        {
+            const PeerStats &peer = entry.second;
+            unsigned long long expected = peer.received + peer.lost;
+            nodes.push_back({{"node_id", entry.first},
+                             {"received", peer.received},
+                             {"lost", peer.lost},
+                             {"late", peer.late},
+                             {"loss_rate", expected > 0 ? static_cast<double>(peer.lost) / static_cast<double>(expected) : 0.0},
+                             {"sessions", peer.sessions},
+                             {"last_seq", peer.next_seq > 0 ? peer.next_seq - 1 : 0},
+                             {"last_seen", peer.last_seen}});
+        }
+    }
+    return {{"port", port_},
+            {"datagrams", datagrams_.load()},
+            {"invalid", invalid_.load()},
+            {"saved", saved_.load()},
+            {"failed", failed_.load()},
+            {"nodes", nodes}};
+}
@@ -0,0 +1,112 @@
+#ifndef UDP_REPORT_SERVER_H
+#define UDP_REPORT_SERVER_H
+
+#include <string>
+#include <memory>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+
+// 前向声明
+class DatabaseManager;
+
+/**
+ * UdpReportServer类 - UDP上报接收
+ * 
+ * 接收Agent以UDP数据报发送的上报（格式见utils/udp_report.h），与/api/report同样保存。
+ * 一次取完套接字中积压的数据报，在一个事务中保存，Agent数量很多时写事务数不随上报数增长。
+ * 按节点记录会话和序号，统计丢失和乱序到达的数据报
+ */
+class UdpReportServer
+{
+public:
+    /**
+     * 构造函数
+     * 
+     * @param db_manager 数据库管理器
+     * @param port UDP监听端口
+     */
+    UdpReportServer(std::shared_ptr<DatabaseManager> db_manager, int port);
+
+    /**
+     * 析构函数
+     */
+    ~UdpReportServer();
+
+    /**
+     * 绑定端口并启动接收线程
+     * 
+     * @return 是否成功
+     */
+    bool start();
+
+    /**
+     * 停止接收线程并关闭套接字
+     */
+    void stop();
+
+    /**
+     * 获取监听端口
+     * 
+     * @return 端口
+     */
+    int port() const
+    {
+        return port_;
+    }
+
+    /**
+     * 获取接收统计和各节点的丢失统计
+     * 
+     * @return 统计
+     */
+    nlohmann::json getStats();
+
+private:
+    /**
+     * 一个节点的数据报统计
+     */
+    struct PeerStats
+    {
+        uint64_t session = 0;                   // 当前会话
+        uint64_t next_seq = 0;                  // 期望的下一个序号
+        unsigned long long received = 0;        // 收到的数据报数
+        unsigned long long lost = 0;            // 序号缺失的数据报数（后来乱序到达的不计）
+        unsigned long long late = 0;            // 乱序晚到的数据报数
+        unsigned long long sessions = 0;        // 会话数（Agent重启次数加1）
+        long long last_seen = 0;                // 最近收到数据报的时间（秒）
+    };
+
+    /**
+     * 接收线程函数
+     */
+    void receiveLoop();
+
+    /**
+     * 解析一个数据报并记录序号，有效的上报追加到reports
+     * 
+     * @param data 数据报
+     * @param size 数据报长度
+     * @param reports 待保存的上报
+     */
+    void handleDatagram(const char *data, size_t size, nlohmann::json &reports);
+
+private:
+    std::shared_ptr<DatabaseManager> db_manager_;   // 数据库管理器
+    int port_;                                      // UDP监听端口
+    int fd_;                                        // UDP套接字
+    std::atomic<bool> running_;                     // 运行标志
+    std::thread receive_thread_;                    // 接收线程
+
+    std::mutex stats_mutex_;                        // 保护peers_
+    std::map<std::string, PeerStats> peers_;        // 按节点的数据报统计
+    std::atomic<unsigned long long> datagrams_;     // 收到的数据报数
+    std::atomic<unsigned long long> invalid_;       // 格式错误的数据报数
+    std::atomic<unsigned long long> saved_;         // 已保存的上报数
+    std::atomic<unsigned long long> failed_;        // 保存失败的上报数
+};
+
+#endif // UDP_REPORT_SERVER_H
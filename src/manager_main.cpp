@@ -26,6 +26,9 @@ int main(int argc, char* argv[]) {
     // 默认参数
     int port = 8080;
     std::string db_path = "resource_monitor.db";
+    int compress_level = 0;
+    int compress_threshold = 1024;
+    int udp_port = 0;
     
     // 解析命令行参数
     for (int i = 1; i < argc; i++) {
@@ -34,11 +37,20 @@ int main(int argc, char* argv[]) {
             port = std::atoi(argv[++i]);
         } else if (arg == "--db-path" && i + 1 < argc) {
             db_path = argv[++i];
+        } else if (arg == "--compress-level" && i + 1 < argc) {
+            compress_level = std::atoi(argv[++i]);
+        } else if (arg == "--compress-threshold" && i + 1 < argc) {
+            compress_threshold = std::atoi(argv[++i]);
+        } else if (arg == "--udp-port" && i + 1 < argc) {
+            udp_port = std::atoi(argv[++i]);
         } else if (arg == "--help") {
             LOG_INFO("Usage: manager [options]");
             LOG_INFO("Options:");
             LOG_INFO("  --port <port>       HTTP server port (default: 8080)");
             LOG_INFO("  --db-path <path>    Database file path (default: resource_monitor.db)");
+            LOG_INFO("  --compress-level <n>  gzip level 1-9 for deploy/stop requests sent to agents, 0 to disable (default: 0)");
+            LOG_INFO("  --compress-threshold <bytes>  Minimum request body size to compress (default: 1024)");
+            LOG_INFO("  --udp-port <port>   Also accept agent reports as UDP datagrams on this port, 0 to disable (default: 0)");
             LOG_INFO("  --help              Show this help message");
             return 0;
         }
@@ -49,7 +61,8 @@ int main(int argc, char* argv[]) {
     signal(SIGTERM, signalHandler);
     
     // 创建Manager实例
-    g_manager = std::make_unique<Manager>(port, db_path);
+    g_manager = std::make_unique<Manager>(port, db_path, compress_level,
+                                          compress_threshold > 0 ? static_cast<size_t>(compress_threshold) : 0, udp_port);
     
     if (!g_manager->initialize()) {
         LOG_ERROR("Failed to initialize manager");
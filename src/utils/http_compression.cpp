@@ -0,0 +1,146 @@
+#include "utils/http_compression.h"
+#include <ctime>
+#include <zlib.h>
+
+namespace {
+
+// 解压结果的上限，防止异常的响应体解压后耗尽内存
+const size_t kMaxDecompressedBytes = 64 * 1024 * 1024;
+// deflateInit2/inflateInit2的窗口参数：15位窗口，加16表示gzip格式
+const int kGzipWindowBits = 15 + 16;
+
+/**
+ * 当前线程已使用的CPU时间（微秒），用于统计压缩的CPU开销
+ */
+unsigned long long threadCpuMicros() {
+    struct timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) {
+        return 0;
+    }
+    return static_cast<unsigned long long>(ts.tv_sec) * 1000000ULL + static_cast<unsigned long long>(ts.tv_nsec) / 1000;
+}
+
+}
+
+bool gzipCompress(const char* data, size_t size, int level, std::string& out) {
+    z_stream stream = {};
+    if (deflateInit2(&stream, level, Z_DEFLATED, kGzipWindowBits, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return false;
+    }
+
+    // 按上界一次分配，单次deflate完成
+    out.resize(deflateBound(&stream, static_cast<uLong>(size)));
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+    stream.avail_in = static_cast<uInt>(size);
+    stream.next_out = reinterpret_cast<Bytef*>(&out[0]);
+    stream.avail_out = static_cast<uInt>(out.size());
+    int ret = deflate(&stream, Z_FINISH);
+    out.resize(stream.total_out);
+    deflateEnd(&stream);
+    return ret == Z_STREAM_END;
+}
+
+bool gzipDecompress(const char* data, size_t size, size_t max_size, std::string& out) {
+    z_stream stream = {};
+    if (inflateInit2(&stream, kGzipWindowBits) != Z_OK) {
+        return false;
+    }
+
+    out.clear();
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+    stream.avail_in = static_cast<uInt>(size);
+    char buffer[16384];
+    int ret = Z_OK;
+    while (ret == Z_OK) {
+        stream.next_out = reinterpret_cast<Bytef*>(buffer);
+        stream.avail_out = sizeof(buffer);
+        ret = inflate(&stream, Z_NO_FLUSH);
+        if (ret != Z_OK && ret != Z_STREAM_END) {
+            break;
+        }
+        out.append(buffer, sizeof(buffer) - stream.avail_out);
+        if (out.size() > max_size) {
+            ret = Z_MEM_ERROR;
+            break;
+        }
+        // 输入已用完但流未结束，数据被截断
+        if (ret == Z_OK && stream.avail_in == 0 && stream.avail_out != 0) {
+            ret = Z_DATA_ERROR;
+            break;
+        }
+    }
+    inflateEnd(&stream);
+    return ret == Z_STREAM_END;
+}
+
+HttpCompression::HttpCompression(int level, size_t threshold)
+    : level_(level < 0 ? 0 : (level > 9 ? 9 : level)),
+      threshold_(threshold),
+      compressed_(0),
+      skipped_(0),
+      raw_bytes_(0),
+      encoded_bytes_(0),
+      compress_us_(0),
+      decompressed_(0),
+      wire_bytes_(0),
+      decoded_bytes_(0),
+      decompress_us_(0) {
+}
+
+bool HttpCompression::compress(const std::string& body, std::string& out) {
+    int level = level_.load(std::memory_order_relaxed);
+    if (level <= 0) {
+        return false;
+    }
+    if (body.size() < threshold_) {
+        ++skipped_;
+        return false;
+    }
+
+    unsigned long long start = threadCpuMicros();
+    bool ok = gzipCompress(body.data(), body.size(), level, out);
+    compress_us_ += threadCpuMicros() - start;
+
+    // 压缩失败或没有变小时发送原文
+    if (!ok || out.size() >= body.size()) {
+        ++skipped_;
+        return false;
+    }
+    ++compressed_;
+    raw_bytes_ += body.size();
+    encoded_bytes_ += out.size();
+    return true;
+}
+
+bool HttpCompression::decompress(const std::string& body, std::string& out) {
+    unsigned long long start = threadCpuMicros();
+    bool ok = gzipDecompress(body.data(), body.size(), kMaxDecompressedBytes, out);
+    decompress_us_ += threadCpuMicros() - start;
+    if (!ok) {
+        return false;
+    }
+    ++decompressed_;
+    wire_bytes_ += body.size();
+    decoded_bytes_ += out.size();
+    return true;
+}
+
+void HttpCompression::recordDecompressed(size_t wire_bytes, size_t decoded_bytes) {
+    ++decompressed_;
+    wire_bytes_ += wire_bytes;
+    decoded_bytes_ += decoded_bytes;
+}
+
+HttpCompression::Stats HttpCompression::getStats() const {
+    Stats stats;
+    stats.compressed = compressed_;
+    stats.skipped = skipped_;
+    stats.raw_bytes = raw_bytes_;
+    stats.encoded_bytes = encoded_bytes_;
+    stats.compress_us = compress_us_;
+    stats.decompressed = decompressed_;
+    stats.wire_bytes = wire_bytes_;
+    stats.decoded_bytes = decoded_bytes_;
+    stats.decompress_us = decompress_us_;
+    return stats;
+}
@@ -0,0 +1,144 @@
+#ifndef HTTP_COMPRESSION_H
+#define HTTP_COMPRESSION_H
+
+#include <string>
+#include <atomic>
+#include <cstddef>
+
+/**
+ * HttpCompression类 - HTTP请求体/响应体的gzip压缩
+ * 
+ * 发送方对不小于阈值的请求体压缩并带Content-Encoding: gzip，接收方按响应的
+ * Content-Encoding解压。压缩级别为0时不压缩；压缩后不比原文小的请求体按原文发送。
+ * 累计压缩比和压缩/解压耗费的CPU时间，可在多个线程中同时使用
+ */
+class HttpCompression {
+public:
+    /**
+     * 压缩统计
+     */
+    struct Stats {
+        unsigned long long compressed;          // 压缩后发送的请求体数
+        unsigned long long skipped;             // 小于阈值或压缩无收益、按原文发送的请求体数
+        unsigned long long raw_bytes;           // 压缩前的字节数
+        unsigned long long encoded_bytes;       // 压缩后的字节数
+        unsigned long long compress_us;         // 压缩耗费的CPU时间（微秒）
+        unsigned long long decompressed;        // 解压的响应体数
+        unsigned long long wire_bytes;          // 解压前的字节数
+        unsigned long long decoded_bytes;       // 解压后的字节数
+        unsigned long long decompress_us;       // 解压耗费的CPU时间（微秒）
+    };
+
+    /**
+     * 构造函数
+     * 
+     * @param level gzip压缩级别（1-9），0表示不压缩请求体
+     * @param threshold 压缩的最小请求体字节数
+     */
+    HttpCompression(int level = 0, size_t threshold = 1024);
+
+    /**
+     * 是否压缩请求体
+     * 
+     * @return 压缩级别大于0时返回true
+     */
+    bool enabled() const {
+        return level_.load(std::memory_order_relaxed) > 0;
+    }
+
+    /**
+     * 停止压缩请求体（对端不支持Content-Encoding时）
+     */
+    void disable() {
+        level_.store(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * 按阈值压缩请求体
+     * 
+     * @param body 请求体
+     * @param out 输出参数，压缩后的请求体
+     * @return 已压缩时返回true，应发送out并带Content-Encoding: gzip；否则发送原文
+     */
+    bool compress(const std::string& body, std::string& out);
+
+    /**
+     * 解压gzip编码的响应体
+     * 
+     * @param body 响应体
+     * @param out 输出参数，解压后的内容
+     * @return 是否成功，数据损坏或解压后超过上限时返回false
+     */
+    bool decompress(const std::string& body, std::string& out);
+
+    /**
+     * 记录由HTTP库解压的请求体（httplib服务端自动解压gzip请求），只统计个数和字节数，解压耗时无法统计
+     * 
+     * @param wire_bytes 解压前的字节数
+     * @param decoded_bytes 解压后的字节数
+     */
+    void recordDecompressed(size_t wire_bytes, size_t decoded_bytes);
+
+    /**
+     * 获取累计统计
+     * 
+     * @return 压缩统计
+     */
+    Stats getStats() const;
+
+    /**
+     * 获取压缩级别
+     * 
+     * @return 压缩级别，0表示不压缩
+     */
+    int level() const {
+        return level_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * 获取压缩阈值
+     * 
+     * @return 阈值（字节）
+     */
+    size_t threshold() const {
+        return threshold_;
+    }
+
+private:
+    std::atomic<int> level_;                                // gzip压缩级别
+    size_t threshold_;                                      // 压缩的最小请求体字节数
+
+    std::atomic<unsigned long long> compressed_;            // 压缩后发送的请求体数
+    std::atomic<unsigned long long> skipped_;               // 按原文发送的请求体数
+    std::atomic<unsigned long long> raw_bytes_;             // 压缩前的字节数
+    std::atomic<unsigned long long> encoded_bytes_;         // 压缩后的字节数
+    std::atomic<unsigned long long> compress_us_;           // 压缩耗时
+    std::atomic<unsigned long long> decompressed_;          // 解压的响应体数
+    std::atomic<unsigned long long> wire_bytes_;            // 解压前的字节数
+    std::atomic<unsigned long long> decoded_bytes_;         // 解压后的字节数
+    std::atomic<unsigned long long> decompress_us_;         // 解压耗时
+};
+
+/**
+ * gzip压缩
+ * 
+ * @param data 原文
+ * @param size 原文字节数
+ * @param level 压缩级别（1-9）
+ * @param out 输出参数，压缩结果
+ * @return 是否成功
+ */
+bool gzipCompress(const char* data, size_t size, int level, std::string& out);
+
+/**
+ * gzip解压
+ * 
+ * @param data 压缩数据
+ * @param size 压缩数据字节数
+ * @param max_size 解压结果的字节数上限
+ * @param out 输出参数，解压结果
+ * @return 是否成功
+ */
+bool gzipDecompress(const char* data, size_t size, size_t max_size, std::string& out);
+
+#endif // HTTP_COMPRESSION_H
@@ -0,0 +1,619 @@
+#include "utils/metric_delta.h"
+#include <cstring>
+#include <ctime>
+#include <random>
+
+namespace {
+
+/**
+ * 按位写入，高位在前，写完后flush补齐到字节
+ */
+class BitWriter {
+public:
+    explicit BitWriter(std::string& out) : out_(out), current_(0), bits_(0) {
+    }
+
+    void write(uint64_t value, int count) {
+        while (count > 0) {
+            int room = 8 - bits_;
+            int n = count < room ? count : room;
+            uint64_t chunk = (value >> (count - n)) & ((1ULL << n) - 1);
+            current_ = static_cast<unsigned>((current_ << n) | chunk);
+            bits_ += n;
+            count -= n;
+            if (bits_ == 8) {
+                out_ += static_cast<char>(current_);
+                current_ = 0;
+                bits_ = 0;
+            }
+        }
+    }
+
+    void flush() {
+        if (bits_ > 0) {
+            out_ += static_cast<char>(current_ << (8 - bits_));
+            current_ = 0;
+            bits_ = 0;
+        }
+    }
+
+private:
+    std::string& out_;
+    unsigned current_;
+    int bits_;
+};
+
+/**
+ * 按位读取，越界时返回false
+ */
+class BitReader {
+public:
+    BitReader(const char* data, size_t size) : data_(data), size_(size), position_(0) {
+    }
+
+    bool read(int count, uint64_t& value) {
+        if (position_ + static_cast<size_t>(count) > size_ * 8) {
+            return false;
+        }
+        value = 0;
+        while (count > 0) {
+            unsigned char byte = static_cast<unsigned char>(data_[position_ / 8]);
+            int offset = static_cast<int>(position_ % 8);
+            int available = 8 - offset;
+            int n = count < available ? count : available;
+            uint64_t chunk = (byte >> (available - n)) & ((1u << n) - 1);
+            value = (value << n) | chunk;
+            position_ += static_cast<size_t>(n);
+            count -= n;
+        }
+        return true;
+    }
+
+private:
+    const char* data_;
+    size_t size_;
+    size_t position_;
+};
+
+uint64_t zigzag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+int64_t unzigzag(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+// 无符号整数按大小分桶：0+8位、10+16位、110+32位、111+64位
+void writeUnsigned(BitWriter& bits, uint64_t value) {
+    if (value <= 0xFF) {
+        bits.write(0, 1);
+        bits.write(value, 8);
+    } else if (value <= 0xFFFF) {
+        bits.write(2, 2);
+        bits.write(value, 16);
+    } else if (value <= 0xFFFFFFFFULL) {
+        bits.write(6, 3);
+        bits.write(value, 32);
+    } else {
+        bits.write(7, 3);
+        bits.write(value, 64);
+    }
+}
+
+bool readUnsigned(BitReader& bits, uint64_t& value) {
+    static const int kWidths[] = {8, 16, 32, 64};
+    int bucket = 0;
+    uint64_t flag = 0;
+    while (bucket < 3) {
+        if (!bits.read(1, flag)) {
+            return false;
+        }
+        if (flag == 0) {
+            break;
+        }
+        ++bucket;
+    }
+    return bits.read(kWidths[bucket], value);
+}
+
+int leadingZeros(uint64_t value) {
+    return __builtin_clzll(value);
+}
+
+int trailingZeros(uint64_t value) {
+    return __builtin_ctzll(value);
+}
+
+// 写入一个值：1位是否变化，变化时按类型写入相对上一次的值，并更新上一次的值
+void encodeValue(BitWriter& bits, DeltaValue& previous, const DeltaValue& value) {
+    bool changed = value.type == kDeltaString ? value.text != previous.text : value.bits != previous.bits;
+    bits.write(changed ? 1 : 0, 1);
+    if (!changed) {
+        return;
+    }
+
+    switch (value.type) {
+        case kDeltaDouble: {
+            // Gorilla：异或结果的有效位落在上一次的窗口内时写0和窗口内的位，
+            // 否则写1、前导零位数（5位）、有效位长度-1（6位）和有效位
+            uint64_t xored = value.bits ^ previous.bits;
+            int leading = leadingZeros(xored);
+            int trailing = trailingZeros(xored);
+            if (leading > 31) {
+                leading = 31;
+            }
+            if (previous.leading >= 0 && leading >= previous.leading && trailing >= previous.trailing) {
+                bits.write(0, 1);
+                bits.write(xored >> previous.trailing, 64 - previous.leading - previous.trailing);
+            } else {
+                int length = 64 - leading - trailing;
+                bits.write(1, 1);
+                bits.write(static_cast<uint64_t>(leading), 5);
+                bits.write(static_cast<uint64_t>(length - 1), 6);
+                bits.write(xored >> trailing, length);
+                previous.leading = leading;
+                previous.trailing = trailing;
+            }
+            break;
+        }
+        case kDeltaInt:
+        case kDeltaUint:
+            writeUnsigned(bits, zigzag(static_cast<int64_t>(value.bits - previous.bits)));
+            break;
+        case kDeltaString:
+            writeUnsigned(bits, value.text.size());
+            for (char c : value.text) {
+                bits.write(static_cast<unsigned char>(c), 8);
+            }
+            previous.text = value.text;
+            break;
+        default:
+            // 布尔值变化即取反，无需写入
+            break;
+    }
+    previous.bits = value.bits;
+}
+
+// 读取一个值并更新，返回-1表示数据错误，0表示未变化，1表示已变化
+int decodeValue(BitReader& bits, DeltaValue& value) {
+    uint64_t changed = 0;
+    if (!bits.read(1, changed)) {
+        return -1;
+    }
+    if (changed == 0) {
+        return 0;
+    }
+
+    switch (value.type) {
+        case kDeltaDouble: {
+            uint64_t control = 0;
+            if (!bits.read(1, control)) {
+                return -1;
+            }
+            if (control == 1) {
+                uint64_t leading = 0;
+                uint64_t length = 0;
+                if (!bits.read(5, leading) || !bits.read(6, length)) {
+                    return -1;
+                }
+                if (leading + length + 1 > 64) {
+                    return -1;
+                }
+                value.leading = static_cast<int>(leading);
+                value.trailing = 64 - static_cast<int>(leading) - static_cast<int>(length) - 1;
+            } else if (value.leading < 0) {
+                return -1;
+            }
+            uint64_t meaningful = 0;
+            if (!bits.read(64 - value.leading - value.trailing, meaningful)) {
+                return -1;
+            }
+            value.bits ^= meaningful << value.trailing;
+            break;
+        }
+        case kDeltaInt:
+        case kDeltaUint: {
+            uint64_t delta = 0;
+            if (!readUnsigned(bits, delta)) {
+                return -1;
+            }
+            value.bits += static_cast<uint64_t>(unzigzag(delta));
+            break;
+        }
+        case kDeltaString: {
+            uint64_t length = 0;
+            if (!readUnsigned(bits, length) || length > 0xFFFFFF) {
+                return -1;
+            }
+            value.text.resize(static_cast<size_t>(length));
+            for (size_t i = 0; i < value.text.size(); ++i) {
+                uint64_t c = 0;
+                if (!bits.read(8, c)) {
+                    return -1;
+                }
+                value.text[i] = static_cast<char>(c);
+            }
+            break;
+        }
+        default:
+            value.bits ^= 1;
+            break;
+    }
+    return 1;
+}
+
+bool readVarint(const char*& p, const char* end, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && p < end; shift += 7) {
+        unsigned char byte = static_cast<unsigned char>(*p++);
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// 读取结构中的一个记号及其字段名
+bool readToken(const char*& p, const char* end, unsigned char& token, const char*& key, size_t& key_length) {
+    if (p >= end) {
+        return false;
+    }
+    token = static_cast<unsigned char>(*p++);
+    key = nullptr;
+    key_length = 0;
+    if (token == kDeltaEndObject || token == kDeltaEndArray) {
+        return true;
+    }
+    if (token < kDeltaBeginObject || token > kDeltaNull) {
+        return false;
+    }
+    uint64_t length = 0;
+    if (!readVarint(p, end, length) || length > static_cast<uint64_t>(end - p) + 1) {
+        return false;
+    }
+    if (length > 0) {
+        key = p;
+        key_length = static_cast<size_t>(length - 1);
+        p += key_length;
+    }
+    return true;
+}
+
+// 在对象或数组中添加一个子元素，对象缺少字段名或字段名重复时返回nullptr
+nlohmann::json* addChild(nlohmann::json& parent, const char* key, size_t key_length) {
+    if (parent.is_array()) {
+        parent.push_back(nullptr);
+        return &parent.back();
+    }
+    if (!key) {
+        return nullptr;
+    }
+    std::string name(key, key_length);
+    if (parent.contains(name)) {
+        // 重复的字段会替换前一个定义，第二遍按前一个定义定位时会越界或类型不符
+        return nullptr;
+    }
+    return &parent[name];
+}
+
+// 按第一遍建立的上报定位子元素，不存在时返回nullptr（不会扩展数组或添加字段）
+nlohmann::json* findChild(nlohmann::json& parent, size_t index, const char* key, size_t key_length) {
+    if (parent.is_array()) {
+        return index < parent.size() ? &parent[index] : nullptr;
+    }
+    if (!parent.is_object() || !key) {
+        return nullptr;
+    }
+    auto it = parent.find(std::string(key, key_length));
+    return it != parent.end() ? &*it : nullptr;
+}
+
+// 把值写入还原的上报
+void applyValue(nlohmann::json& slot, const DeltaValue& value) {
+    switch (value.type) {
+        case kDeltaDouble: {
+            double number;
+            memcpy(&number, &value.bits, sizeof(number));
+            slot = number;
+            break;
+        }
+        case kDeltaInt:
+            slot = static_cast<long long>(value.bits);
+            break;
+        case kDeltaUint:
+            slot = static_cast<unsigned long long>(value.bits);
+            break;
+        case kDeltaString:
+            slot = value.text;
+            break;
+        default:
+            slot = value.bits != 0;
+            break;
+    }
+}
+
+}
+
+void appendDeltaVarint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out += static_cast<char>((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    out += static_cast<char>(value);
+}
+
+DeltaEncoder::DeltaEncoder(size_t keyframe_interval, size_t max_schemas)
+    : keyframe_interval_(keyframe_interval > 0 ? keyframe_interval : 1),
+      seq_(0),
+      frames_since_keyframe_(keyframe_interval_),
+      schemas_(max_schemas < 1 ? 1 : (max_schemas > 256 ? 256 : max_schemas)),
+      keyframe_requested_(false),
+      keyframes_(0) {
+    std::random_device random;
+    stream_id_ = (static_cast<uint64_t>(random()) << 32) ^ random();
+}
+
+void DeltaEncoder::encode(const DeltaSample& sample, std::string& out) {
+    unsigned char flags = 0;
+    if (keyframe_requested_.exchange(false, std::memory_order_relaxed) || frames_since_keyframe_ >= keyframe_interval_) {
+        for (auto& schema : schemas_) {
+            schema.tokens.clear();
+        }
+        frames_since_keyframe_ = 0;
+        flags |= kDeltaFlagKeyframe;
+        ++keyframes_;
+    }
+
+    // 查找相同的结构；没有时占用空闲编号，或替换最久未用的结构并重新定义
+    size_t id = schemas_.size();
+    for (size_t i = 0; i < schemas_.size(); ++i) {
+        if (schemas_[i].tokens == sample.schema) {
+            id = i;
+            break;
+        }
+    }
+    if (id == schemas_.size()) {
+        id = 0;
+        for (size_t i = 0; i < schemas_.size(); ++i) {
+            if (schemas_[i].tokens.empty()) {
+                id = i;
+                break;
+            }
+            if (schemas_[i].last_seq < schemas_[id].last_seq) {
+                id = i;
+            }
+        }
+        Schema& schema = schemas_[id];
+        schema.tokens = sample.schema;
+        schema.values.assign(sample.count, DeltaValue());
+        for (size_t i = 0; i < sample.count; ++i) {
+            schema.values[i].type = sample.values[i].type;
+        }
+        flags |= kDeltaFlagSchema;
+    }
+    Schema& schema = schemas_[id];
+
+    out += static_cast<char>(kDeltaFrameMagic);
+    out += static_cast<char>(kDeltaFrameVersion);
+    out += static_cast<char>(flags);
+    for (int shift = 0; shift < 64; shift += 8) {
+        out += static_cast<char>((stream_id_ >> shift) & 0xFF);
+    }
+    appendDeltaVarint(out, seq_);
+    out += static_cast<char>(id);
+    if (flags & kDeltaFlagSchema) {
+        appendDeltaVarint(out, schema.tokens.size());
+        out += schema.tokens;
+    }
+
+    values_buffer_.clear();
+    BitWriter bits(values_buffer_);
+    for (size_t i = 0; i < sample.count; ++i) {
+        encodeValue(bits, schema.values[i], sample.values[i]);
+    }
+    bits.flush();
+    appendDeltaVarint(out, values_buffer_.size());
+    out += values_buffer_;
+
+    schema.last_seq = seq_;
+    ++seq_;
+    ++frames_since_keyframe_;
+}
+
+DeltaDecoder::DeltaDecoder(int idle_timeout_sec) : idle_timeout_sec_(idle_timeout_sec) {
+}
+
+DeltaDecoder::Result DeltaDecoder::decode(const char* data, size_t size, size_t& consumed,
+                                          uint64_t& stream_id, const nlohmann::json*& report) {
+    const char* p = data;
+    const char* end = data + size;
+    if (size < 11 || static_cast<unsigned char>(p[0]) != kDeltaFrameMagic ||
+        static_cast<unsigned char>(p[1]) != kDeltaFrameVersion) {
+        return kDecodeInvalid;
+    }
+    unsigned char flags = static_cast<unsigned char>(p[2]);
+    stream_id = 0;
+    for (int i = 0; i < 8; ++i) {
+        stream_id |= static_cast<uint64_t>(static_cast<unsigned char>(p[3 + i])) << (i * 8);
+    }
+    p += 11;
+
+    // 先确认整帧完整，再改动流状态
+    uint64_t seq = 0;
+    uint64_t schema_length = 0;
+    uint64_t values_length = 0;
+    if (!readVarint(p, end, seq) || p >= end) {
+        return kDecodeInvalid;
+    }
+    size_t id = static_cast<unsigned char>(*p++);
+    const char* schema_data = p;
+    if (flags & kDeltaFlagSchema) {
+        if (!readVarint(p, end, schema_length) || schema_length > static_cast<uint64_t>(end - p)) {
+            return kDecodeInvalid;
+        }
+        schema_data = p;
+        p += schema_length;
+    }
+    if (!readVarint(p, end, values_length) || values_length > static_cast<uint64_t>(end - p)) {
+        return kDecodeInvalid;
+    }
+    const char* values_data = p;
+    p += values_length;
+    consumed = static_cast<size_t>(p - data);
+
+    long long now = static_cast<long long>(time(nullptr));
+    auto it = streams_.find(stream_id);
+    if (flags & kDeltaFlagKeyframe) {
+        if (it == streams_.end()) {
+            // 新流：顺带清理长时间没有上报的流
+            for (auto stale = streams_.begin(); stale != streams_.end();) {
+                if (now - stale->second.last_used > idle_timeout_sec_) {
+                    stale = streams_.erase(stale);
+                } else {
+                    ++stale;
+                }
+            }
+            it = streams_.emplace(stream_id, Stream()).first;
+        } else {
+            it->second.schemas.clear();
+        }
+    } else if (it == streams_.end() || seq != it->second.next_seq) {
+        return kDecodeKeyframeRequired;
+    }
+    Stream& stream = it->second;
+
+    if (id >= stream.schemas.size()) {
+        stream.schemas.resize(id + 1);
+    }
+    Schema& schema = stream.schemas[id];
+    if (flags & kDeltaFlagSchema) {
+        schema.tokens.assign(schema_data, static_cast<size_t>(schema_length));
+        if (!buildSchema(schema)) {
+            streams_.erase(it);
+            return kDecodeInvalid;
+        }
+    } else if (schema.tokens.empty()) {
+        streams_.erase(it);
+        return kDecodeKeyframeRequired;
+    }
+
+    // 只更新变化的字段，其余字段保持上一次还原的值
+    BitReader bits(values_data, static_cast<size_t>(values_length));
+    for (size_t i = 0; i < schema.values.size(); ++i) {
+        int changed = decodeValue(bits, schema.values[i]);
+        if (changed < 0) {
+            streams_.erase(it);
+            return kDecodeInvalid;
+        }
+        if (changed > 0) {
+            applyValue(*schema.slots[i], schema.values[i]);
+        }
+    }
+
+    stream.next_seq = seq + 1;
+    stream.last_used = now;
+    report = &schema.report;
+    return kDecodeOk;
+}
+
+void DeltaDecoder::invalidate(uint64_t stream_id) {
+    streams_.erase(stream_id);
+}
+
+bool DeltaDecoder::buildSchema(Schema& schema) {
+    const char* begin = schema.tokens.data();
+    const char* end = begin + schema.tokens.size();
+    unsigned char token;
+    const char* key;
+    size_t key_length;
+
+    // 第一遍按结构建立上报，值为各类型的零值（与编码两侧的初始值一致）
+    schema.report = nlohmann::json();
+    schema.values.clear();
+    std::vector<nlohmann::json*> stack;
+    const char* p = begin;
+    while (p < end) {
+        if (!readToken(p, end, token, key, key_length)) {
+            return false;
+        }
+        if (token == kDeltaEndObject || token == kDeltaEndArray) {
+            if (stack.empty() || stack.back()->is_array() != (token == kDeltaEndArray)) {
+                return false;
+            }
+            stack.pop_back();
+            if (stack.empty() && p != end) {
+                return false;
+            }
+            continue;
+        }
+
+        nlohmann::json* node = nullptr;
+        if (stack.empty()) {
+            if (token != kDeltaBeginObject || !schema.report.is_null()) {
+                return false;
+            }
+            node = &schema.report;
+        } else {
+            node = addChild(*stack.back(), key, key_length);
+            if (!node) {
+                return false;
+            }
+        }
+
+        DeltaValue value;
+        value.type = token;
+        switch (token) {
+            case kDeltaBeginObject:
+                *node = nlohmann::json::object();
+                stack.push_back(node);
+                continue;
+            case kDeltaBeginArray:
+                *node = nlohmann::json::array();
+                stack.push_back(node);
+                continue;
+            case kDeltaNull:
+                *node = nullptr;
+                continue;
+            default:
+                applyValue(*node, value);
+                schema.values.push_back(value);
+                break;
+        }
+    }
+    if (!stack.empty() || !schema.report.is_object()) {
+        return false;
+    }
+
+    // 第二遍按同样的顺序定位各值，此时数组不再增长，元素地址稳定
+    schema.slots.clear();
+    std::vector<std::pair<nlohmann::json*, size_t>> path;
+    p = begin;
+    while (p < end) {
+        readToken(p, end, token, key, key_length);
+        if (token == kDeltaEndObject || token == kDeltaEndArray) {
+            if (path.empty()) {
+                return false;
+            }
+            path.pop_back();
+            continue;
+        }
+
+        nlohmann::json* node = &schema.report;
+        if (!path.empty()) {
+            node = findChild(*path.back().first, path.back().second++, key, key_length);
+            if (!node) {
+                return false;
+            }
+        }
+        if (token == kDeltaBeginObject || token == kDeltaBeginArray) {
+            if (node->is_array() != (token == kDeltaBeginArray)) {
+                return false;
+            }
+            path.emplace_back(node, 0);
+        } else if (token != kDeltaNull) {
+            schema.slots.push_back(node);
+        }
+    }
+    return schema.slots.size() == schema.values.size();
+}
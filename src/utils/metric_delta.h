@@ -0,0 +1,221 @@
+#ifndef METRIC_DELTA_H
+#define METRIC_DELTA_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+
+/**
+ * 增量编码的上报流（Agent编码，Manager解码）
+ * 
+ * 一次上报拆成结构（字段名和类型的序列）和值两部分。结构在流内定义一次后按编号引用，
+ * 值只发送与同一结构上一次上报相比变化的字段：整数发送差值，浮点数与上一次的值按位异或后
+ * 按Gorilla方式只写有效位，未变化的字段只占1位。关键帧清空双方状态，所有值相对0编码。
+ * 
+ * 帧格式（自带长度，批量上报时直接拼接）：
+ *   magic(0xD5) version flags stream_id(8字节小端) seq(varint) schema_id(1字节)
+ *   [schema_length(varint) schema]  flags含kDeltaFlagSchema时
+ *   values_length(varint) values    值的位流
+ */
+
+const unsigned char kDeltaFrameMagic = 0xD5;
+const unsigned char kDeltaFrameVersion = 1;
+const unsigned char kDeltaFlagKeyframe = 0x01;     // 关键帧：丢弃流的全部状态后再解码
+const unsigned char kDeltaFlagSchema = 0x02;       // 帧内带结构定义，该编号的值状态清零
+
+/**
+ * 结构中的记号，记号字节后除endObject/endArray外跟字段名（varint(长度+1)，数组元素为0）
+ */
+enum DeltaToken {
+    kDeltaBeginObject = 1,
+    kDeltaEndObject = 2,
+    kDeltaBeginArray = 3,
+    kDeltaEndArray = 4,
+    kDeltaDouble = 5,
+    kDeltaInt = 6,
+    kDeltaUint = 7,
+    kDeltaString = 8,
+    kDeltaBool = 9,
+    kDeltaNull = 10                                 // 只出现在结构中，没有值
+};
+
+/**
+ * 一个字段的值，同时作为编解码两侧保存的上一次的值
+ */
+struct DeltaValue {
+    unsigned char type = kDeltaNull;                // 记号类型
+    uint64_t bits = 0;                              // 浮点数的位模式，或整数/布尔值
+    std::string text;                               // 字符串值
+    int leading = -1;                               // 浮点数上一次异或的前导零位数，-1表示尚无
+    int trailing = 0;                               // 浮点数上一次异或的末尾零位数
+};
+
+/**
+ * 一次上报的结构和值，由DeltaWriter填充后交给DeltaEncoder编码
+ */
+struct DeltaSample {
+    std::string schema;                             // 结构（记号序列）
+    std::vector<DeltaValue> values;                 // 值，前count个有效，元素在上报间复用
+    size_t count = 0;                               // 值的个数
+};
+
+/**
+ * DeltaEncoder类 - Agent侧增量编码器
+ * 
+ * 每个结构保存上一次的值。首帧、每keyframe_interval帧以及Manager要求时发送关键帧；
+ * 结构数超过上限时替换最久未用的结构。只由采集线程调用encode，requestKeyframe可在其他线程调用
+ */
+class DeltaEncoder {
+public:
+    /**
+     * 构造函数
+     * 
+     * @param keyframe_interval 关键帧间隔（帧数）
+     * @param max_schemas 同时保留的结构数上限（不超过256）
+     */
+    DeltaEncoder(size_t keyframe_interval, size_t max_schemas);
+
+    /**
+     * 编码一次上报
+     * 
+     * @param sample 上报的结构和值
+     * @param out 输出缓冲区，帧追加在末尾
+     */
+    void encode(const DeltaSample& sample, std::string& out);
+
+    /**
+     * 要求下一帧为关键帧（Manager检测到序号不连续时）
+     */
+    void requestKeyframe() {
+        keyframe_requested_.store(true, std::memory_order_relaxed);
+    }
+
+    /**
+     * 获取已编码的关键帧数
+     * 
+     * @return 关键帧数
+     */
+    unsigned long long keyframes() const {
+        return keyframes_.load(std::memory_order_relaxed);
+    }
+
+private:
+    /**
+     * 一个已定义的结构
+     */
+    struct Schema {
+        std::string tokens;                         // 结构，为空表示编号未使用
+        std::vector<DeltaValue> values;             // 上一次的值
+        uint64_t last_seq = 0;                      // 最近使用的帧序号
+    };
+
+private:
+    size_t keyframe_interval_;                      // 关键帧间隔
+    uint64_t stream_id_;                            // 流标识，每次启动随机生成
+    uint64_t seq_;                                  // 下一帧的序号
+    size_t frames_since_keyframe_;                  // 距上一个关键帧的帧数
+    std::vector<Schema> schemas_;                   // 按编号排列的结构
+    std::string values_buffer_;                     // 复用的值位流缓冲区
+    std::atomic<bool> keyframe_requested_;          // 是否要求关键帧
+    std::atomic<unsigned long long> keyframes_;     // 已编码的关键帧数
+};
+
+/**
+ * DeltaDecoder类 - Manager侧增量解码器
+ * 
+ * 按流保存各结构还原出的完整上报及其值，增量帧只更新变化的字段。
+ * 非关键帧的序号必须紧接上一帧，否则（Agent丢帧、Manager重启）返回kDecodeKeyframeRequired，
+ * 由调用方通知Agent发送关键帧。不是线程安全的，由调用方加锁
+ */
+class DeltaDecoder {
+public:
+    /**
+     * 解码结果
+     */
+    enum Result {
+        kDecodeOk,                  // 已还原出完整上报
+        kDecodeKeyframeRequired,    // 流状态缺失或序号不连续，帧被跳过
+        kDecodeInvalid              // 帧格式错误
+    };
+
+    /**
+     * 构造函数
+     * 
+     * @param idle_timeout_sec 流多久未收到帧后丢弃其状态（秒）
+     */
+    explicit DeltaDecoder(int idle_timeout_sec = 600);
+
+    /**
+     * 解码一帧
+     * 
+     * @param data 帧数据
+     * @param size 可用的字节数
+     * @param consumed 输出参数，帧的长度（kDecodeInvalid时无意义）
+     * @param stream_id 输出参数，帧所属的流
+     * @param report 输出参数，还原出的完整上报，在同一流的下一次解码前有效
+     * @return 解码结果
+     */
+    Result decode(const char* data, size_t size, size_t& consumed, uint64_t& stream_id, const nlohmann::json*& report);
+
+    /**
+     * 丢弃一个流的状态（还原出的上报未能保存时），该流的下一帧须为关键帧
+     * 
+     * @param stream_id 流标识
+     */
+    void invalidate(uint64_t stream_id);
+
+    /**
+     * 获取当前保存状态的流数
+     * 
+     * @return 流数
+     */
+    size_t streamCount() const {
+        return streams_.size();
+    }
+
+private:
+    /**
+     * 一个结构的还原状态
+     */
+    struct Schema {
+        std::string tokens;                         // 结构
+        std::vector<DeltaValue> values;             // 上一次的值
+        nlohmann::json report;                      // 还原出的完整上报
+        std::vector<nlohmann::json*> slots;         // 各值在report中的位置
+    };
+
+    /**
+     * 一个流的还原状态
+     */
+    struct Stream {
+        uint64_t next_seq = 0;                      // 期望的下一帧序号
+        std::vector<Schema> schemas;                // 按编号排列的结构
+        long long last_used = 0;                    // 最近收到帧的时间（秒）
+    };
+
+    /**
+     * 按结构建立还原的上报和值的位置
+     * 
+     * @param schema 结构
+     * @return 结构有效时返回true
+     */
+    static bool buildSchema(Schema& schema);
+
+private:
+    int idle_timeout_sec_;                          // 流状态的空闲超时
+    std::map<uint64_t, Stream> streams_;            // 按流标识保存的状态
+};
+
+/**
+ * 追加varint编码的无符号整数（每字节7位，低位在前）
+ * 
+ * @param out 输出缓冲区
+ * @param value 数值
+ */
+void appendDeltaVarint(std::string& out, uint64_t value);
+
+#endif // METRIC_DELTA_H
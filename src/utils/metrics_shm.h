@@ -0,0 +1,217 @@
+#ifndef METRICS_SHM_H
+#define METRICS_SHM_H
+
+#include <string>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/**
+ * 本机指标共享内存（Agent写入，同机的其他服务只读映射）
+ * 
+ * Agent每完成一次CPU、内存采集和每次上报前的组件状态都写入一个内存映射文件（默认在/dev/shm下），
+ * 布局固定为下面的结构体，读取方不需要调用Manager也不需要解析JSON。
+ * 
+ * 用seqlock保护：写入前后各把seq加1（写入期间为奇数），读取方复制数据前后读seq，
+ * 两次相同且为偶数即为一致的快照，否则重试。读取方不加锁、不阻塞写入方。
+ * 只有Agent的采集线程写入，数值均为本机字节序。
+ * 
+ * 本文件只依赖标准库和POSIX，其他服务直接包含即可使用MetricsShmReader
+ */
+
+const uint32_t kMetricsShmMagic = 0x524D5348;           // "RMSH"
+const uint32_t kMetricsShmVersion = 1;
+const uint32_t kMetricsShmMaxCores = 256;
+const uint32_t kMetricsShmMaxComponents = 64;
+const size_t kMetricsShmIdSize = 64;                    // 组件ID、业务ID，含结尾的'\0'，超长截断
+const size_t kMetricsShmStatusSize = 16;                // 组件状态，含结尾的'\0'
+const char* const kMetricsShmDefaultPath = "/dev/shm/resource_monitor_metrics";
+
+/**
+ * 一个CPU核心
+ */
+struct MetricsShmCore {
+    int32_t core;                           // 核心编号
+    uint32_t reserved;
+    double usage_percent;
+    double iowait_percent;
+    double irq_percent;
+    double steal_percent;
+};
+
+/**
+ * CPU样本，time_ns为0表示尚未采集
+ */
+struct MetricsShmCpu {
+    int64_t time_ns;                        // 采集时间（系统时间，纳秒）
+    double usage_percent;                   // 整体使用率，读取失败时为-1
+    double user_percent;
+    double system_percent;
+    double iowait_percent;
+    double irq_percent;
+    double steal_percent;
+    double load_avg[3];                     // 1分钟、5分钟、15分钟负载
+    int32_t core_count;                     // 在线核心数
+    uint32_t cores;                         // cores[]中的有效项数，不超过kMetricsShmMaxCores
+};
+
+/**
+ * 内存样本（字节），time_ns为0表示尚未采集
+ */
+struct MetricsShmMemory {
+    int64_t time_ns;                        // 采集时间（系统时间，纳秒）
+    uint64_t total;
+    uint64_t used;
+    uint64_t free;
+    double usage_percent;
+};
+
+/**
+ * 一个组件的状态和资源使用
+ */
+struct MetricsShmComponent {
+    char component_id[kMetricsShmIdSize];
+    char business_id[kMetricsShmIdSize];
+    char status[kMetricsShmStatusSize];     // running、stopped等
+    int64_t timestamp;                      // 状态收集时间（秒）
+    uint32_t has_usage;                     // 是否有资源使用数据（只有运行中的组件有）
+    uint32_t reserved;
+    double cpu_percent;                     // 100表示占满一个核心
+    uint64_t memory_bytes;
+};
+
+/**
+ * 一份完整的快照。读取方应复用同一个对象（约20KB），不要放在栈上反复构造
+ */
+struct MetricsShmSnapshot {
+    uint64_t updates;                       // 累计写入次数
+    int32_t writer_pid;                     // 写入方Agent的进程号，Agent正常退出后为0
+    uint32_t component_count;               // components[]中的有效项数，不超过kMetricsShmMaxComponents
+    int64_t components_time_ns;             // 组件状态的写入时间，0表示尚未写入
+    MetricsShmMemory memory;
+    MetricsShmCpu cpu;
+    MetricsShmCore cores[kMetricsShmMaxCores];
+    MetricsShmComponent components[kMetricsShmMaxComponents];
+};
+
+/**
+ * 映射文件的布局。seq单独占一个缓存行，读取方轮询seq时不与数据的写入争用同一缓存行
+ */
+struct MetricsShmRegion {
+    uint32_t magic;                         // kMetricsShmMagic，初始化完成后写入
+    uint32_t version;                       // kMetricsShmVersion
+    uint32_t size;                          // sizeof(MetricsShmRegion)
+    uint32_t reserved;
+    alignas(64) std::atomic<uint64_t> seq;  // seqlock序号，奇数表示正在写入
+    alignas(64) MetricsShmSnapshot data;
+};
+
+/**
+ * MetricsShmReader类 - 本机指标共享内存读取
+ * 
+ * 只读映射Agent写入的文件，read()复制一份一致的快照，不加锁
+ */
+class MetricsShmReader {
+public:
+    MetricsShmReader() : region_(nullptr) {}
+
+    ~MetricsShmReader() {
+        close();
+    }
+
+    MetricsShmReader(const MetricsShmReader&) = delete;
+    MetricsShmReader& operator=(const MetricsShmReader&) = delete;
+
+    /**
+     * 只读映射指标文件
+     * 
+     * @param path 文件路径，与Agent的--shm-path相同
+     * @return 文件存在且布局版本一致时返回true；Agent尚未启动时返回false，可稍后重试
+     */
+    bool open(const std::string& path = kMetricsShmDefaultPath) {
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st;
+        void* addr = MAP_FAILED;
+        if (fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= sizeof(MetricsShmRegion)) {
+            addr = mmap(nullptr, sizeof(MetricsShmRegion), PROT_READ, MAP_SHARED, fd, 0);
+        }
+        ::close(fd);
+        if (addr == MAP_FAILED) {
+            return false;
+        }
+        const MetricsShmRegion* region = static_cast<const MetricsShmRegion*>(addr);
+        if (__atomic_load_n(&region->magic, __ATOMIC_ACQUIRE) != kMetricsShmMagic ||
+            region->version != kMetricsShmVersion || region->size != sizeof(MetricsShmRegion)) {
+            munmap(addr, sizeof(MetricsShmRegion));
+            return false;
+        }
+        region_ = region;
+        return true;
+    }
+
+    /**
+     * 解除映射
+     */
+    void close() {
+        if (region_) {
+            munmap(const_cast<MetricsShmRegion*>(region_), sizeof(MetricsShmRegion));
+            region_ = nullptr;
+        }
+    }
+
+    /**
+     * 是否已映射
+     * 
+     * @return 是否已映射
+     */
+    bool isOpen() const {
+        return region_ != nullptr;
+    }
+
+    /**
+     * 复制一份一致的快照。只复制有效的核心和组件，写入期间重试
+     * 
+     * @param snapshot 输出参数，快照
+     * @param max_attempts 最多尝试次数，写入方在写入中途退出时不会无限重试
+     * @return 是否读到一致的快照
+     */
+    bool read(MetricsShmSnapshot& snapshot, int max_attempts = 1000) const {
+        if (!region_) {
+            return false;
+        }
+        const MetricsShmSnapshot& data = region_->data;
+        for (int attempt = 0; attempt < max_attempts; ++attempt) {
+            uint64_t begin = region_->seq.load(std::memory_order_acquire);
+            if (begin & 1) {
+                continue;
+            }
+            memcpy(&snapshot, &data, offsetof(MetricsShmSnapshot, cores));
+            uint32_t cores = snapshot.cpu.cores < kMetricsShmMaxCores ? snapshot.cpu.cores : kMetricsShmMaxCores;
+            uint32_t components = snapshot.component_count < kMetricsShmMaxComponents ? snapshot.component_count : kMetricsShmMaxComponents;
+            memcpy(snapshot.cores, data.cores, cores * sizeof(MetricsShmCore));
+            memcpy(snapshot.components, data.components, components * sizeof(MetricsShmComponent));
+            // 复制的数据在第二次读seq之前完成；seq未变说明复制期间没有写入
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (region_->seq.load(std::memory_order_relaxed) == begin) {
+                snapshot.cpu.cores = cores;
+                snapshot.component_count = components;
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    const MetricsShmRegion* region_;        // 只读映射的区域
+};
+
+#endif // METRICS_SHM_H
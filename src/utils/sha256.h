@@ -0,0 +1,50 @@
+#ifndef SHA256_H
+#define SHA256_H
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Sha256类 - SHA-256摘要（FIPS 180-4）
+ *
+ * 数据可分块多次传入，用于边下载边计算制品的内容摘要
+ */
+class Sha256 {
+public:
+    Sha256();
+
+    /**
+     * 追加数据
+     *
+     * @param data 数据
+     * @param size 长度
+     */
+    void update(const void* data, size_t size);
+
+    /**
+     * 结束计算，之后不能再追加数据
+     *
+     * @return 64个字符的小写十六进制摘要
+     */
+    std::string hexDigest();
+
+    /**
+     * 计算文件的摘要
+     *
+     * @param path 文件路径
+     * @param digest 输出参数，小写十六进制摘要
+     * @return 文件是否读取成功
+     */
+    static bool hashFile(const std::string& path, std::string& digest);
+
+private:
+    void transform(const unsigned char* block);
+
+    uint32_t state_[8];
+    unsigned char block_[64];
+    size_t block_size_;             // block_中已有的字节数
+    uint64_t total_;                // 累计字节数
+};
+
+#endif // SHA256_H
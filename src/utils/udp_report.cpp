@@ -0,0 +1,41 @@
+#include "utils/udp_report.h"
+
+namespace {
+
+void appendUint64(std::string& out, uint64_t value) {
+    for (int i = 0; i < 8; ++i) {
+        out += static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+}
+
+uint64_t readUint64(const char* data) {
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; --i) {
+        value = (value << 8) | static_cast<unsigned char>(data[i]);
+    }
+    return value;
+}
+
+}
+
+void appendUdpReportHeader(std::string& out, const UdpReportHeader& header) {
+    out += static_cast<char>(kUdpReportMagic);
+    out += static_cast<char>(kUdpReportVersion);
+    out += static_cast<char>(header.format);
+    out += static_cast<char>(header.flags);
+    appendUint64(out, header.session);
+    appendUint64(out, header.seq);
+}
+
+bool parseUdpReportHeader(const char* data, size_t size, UdpReportHeader& header) {
+    if (size < kUdpReportHeaderSize ||
+        static_cast<unsigned char>(data[0]) != kUdpReportMagic ||
+        static_cast<unsigned char>(data[1]) != kUdpReportVersion) {
+        return false;
+    }
+    header.format = static_cast<unsigned char>(data[2]);
+    header.flags = static_cast<unsigned char>(data[3]);
+    header.session = readUint64(data + 4);
+    header.seq = readUint64(data + 12);
+    return header.format <= kUdpFormatMsgPack;
+}
@@ -0,0 +1,63 @@
+#ifndef UDP_REPORT_H
+#define UDP_REPORT_H
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * UDP上报数据报（Agent发送，Manager接收，不确认、不重传）
+ * 
+ * 每个数据报是一次完整的上报，不分片，总长不超过kUdpReportMaxDatagram，放不下的上报由Agent改走HTTP。
+ * 每个Agent进程是一个会话（随机的session），数据报按序号连续编号，Manager据此按节点统计丢失和乱序。
+ * 
+ * 数据报格式（多字节整数小端）：
+ *   magic(0xD6) version format flags session(8字节) seq(8字节)  共20字节
+ *   payload  上报内容，编码与HTTP上报的请求体相同；flags含kUdpFlagGzip时为gzip压缩后的内容
+ */
+
+const unsigned char kUdpReportMagic = 0xD6;
+const unsigned char kUdpReportVersion = 1;
+const unsigned char kUdpFlagGzip = 0x01;            // 上报内容经gzip压缩
+const size_t kUdpReportHeaderSize = 20;
+// 以太网MTU 1500减去IPv4头20字节和UDP头8字节，数据报不会在IP层分片
+const size_t kUdpReportMaxDatagram = 1472;
+
+/**
+ * 上报内容的编码
+ */
+enum UdpReportFormat {
+    kUdpFormatJson = 0,
+    kUdpFormatCbor = 1,
+    kUdpFormatMsgPack = 2
+};
+
+/**
+ * 数据报头
+ */
+struct UdpReportHeader {
+    unsigned char format = kUdpFormatJson;          // 上报内容的编码
+    unsigned char flags = 0;                        // kUdpFlag*
+    uint64_t session = 0;                           // 会话标识，Agent每次启动随机生成
+    uint64_t seq = 0;                               // 会话内从0开始连续的序号
+};
+
+/**
+ * 追加数据报头
+ * 
+ * @param out 输出缓冲区
+ * @param header 数据报头
+ */
+void appendUdpReportHeader(std::string& out, const UdpReportHeader& header);
+
+/**
+ * 解析数据报头
+ * 
+ * @param data 数据报
+ * @param size 数据报长度
+ * @param header 输出参数，数据报头
+ * @return magic、版本和编码都有效时返回true
+ */
+bool parseUdpReportHeader(const char* data, size_t size, UdpReportHeader& header);
+
+#endif // UDP_REPORT_H
@@ -1 +1,35 @@
-g++ -o sleep sleep.cpp
\ No newline at end of file
+#! /bin/bash
+
+# 编译测试程序和基准测试。依赖的头文件取自根目录build.sh构建时下载的依赖（build/_deps），
+# 不在该处时通过CXXFLAGS/LDFLAGS指定，如 CXXFLAGS=-I/path/to/json/include
+cd "$(dirname "$0")"
+
+DEPS=../build/_deps
+INCLUDES="-I../src -I../src/agent -I../src/manager -I$DEPS/nlohmann_json-src/include -I$DEPS/cpp_httplib-src"
+FLAGS="-std=c++14 -O2 -Wall -Wextra $INCLUDES $CXXFLAGS"
+
+g++ -o sleep sleep.cpp
+
+# 单元测试
+g++ $FLAGS -o metric_delta_test metric_delta_test.cpp ../src/utils/metric_delta.cpp $LDFLAGS
+
+# 基准测试
+g++ $FLAGS -o cpu_collector_bench cpu_collector_bench.cpp \
+    ../src/agent/cpu_collector.cpp ../src/agent/sample_writer.cpp ../src/utils/metric_delta.cpp $LDFLAGS
+g++ $FLAGS -o report_serialize_bench report_serialize_bench.cpp \
+    ../src/agent/cpu_collector.cpp ../src/agent/memory_collector.cpp ../src/agent/disk_collector.cpp \
+    ../src/agent/network_collector.cpp ../src/agent/pressure_collector.cpp \
+    ../src/agent/sample_writer.cpp ../src/utils/metric_delta.cpp $LDFLAGS
+g++ $FLAGS -o wire_format_bench wire_format_bench.cpp \
+    ../src/agent/cpu_collector.cpp ../src/agent/memory_collector.cpp ../src/agent/disk_collector.cpp \
+    ../src/agent/network_collector.cpp ../src/agent/pressure_collector.cpp \
+    ../src/agent/sample_writer.cpp ../src/utils/metric_delta.cpp $LDFLAGS
+g++ $FLAGS -DCPPHTTPLIB_ZLIB_SUPPORT -o http_keepalive_bench http_keepalive_bench.cpp \
+    ../src/agent/http_client.cpp ../src/utils/http_compression.cpp $LDFLAGS -lz -lpthread
+g++ $FLAGS -I$DEPS/spdlog-src/include -o metrics_shm_bench metrics_shm_bench.cpp \
+    ../src/agent/metrics_shm_writer.cpp ../src/utils/logger.cpp $LDFLAGS -luuid -lpthread
+g++ $FLAGS -I$DEPS/sqlitecpp-src/include -I$DEPS/spdlog-src/include -o report_ingest_bench report_ingest_bench.cpp \
+    ../src/manager/database_manager*.cpp ../src/utils/logger.cpp \
+    $LDFLAGS $DEPS/sqlitecpp-build/libSQLiteCpp.a -lsqlite3 -luuid -lpthread
+g++ $FLAGS -I$DEPS/spdlog-src/include -o docker_api_bench docker_api_bench.cpp \
+    ../src/agent/docker_api_client.cpp ../src/utils/logger.cpp $LDFLAGS -lcurl -luuid -lpthread
@@ -0,0 +1,258 @@
+// 容器操作的延迟：DockerApiClient经unix套接字长连接发送Engine API请求，对比每次调用启动一个外部进程
+// （改动前DockerManager经popen运行docker命令行，这里用curl进程代替，低估了docker命令行的启动开销）
+// 服务端是本程序内模拟的Engine API，只实现create、start、inspect和stop，不需要Docker守护进程
+// 用法：./docker_api_bench [API轮数] [外部进程轮数]，默认300轮（1200个请求）、50轮
+
+#include "docker_api_client.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+const std::string kContainerId(64, 'c');
+
+// 模拟的Engine API：每个连接一个线程，按HTTP/1.1长连接逐个处理请求，连接在stop()时统一关闭
+class FakeEngine {
+public:
+    explicit FakeEngine(const std::string& path) : path_(path), fd_(-1), running_(false) {}
+
+    ~FakeEngine() {
+        stop();
+    }
+
+    bool start() {
+        unlink(path_.c_str());
+        fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        struct sockaddr_un addr = {};
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, path_.c_str(), sizeof(addr.sun_path) - 1);
+        if (fd_ < 0 || bind(fd_, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0 || listen(fd_, 16) != 0) {
+            return false;
+        }
+        running_ = true;
+        accept_thread_ = std::thread([this]() { acceptLoop(); });
+        return true;
+    }
+
+    void stop() {
+        if (running_.exchange(false)) {
+            // 关闭监听和仍保持着的长连接，各线程的accept/read随之返回
+            shutdown(fd_, SHUT_RDWR);
+            accept_thread_.join();
+            for (int client : clients_) {
+                shutdown(client, SHUT_RDWR);
+            }
+            for (auto& thread : connection_threads_) {
+                thread.join();
+            }
+            for (int client : clients_) {
+                close(client);
+            }
+        }
+        if (fd_ >= 0) {
+            close(fd_);
+            fd_ = -1;
+            unlink(path_.c_str());
+        }
+    }
+
+private:
+    void acceptLoop() {
+        while (running_) {
+            int client = accept4(fd_, nullptr, nullptr, SOCK_CLOEXEC);
+            if (client < 0) {
+                break;
+            }
+            clients_.push_back(client);
+            connection_threads_.emplace_back([client]() { serve(client); });
+        }
+    }
+
+    static void serve(int fd) {
+        std::string buffer;
+        char chunk[4096];
+        while (true) {
+            size_t header_end;
+            while ((header_end = buffer.find("\r\n\r\n")) == std::string::npos) {
+                ssize_t n = read(fd, chunk, sizeof(chunk));
+                if (n <= 0) {
+                    return;
+                }
+                buffer.append(chunk, n);
+            }
+            size_t body_length = 0;
+            size_t pos = buffer.find("Content-Length:");
+            if (pos == std::string::npos) {
+                pos = buffer.find("content-length:");
+            }
+            if (pos != std::string::npos && pos < header_end) {
+                body_length = strtoul(buffer.c_str() + pos + 15, nullptr, 10);
+            }
+            while (buffer.size() < header_end + 4 + body_length) {
+                ssize_t n = read(fd, chunk, sizeof(chunk));
+                if (n <= 0) {
+                    return;
+                }
+                buffer.append(chunk, n);
+            }
+            std::string request_line = buffer.substr(0, buffer.find("\r\n"));
+            buffer.erase(0, header_end + 4 + body_length);
+
+            std::string response = respond(request_line);
+            if (write(fd, response.data(), response.size()) != static_cast<ssize_t>(response.size())) {
+                return;
+            }
+        }
+    }
+
+    static std::string respond(const std::string& request_line) {
+        int status = 404;
+        std::string body = "{\"message\":\"page not found\"}";
+        if (request_line.find("POST /v1.40/containers/create") == 0) {
+            status = 201;
+            body = "{\"Id\":\"" + kContainerId + "\",\"Warnings\":[]}";
+        } else if (request_line.find("/start ") != std::string::npos || request_line.find("/stop") != std::string::npos) {
+            status = 204;
+            body.clear();
+        } else if (request_line.find("GET /v1.40/containers/") == 0) {
+            status = 200;
+            body = "{\"Id\":\"" + kContainerId + "\",\"Name\":\"/bench\",\"State\":{\"Status\":\"running\","
+                   "\"Running\":true,\"Pid\":12345,\"ExitCode\":0,\"StartedAt\":\"2024-01-01T00:00:00Z\"},"
+                   "\"Config\":{\"Image\":\"nginx:latest\",\"Labels\":{}}}";
+        }
+        const char* reason = status == 200 ? "OK" : status == 201 ? "Created" : status == 204 ? "No Content" : "Not Found";
+        std::string response = "HTTP/1.1 " + std::to_string(status) + " " + reason + "\r\n";
+        if (status != 204) {
+            response += "Content-Type: application/json\r\n";
+        }
+        response += "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body;
+        return response;
+    }
+
+    std::string path_;
+    int fd_;
+    std::atomic<bool> running_;
+    std::thread accept_thread_;
+    std::vector<int> clients_;                      // 各连接的套接字，stop()时关闭
+    std::vector<std::thread> connection_threads_;   // clients_和connection_threads_只由accept线程添加，stop()在其结束后才访问
+};
+
+// 与DockerManager::createContainer相同的容器配置
+std::string createBody() {
+    nlohmann::json config;
+    config["Image"] = "nginx:latest";
+    config["Labels"] = {{"resource_monitor.component_id", "component-bench"}};
+    config["Env"] = {"PORT=8080", "MODE=bench"};
+    config["HostConfig"] = {{"NanoCpus", 500000000LL}, {"Memory", 268435456LL}, {"Binds", nlohmann::json::array()}};
+    return config.dump();
+}
+
+// 改动前的方式：每次调用启动一个进程，读取其输出
+bool execCurl(const std::string& socket_path, const std::string& method, const std::string& path,
+              const std::string& body) {
+    std::string command = "curl -s -o /dev/null -w '%{http_code}' --unix-socket " + socket_path + " -X " + method;
+    if (!body.empty()) {
+        command += " -H 'Content-Type: application/json' -d '" + body + "'";
+    }
+    command += " http://localhost/v1.40" + path;
+    FILE* pipe = popen(command.c_str(), "r");
+    if (!pipe) {
+        return false;
+    }
+    char output[16] = {};
+    size_t n = fread(output, 1, sizeof(output) - 1, pipe);
+    output[n] = '\0';
+    return pclose(pipe) == 0 && output[0] == '2';
+}
+
+struct Latencies {
+    std::vector<double> create, inspect, stop;
+};
+
+double msSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+double percentile(std::vector<double>& values, int percent) {
+    std::sort(values.begin(), values.end());
+    return values[values.size() * percent / 100];
+}
+
+void printLatencies(const char* name, Latencies& latencies) {
+    printf("%-26s create+start p50 %7.2f ms  inspect p50 %7.2f ms  stop p50 %7.2f ms  (stop p99 %.2f ms)\n", name,
+           percentile(latencies.create, 50), percentile(latencies.inspect, 50), percentile(latencies.stop, 50),
+           percentile(latencies.stop, 99));
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    int api_rounds = argc > 1 ? atoi(argv[1]) : 300;
+    int exec_rounds = argc > 2 ? atoi(argv[2]) : 50;
+    std::string socket_path = "/tmp/docker_api_bench_" + std::to_string(getpid()) + ".sock";
+
+    FakeEngine engine(socket_path);
+    if (!engine.start()) {
+        printf("FAIL: cannot listen on %s\n", socket_path.c_str());
+        return 1;
+    }
+    std::string body = createBody();
+    bool ok = true;
+
+    Latencies api;
+    DockerApiClient client(socket_path);
+    for (int i = 0; i < api_rounds && ok; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        DockerApiClient::Response created = client.request("POST", "/containers/create?name=bench", body);
+        nlohmann::json id = created.json().value("Id", nlohmann::json());
+        ok = created.ok() && id.is_string() &&
+             client.request("POST", "/containers/" + id.get<std::string>() + "/start").ok();
+        api.create.push_back(msSince(start));
+
+        start = std::chrono::steady_clock::now();
+        ok = ok && client.request("GET", "/containers/" + kContainerId + "/json").json()["State"]["Running"] == true;
+        api.inspect.push_back(msSince(start));
+
+        start = std::chrono::steady_clock::now();
+        ok = ok && client.request("POST", "/containers/" + kContainerId + "/stop?t=10").ok();
+        api.stop.push_back(msSince(start));
+    }
+    DockerApiClient::Stats stats = client.getStats();
+
+    Latencies exec;
+    for (int i = 0; i < exec_rounds && ok; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        ok = execCurl(socket_path, "POST", "/containers/create?name=bench", body) &&
+             execCurl(socket_path, "POST", "/containers/" + kContainerId + "/start", "");
+        exec.create.push_back(msSince(start));
+
+        start = std::chrono::steady_clock::now();
+        ok = ok && execCurl(socket_path, "GET", "/containers/" + kContainerId + "/json", "");
+        exec.inspect.push_back(msSince(start));
+
+        start = std::chrono::steady_clock::now();
+        ok = ok && execCurl(socket_path, "POST", "/containers/" + kContainerId + "/stop?t=10", "");
+        exec.stop.push_back(msSince(start));
+    }
+    engine.stop();
+
+    if (!ok) {
+        printf("FAIL: a request to the fake Engine API failed\n");
+        return 1;
+    }
+    printLatencies("DockerApiClient:", api);
+    printLatencies("process per call (curl):", exec);
+    printf("DockerApiClient: %llu requests over %llu connections, %llu failures\n",
+           stats.requests, stats.connections, stats.failures);
+    return 0;
+}
@@ -0,0 +1,91 @@
+// 上报请求的延迟：每次请求新建httplib::Client（新连接），对比HttpClient复用的长连接
+// 用法：./http_keepalive_bench [次数] [上报字节数] [nagle]，默认2000次、6KB；第三个参数为nagle时服务端不设TCP_NODELAY
+
+#include "http_client.h"
+#include <httplib.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+void printLatency(const char* name, std::vector<double>& latencies_us) {
+    std::sort(latencies_us.begin(), latencies_us.end());
+    double sum = 0.0;
+    for (double latency : latencies_us) {
+        sum += latency;
+    }
+    printf("%-32s avg %7.0f us  p50 %7.0f us  p99 %7.0f us\n", name, sum / latencies_us.size(),
+           latencies_us[latencies_us.size() / 2], latencies_us[latencies_us.size() * 99 / 100]);
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    int iterations = argc > 1 ? atoi(argv[1]) : 2000;
+    size_t body_size = argc > 2 ? static_cast<size_t>(atoi(argv[2])) : 6 * 1024;
+    bool nagle = argc > 3 && strcmp(argv[3], "nagle") == 0;
+
+    // 本机HTTP/1.1 keep-alive服务端，模拟Manager的/api/report
+    httplib::Server server;
+    server.set_tcp_nodelay(!nagle);
+    server.set_keep_alive_max_count(iterations * 2);
+    server.Post("/api/report", [](const httplib::Request&, httplib::Response& res) {
+        res.set_content("{\"status\":\"success\",\"message\":\"Resource usage saved successfully\"}", "application/json");
+    });
+    int port = server.bind_to_any_port("127.0.0.1");
+    if (port <= 0) {
+        printf("FAIL: cannot bind\n");
+        return 1;
+    }
+    std::thread server_thread([&server]() { server.listen_after_bind(); });
+    server.wait_until_ready();
+
+    std::string body = "{\"node_id\":\"node-bench\",\"padding\":\"" + std::string(body_size, 'x') + "\"}";
+    std::vector<double> fresh_us, reused_us;
+    fresh_us.reserve(iterations);
+    reused_us.reserve(iterations);
+
+    // 改动前的方式：每次请求构造新的httplib::Client
+    for (int i = 0; i < iterations; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        httplib::Client client("127.0.0.1", port);
+        auto res = client.Post("/api/report", body, "application/json");
+        fresh_us.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+        if (!res || res->status != 200) {
+            printf("FAIL: fresh request %d\n", i);
+            server.stop();
+            server_thread.join();
+            return 1;
+        }
+    }
+
+    HttpClient client("http://127.0.0.1:" + std::to_string(port));
+    for (int i = 0; i < iterations; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        nlohmann::json response = client.reportRawData(body);
+        reused_us.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+        if (response.value("status", "") != "success") {
+            printf("FAIL: reused request %d: %s\n", i, response.dump().c_str());
+            server.stop();
+            server_thread.join();
+            return 1;
+        }
+    }
+    HttpClient::ConnectionStats stats = client.getConnectionStats();
+
+    server.stop();
+    server_thread.join();
+
+    printf("%d requests of %zu bytes each, server TCP_NODELAY %s\n", iterations, body.size(), nagle ? "off" : "on");
+    printLatency("fresh connection per request:", fresh_us);
+    printLatency("reused connection (HttpClient):", reused_us);
+    printf("HttpClient: %llu requests over %llu connections, %llu retries\n",
+           stats.requests, stats.connections, stats.retries);
+    return 0;
+}
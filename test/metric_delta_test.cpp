@@ -0,0 +1,198 @@
+// DeltaDecoder对正常和畸形结构的处理：正常结构往返一致，畸形和字段名重复的结构被拒绝
+
+#include "utils/metric_delta.h"
+#include <cstring>
+#include <iostream>
+#include <string>
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const std::string& name) {
+    std::cout << (condition ? "PASS " : "FAIL ") << name << std::endl;
+    if (!condition) {
+        ++failures;
+    }
+}
+
+void appendToken(std::string& schema, DeltaToken token) {
+    schema += static_cast<char>(token);
+}
+
+void appendToken(std::string& schema, DeltaToken token, const std::string& key) {
+    schema += static_cast<char>(token);
+    appendDeltaVarint(schema, key.size() + 1);
+    schema += key;
+}
+
+// 数组元素的记号，字段名长度为0
+void appendElement(std::string& schema, DeltaToken token) {
+    schema += static_cast<char>(token);
+    appendDeltaVarint(schema, 0);
+}
+
+// 以关键帧发送结构，所有值都未变化（每个值1个0位）
+std::string keyframe(uint64_t stream_id, const std::string& schema) {
+    std::string frame;
+    frame += static_cast<char>(kDeltaFrameMagic);
+    frame += static_cast<char>(kDeltaFrameVersion);
+    frame += static_cast<char>(kDeltaFlagKeyframe | kDeltaFlagSchema);
+    for (int shift = 0; shift < 64; shift += 8) {
+        frame += static_cast<char>((stream_id >> shift) & 0xFF);
+    }
+    appendDeltaVarint(frame, 0);
+    frame += static_cast<char>(0);
+    appendDeltaVarint(frame, schema.size());
+    frame += schema;
+    appendDeltaVarint(frame, 16);
+    frame += std::string(16, '\0');
+    return frame;
+}
+
+DeltaDecoder::Result decodeFrame(DeltaDecoder& decoder, const std::string& frame, const nlohmann::json*& report) {
+    size_t consumed = 0;
+    uint64_t stream_id = 0;
+    report = nullptr;
+    return decoder.decode(frame.data(), frame.size(), consumed, stream_id, report);
+}
+
+void testRoundTrip() {
+    DeltaSample sample;
+    appendToken(sample.schema, kDeltaBeginObject, "");
+    appendToken(sample.schema, kDeltaDouble, "cpu");
+    appendToken(sample.schema, kDeltaBeginArray, "disks");
+    appendElement(sample.schema, kDeltaBeginObject);
+    appendToken(sample.schema, kDeltaUint, "reads");
+    appendToken(sample.schema, kDeltaEndObject);
+    appendElement(sample.schema, kDeltaBeginObject);
+    appendToken(sample.schema, kDeltaUint, "reads");
+    appendToken(sample.schema, kDeltaEndObject);
+    appendToken(sample.schema, kDeltaEndArray);
+    appendToken(sample.schema, kDeltaEndObject);
+
+    sample.values.resize(3);
+    sample.count = 3;
+    uint64_t cpu_bits;
+    double cpu = 42.5;
+    memcpy(&cpu_bits, &cpu, sizeof(cpu_bits));
+    sample.values[0].type = kDeltaDouble;
+    sample.values[0].bits = cpu_bits;
+    sample.values[1].type = kDeltaUint;
+    sample.values[1].bits = 7;
+    sample.values[2].type = kDeltaUint;
+    sample.values[2].bits = 9;
+
+    DeltaEncoder encoder(10, 4);
+    DeltaDecoder decoder;
+    bool ok = true;
+    for (int i = 0; i < 3 && ok; ++i) {
+        sample.values[2].bits += static_cast<uint64_t>(i);
+        std::string frame;
+        encoder.encode(sample, frame);
+        const nlohmann::json* report = nullptr;
+        ok = decodeFrame(decoder, frame, report) == DeltaDecoder::kDecodeOk && report &&
+             (*report)["cpu"] == 42.5 && (*report)["disks"].size() == 2 &&
+             (*report)["disks"][0]["reads"] == 7 && (*report)["disks"][1]["reads"] == sample.values[2].bits;
+    }
+    check(ok, "valid schema round-trips through encoder and decoder");
+}
+
+void expectInvalid(const std::string& schema, const std::string& name) {
+    DeltaDecoder decoder;
+    const nlohmann::json* report = nullptr;
+    check(decodeFrame(decoder, keyframe(1, schema), report) == DeltaDecoder::kDecodeInvalid &&
+          decoder.streamCount() == 0, name);
+}
+
+void testDuplicateKeys() {
+    // a先定义为对象再定义为数组：第二个定义替换第一个，按第一个定位时会越界扩展数组
+    std::string schema;
+    appendToken(schema, kDeltaBeginObject, "");
+    appendToken(schema, kDeltaBeginObject, "a");
+    appendToken(schema, kDeltaUint, "x");
+    appendToken(schema, kDeltaEndObject);
+    appendToken(schema, kDeltaBeginArray, "a");
+    appendElement(schema, kDeltaUint);
+    appendToken(schema, kDeltaEndArray);
+    appendToken(schema, kDeltaEndObject);
+    expectInvalid(schema, "object key redefined as array is rejected");
+
+    schema.clear();
+    appendToken(schema, kDeltaBeginObject, "");
+    appendToken(schema, kDeltaBeginArray, "a");
+    appendElement(schema, kDeltaUint);
+    appendToken(schema, kDeltaEndArray);
+    appendToken(schema, kDeltaBeginArray, "a");
+    appendElement(schema, kDeltaUint);
+    appendElement(schema, kDeltaUint);
+    appendElement(schema, kDeltaUint);
+    appendToken(schema, kDeltaEndArray);
+    appendToken(schema, kDeltaEndObject);
+    expectInvalid(schema, "array key repeated with more elements is rejected");
+
+    schema.clear();
+    appendToken(schema, kDeltaBeginObject, "");
+    appendToken(schema, kDeltaUint, "a");
+    appendToken(schema, kDeltaDouble, "a");
+    appendToken(schema, kDeltaEndObject);
+    expectInvalid(schema, "repeated scalar key is rejected");
+}
+
+void testMalformed() {
+    std::string schema;
+    appendToken(schema, kDeltaBeginObject, "");
+    appendToken(schema, kDeltaUint, "a");
+    expectInvalid(schema, "unterminated object is rejected");
+
+    schema.clear();
+    appendToken(schema, kDeltaBeginObject, "");
+    appendToken(schema, kDeltaEndArray);
+    expectInvalid(schema, "mismatched end token is rejected");
+
+    schema.clear();
+    appendToken(schema, kDeltaBeginObject, "");
+    appendElement(schema, kDeltaUint);
+    appendToken(schema, kDeltaEndObject);
+    expectInvalid(schema, "object member without key is rejected");
+
+    schema.clear();
+    appendToken(schema, kDeltaBeginArray, "");
+    appendToken(schema, kDeltaEndArray);
+    expectInvalid(schema, "non-object root is rejected");
+
+    schema.clear();
+    appendToken(schema, kDeltaBeginObject, "");
+    appendToken(schema, kDeltaEndObject);
+    appendToken(schema, kDeltaBeginObject, "");
+    appendToken(schema, kDeltaEndObject);
+    expectInvalid(schema, "trailing tokens after root are rejected");
+
+    schema.clear();
+    appendToken(schema, kDeltaBeginObject, "");
+    schema += static_cast<char>(kDeltaUint);
+    appendDeltaVarint(schema, 100);
+    schema += "ab";
+    expectInvalid(schema, "key longer than schema is rejected");
+
+    schema.clear();
+    appendToken(schema, kDeltaBeginObject, "");
+    schema += static_cast<char>(99);
+    appendDeltaVarint(schema, 1);
+    appendToken(schema, kDeltaEndObject);
+    expectInvalid(schema, "unknown token is rejected");
+}
+
+}
+
+int main() {
+    testRoundTrip();
+    testDuplicateKeys();
+    testMalformed();
+    if (failures > 0) {
+        std::cout << failures << " test(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "all tests passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,165 @@
+// 本机指标共享内存的读取延迟：无写入、4 Hz写入和持续写入时MetricsShmReader::read()的p50/p99/p99.9，
+// 并在持续写入时检查是否读到撕裂的快照（每次写入的所有核心带同一个值）
+// 用法：./metrics_shm_bench [读取次数] [核心数] [映射文件]，默认100万次、64核、/dev/shm/metrics_shm_bench
+
+#include "metrics_shm_writer.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+long long nowNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// 所有字段都取同一个值，读取方据此判断快照是否一致
+void tagSample(CpuCollector::Sample& sample, double tag) {
+    sample.usage_percent = tag;
+    for (auto& core : sample.cores) {
+        core.usage_percent = tag;
+        core.iowait_percent = tag;
+    }
+}
+
+bool consistent(const MetricsShmSnapshot& snapshot) {
+    for (uint32_t i = 0; i < snapshot.cpu.cores; ++i) {
+        if (snapshot.cores[i].usage_percent != snapshot.cpu.usage_percent ||
+            snapshot.cores[i].iowait_percent != snapshot.cpu.usage_percent) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 写入线程：interval_ms为0时持续写入，否则每interval_ms写一次
+class Writer {
+public:
+    Writer(MetricsShmWriter& shm, CpuCollector::Sample sample, int interval_ms)
+        : shm_(shm), sample_(sample), interval_ms_(interval_ms), running_(true), writes_(0),
+          thread_([this]() { run(); }) {}
+
+    ~Writer() {
+        running_ = false;
+        thread_.join();
+    }
+
+    unsigned long long writes() const {
+        return writes_.load();
+    }
+
+private:
+    void run() {
+        double tag = 0.0;
+        while (running_.load(std::memory_order_relaxed)) {
+            tagSample(sample_, tag += 1.0);
+            shm_.publishCpu(sample_, nowNs());
+            writes_.fetch_add(1, std::memory_order_relaxed);
+            if (interval_ms_ > 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(interval_ms_));
+            }
+        }
+    }
+
+    MetricsShmWriter& shm_;
+    CpuCollector::Sample sample_;
+    int interval_ms_;
+    std::atomic<bool> running_;
+    std::atomic<unsigned long long> writes_;
+    std::thread thread_;
+};
+
+// 逐次计时read()，返回失败次数（超过重试上限）
+int measure(const MetricsShmReader& reader, MetricsShmSnapshot& snapshot, std::vector<long long>& latencies_ns) {
+    int failures = 0;
+    for (auto& latency : latencies_ns) {
+        long long start = nowNs();
+        bool ok = reader.read(snapshot);
+        latency = nowNs() - start;
+        failures += ok ? 0 : 1;
+    }
+    return failures;
+}
+
+void printLatency(const char* name, std::vector<long long>& latencies_ns, int failures) {
+    std::sort(latencies_ns.begin(), latencies_ns.end());
+    size_t n = latencies_ns.size();
+    printf("%-20s p50 %6lld ns  p99 %6lld ns  p99.9 %6lld ns  (%d failed)\n", name,
+           latencies_ns[n / 2], latencies_ns[n * 99 / 100], latencies_ns[n * 999 / 1000], failures);
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    int reads = argc > 1 ? atoi(argv[1]) : 1000000;
+    int cores = argc > 2 ? atoi(argv[2]) : 64;
+    std::string path = argc > 3 ? argv[3] : "/dev/shm/metrics_shm_bench";
+
+    unlink(path.c_str());
+    bool ok = true;
+    {
+        MetricsShmWriter shm(path);
+        MetricsShmReader reader;
+        if (!shm.open() || !reader.open(path)) {
+            printf("FAIL: cannot map %s\n", path.c_str());
+            return 1;
+        }
+
+        CpuCollector::Sample sample = {};
+        sample.core_count = cores;
+        for (int i = 0; i < cores; ++i) {
+            sample.cores.push_back({i, 0.0, 0.0, 0.0, 0.0});
+        }
+        tagSample(sample, 0.0);
+        shm.publishCpu(sample, nowNs());
+
+        // 快照约20KB，复用同一个对象
+        std::unique_ptr<MetricsShmSnapshot> snapshot(new MetricsShmSnapshot());
+        std::vector<long long> latencies_ns(reads);
+        printf("%d reads per case, %d cores, region %zu bytes\n", reads, cores, sizeof(MetricsShmRegion));
+
+        int failures = measure(reader, *snapshot, latencies_ns);
+        printLatency("idle:", latencies_ns, failures);
+        {
+            Writer writer(shm, sample, 250);
+            failures = measure(reader, *snapshot, latencies_ns);
+        }
+        printLatency("writer at 4 Hz:", latencies_ns, failures);
+        {
+            Writer writer(shm, sample, 0);
+            failures = measure(reader, *snapshot, latencies_ns);
+        }
+        printLatency("writer saturated:", latencies_ns, failures);
+
+        // 撕裂检查：持续写入时每个读到的快照中所有核心的值必须相同
+        int torn = 0, consistent_reads = 0, retry_cap = 0;
+        unsigned long long writes = 0;
+        {
+            Writer writer(shm, sample, 0);
+            for (int i = 0; i < reads * 3; ++i) {
+                if (!reader.read(*snapshot)) {
+                    ++retry_cap;
+                } else if (consistent(*snapshot)) {
+                    ++consistent_reads;
+                } else {
+                    ++torn;
+                }
+            }
+            writes = writer.writes();
+        }
+        printf("torn-read check: %d reads against %llu writes: %d consistent, %d torn, %d hit the retry cap\n",
+               reads * 3, writes, consistent_reads, torn, retry_cap);
+        ok = torn == 0;
+    }
+    unlink(path.c_str());
+    return ok ? 0 : 1;
+}
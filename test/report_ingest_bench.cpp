@@ -0,0 +1,175 @@
+// Manager写入上报的吞吐：各表分别写入（每条语句各自提交），对比每个上报一个事务和批量上报
+// 用法：./report_ingest_bench [上报数] [数据库文件]，默认2000个、当前目录下的report_ingest_bench.db（在磁盘上测）
+
+#include "database_manager.h"
+#include <SQLiteCpp/SQLiteCpp.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+const char* kNodeId = "node-bench";
+
+// 与Agent上报相同结构：cpu、memory、3个文件系统、2块磁盘、2块网卡、tcp、3项PSI、5项聚合和2个组件
+nlohmann::json makeReport(long long timestamp) {
+    double t = static_cast<double>(timestamp % 1000);
+    nlohmann::json resource;
+    resource["cpu"] = {{"usage_percent", 12.5 + t / 100}, {"load_avg_1m", 0.5}, {"load_avg_5m", 0.4},
+                       {"load_avg_15m", 0.3}, {"core_count", 16}};
+    resource["memory"] = {{"total", 34359738368ULL}, {"used", 8589934592ULL}, {"free", 25769803776ULL},
+                          {"usage_percent", 25.0}};
+    nlohmann::json filesystems = nlohmann::json::array();
+    const char* mounts[] = {"/", "/home", "/data"};
+    for (int i = 0; i < 3; ++i) {
+        filesystems.push_back({{"device", "/dev/sda" + std::to_string(i + 1)}, {"mount_point", mounts[i]},
+                               {"fs_type", "ext4"}, {"total", 107374182400ULL}, {"used", 53687091200ULL},
+                               {"free", 53687091200ULL}, {"usage_percent", 50.0}});
+    }
+    nlohmann::json devices = nlohmann::json::array();
+    for (int i = 0; i < 2; ++i) {
+        devices.push_back({{"device", i == 0 ? "sda" : "nvme0n1"}, {"read_iops", 10.0 + t}, {"write_iops", 20.0},
+                           {"read_bytes_per_sec", 40960.0}, {"write_bytes_per_sec", 81920.0},
+                           {"await_ms", 0.8}, {"util_percent", 3.5}});
+    }
+    resource["disk"] = {{"filesystems", filesystems}, {"devices", devices}};
+    nlohmann::json interfaces = nlohmann::json::array();
+    for (int i = 0; i < 2; ++i) {
+        interfaces.push_back({{"interface", "eth" + std::to_string(i)}, {"rx_bytes_per_sec", 125000.0 + t},
+                              {"tx_bytes_per_sec", 64000.0}, {"rx_packets_per_sec", 900.0},
+                              {"tx_packets_per_sec", 700.0}});
+    }
+    resource["network"] = {{"interfaces", interfaces},
+                           {"tcp", {{"out_segs_per_sec", 800.0}, {"retrans_segs_per_sec", 1.0}, {"retrans_percent", 0.1}}}};
+    resource["pressure"] = nlohmann::json::object();
+    for (const char* name : {"cpu", "memory", "io"}) {
+        resource["pressure"][name] = {{"some_avg10", 1.5}, {"some_avg60", 1.2}, {"some_stall_us", 123456ULL},
+                                      {"full_avg10", 0.5}, {"full_avg60", 0.4}, {"full_stall_us", 65432ULL}};
+    }
+
+    nlohmann::json aggregates;
+    nlohmann::json aggregate = {{"min", 5.0}, {"max", 30.0}, {"avg", 12.0}, {"p95", 25.0}, {"last", 12.5}, {"samples", 15}};
+    aggregates["cpu"] = {{"usage_percent", aggregate}};
+    aggregates["memory"] = {{"usage_percent", aggregate}};
+    aggregates["pressure"] = {{"cpu_some_avg10", aggregate}, {"memory_some_avg10", aggregate}, {"io_some_avg10", aggregate}};
+
+    nlohmann::json components = nlohmann::json::array();
+    for (int i = 0; i < 2; ++i) {
+        components.push_back({{"component_id", "component-" + std::to_string(i)}, {"business_id", "business-bench"},
+                              {"type", i == 0 ? "docker" : "binary"}, {"status", "running"},
+                              {"container_id", i == 0 ? "3f2a9c1d7e4b" : ""}, {"process_id", i == 0 ? "" : "12345"},
+                              {"resource_usage", {{"cpu_percent", 12.5}, {"memory_mb", 256}, {"gpu_percent", 0.0}}}});
+    }
+
+    return {{"node_id", kNodeId}, {"timestamp", timestamp}, {"resource", resource},
+            {"aggregates", aggregates}, {"components", components}};
+}
+
+// 改动前/api/report的写入方式：各表分别调用公开的保存接口，每条语句各自提交
+bool savePerTable(DatabaseManager& db, const nlohmann::json& report) {
+    std::string node_id = report["node_id"];
+    long long timestamp = report["timestamp"];
+    const auto& resource = report["resource"];
+    bool ok = db.updateNodeLastSeen(node_id);
+    ok = db.saveCpuMetrics(node_id, timestamp, resource["cpu"]) && ok;
+    ok = db.saveMemoryMetrics(node_id, timestamp, resource["memory"]) && ok;
+    ok = db.saveDiskMetrics(node_id, timestamp, resource["disk"]) && ok;
+    ok = db.saveNetworkMetrics(node_id, timestamp, resource["network"]) && ok;
+    ok = db.savePressureMetrics(node_id, timestamp, resource["pressure"]) && ok;
+    for (const auto& component : report["components"]) {
+        ok = db.updateComponentStatus(component) && ok;
+        ok = db.saveComponentMetrics(component["component_id"], timestamp, component["resource_usage"]) && ok;
+    }
+    return ok;
+}
+
+int countRows(const std::string& path, const char* table) {
+    SQLite::Database db(path, SQLite::OPEN_READONLY);
+    SQLite::Statement query(db, std::string("SELECT COUNT(*) FROM ") + table);
+    query.executeStep();
+    return query.getColumn(0).getInt();
+}
+
+bool registerNode(DatabaseManager& db) {
+    if (!db.saveNode({{"node_id", kNodeId}, {"hostname", "bench"}, {"ip_address", "127.0.0.1"}, {"os_info", "Linux"}})) {
+        return false;
+    }
+    if (!db.saveBusiness({{"business_id", "business-bench"}, {"business_name", "bench"}, {"status", "running"}})) {
+        return false;
+    }
+    for (int i = 0; i < 2; ++i) {
+        nlohmann::json component = {{"component_id", "component-" + std::to_string(i)}, {"business_id", "business-bench"},
+                                    {"component_name", "component-" + std::to_string(i)},
+                                    {"type", i == 0 ? "docker" : "binary"}, {"status", "running"}, {"node_id", kNodeId}};
+        if (!db.saveBusinessComponent(component)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    int count = argc > 1 ? atoi(argv[1]) : 2000;
+    std::string path = argc > 2 ? argv[2] : "report_ingest_bench.db";
+
+    std::vector<nlohmann::json> reports;
+    reports.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        reports.push_back(makeReport(1700000000000LL + i * 1000LL));
+    }
+
+    // 每种方式各用一个新数据库，写入后核对cpu和磁盘各表的行数
+    const char* names[] = {"per table (before):", "one transaction per report:", "batch of 10:", "batch of 100:"};
+    int batch_sizes[] = {0, 1, 10, 100};
+    bool ok = true;
+    for (int mode = 0; mode < 4 && ok; ++mode) {
+        unlink(path.c_str());
+        int saved = 0;
+        double seconds = 0.0;
+        {
+            DatabaseManager db(path);
+            if (!db.initialize() || !registerNode(db)) {
+                printf("FAIL: cannot initialize %s\n", path.c_str());
+                return 1;
+            }
+            auto start = std::chrono::steady_clock::now();
+            if (batch_sizes[mode] == 0) {
+                for (const auto& report : reports) {
+                    saved += savePerTable(db, report) ? 1 : 0;
+                }
+            } else if (batch_sizes[mode] == 1) {
+                for (const auto& report : reports) {
+                    bool report_saved = false;
+                    saved += db.saveResourceUsage(report, report_saved) && report_saved ? 1 : 0;
+                }
+            } else {
+                for (int i = 0; i < count; i += batch_sizes[mode]) {
+                    nlohmann::json batch = nlohmann::json::array();
+                    for (int j = i; j < count && j < i + batch_sizes[mode]; ++j) {
+                        batch.push_back(reports[j]);
+                    }
+                    int batch_saved = 0;
+                    db.saveResourceUsageBatch(batch, batch_saved);
+                    saved += batch_saved;
+                }
+            }
+            seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+        int cpu_rows = countRows(path, "cpu_metrics");
+        int disk_rows = countRows(path, "disk_metrics") + countRows(path, "disk_io_metrics");
+        printf("%-30s %8.0f samples/s  (%d saved, %d cpu rows, %d disk rows)\n",
+               names[mode], count / seconds, saved, cpu_rows, disk_rows);
+        ok = saved == count && cpu_rows == count && disk_rows == count * 5;
+    }
+    unlink(path.c_str());
+    if (!ok) {
+        printf("FAIL: not every report was written\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,182 @@
+// 上报生成的耗时和内存分配次数：各采集器collect()建json DOM再dump()，对比采集到类型化样本后用JsonTextWriter直接写文本
+// 用法：./report_serialize_bench [次数]，默认3000次，使用本机的/proc
+
+#include "cpu_collector.h"
+#include "memory_collector.h"
+#include "disk_collector.h"
+#include "network_collector.h"
+#include "pressure_collector.h"
+#include "sample_writer.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace {
+
+unsigned long long allocations = 0;
+
+}
+
+// 统计全局operator new的调用次数。GCC内联后会把与之配对的free误报为不匹配
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+
+void* operator new(size_t size) {
+    ++allocations;
+    void* p = malloc(size > 0 ? size : 1);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+
+namespace {
+
+// 与Agent上报中的组件状态相同结构的示例
+nlohmann::json makeComponents() {
+    nlohmann::json components = nlohmann::json::array();
+    for (int i = 0; i < 2; ++i) {
+        components.push_back({
+            {"component_id", "component-" + std::to_string(i)},
+            {"business_id", "business-1"},
+            {"type", i == 0 ? "docker" : "binary"},
+            {"status", "running"},
+            {"container_id", i == 0 ? "3f2a9c1d7e4b" : ""},
+            {"process_id", i == 0 ? "" : "12345"},
+            {"resource_usage", {{"cpu_percent", 12.5}, {"memory_mb", 256}, {"gpu_percent", 0.0}}}
+        });
+    }
+    return components;
+}
+
+// 改动前的生成方式：每个采集器collect()建DOM，合并成上报后dump()
+std::string buildDom(std::vector<std::unique_ptr<ResourceCollector>>& collectors, const nlohmann::json& components) {
+    nlohmann::json report;
+    report["node_id"] = "node-bench";
+    report["timestamp"] = 1700000000000LL;
+    nlohmann::json resource = nlohmann::json::object();
+    for (auto& collector : collectors) {
+        resource[collector->getType()] = collector->collect();
+    }
+    report["resource"] = resource;
+    report["components"] = components;
+    return report.dump();
+}
+
+// 写出一次上报的各字段，不重新采集。JsonDomWriter的根对象即为上报，JsonTextWriter须由调用方写出根对象
+void writeReport(SampleWriter& writer, std::vector<std::unique_ptr<ResourceCollector>>& collectors,
+                 const std::vector<std::string>& types, const nlohmann::json& components) {
+    writer.writeString("node_id", "node-bench");
+    writer.writeInt("timestamp", 1700000000000LL);
+    writer.beginObject("resource");
+    for (size_t i = 0; i < collectors.size(); ++i) {
+        writer.beginObject(types[i].c_str());
+        collectors[i]->writeSample(writer);
+        writer.endObject();
+    }
+    writer.endObject();
+    writer.writeJson("components", components);
+}
+
+void writeReportText(std::string& out, std::vector<std::unique_ptr<ResourceCollector>>& collectors,
+                     const std::vector<std::string>& types, const nlohmann::json& components) {
+    JsonTextWriter writer(out);
+    writer.beginObject(nullptr);
+    writeReport(writer, collectors, types, components);
+    writer.endObject();
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    int iterations = argc > 1 ? atoi(argv[1]) : 3000;
+
+    std::vector<std::unique_ptr<ResourceCollector>> collectors;
+    collectors.emplace_back(new CpuCollector());
+    collectors.emplace_back(new MemoryCollector());
+    collectors.emplace_back(new DiskCollector());
+    collectors.emplace_back(new NetworkCollector());
+    collectors.emplace_back(new PressureCollector());
+    std::vector<std::string> types;
+    for (auto& collector : collectors) {
+        types.push_back(collector->getType());
+        collector->sample();
+    }
+    nlohmann::json components = makeComponents();
+
+    // 同一组样本分别经JsonTextWriter和JsonDomWriter写出，两者应完全一致
+    std::string text;
+    writeReportText(text, collectors, types, components);
+    nlohmann::json dom;
+    {
+        JsonDomWriter writer(dom);
+        writeReport(writer, collectors, types, components);
+    }
+    nlohmann::json diff = nlohmann::json::diff(nlohmann::json::parse(text), dom);
+    printf("report: %zu bytes, text vs DOM diff: %s\n", text.size(), diff.empty() ? "empty" : diff.dump().c_str());
+
+    // 两种方式交替跑两轮，取第二轮
+    double dom_us = 0.0, typed_us = 0.0, dom_serialize_us = 0.0, typed_serialize_us = 0.0;
+    unsigned long long dom_allocations = 0, typed_allocations = 0;
+    size_t bytes = 0;
+    std::string body;
+    body.reserve(text.size() * 2);
+    for (int round = 0; round < 2; ++round) {
+        unsigned long long before = allocations;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            bytes += buildDom(collectors, components).size();
+        }
+        dom_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / iterations;
+        dom_allocations = (allocations - before) / static_cast<unsigned long long>(iterations);
+
+        before = allocations;
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            for (auto& collector : collectors) {
+                collector->sample();
+            }
+            body.clear();
+            writeReportText(body, collectors, types, components);
+            bytes += body.size();
+        }
+        typed_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / iterations;
+        typed_allocations = (allocations - before) / static_cast<unsigned long long>(iterations);
+
+        // 只比较生成上报文本：DOM方式为JsonDomWriter建DOM后dump()，类型化方式为JsonTextWriter
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            nlohmann::json report;
+            JsonDomWriter writer(report);
+            writeReport(writer, collectors, types, components);
+            bytes += report.dump().size();
+        }
+        dom_serialize_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / iterations;
+
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            body.clear();
+            writeReportText(body, collectors, types, components);
+            bytes += body.size();
+        }
+        typed_serialize_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / iterations;
+    }
+
+    printf("%zu collectors, %d cycles\n", collectors.size(), iterations);
+    printf("json DOM path:  %7.1f us/cycle, %5llu allocations/cycle\n", dom_us, dom_allocations);
+    printf("typed path:     %7.1f us/cycle, %5llu allocations/cycle\n", typed_us, typed_allocations);
+    printf("serialization only: DOM + dump() %.1f us, JsonTextWriter %.1f us\n", dom_serialize_us, typed_serialize_us);
+    printf("(%zu bytes total)\n", bytes);
+    return diff.empty() ? 0 : 1;
+}
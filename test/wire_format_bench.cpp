@@ -0,0 +1,142 @@
+// 上报的三种编码：JSON、CBOR、MessagePack的字节数、Agent编码耗时和Manager解析耗时，并核对三者解析结果一致
+// 用法：./wire_format_bench [次数] [聚合指标数]，默认20000次、5项聚合，使用本机的/proc
+
+#include "cpu_collector.h"
+#include "memory_collector.h"
+#include "disk_collector.h"
+#include "network_collector.h"
+#include "pressure_collector.h"
+#include "metric_window.h"
+#include "sample_writer.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+// 与Agent上报中的组件状态相同结构的示例
+nlohmann::json makeComponents(int count) {
+    nlohmann::json components = nlohmann::json::array();
+    for (int i = 0; i < count; ++i) {
+        components.push_back({
+            {"component_id", "component-" + std::to_string(i)},
+            {"business_id", "business-1"},
+            {"type", i % 2 == 0 ? "docker" : "binary"},
+            {"status", "running"},
+            {"container_id", i % 2 == 0 ? "3f2a9c1d7e4b" : ""},
+            {"process_id", i % 2 == 0 ? "" : std::to_string(12345 + i)},
+            {"resource_usage", {{"cpu_percent", 12.5 + i}, {"memory_mb", 256 * (i + 1)}, {"gpu_percent", 0.0}}}
+        });
+    }
+    return components;
+}
+
+struct Report {
+    std::vector<std::unique_ptr<ResourceCollector>> collectors;
+    std::vector<std::string> types;
+    std::vector<std::pair<std::string, MetricWindow>> aggregates;
+    nlohmann::json components;
+};
+
+// 与Agent::writeReport相同的结构：节点、时间戳、各采集器样本、窗口聚合值和组件状态
+void writeReport(SampleWriter& writer, Report& report) {
+    writer.beginObject(nullptr);
+    writer.writeString("node_id", "node-bench");
+    writer.writeInt("timestamp", 1700000000000LL);
+    writer.beginObject("resource");
+    for (size_t i = 0; i < report.collectors.size(); ++i) {
+        writer.beginObject(report.types[i].c_str());
+        report.collectors[i]->writeSample(writer);
+        writer.endObject();
+    }
+    writer.endObject();
+    writer.beginObject("aggregates");
+    writer.beginObject("cpu");
+    for (auto& field : report.aggregates) {
+        writer.beginObject(field.first.c_str());
+        field.second.aggregate(writer);
+        writer.endObject();
+    }
+    writer.endObject();
+    writer.endObject();
+    writer.writeJson("components", report.components);
+    writer.endObject();
+}
+
+template <typename Writer>
+double encodeUs(Report& report, std::string& out, int iterations) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        out.clear();
+        Writer writer(out);
+        writeReport(writer, report);
+    }
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / iterations;
+}
+
+template <typename Parse>
+double parseUs(Parse parse, int iterations, size_t& checksum) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        checksum += parse().size();
+    }
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / iterations;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    int iterations = argc > 1 ? atoi(argv[1]) : 20000;
+    int aggregate_count = argc > 2 ? atoi(argv[2]) : 5;
+
+    Report report;
+    report.collectors.emplace_back(new CpuCollector());
+    report.collectors.emplace_back(new MemoryCollector());
+    report.collectors.emplace_back(new DiskCollector());
+    report.collectors.emplace_back(new NetworkCollector());
+    report.collectors.emplace_back(new PressureCollector());
+    for (auto& collector : report.collectors) {
+        report.types.push_back(collector->getType());
+        collector->sample();
+    }
+    // 每项聚合指标放入15个样本
+    for (int i = 0; i < aggregate_count; ++i) {
+        MetricWindow window;
+        for (int j = 0; j < 15; ++j) {
+            window.add(i * 1.7 + j * 0.13);
+        }
+        report.aggregates.emplace_back("metric_" + std::to_string(i), window);
+    }
+    report.components = makeComponents(4);
+
+    std::string json_text, cbor, msgpack;
+    double json_encode = 0.0, cbor_encode = 0.0, msgpack_encode = 0.0;
+    double json_parse = 0.0, cbor_parse = 0.0, msgpack_parse = 0.0;
+    size_t checksum = 0;
+    // 各编码交替跑两轮，取第二轮
+    for (int round = 0; round < 2; ++round) {
+        json_encode = encodeUs<JsonTextWriter>(report, json_text, iterations);
+        cbor_encode = encodeUs<CborWriter>(report, cbor, iterations);
+        msgpack_encode = encodeUs<MsgPackWriter>(report, msgpack, iterations);
+        json_parse = parseUs([&]() { return nlohmann::json::parse(json_text); }, iterations, checksum);
+        cbor_parse = parseUs([&]() { return nlohmann::json::from_cbor(cbor); }, iterations, checksum);
+        msgpack_parse = parseUs([&]() { return nlohmann::json::from_msgpack(msgpack); }, iterations, checksum);
+    }
+
+    nlohmann::json expected = nlohmann::json::parse(json_text);
+    bool cbor_equal = nlohmann::json::from_cbor(cbor) == expected;
+    bool msgpack_equal = nlohmann::json::from_msgpack(msgpack) == expected;
+
+    printf("%zu collectors, %d aggregate metrics, %zu components, %d iterations\n",
+           report.collectors.size(), aggregate_count, report.components.size(), iterations);
+    printf("                  %10s %10s %10s\n", "json", "cbor", "msgpack");
+    printf("bytes/report      %10zu %10zu %10zu\n", json_text.size(), cbor.size(), msgpack.size());
+    printf("agent encode us   %10.1f %10.1f %10.1f\n", json_encode, cbor_encode, msgpack_encode);
+    printf("manager parse us  %10.1f %10.1f %10.1f\n", json_parse, cbor_parse, msgpack_parse);
+    printf("decoded == json::parse: cbor %s, msgpack %s  (checksum %zu)\n",
+           cbor_equal ? "yes" : "NO", msgpack_equal ? "yes" : "NO", checksum);
+    return cbor_equal && msgpack_equal ? 0 : 1;
+}